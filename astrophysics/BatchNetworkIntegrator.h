@@ -0,0 +1,662 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#ifndef ASTROPHYSICS_BATCHNETWORKINTEGRATOR_H_
+#define ASTROPHYSICS_BATCHNETWORKINTEGRATOR_H_
+
+#include <ReactionNetwork.h>
+#include <array>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <math.h>
+
+namespace fire {
+namespace astrophysics {
+
+/**
+ * This structure describes a single zone - one thermodynamic trajectory
+ * point with constant temperature and density - that should be integrated by
+ * the BatchNetworkIntegrator. The abundances are read as initial conditions
+ * and overwritten with the final abundances.
+ */
+struct NetworkZone {
+
+	/**
+	 * The temperature of the zone in units of 10^9 Kelvin.
+	 */
+	double temperature = 0.0;
+
+	/**
+	 * The density of the zone.
+	 */
+	double density = 0.0;
+
+	/**
+	 * The time at which the integration should stop. The integration starts
+	 * at zero.
+	 */
+	double endTime = 0.0;
+
+	/**
+	 * The initial step size. If it is zero or less, the integrator picks one.
+	 */
+	double initialStepSize = 0.0;
+
+	/**
+	 * The abundances of the species in the network, in the same order as the
+	 * species in the ReactionNetwork.
+	 */
+	std::vector<double> abundances;
+
+	/**
+	 * The time actually reached by the integration. This is equal to endTime
+	 * unless the integration failed.
+	 */
+	double time = 0.0;
+
+	/**
+	 * The number of accepted steps taken for this zone.
+	 */
+	long numSteps = 0;
+
+	/**
+	 * The number of rejected steps taken for this zone.
+	 */
+	long numRejectedSteps = 0;
+
+	/**
+	 * True if the integration of this zone failed because the step size
+	 * underflowed or the maximum number of steps was exceeded.
+	 */
+	bool failed = false;
+};
+
+/**
+ * This class integrates many small reaction networks in lockstep by
+ * interleaving W zones in the lanes of SIMD registers. It is designed for
+ * networks like the 16 species, 48 reaction alpha network where a single zone
+ * is too small to fill a vector register, but where tens of thousands of zones
+ * need to be integrated.
+ *
+ * All per-zone data is stored with the lane index innermost, so that every
+ * operation on a species, reaction or matrix element is a loop of length W
+ * over zones that the compiler vectorizes: the rate evaluation, the flux
+ * accumulation through the network's flux maps, the Jacobian and a batched
+ * dense LU factorization and solve. Building with optimization
+ * (-DCMAKE_BUILD_TYPE=Release) is required for the loops to be vectorized.
+ *
+ * Each lane is integrated with the second order, L-stable Rosenbrock method
+ * ROS2 of Verwer et al. (SIAM J. Sci. Comput. 20, 1999)
+ * \f{eqnarray*}{
+ * (I - \gamma hJ)k_{1} &=& f(y_{n}) \\
+ * (I - \gamma hJ)k_{2} &=& f(y_{n} + hk_{1}) - 2k_{1} \\
+ * y_{n+1} &=& y_{n} + \frac{3}{2}hk_{1} + \frac{1}{2}hk_{2}
+ * \f}
+ * with \f$\gamma = 1 + 1/\sqrt{2}\f$ and the embedded first order solution
+ * \f$y_{n} + hk_{1}\f$ for error control. The method is linearly implicit, so
+ * each step costs exactly one Jacobian, one factorization and two right hand
+ * side evaluations for every lane, which keeps the lanes in lockstep. Each
+ * lane has its own time and step size. Lanes that reject a step simply do
+ * not advance, and when a zone finishes its lane is refilled with the next
+ * zone. Lanes left without zones at the end of the batch are masked out.
+ *
+ * The LU factorization does not pivot because pivoting would break the
+ * lockstep. The matrix I - gamma*h*J of a reaction network is dominated by
+ * its diagonal for small h, so a lane that encounters a vanishing pivot just
+ * rejects the step and tries again with a smaller one.
+ *
+ * The integrator is used as follows:
+ * @code
+ * ReactionNetwork & network = ...; // loaded network
+ * BatchNetworkIntegrator<4> integrator(network);
+ * std::vector<NetworkZone> zones = ...;
+ * integrator.integrate(zones);
+ * @endcode
+ */
+template<int W>
+class BatchNetworkIntegrator {
+
+public:
+
+	/**
+	 * The type used to store one value for every lane.
+	 */
+	typedef std::array<double,W> Lanes;
+
+protected:
+
+	/**
+	 * The number of species in the network.
+	 */
+	int numSpecies;
+
+	/**
+	 * The number of reactions in the network.
+	 */
+	int numReactions;
+
+	/**
+	 * The REACLIB coefficients of each reaction.
+	 */
+	std::vector<std::array<double,7>> rateCoeffs;
+
+	/**
+	 * The statistical factor of each reaction.
+	 */
+	std::vector<double> statisticalFactors;
+
+	/**
+	 * The number of reactants of each reaction.
+	 */
+	std::vector<int> numReactants;
+
+	/**
+	 * The species indices of the reactants of each reaction.
+	 */
+	std::vector<std::array<int,3>> reactants;
+
+	/**
+	 * The offsets into stoichSpecies and stoichCoeffs for each reaction. This
+	 * is the transpose of the network's F+ and F- maps: for reaction r, the
+	 * entries in [stoichOffsets[r],stoichOffsets[r+1]) list the species
+	 * changed by the reaction and the (signed) factor of the change.
+	 */
+	std::vector<int> stoichOffsets;
+
+	/**
+	 * The species changed by each reaction. See stoichOffsets.
+	 */
+	std::vector<int> stoichSpecies;
+
+	/**
+	 * The signed factors for each species changed by each reaction. See
+	 * stoichOffsets.
+	 */
+	std::vector<double> stoichCoeffs;
+
+	/**
+	 * The relative tolerance of the local error test.
+	 */
+	double relTol = 1.0e-4;
+
+	/**
+	 * The absolute tolerance of the local error test.
+	 */
+	double absTol = 1.0e-10;
+
+	/**
+	 * The maximum number of steps per zone.
+	 */
+	long maxNumSteps = 100000;
+
+	/**
+	 * The reaction rates for every lane.
+	 */
+	std::vector<Lanes> rates;
+
+	/**
+	 * The reaction fluxes for every lane.
+	 */
+	std::vector<Lanes> fluxes;
+
+	/**
+	 * The iteration matrix, row major, for every lane.
+	 */
+	std::vector<Lanes> matrix;
+
+	/**
+	 * Work vectors for the solution, the derivatives and the stages.
+	 */
+	std::vector<Lanes> y, yNew, f, k1, k2;
+
+	/**
+	 * The temperature, density, time, step size and final time of each lane.
+	 */
+	Lanes temperatures, densities, t, h, tEnd;
+
+	/**
+	 * The index of the zone in each lane or -1 if the lane is masked out.
+	 */
+	std::array<int,W> laneZones;
+
+	/**
+	 * This operation builds the per-reaction stoichiometry from the flux maps
+	 * of the network.
+	 */
+	void buildStoichiometry(const ReactionNetwork & network) {
+		std::vector<std::vector<std::pair<int,double>>> entries(numReactions);
+		// The maximums are cumulative, so the number of entries for each
+		// species is the difference between consecutive maximums. The
+		// unsigned arithmetic wraps correctly for species without entries.
+		int plusStart = 0, minusStart = 0;
+		for (int i = 0; i < numSpecies; i++) {
+			int plusCount = (unsigned short) (network.fPlusMaximums[i] + 1
+					- plusStart);
+			for (int j = plusStart; j < plusStart + plusCount; j++) {
+				entries[(int) network.fPlusMap[j]].emplace_back(i,
+						network.fPlusFactors[j]);
+			}
+			plusStart += plusCount;
+			int minusCount = (unsigned short) (network.fMinusMaximums[i] + 1
+					- minusStart);
+			for (int j = minusStart; j < minusStart + minusCount; j++) {
+				entries[(int) network.fMinusMap[j]].emplace_back(i,
+						-network.fMinusFactors[j]);
+			}
+			minusStart += minusCount;
+		}
+		stoichOffsets.assign(1,0);
+		for (auto & reactionEntries : entries) {
+			for (auto & entry : reactionEntries) {
+				stoichSpecies.push_back(entry.first);
+				stoichCoeffs.push_back(entry.second);
+			}
+			stoichOffsets.push_back(stoichSpecies.size());
+		}
+	}
+
+	/**
+	 * This operation computes the reaction rates for the lanes with a
+	 * nonzero entry in mask.
+	 */
+	void computeRates(const std::array<int,W> & mask) {
+		Lanes tempValues[6];
+		for (int l = 0; l < W; l++) {
+			double temp = mask[l] ? temperatures[l] : 1.0, cbrtT = cbrt(temp);
+			tempValues[0][l] = 1.0/temp;
+			tempValues[1][l] = 1.0/cbrtT;
+			tempValues[2][l] = cbrtT;
+			tempValues[3][l] = temp;
+			tempValues[4][l] = cbrtT*cbrtT*cbrtT*cbrtT*cbrtT;
+			tempValues[5][l] = log(temp);
+		}
+		for (int r = 0; r < numReactions; r++) {
+			auto & p = rateCoeffs[r];
+			auto & rate = rates[r];
+			for (int l = 0; l < W; l++) {
+				if (!mask[l]) continue;
+				double x = p[0] + tempValues[0][l]*p[1] + tempValues[1][l]*p[2]
+						+ tempValues[2][l]*p[3] + tempValues[3][l]*p[4]
+						+ tempValues[4][l]*p[5] + tempValues[5][l]*p[6];
+				double prefactor = statisticalFactors[r]
+						*pow(densities[l],numReactants[r]-1);
+				rate[l] = prefactor*exp(x);
+			}
+		}
+	}
+
+	/**
+	 * This operation computes the time derivatives dydt of the abundances
+	 * yVals for all lanes.
+	 */
+	void computeDerivatives(const std::vector<Lanes> & yVals,
+			std::vector<Lanes> & dydt) {
+		// Compute the flux due to each reaction
+		for (int r = 0; r < numReactions; r++) {
+			auto & flux = fluxes[r];
+			auto & rate = rates[r];
+			auto & y0 = yVals[reactants[r][0]];
+			for (int l = 0; l < W; l++) flux[l] = rate[l]*y0[l];
+			if (numReactants[r] > 1) {
+				auto & y1 = yVals[reactants[r][1]];
+				for (int l = 0; l < W; l++) flux[l] *= y1[l];
+			}
+			if (numReactants[r] > 2) {
+				auto & y2 = yVals[reactants[r][2]];
+				for (int l = 0; l < W; l++) flux[l] *= y2[l];
+			}
+		}
+		// Accumulate the fluxes into the derivatives
+		for (int i = 0; i < numSpecies; i++) dydt[i].fill(0.0);
+		for (int r = 0; r < numReactions; r++) {
+			auto & flux = fluxes[r];
+			for (int e = stoichOffsets[r]; e < stoichOffsets[r+1]; e++) {
+				auto & d = dydt[stoichSpecies[e]];
+				double coeff = stoichCoeffs[e];
+				for (int l = 0; l < W; l++) d[l] += coeff*flux[l];
+			}
+		}
+	}
+
+	/**
+	 * This operation computes the iteration matrix I - gamma*h*J for all lanes
+	 * and stores it in matrix.
+	 */
+	void computeMatrix(const std::vector<Lanes> & yVals, const double & gamma) {
+		jacobian(yVals,matrix);
+		Lanes scale;
+		for (int l = 0; l < W; l++) scale[l] = -gamma*h[l];
+		for (int i = 0; i < numSpecies*numSpecies; i++) {
+			auto & a = matrix[i];
+			for (int l = 0; l < W; l++) a[l] *= scale[l];
+		}
+		for (int i = 0; i < numSpecies; i++) {
+			auto & a = matrix[i*numSpecies + i];
+			for (int l = 0; l < W; l++) a[l] += 1.0;
+		}
+	}
+
+	/**
+	 * This operation LU factors the matrix in place for all lanes without
+	 * pivoting. The diagonal of U is replaced by its inverse. Lanes that
+	 * encounter a vanishing pivot are flagged with a zero in ok.
+	 */
+	void factor(std::array<int,W> & ok) {
+		const int n = numSpecies;
+		ok.fill(1);
+		for (int k = 0; k < n; k++) {
+			auto & pivot = matrix[k*n + k];
+			for (int l = 0; l < W; l++) {
+				ok[l] &= (fabs(pivot[l]) > 1.0e-300);
+				pivot[l] = (ok[l]) ? 1.0/pivot[l] : 0.0;
+			}
+			for (int i = k + 1; i < n; i++) {
+				auto & lik = matrix[i*n + k];
+				for (int l = 0; l < W; l++) lik[l] *= pivot[l];
+				for (int j = k + 1; j < n; j++) {
+					auto & aij = matrix[i*n + j];
+					auto & akj = matrix[k*n + j];
+					for (int l = 0; l < W; l++) aij[l] -= lik[l]*akj[l];
+				}
+			}
+		}
+	}
+
+	/**
+	 * This operation solves the factored system in place for all lanes.
+	 */
+	void solve(std::vector<Lanes> & b) {
+		const int n = numSpecies;
+		for (int i = 1; i < n; i++) {
+			auto & bi = b[i];
+			for (int j = 0; j < i; j++) {
+				auto & lij = matrix[i*n + j];
+				auto & bj = b[j];
+				for (int l = 0; l < W; l++) bi[l] -= lij[l]*bj[l];
+			}
+		}
+		for (int i = n - 1; i >= 0; i--) {
+			auto & bi = b[i];
+			for (int j = i + 1; j < n; j++) {
+				auto & uij = matrix[i*n + j];
+				auto & bj = b[j];
+				for (int l = 0; l < W; l++) bi[l] -= uij[l]*bj[l];
+			}
+			auto & uii = matrix[i*n + i];
+			for (int l = 0; l < W; l++) bi[l] *= uii[l];
+		}
+	}
+
+	/**
+	 * This operation loads a zone into a lane.
+	 */
+	void loadLane(const int & lane, const int & zoneId, NetworkZone & zone) {
+		if ((int) zone.abundances.size() != numSpecies) {
+			throw std::runtime_error("Zone abundances do not match the network size.");
+		}
+		laneZones[lane] = zoneId;
+		temperatures[lane] = zone.temperature;
+		densities[lane] = zone.density;
+		t[lane] = 0.0;
+		tEnd[lane] = zone.endTime;
+		h[lane] = (zone.initialStepSize > 0.0) ? zone.initialStepSize
+				: 1.0e-10*zone.endTime;
+		zone.numSteps = 0;
+		zone.numRejectedSteps = 0;
+		zone.failed = false;
+		for (int i = 0; i < numSpecies; i++) y[i][lane] = zone.abundances[i];
+	}
+
+	/**
+	 * This operation stores the solution in a lane back in its zone.
+	 */
+	void storeLane(const int & lane, NetworkZone & zone) {
+		for (int i = 0; i < numSpecies; i++) zone.abundances[i] = y[i][lane];
+		zone.time = t[lane];
+		laneZones[lane] = -1;
+	}
+
+public:
+
+	/**
+	 * The constructor. It copies everything that it needs from the network,
+	 * which must already be loaded.
+	 * @param network the reaction network
+	 */
+	BatchNetworkIntegrator(const ReactionNetwork & network) :
+		numSpecies(network.numSpecies), numReactions(network.numReactions) {
+		for (auto & reaction : *network.reactions) {
+			rateCoeffs.push_back(reaction.reaclibRateCoeff);
+			statisticalFactors.push_back(reaction.statisticalFactor);
+			numReactants.push_back(reaction.numReactants);
+			reactants.push_back(reaction.reactants);
+		}
+		buildStoichiometry(network);
+		rates.resize(numReactions);
+		fluxes.resize(numReactions);
+		matrix.resize(numSpecies*numSpecies);
+		y.resize(numSpecies);
+		yNew.resize(numSpecies);
+		f.resize(numSpecies);
+		k1.resize(numSpecies);
+		k2.resize(numSpecies);
+		laneZones.fill(-1);
+		h.fill(0.0);
+	}
+
+	/**
+	 * This operation sets the relative and absolute tolerances of the local
+	 * error test.
+	 * @param rtol the relative tolerance
+	 * @param atol the absolute tolerance
+	 */
+	void tolerances(const double & rtol, const double & atol) {
+		relTol = rtol;
+		absTol = atol;
+	}
+
+	/**
+	 * This operation sets the maximum number of steps per zone.
+	 * @param steps the maximum number of accepted and rejected steps
+	 */
+	void maxSteps(const long & steps) { maxNumSteps = steps;};
+
+	/**
+	 * This operation sets the temperature and density of a lane and computes
+	 * its reaction rates. It is normally only called internally, but is
+	 * useful along with derivatives() and jacobian() for checking the lanes.
+	 * @param lane the lane
+	 * @param temperature the temperature in units of 10^9 K
+	 * @param density the density
+	 */
+	void conditions(const int & lane, const double & temperature,
+			const double & density) {
+		std::array<int,W> mask;
+		mask.fill(0);
+		mask[lane] = 1;
+		temperatures[lane] = temperature;
+		densities[lane] = density;
+		computeRates(mask);
+	}
+
+	/**
+	 * This operation computes the time derivatives of the abundances for all
+	 * lanes under the conditions set by conditions().
+	 * @param yVals the abundances of each species for every lane
+	 * @param dydt the time derivatives of each species for every lane
+	 */
+	void derivatives(const std::vector<Lanes> & yVals, std::vector<Lanes> & dydt) {
+		dydt.resize(numSpecies);
+		computeDerivatives(yVals,dydt);
+	}
+
+	/**
+	 * This operation computes the Jacobian of the time derivatives for all
+	 * lanes under the conditions set by conditions(). The Jacobian is
+	 * computed directly from the flux structure of the network. The flux of a
+	 * reaction is its rate times the product of its reactant abundances, so
+	 * its derivative with respect to each reactant is the rate times the
+	 * product of the other reactant abundances.
+	 * @param yVals the abundances of each species for every lane
+	 * @param jac the row major Jacobian for every lane
+	 */
+	void jacobian(const std::vector<Lanes> & yVals, std::vector<Lanes> & jac) {
+		const int n = numSpecies;
+		jac.resize(n*n);
+		for (auto & entry : jac) entry.fill(0.0);
+		Lanes dFlux;
+		for (int r = 0; r < numReactions; r++) {
+			auto & rate = rates[r];
+			int nR = numReactants[r];
+			for (int p = 0; p < nR; p++) {
+				for (int l = 0; l < W; l++) dFlux[l] = rate[l];
+				for (int m = 0; m < nR; m++) {
+					if (m == p) continue;
+					auto & ym = yVals[reactants[r][m]];
+					for (int l = 0; l < W; l++) dFlux[l] *= ym[l];
+				}
+				int q = reactants[r][p];
+				for (int e = stoichOffsets[r]; e < stoichOffsets[r+1]; e++) {
+					auto & jsq = jac[stoichSpecies[e]*n + q];
+					double coeff = stoichCoeffs[e];
+					for (int l = 0; l < W; l++) jsq[l] += coeff*dFlux[l];
+				}
+			}
+		}
+	}
+
+	/**
+	 * This operation integrates all of the zones from t = 0 to their end
+	 * times, W zones at a time.
+	 * @param zones the zones. The abundances, time and statistics of each
+	 * zone are updated in place.
+	 */
+	void integrate(std::vector<NetworkZone> & zones) {
+
+		const double gamma = 1.0 + 1.0/sqrt(2.0);
+		const int n = numSpecies;
+		int nextZone = 0, numZones = zones.size();
+		std::array<int,W> mask, ok;
+
+		// Fill the lanes
+		laneZones.fill(-1);
+		mask.fill(0);
+		for (int l = 0; l < W && nextZone < numZones; l++, nextZone++) {
+			loadLane(l,nextZone,zones[nextZone]);
+			mask[l] = 1;
+		}
+		computeRates(mask);
+
+		while (std::any_of(laneZones.begin(),laneZones.end(),
+				[](const int & zone) {return zone >= 0;})) {
+
+			// Masked lanes take zero steps and the others are clamped to
+			// their final times.
+			for (int l = 0; l < W; l++) {
+				h[l] = (laneZones[l] < 0) ? 0.0 : std::min(h[l],tEnd[l] - t[l]);
+			}
+
+			// k1
+			computeDerivatives(y,f);
+			computeMatrix(y,gamma);
+			factor(ok);
+			for (int i = 0; i < n; i++) k1[i] = f[i];
+			solve(k1);
+			// k2
+			for (int i = 0; i < n; i++) {
+				for (int l = 0; l < W; l++) yNew[i][l] = y[i][l] + h[l]*k1[i][l];
+			}
+			computeDerivatives(yNew,k2);
+			for (int i = 0; i < n; i++) {
+				for (int l = 0; l < W; l++) k2[i][l] -= 2.0*k1[i][l];
+			}
+			solve(k2);
+
+			// New solution and error estimate
+			Lanes err;
+			err.fill(0.0);
+			for (int i = 0; i < n; i++) {
+				for (int l = 0; l < W; l++) {
+					yNew[i][l] = y[i][l] + h[l]*(1.5*k1[i][l] + 0.5*k2[i][l]);
+					double scale = absTol
+							+ relTol*std::max(fabs(y[i][l]),fabs(yNew[i][l]));
+					double e = 0.5*h[l]*(k1[i][l] + k2[i][l])/scale;
+					err[l] += e*e;
+				}
+			}
+
+			// Accept or reject the step for each lane and refill the lanes
+			// that finish.
+			mask.fill(0);
+			for (int l = 0; l < W; l++) {
+				int zoneId = laneZones[l];
+				if (zoneId < 0) continue;
+				NetworkZone & zone = zones[zoneId];
+				double e = sqrt(err[l]/n);
+				double factor = (e > 0.0) ? 0.9/sqrt(e) : 5.0;
+				if (ok[l] && e <= 1.0 && std::isfinite(e)) {
+					t[l] += h[l];
+					for (int i = 0; i < n; i++) y[i][l] = yNew[i][l];
+					zone.numSteps++;
+					h[l] *= std::min(5.0,std::max(0.2,factor));
+				} else {
+					zone.numRejectedSteps++;
+					h[l] *= (ok[l] && std::isfinite(e)) ? std::max(0.2,factor) : 0.25;
+				}
+				bool finished = t[l] >= tEnd[l];
+				bool failed = (zone.numSteps + zone.numRejectedSteps > maxNumSteps)
+						|| (t[l] + h[l] == t[l]);
+				if (finished || failed) {
+					zone.failed = !finished;
+					storeLane(l,zone);
+					if (nextZone < numZones) {
+						loadLane(l,nextZone,zones[nextZone]);
+						nextZone++;
+						mask[l] = 1;
+					}
+				}
+			}
+			if (std::any_of(mask.begin(),mask.end(),
+					[](const int & m) {return m != 0;})) {
+				computeRates(mask);
+			}
+		}
+
+		return;
+	}
+
+};
+
+} /* namespace astrophysics */
+} /* namespace fire */
+
+#endif /* ASTROPHYSICS_BATCHNETWORKINTEGRATOR_H_ */
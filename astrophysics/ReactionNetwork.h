@@ -161,6 +161,26 @@ public:
 	 */
 	int numFMinus;
 
+	/**
+	 * The total detracting flux for each species, as computed by the most
+	 * recent call to computeFluxes(). Dividing by the abundance of the species
+	 * gives its destruction rate, which approximates the diagonal of the
+	 * Jacobian and is used to precondition iterative solvers.
+	 * (Size = numSpecies)
+	 */
+	vector<double> fMinusSums;
+
+	/**
+	 * The temperature, in units of 10^9 Kelvin, passed to the most recent
+	 * call to computeRates().
+	 */
+	double temperature = 0.0;
+
+	/**
+	 * The density passed to the most recent call to computePrefactors().
+	 */
+	double density = 0.0;
+
 	double & operator()(int i) { return species->at(i).massFraction; }
 
 
@@ -399,6 +419,7 @@ public:
 	 * @param rho the current density in units of g/m^3.
 	 */
 	void computePrefactors(const double & rho) {
+		density = rho;
 		// Compute the factors.
 		for(Reaction & reaction : *reactions) {
 	        reaction.setPrefactor(rho);
@@ -412,6 +433,7 @@ public:
 	 * @param temp the current temperature in units of 10^9 Kelvin.
 	 */
 	void computeRates(const double & temp) {
+		temperature = temp;
 		// Compute the temperatures
 		array<double,6> tempValues;
 		double cbrtT = cbrt(temp); // Cube root of T
@@ -452,10 +474,9 @@ public:
 				reactionFlux[i] *=
 						(species->at(reaction.reactants[1]).massFraction);
 			// 3 Body
-			else if (reaction.numReactants > 2)
+			if (reaction.numReactants > 2)
 				reactionFlux[i] *=
-						(species->at(reaction.reactants[1]).massFraction)
-								* (species->at(reaction.reactants[2]).massFraction);
+						(species->at(reaction.reactants[2]).massFraction);
 		}
 
 		// Populate the incoming (fPlus) and outgoing flux (fMinus).
@@ -488,6 +509,60 @@ public:
 			}
 			species->at(i).flux = fPlusSum[i] - fMinusSum[i];
 		}
+		fMinusSums = fMinusSum;
+
+		return;
+	}
+
+	/**
+	 * This operation computes the product of the Jacobian of the species
+	 * fluxes with a vector v without forming the Jacobian. The flux of each
+	 * reaction is its rate times the product of its reactant abundances, so
+	 * the directional derivative of the flux along v is the rate times the
+	 * sum over reactants of v for that reactant times the abundances of the
+	 * other reactants. These reaction derivatives are then distributed to
+	 * the species through the same F+ and F- maps used by computeFluxes(), so
+	 * the cost is the same as one flux evaluation.
+	 *
+	 * computeRates() must be called before this operation.
+	 *
+	 * @param v the vector to multiply, of size numSpecies
+	 * @param jv the product, of size numSpecies, which is set on exit
+	 */
+	void computeJacobianVectorProduct(const double * v, double * jv) {
+
+		vector<double> reactionFlux(numReactions, 0);
+
+		// Compute the derivative of the flux due to each reaction along v
+		for (int i = 0; i < numReactions; i++) {
+			Reaction & reaction = reactions->at(i);
+			double y[3], sum = 0.0;
+			for (int k = 0; k < reaction.numReactants; k++) {
+				y[k] = species->at(reaction.reactants[k]).massFraction;
+			}
+			for (int k = 0; k < reaction.numReactants; k++) {
+				double term = v[reaction.reactants[k]];
+				for (int m = 0; m < reaction.numReactants; m++) {
+					if (m != k) term *= y[m];
+				}
+				sum += term;
+			}
+			reactionFlux[i] = reaction.rate * sum;
+		}
+
+		// Sum the contributing and detracting terms for each species.
+		int minny;
+		for (int i = 0; i < numSpecies; i++) {
+			jv[i] = 0.0;
+			minny = (i > 0) ? fPlusMaximums[i - 1] + 1 : 0;
+			for (int j = minny; j <= fPlusMaximums[i]; j++) {
+				jv[i] += fPlusFactors[j] * reactionFlux[fPlusMap[j]];
+			}
+			minny = (i > 0) ? fMinusMaximums[i - 1] + 1 : 0;
+			for (int j = minny; j <= fMinusMaximums[i]; j++) {
+				jv[i] -= fMinusFactors[j] * reactionFlux[fMinusMap[j]];
+			}
+		}
 
 		return;
 	}
@@ -546,6 +621,45 @@ double * State<ReactionNetwork>::dudt(const double & t) {
 	return dudtPtr;
 };
 
+template<>
+std::vector<double> State<ReactionNetwork>::parameters() {
+	// The conditions under which the rates were computed
+	return {state.temperature, state.density};
+};
+
+template<>
+void State<ReactionNetwork>::parameters(const std::vector<double> & params) {
+	// Recompute the prefactors and rates for the stored conditions
+	state.computePrefactors(params.at(1));
+	state.computeRates(params.at(0));
+	return;
+};
+
+template<>
+void State<ReactionNetwork>::jv(const double &, const double * v,
+		double * jvData) {
+	// The network computes the product directly from its flux structure.
+	state.computeJacobianVectorProduct(v, jvData);
+	return;
+};
+
+template<>
+bool State<ReactionNetwork>::jacobianDiagonal(const double &, double * diag) {
+
+	// Compute the detracting fluxes at the current abundances
+	state.computeFluxes();
+
+	// The diagonal is approximated by the negative of the destruction rate of
+	// each species. Species that are not present have no destruction flux
+	// and do not contribute.
+	for (int i = 0; i < systemSize; i++) {
+		double abundance = state.species->at(i).massFraction;
+		diag[i] = (abundance > 0.0) ? -state.fMinusSums[i]/abundance : 0.0;
+	}
+
+	return true;
+};
+
 } /** namespace fire **/
 
 
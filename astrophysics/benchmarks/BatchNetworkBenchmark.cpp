@@ -0,0 +1,115 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+
+/**
+ * This program measures the throughput of integrating many zones of the
+ * alpha network with the BatchNetworkIntegrator, with
+ *
+ * 1) one lane, which integrates the zones independently, one at a time,
+ * 2) four lanes, and
+ * 3) eight lanes, which integrate four or eight zones in lockstep.
+ *
+ * Every zone is integrated with the same method, so each zone takes the
+ * same steps, up to rounding, and only the throughput differs. It must
+ * be built with optimization (-DCMAKE_BUILD_TYPE=Release) for the lanes to
+ * be vectorized. It reads alpha_gold.ini and its data files from the working
+ * directory.
+ *
+ * Usage: BatchNetworkBenchmark [number of zones, default 1024]
+ */
+
+#include <INIPropertyParser.h>
+#include <BatchNetworkIntegrator.h>
+#include <chrono>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdlib>
+
+using namespace std;
+using namespace fire;
+using namespace fire::astrophysics;
+
+/**
+ * This operation integrates a copy of the zones with W lanes and reports
+ * the number of zones per second.
+ */
+template<int W>
+double time(const string & name, const ReactionNetwork & network,
+		vector<NetworkZone> zones) {
+	BatchNetworkIntegrator<W> integrator(network);
+	auto start = chrono::steady_clock::now();
+	integrator.integrate(zones);
+	chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+	double checksum = 0.0;
+	long steps = 0;
+	for (auto & zone : zones) {
+		for (auto & abundance : zone.abundances) checksum += abundance;
+		steps += zone.numSteps;
+	}
+	cout << name << ": " << elapsed.count() << " s, "
+			<< zones.size()/elapsed.count() << " zones/s, " << steps
+			<< " steps (checksum " << checksum << ")" << endl;
+	return elapsed.count();
+}
+
+int main(int argc, char ** argv) {
+
+	int numZones = (argc > 1) ? atoi(argv[1]) : 1024;
+	ReactionNetwork network;
+	INIPropertyParser parser =
+			build<INIPropertyParser,const string &>("alpha_gold.ini");
+	network.setProperties(parser.getPropertyBlock("network"));
+	network.load();
+	cout << "Integrating " << numZones << " zones of a network with "
+			<< network.numSpecies << " species and " << network.numReactions
+			<< " reactions." << endl;
+
+	// Pure He4 burning over a range of temperatures and densities
+	vector<NetworkZone> zones(numZones);
+	for (int z = 0; z < numZones; z++) {
+		zones[z].temperature = 2.0 + (6.0*z)/numZones;
+		zones[z].density = 1.0e8/(1.0 + (9.0*z)/numZones);
+		zones[z].endTime = 1.0e-4;
+		zones[z].abundances.assign(network.numSpecies, 0.0);
+		zones[z].abundances[0] = 0.25;
+	}
+
+	double before = time<1>("Independent zones (1 lane)", network, zones);
+	double four = time<4>("Lockstep zones (4 lanes)", network, zones);
+	double eight = time<8>("Lockstep zones (8 lanes)", network, zones);
+
+	cout << "Speedup with 4 lanes: " << before/four << endl;
+	cout << "Speedup with 8 lanes: " << before/eight << endl;
+
+	return 0;
+}
@@ -0,0 +1,186 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2015-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE BatchNetworkIntegrator
+
+#include <boost/test/included/unit_test.hpp>
+#include <vector>
+#include <string>
+#include <INIPropertyParser.h>
+#include <BatchNetworkIntegrator.h>
+
+using namespace std;
+using namespace fire;
+using namespace fire::astrophysics;
+
+static const string & propertyFileName = "alpha_gold.ini";
+
+/**
+ * This operation loads the alpha network used by all of the tests.
+ */
+static void loadNetwork(ReactionNetwork & network) {
+	INIPropertyParser parser = build<INIPropertyParser,const string &>(propertyFileName);
+	auto props = parser.getPropertyBlock("network");
+	network.setProperties(props);
+	network.load();
+}
+
+/**
+ * This operation creates a set of abundances for every species in the network
+ * that is nonzero for all species, so that all of the flux terms contribute.
+ */
+static vector<double> testAbundances(ReactionNetwork & network, const double & scale) {
+	vector<double> abundances;
+	for (int i = 0; i < network.numSpecies; i++) {
+		abundances.push_back(scale*(1.0e-3 + 1.0e-4*i)
+				/network.species->at(i).massNumber);
+	}
+	return abundances;
+}
+
+/**
+ * This operation checks that the batched derivatives and the analytic Jacobian
+ * agree with the scalar network.
+ */
+BOOST_AUTO_TEST_CASE(checkDerivatives) {
+
+	ReactionNetwork network;
+	loadNetwork(network);
+	int n = network.numSpecies;
+	BatchNetworkIntegrator<4> integrator(network);
+
+	// Give each lane a different set of conditions and abundances
+	vector<double> temps = {7.0, 5.0, 3.0, 1.5}, densities = {1.0e8, 1.0e7,
+			1.0e6, 1.0e5};
+	vector<array<double,4>> y(n), dydt, jac;
+	for (int l = 0; l < 4; l++) {
+		integrator.conditions(l,temps[l],densities[l]);
+		auto abundances = testAbundances(network,1.0 + l);
+		for (int i = 0; i < n; i++) y[i][l] = abundances[i];
+	}
+	integrator.derivatives(y,dydt);
+
+	// Compare each lane with the scalar network
+	for (int l = 0; l < 4; l++) {
+		network.computePrefactors(densities[l]);
+		network.computeRates(temps[l]);
+		for (int i = 0; i < n; i++) network.species->at(i).massFraction = y[i][l];
+		network.computeFluxes();
+		for (int i = 0; i < n; i++) {
+			BOOST_REQUIRE_CLOSE(network.species->at(i).flux,dydt[i][l],1.0e-8);
+		}
+	}
+
+	// Check the Jacobian against centered finite differences. The errors are
+	// measured relative to the largest term in each row, since the Jacobian
+	// has entries that are many orders of magnitude smaller than the others.
+	integrator.jacobian(y,jac);
+	vector<array<double,4>> rowScales(n);
+	for (int i = 0; i < n; i++) {
+		for (int l = 0; l < 4; l++) {
+			rowScales[i][l] = 0.0;
+			for (int j = 0; j < n; j++) {
+				rowScales[i][l] = max(rowScales[i][l],fabs(jac[i*n+j][l]*y[j][l]));
+			}
+		}
+	}
+	for (int j = 0; j < n; j++) {
+		vector<array<double,4>> yPlus = y, yMinus = y, fPlus, fMinus;
+		array<double,4> dy;
+		for (int l = 0; l < 4; l++) {
+			dy[l] = 1.0e-6*y[j][l];
+			yPlus[j][l] += dy[l];
+			yMinus[j][l] -= dy[l];
+		}
+		integrator.derivatives(yPlus,fPlus);
+		integrator.derivatives(yMinus,fMinus);
+		for (int i = 0; i < n; i++) {
+			for (int l = 0; l < 4; l++) {
+				double fd = (fPlus[i][l] - fMinus[i][l])/(2.0*dy[l]);
+				BOOST_REQUIRE_SMALL((fd - jac[i*n+j][l])*y[j][l]/rowScales[i][l],
+						1.0e-6);
+			}
+		}
+	}
+
+	return;
+}
+
+/**
+ * This operation checks that integrating a batch of zones in lockstep gives
+ * the same answers as integrating them one at a time and that baryon number
+ * is conserved.
+ */
+BOOST_AUTO_TEST_CASE(checkIntegration) {
+
+	ReactionNetwork network;
+	loadNetwork(network);
+	int n = network.numSpecies;
+
+	// Create more zones than lanes so that lanes are refilled, with the
+	// number of zones not divisible by the number of lanes so that some
+	// lanes are masked at the end.
+	vector<NetworkZone> zones(7);
+	for (int z = 0; z < (int) zones.size(); z++) {
+		zones[z].temperature = 2.0 + 0.75*z;
+		zones[z].density = 1.0e8/(1.0 + z);
+		zones[z].endTime = 1.0e-4*(1.0 + z);
+		zones[z].abundances.assign(n,0.0);
+		// Start with pure He4, species 0
+		zones[z].abundances[0] = 0.25;
+	}
+	vector<NetworkZone> batchZones = zones, singleZones = zones;
+
+	BatchNetworkIntegrator<4> batch(network);
+	batch.integrate(batchZones);
+	BatchNetworkIntegrator<1> single(network);
+	single.integrate(singleZones);
+
+	for (int z = 0; z < (int) zones.size(); z++) {
+		BOOST_REQUIRE(!batchZones[z].failed);
+		BOOST_REQUIRE_CLOSE(zones[z].endTime,batchZones[z].time,1.0e-10);
+		BOOST_REQUIRE_GT(batchZones[z].numSteps,0);
+		// The lanes are independent, so the step sequence is the same.
+		BOOST_REQUIRE_EQUAL(singleZones[z].numSteps,batchZones[z].numSteps);
+		double sumAY = 0.0;
+		for (int i = 0; i < n; i++) {
+			BOOST_REQUIRE_CLOSE(singleZones[z].abundances[i],
+					batchZones[z].abundances[i],1.0e-8);
+			sumAY += network.species->at(i).massNumber*batchZones[z].abundances[i];
+		}
+		BOOST_REQUIRE_CLOSE(1.0,sumAY,1.0e-6);
+	}
+	// He4 should have burned in the hottest zone
+	BOOST_REQUIRE_LT(batchZones.back().abundances[0],0.25);
+
+	return;
+}
@@ -37,6 +37,8 @@
 #include <string>
 #include <INIPropertyParser.h>
 #include <ReactionNetwork.h>
+#include <algorithm>
+#include <math.h>
 
 using namespace std;
 using namespace fire;
@@ -128,3 +130,67 @@ BOOST_AUTO_TEST_CASE(checkLoading) {
 
 
 
+
+/**
+ * This operation checks the Jacobian-vector product and the Jacobian diagonal
+ * that the network provides to the matrix-free solvers against finite
+ * differences of the fluxes.
+ */
+BOOST_AUTO_TEST_CASE(checkJacobianVectorProduct) {
+
+	// Load the network
+	INIPropertyParser parser = build<INIPropertyParser,const string &>(propertyFileName);
+	State<ReactionNetwork> state;
+	ReactionNetwork & network = state.get();
+	auto props = parser.getPropertyBlock("network");
+	network.setProperties(props);
+	network.load();
+	int n = network.numSpecies;
+	state.size(n);
+	network.computePrefactors(1.0e8);
+	network.computeRates(7.0);
+
+	// Give every species a nonzero abundance so that all terms contribute.
+	vector<double> y(n), v(n), jv(n);
+	for (int i = 0; i < n; i++) {
+		y[i] = (1.0e-3 + 1.0e-4*i)/network.species->at(i).massNumber;
+		v[i] = (i % 2 == 0) ? y[i] : -0.5*y[i];
+	}
+	state.u(y.data());
+	state.jv(0.0,v.data(),jv.data());
+
+	// Compute the product with a centered finite difference
+	double sigma = 1.0e-6;
+	vector<double> yPlus(n), yMinus(n), fPlus(n), fMinus(n);
+	for (int i = 0; i < n; i++) {
+		yPlus[i] = y[i] + sigma*v[i];
+		yMinus[i] = y[i] - sigma*v[i];
+	}
+	state.u(yPlus.data());
+	double * f = state.dudt(0.0);
+	copy(f,f + n,fPlus.begin());
+	state.u(yMinus.data());
+	f = state.dudt(0.0);
+	copy(f,f + n,fMinus.begin());
+	double scale = 0.0;
+	for (int i = 0; i < n; i++) scale = max(scale,fabs(jv[i]));
+	for (int i = 0; i < n; i++) {
+		double fd = (fPlus[i] - fMinus[i])/(2.0*sigma);
+		BOOST_REQUIRE_SMALL((fd - jv[i])/scale,1.0e-6);
+	}
+
+	// The diagonal is the negative destruction rate of each species, so it
+	// must be negative for every species that is destroyed and consistent
+	// with the detracting fluxes.
+	vector<double> diag(n);
+	state.u(y.data());
+	BOOST_REQUIRE(state.jacobianDiagonal(0.0,diag.data()));
+	for (int i = 0; i < n; i++) {
+		BOOST_REQUIRE_LE(diag[i],0.0);
+		BOOST_REQUIRE_CLOSE(-network.fMinusSums[i],diag[i]*y[i],1.0e-8);
+	}
+	// He4 is destroyed by the triple alpha reaction and alpha captures
+	BOOST_REQUIRE_LT(diag[0],0.0);
+
+	return;
+}
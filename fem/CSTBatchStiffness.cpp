@@ -0,0 +1,180 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+
+// See the header file for API documentation
+
+#include <CSTBatchStiffness.h>
+#include <TriangularQuadratureRule.h>
+#include <BatchQuadrature.h>
+#include <stdexcept>
+#include <cmath>
+
+using namespace std;
+
+namespace fire {
+
+const int CSTBatchStiffness::entryIndex[3][3] = {{0,1,2},{1,3,4},{2,4,5}};
+
+const long CSTBatchStiffness::blockGrain;
+
+CSTBatchStiffness::CSTBatchStiffness(const TwoDMesh & elementMesh,
+		ThreadPool & threadPool) : mesh(elementMesh), pool(threadPool) {}
+
+void CSTBatchStiffness::computeBlock(const long & begin, const long & end,
+		const double * kappa) {
+	const int n = end - begin;
+	const int * ids = &mesh.connectivity()[3*begin];
+	auto & x = mesh.x();
+	auto & y = mesh.y();
+
+	// Gather the coordinates of the block
+	double x1[blockSize], x2[blockSize], x3[blockSize];
+	double y1[blockSize], y2[blockSize], y3[blockSize];
+	for (int e = 0; e < n; e++) {
+		x1[e] = x[ids[3*e]];
+		x2[e] = x[ids[3*e+1]];
+		x3[e] = x[ids[3*e+2]];
+		y1[e] = y[ids[3*e]];
+		y2[e] = y[ids[3*e+1]];
+		y3[e] = y[ids[3*e+2]];
+	}
+
+	// The factors, as in ConstantStrainTriangleElement::recomputeConstants()
+	double * a0 = &aFactors[0][begin], * a1 = &aFactors[1][begin],
+			* a2 = &aFactors[2][begin];
+	double * b0 = &bFactors[0][begin], * b1 = &bFactors[1][begin],
+			* b2 = &bFactors[2][begin];
+	double * c0 = &cFactors[0][begin], * c1 = &cFactors[1][begin],
+			* c2 = &cFactors[2][begin];
+	double * area = &elementAreas[begin];
+	for (int e = 0; e < n; e++) {
+		a0[e] = x2[e]*y3[e] - x3[e]*y2[e];
+		a1[e] = x3[e]*y1[e] - x1[e]*y3[e];
+		a2[e] = x1[e]*y2[e] - x2[e]*y1[e];
+		b0[e] = y2[e] - y3[e];
+		b1[e] = y3[e] - y1[e];
+		b2[e] = y1[e] - y2[e];
+		c0[e] = x3[e] - x2[e];
+		c1[e] = x1[e] - x3[e];
+		c2[e] = x2[e] - x1[e];
+		area[e] = 0.5*(b1[e]*c2[e] - b2[e]*c1[e]);
+	}
+
+	// The unique entries of the stiffness matrices
+	double * k00 = &kEntries[0][begin], * k01 = &kEntries[1][begin],
+			* k02 = &kEntries[2][begin], * k11 = &kEntries[3][begin],
+			* k12 = &kEntries[4][begin], * k22 = &kEntries[5][begin];
+	for (int e = 0; e < n; e++) {
+		double scale = kappa[e]/(4.0*std::fabs(area[e]));
+		k00[e] = scale*(b0[e]*b0[e] + c0[e]*c0[e]);
+		k01[e] = scale*(b0[e]*b1[e] + c0[e]*c1[e]);
+		k02[e] = scale*(b0[e]*b2[e] + c0[e]*c2[e]);
+		k11[e] = scale*(b1[e]*b1[e] + c1[e]*c1[e]);
+		k12[e] = scale*(b1[e]*b2[e] + c1[e]*c2[e]);
+		k22[e] = scale*(b2[e]*b2[e] + c2[e]*c2[e]);
+	}
+
+	return;
+}
+
+void CSTBatchStiffness::computeAll(const function<void(const long &,
+		const long &, double *)> & fillKappa) {
+	long numElements = mesh.numElements();
+	for (int i = 0; i < 3; i++) {
+		aFactors[i].resize(numElements);
+		bFactors[i].resize(numElements);
+		cFactors[i].resize(numElements);
+	}
+	elementAreas.resize(numElements);
+	for (auto & entry : kEntries) entry.resize(numElements);
+
+	long numBlocks = (numElements + blockSize - 1)/blockSize;
+	pool.parallelFor(0, numBlocks, [&](const long & first, const long & last) {
+		double kappa[blockSize];
+		for (long block = first; block < last; block++) {
+			long begin = block*blockSize;
+			long end = min(begin + blockSize, numElements);
+			fillKappa(begin, end, kappa);
+			computeBlock(begin, end, kappa);
+		}
+	}, blockGrain);
+
+	return;
+}
+
+void CSTBatchStiffness::compute(const double & kappa) {
+	computeAll([&](const long & begin, const long & end, double * k) {
+		for (long e = begin; e < end; e++) k[e-begin] = kappa;
+	});
+}
+
+void CSTBatchStiffness::compute(const vector<double> & kappa) {
+	if ((long) kappa.size() != mesh.numElements()) {
+		throw runtime_error("One transfer coefficient is required per element.");
+	}
+	computeAll([&](const long & begin, const long & end, double * k) {
+		for (long e = begin; e < end; e++) k[e-begin] = kappa[e];
+	});
+}
+
+void CSTBatchStiffness::compute(const function<double(const double &,
+		const double &)> & kappa) {
+	auto & x = mesh.x();
+	auto & y = mesh.y();
+	auto & nodes = mesh.connectivity();
+	computeAll([&](const long & begin, const long & end, double * k) {
+		const int * ids = &nodes[3*begin];
+		BatchQuadrature<TriangularQuadratureRule>::integrate([&](
+				const array<double,3> & point, const long & e) {
+			const int * element = &ids[3*e];
+			double xp = point[0]*x[element[0]] + point[1]*x[element[1]]
+					+ point[2]*x[element[2]];
+			double yp = point[0]*y[element[0]] + point[1]*y[element[1]]
+					+ point[2]*y[element[2]];
+			return kappa(xp,yp);
+		}, end - begin, k);
+		// The rule integrates over the reference triangle with an area of
+		// 1/2, so twice the integral is the average coefficient.
+		for (long e = 0; e < end - begin; e++) k[e] *= 2.0;
+	});
+}
+
+void CSTBatchStiffness::elementMatrix(const long & e, double * matrix) const {
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 3; j++) {
+			matrix[3*i+j] = kEntries[entryIndex[i][j]][e];
+		}
+	}
+	return;
+}
+
+} /* namespace fire */
@@ -0,0 +1,245 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#ifndef FEM_CSTBATCHSTIFFNESS_H_
+#define FEM_CSTBATCHSTIFFNESS_H_
+
+#include <array>
+#include <vector>
+#include <functional>
+#include <TwoDMesh.h>
+#include <ThreadPool.h>
+
+namespace fire {
+
+/**
+ * This class computes the geometric factors and stiffness matrices of all of
+ * the Constant Strain Triangles in a TwoDMesh for Laplace's equation at once.
+ * For a transfer coefficient k that is constant over an element, the
+ * stiffness matrix has the closed form (see LaplaceCSTElement)
+ * \f[
+ * k_{ij} = \frac{\kappa}{4|A|} (b_{i}b_{j} + c_{i}c_{j})
+ * \f]
+ * so no quadrature is needed. The matrix is symmetric, so only the six
+ * unique entries k00, k01, k02, k11, k12 and k22 are computed and stored.
+ *
+ * The elements are processed in blocks of blockSize elements. The node
+ * coordinates of each block are gathered into small local arrays and the
+ * factors and entries are then computed by plain loops over those arrays
+ * that the compiler can vectorize. All of the results are stored as a
+ * structure of arrays with one array per factor or entry, indexed by
+ * element, so that the results for consecutive elements are contiguous.
+ * Blocks are distributed across a ThreadPool.
+ *
+ * If the transfer coefficient varies spatially, it is integrated over each
+ * element with the TriangularQuadratureRule and only the coefficient is
+ * evaluated at the quadrature points. Since the geometric part of the kernel
+ * is constant, this gives the same result as integrating the full kernel.
+ *
+ * @code
+ * TwoDMesh mesh = TwoDMesh::rectangle(1000,500,2.0,1.0);
+ * CSTBatchStiffness batch(mesh);
+ * batch.compute(2.5);
+ * double k01 = batch.stiffness(42,0,1);
+ * @endcode
+ *
+ * The a, b and c factors and (signed) area match ConstantStrainTriangleElement's
+ * and the stiffness matches LaplaceCSTElement's, which uses the magnitude of
+ * the area so that it does not depend on the ordering of the nodes.
+ */
+class CSTBatchStiffness {
+
+public:
+
+	/**
+	 * The number of elements processed at once in a block.
+	 */
+	static const int blockSize = 256;
+
+	/**
+	 * The positions of the six unique entries of the symmetric matrix in the
+	 * arrays returned by entries(): k00, k01, k02, k11, k12, k22.
+	 */
+	static const int entryIndex[3][3];
+
+protected:
+
+	/**
+	 * The mesh.
+	 */
+	const TwoDMesh & mesh;
+
+	/**
+	 * The pool used to process the blocks.
+	 */
+	ThreadPool & pool;
+
+	/**
+	 * The a, b and c factors, one array per local node.
+	 */
+	std::array<std::vector<double>,3> aFactors, bFactors, cFactors;
+
+	/**
+	 * The (signed) areas of the elements.
+	 */
+	std::vector<double> elementAreas;
+
+	/**
+	 * The six unique stiffness entries, one array per entry.
+	 */
+	std::array<std::vector<double>,6> kEntries;
+
+	/**
+	 * This operation computes the factors and entries of a block of elements
+	 * with the transfer coefficients of the block already evaluated.
+	 * @param begin the first element of the block
+	 * @param end one past the last element of the block
+	 * @param kappa the transfer coefficients of the elements in the block
+	 */
+	void computeBlock(const long & begin, const long & end,
+			const double * kappa);
+
+	/**
+	 * This operation splits the elements into blocks and processes them in
+	 * the pool.
+	 * @param fillKappa a function that fills the transfer coefficients of the
+	 * elements [begin,end) into an array
+	 */
+	void computeAll(const std::function<void(const long &, const long &,
+			double *)> & fillKappa);
+
+	/**
+	 * The minimum number of blocks per thread. Blocks are coarse, so loops
+	 * are split over as few as four blocks per thread.
+	 */
+	static const long blockGrain = 4;
+
+public:
+
+	/**
+	 * Constructor
+	 * @param elementMesh the mesh, which must outlive this object
+	 * @param threadPool the pool used to process the blocks
+	 */
+	CSTBatchStiffness(const TwoDMesh & elementMesh,
+			ThreadPool & threadPool = ThreadPool::shared());
+
+	/**
+	 * This operation computes the stiffness matrices for a transfer
+	 * coefficient that is the same for all elements.
+	 * @param kappa the transfer coefficient
+	 */
+	void compute(const double & kappa = 1.0);
+
+	/**
+	 * This operation computes the stiffness matrices for a transfer
+	 * coefficient that is constant over each element.
+	 * @param kappa the transfer coefficient of each element
+	 * @throw std::runtime_error if there is not one coefficient per element
+	 */
+	void compute(const std::vector<double> & kappa);
+
+	/**
+	 * This operation computes the stiffness matrices for a spatially varying
+	 * transfer coefficient, which is integrated over each element by
+	 * quadrature.
+	 * @param kappa the transfer coefficient as a function of (x,y)
+	 */
+	void compute(const std::function<double(const double &,
+			const double &)> & kappa);
+
+	/**
+	 * This operation returns the number of elements that have been computed.
+	 * @return the number of elements
+	 */
+	long size() const { return elementAreas.size();};
+
+	/**
+	 * This operation returns the a factors of local node i for all elements.
+	 * @param i the local node id
+	 * @return the factors
+	 */
+	const std::vector<double> & a(const int & i) const { return aFactors[i];};
+
+	/**
+	 * This operation returns the b factors of local node i for all elements.
+	 * @param i the local node id
+	 * @return the factors
+	 */
+	const std::vector<double> & b(const int & i) const { return bFactors[i];};
+
+	/**
+	 * This operation returns the c factors of local node i for all elements.
+	 * @param i the local node id
+	 * @return the factors
+	 */
+	const std::vector<double> & c(const int & i) const { return cFactors[i];};
+
+	/**
+	 * This operation returns the (signed) areas of all elements.
+	 * @return the areas
+	 */
+	const std::vector<double> & areas() const { return elementAreas;};
+
+	/**
+	 * This operation returns stiffness entry (i,j) for all elements.
+	 * @param i the first local node id
+	 * @param j the second local node id
+	 * @return the entries, indexed by element
+	 */
+	const std::vector<double> & entries(const int & i, const int & j) const {
+		return kEntries[entryIndex[i][j]];
+	};
+
+	/**
+	 * This operation returns stiffness entry (i,j) of an element.
+	 * @param e the element
+	 * @param i the first local node id
+	 * @param j the second local node id
+	 * @return the entry
+	 */
+	double stiffness(const long & e, const int & i, const int & j) const {
+		return kEntries[entryIndex[i][j]][e];
+	};
+
+	/**
+	 * This operation writes the full 3x3 stiffness matrix of an element in
+	 * row-major order.
+	 * @param e the element
+	 * @param matrix the nine entries of the matrix
+	 */
+	void elementMatrix(const long & e, double * matrix) const;
+
+};
+
+} /* namespace fire */
+
+#endif /* FEM_CSTBATCHSTIFFNESS_H_ */
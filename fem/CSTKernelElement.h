@@ -0,0 +1,247 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#ifndef FEM_CSTKERNELELEMENT_H_
+#define FEM_CSTKERNELELEMENT_H_
+
+#include <array>
+#include <functional>
+#include <cmath>
+#include <TriangularQuadratureRule.h>
+#include <TwoDMesh.h>
+
+namespace fire {
+
+/**
+ * This structure holds the geometric constants of a Constant Strain Triangle
+ * that kernels need: the area and the b and c constants of the area
+ * coordinates. (See ConstantStrainTriangleElement for their definitions.)
+ */
+struct CSTGeometry {
+
+	/**
+	 * The area of the element.
+	 */
+	double area = 0.0;
+
+	/**
+	 * The b constants, b_i = y_j - y_k.
+	 */
+	std::array<double,3> b;
+
+	/**
+	 * The c constants, c_i = x_k - x_j.
+	 */
+	std::array<double,3> c;
+
+	/**
+	 * This operation loads the geometry of an element from a mesh.
+	 * @param mesh the mesh
+	 * @param e the index of the element
+	 * @return the geometry
+	 */
+	static CSTGeometry fromMesh(const TwoDMesh & mesh, const long & e) {
+		CSTGeometry geometry;
+		geometry.area = mesh.areas()[e];
+		for (int i = 0; i < 3; i++) {
+			geometry.b[i] = mesh.b()[3*e + i];
+			geometry.c[i] = mesh.c()[3*e + i];
+		}
+		return geometry;
+	}
+};
+
+/**
+ * This is the kernel policy for Laplace's equation with a constant transfer
+ * coefficient, as in LaplaceCSTElement:
+ * \f[
+ * k_{ij} = \frac{\kappa}{4A^{2}}(b_{i}b_{j} + c_{i}c_{j}), f_{i} = 0
+ * \f]
+ */
+struct LaplaceKernel {
+
+	/**
+	 * The transfer coefficient.
+	 */
+	double kappa = 1.0;
+
+	/**
+	 * The stiffness kernel
+	 */
+	double stiffness(const std::array<double,3> &,
+			const CSTGeometry & geometry, const int & i, const int & j) const {
+		return kappa*(geometry.b[i]*geometry.b[j] + geometry.c[i]*geometry.c[j])
+				/(4.0*geometry.area*geometry.area);
+	}
+
+	/**
+	 * The body force kernel
+	 */
+	double bodyForce(const std::array<double,3> &, const CSTGeometry &,
+			const int &) const {
+		return 0.0;
+	}
+};
+
+/**
+ * This kernel policy adapts kernels that are only known at runtime, as
+ * std::functions, to CSTKernelElement. It has the same cost per quadrature
+ * point as ConstantStrainTriangleElement and exists for compatibility.
+ */
+struct FunctionKernel {
+
+	/**
+	 * The stiffness kernel
+	 */
+	std::function<double(const std::array<double,3> &, const CSTGeometry &,
+			const int &, const int &)> stiffnessFunction;
+
+	/**
+	 * The body force kernel
+	 */
+	std::function<double(const std::array<double,3> &, const CSTGeometry &,
+			const int &)> bodyForceFunction;
+
+	/**
+	 * This operation forwards to the stiffness function.
+	 */
+	double stiffness(const std::array<double,3> & point,
+			const CSTGeometry & geometry, const int & i, const int & j) const {
+		return stiffnessFunction(point, geometry, i, j);
+	}
+
+	/**
+	 * This operation forwards to the body force function.
+	 */
+	double bodyForce(const std::array<double,3> & point,
+			const CSTGeometry & geometry, const int & i) const {
+		return bodyForceFunction(point, geometry, i);
+	}
+};
+
+/**
+ * This class computes the stiffness matrix and body force vector of a
+ * Constant Strain Triangle with the physics supplied by a kernel policy. The
+ * policy is a compile-time type with the operations
+ * @code
+ * double stiffness(const std::array<double,3> & point,
+ *		const CSTGeometry & geometry, const int & i, const int & j) const;
+ * double bodyForce(const std::array<double,3> & point,
+ *		const CSTGeometry & geometry, const int & i) const;
+ * @endcode
+ * which are evaluated at the area coordinates of each quadrature point, just
+ * like the kernels of ConstantStrainTriangleElement. Because the kernel type
+ * is known to the compiler, the kernels are inlined into the quadrature loop
+ * instead of being called through a std::function at every point. Body
+ * force kernels must include the shape function L_i if it is required.
+ *
+ * The element stores nothing but the kernel, so a single element can be used
+ * for every triangle in a TwoDMesh:
+ * @code
+ * CSTKernelElement<LaplaceKernel> element;
+ * std::array<double,9> k;
+ * for (long e = 0; e < mesh.numElements(); e++) {
+ *	element.stiffnessMatrix(CSTGeometry::fromMesh(mesh,e), k.data());
+ *	// ... scatter k
+ * }
+ * @endcode
+ * Runtime kernels can still be used through the FunctionKernel adapter.
+ *
+ * The integrals are taken over the element, so the quadrature rule's
+ * integrals over the reference triangle are scaled by the Jacobian, 2A.
+ */
+template<typename Kernel>
+class CSTKernelElement {
+
+protected:
+
+	/**
+	 * The kernel policy
+	 */
+	Kernel kernel;
+
+	/**
+	 * The quadrature rule used to integrate the kernels.
+	 */
+	TriangularQuadratureRule rule;
+
+public:
+
+	/**
+	 * Constructor
+	 * @param elementKernel the kernel, which is copied
+	 */
+	CSTKernelElement(const Kernel & elementKernel = Kernel()) :
+		kernel(elementKernel) {};
+
+	/**
+	 * This operation returns the kernel, which may be modified.
+	 * @return the kernel
+	 */
+	Kernel & getKernel() { return kernel;};
+
+	/**
+	 * This operation computes the element stiffness matrix.
+	 * @param geometry the geometry of the element
+	 * @param k the matrix, which must hold 9 values, in row major order
+	 */
+	void stiffnessMatrix(const CSTGeometry & geometry, double * k) const {
+		double jacobian = 2.0*std::fabs(geometry.area);
+		for (int i = 0; i < 3; i++) {
+			for (int j = 0; j < 3; j++) {
+				k[3*i + j] = jacobian*rule.integrate(
+						[&](const std::array<double,3> & point) {
+					return kernel.stiffness(point, geometry, i, j);
+				});
+			}
+		}
+	}
+
+	/**
+	 * This operation computes the element body force vector.
+	 * @param geometry the geometry of the element
+	 * @param f the vector, which must hold 3 values
+	 */
+	void bodyForceVector(const CSTGeometry & geometry, double * f) const {
+		double jacobian = 2.0*std::fabs(geometry.area);
+		for (int i = 0; i < 3; i++) {
+			f[i] = jacobian*rule.integrate(
+					[&](const std::array<double,3> & point) {
+				return kernel.bodyForce(point, geometry, i);
+			});
+		}
+	}
+
+};
+
+} /* namespace fire */
+
+#endif /* FEM_CSTKERNELELEMENT_H_ */
@@ -0,0 +1,166 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+
+// See the header file for API documentation
+
+#include <CSTStiffnessOperator.h>
+#include <ElementColoring.h>
+#include <stdexcept>
+#include <math.h>
+
+using namespace std;
+
+namespace fire {
+
+CSTStiffnessOperator::CSTStiffnessOperator(const TwoDMesh & stiffnessMesh,
+		ThreadPool & threadPool) : mesh(stiffnessMesh), pool(threadPool),
+		elementColors(colorElements(stiffnessMesh.connectivity(), 3,
+				stiffnessMesh.numNodes())),
+		fixedFlags(stiffnessMesh.numNodes(), 0) {}
+
+void CSTStiffnessOperator::coefficient(const double & kappa) {
+	constantCoefficient = kappa;
+	coefficients.clear();
+}
+
+void CSTStiffnessOperator::coefficient(const vector<double> & kappa) {
+	if ((long) kappa.size() != mesh.numElements()) {
+		throw runtime_error("One transfer coefficient is required per element.");
+	}
+	coefficients = kappa;
+}
+
+void CSTStiffnessOperator::constrain(const DirichletLifting & conditions) {
+	if ((int) conditions.values().size() != size()) {
+		throw runtime_error("The conditions do not match the mesh.");
+	}
+	for (int node : fixedNodes) fixedFlags[node] = 0;
+	fixedNodes = conditions.nodes();
+	for (int node : fixedNodes) fixedFlags[node] = 1;
+	// Find the local nodes that contribute to the diagonal of the
+	// constrained rows
+	fixedEntries.clear();
+	auto & ids = mesh.connectivity();
+	for (long k = 0; k < (long) ids.size(); k++) {
+		if (fixedFlags[ids[k]]) fixedEntries.push_back(k);
+	}
+}
+
+void CSTStiffnessOperator::apply(const vector<double> & x,
+		vector<double> & y) const {
+	auto & ids = mesh.connectivity();
+	auto & b = mesh.b();
+	auto & c = mesh.c();
+	auto & areas = mesh.areas();
+	pool.parallelFor(0, y.size(), [&](const long & begin, const long & end) {
+		for (long i = begin; i < end; i++) y[i] = 0.0;
+	});
+	for (auto & elementColor : elementColors) {
+		pool.parallelFor(0, elementColor.size(),
+				[&](const long & begin, const long & end) {
+			for (long k = begin; k < end; k++) {
+				long e = elementColor[k];
+				const int * n = &ids[3*e];
+				const double * be = &b[3*e], * ce = &c[3*e];
+				// The gradient of x times the area, then its flux
+				double x0 = x[n[0]], x1 = x[n[1]], x2 = x[n[2]];
+				double gx = be[0]*x0 + be[1]*x1 + be[2]*x2;
+				double gy = ce[0]*x0 + ce[1]*x1 + ce[2]*x2;
+				double scale = coefficient(e)/(4.0*fabs(areas[e]));
+				gx *= scale;
+				gy *= scale;
+				y[n[0]] += be[0]*gx + ce[0]*gy;
+				y[n[1]] += be[1]*gx + ce[1]*gy;
+				y[n[2]] += be[2]*gx + ce[2]*gy;
+			}
+		});
+	}
+}
+
+void CSTStiffnessOperator::diagonal(vector<double> & diag) const {
+	auto & ids = mesh.connectivity();
+	auto & b = mesh.b();
+	auto & c = mesh.c();
+	auto & areas = mesh.areas();
+	diag.assign(size(), 0.0);
+	for (long e = 0; e < mesh.numElements(); e++) {
+		double scale = coefficient(e)/(4.0*fabs(areas[e]));
+		for (int i = 0; i < 3; i++) {
+			double bi = b[3*e+i], ci = c[3*e+i];
+			diag[ids[3*e+i]] += scale*(bi*bi + ci*ci);
+		}
+	}
+}
+
+void CSTStiffnessOperator::multiply(const vector<double> & x,
+		vector<double> & y) const {
+	y.resize(size());
+	if (fixedNodes.empty()) {
+		apply(x, y);
+		return;
+	}
+	// Drop the constrained columns and replace the constrained rows with the
+	// diagonal
+	masked = x;
+	for (int node : fixedNodes) masked[node] = 0.0;
+	apply(masked, y);
+	auto & ids = mesh.connectivity();
+	auto & b = mesh.b();
+	auto & c = mesh.c();
+	auto & areas = mesh.areas();
+	for (int node : fixedNodes) y[node] = 0.0;
+	for (long k : fixedEntries) {
+		long e = k/3;
+		int node = ids[k];
+		double scale = coefficient(e)/(4.0*fabs(areas[e]));
+		y[node] += scale*(b[k]*b[k] + c[k]*c[k])*x[node];
+	}
+}
+
+void CSTStiffnessOperator::lift(const DirichletLifting & conditions,
+		vector<double> & rhs) const {
+	if ((int) rhs.size() != size()) {
+		throw runtime_error("The right hand side does not match the mesh.");
+	}
+	// The product of the full operator and the fixed values moves them to
+	// the right hand side of the free rows
+	vector<double> product(size());
+	apply(conditions.values(), product);
+	vector<double> diag;
+	diagonal(diag);
+	for (int i = 0; i < size(); i++) {
+		rhs[i] = conditions.isFixed(i) ? diag[i]*conditions.values()[i]
+				: rhs[i] - product[i];
+	}
+}
+
+} /* namespace fire */
@@ -0,0 +1,218 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#ifndef FEM_CSTSTIFFNESSOPERATOR_H_
+#define FEM_CSTSTIFFNESSOPERATOR_H_
+
+#include <vector>
+#include <TwoDMesh.h>
+#include <LinearOperator.h>
+#include <DirichletLifting.h>
+#include <ThreadPool.h>
+
+namespace fire {
+
+/**
+ * This class applies the stiffness matrix of Laplace's equation on a
+ * TwoDMesh of Constant Strain Triangles to vectors without assembling it.
+ * For an element with transfer coefficient kappa, the contribution to y = Kx
+ * is
+ * \f[
+ * y_{i} \mathrel{+}= \frac{\kappa}{4|A|}\left(b_{i}\sum_{j} b_{j}x_{j} +
+ * c_{i}\sum_{j} c_{j}x_{j}\right)
+ * \f]
+ * which is computed from the b and c constants and areas that the mesh
+ * already stores. This is the same matrix as CSTBatchStiffness, but each
+ * product reads 3 node ids and 7 factors per element instead of a stored
+ * matrix, so no memory is needed for the matrix at all. The elements are
+ * colored (see colorElements()) and the elements of each color are applied
+ * in parallel without locks or atomics because they never write to the same
+ * node.
+ *
+ * The operator can be used directly with the PCGSolver:
+ * @code
+ * TwoDMesh mesh = TwoDMesh::rectangle(2000,2000);
+ * CSTStiffnessOperator stiffness(mesh);
+ * DirichletLifting conditions(mesh.numNodes());
+ * conditions.fixBoundary(mesh, 0, 1.0);
+ * stiffness.constrain(conditions);
+ * vector<double> b(mesh.numNodes(), 0.0), x, diagonal;
+ * stiffness.lift(conditions, b);
+ * stiffness.diagonal(diagonal);
+ * JacobiPreconditioner jacobi(diagonal);
+ * PCGSolver solver;
+ * solver.solve(stiffness, b, x, jacobi);
+ * @endcode
+ *
+ * Constrained nodes are treated the way DirichletLifting eliminates them:
+ * their rows and columns are replaced by the diagonal entry. The geometry is
+ * read from the mesh on every product, so changes to the mesh, such as
+ * those made by MeshDeformation, are picked up immediately. The connectivity
+ * of the mesh must not change.
+ */
+class CSTStiffnessOperator : public ILinearOperator {
+
+protected:
+
+	/**
+	 * The mesh.
+	 */
+	const TwoDMesh & mesh;
+
+	/**
+	 * The threads used for the products.
+	 */
+	ThreadPool & pool;
+
+	/**
+	 * The elements of each color.
+	 */
+	std::vector<std::vector<long>> elementColors;
+
+	/**
+	 * The transfer coefficient of each element, which is empty if the
+	 * coefficient is the same for all elements.
+	 */
+	std::vector<double> coefficients;
+
+	/**
+	 * The transfer coefficient of all elements.
+	 */
+	double constantCoefficient = 1.0;
+
+	/**
+	 * The constrained nodes and their flags.
+	 */
+	std::vector<int> fixedNodes;
+	std::vector<char> fixedFlags;
+
+	/**
+	 * The positions in the connectivity of the constrained nodes, which
+	 * contribute to their diagonal entries.
+	 */
+	std::vector<long> fixedEntries;
+
+	/**
+	 * The vector with the constrained entries set to zero.
+	 */
+	mutable std::vector<double> masked;
+
+	/**
+	 * This operation computes y = Kx, without constraints, for the elements.
+	 * @param x the vector
+	 * @param y the product, which must have the size of the operator
+	 */
+	void apply(const std::vector<double> & x, std::vector<double> & y) const;
+
+	/**
+	 * This operation returns the transfer coefficient of an element.
+	 * @param e the element
+	 * @return the coefficient
+	 */
+	double coefficient(const long & e) const {
+		return coefficients.empty() ? constantCoefficient : coefficients[e];
+	};
+
+public:
+
+	/**
+	 * Constructor. This colors the elements.
+	 * @param stiffnessMesh the mesh, which must outlive this object
+	 * @param threadPool the threads used for the products
+	 */
+	CSTStiffnessOperator(const TwoDMesh & stiffnessMesh,
+			ThreadPool & threadPool = ThreadPool::shared());
+
+	/**
+	 * This operation sets a transfer coefficient that is the same for all
+	 * elements.
+	 * @param kappa the coefficient
+	 */
+	void coefficient(const double & kappa);
+
+	/**
+	 * This operation sets a transfer coefficient that is constant over each
+	 * element.
+	 * @param kappa the coefficient of each element
+	 * @throw std::runtime_error if there is not one coefficient per element
+	 */
+	void coefficient(const std::vector<double> & kappa);
+
+	/**
+	 * This operation constrains the nodes fixed by a set of Dirichlet
+	 * conditions, replacing any earlier constraints.
+	 * @param conditions the conditions
+	 * @throw std::runtime_error if the conditions are for a different number
+	 * of nodes
+	 */
+	void constrain(const DirichletLifting & conditions);
+
+	/**
+	 * This operation lifts a right hand side with the values of a set of
+	 * Dirichlet conditions, as DirichletLifting::lift() does for an assembled
+	 * matrix. The conditions should be the ones passed to constrain().
+	 * @param conditions the conditions
+	 * @param rhs the right hand side, which is modified in place
+	 */
+	void lift(const DirichletLifting & conditions,
+			std::vector<double> & rhs) const;
+
+	/**
+	 * This operation computes the diagonal of the operator, for example for
+	 * the JacobiPreconditioner.
+	 * @param diag the diagonal, which is resized to the number of nodes
+	 */
+	void diagonal(std::vector<double> & diag) const;
+
+	/**
+	 * See ILinearOperator::size().
+	 */
+	virtual int size() const { return mesh.numNodes();};
+
+	/**
+	 * See ILinearOperator::multiply().
+	 */
+	virtual void multiply(const std::vector<double> & x,
+			std::vector<double> & y) const;
+
+	/**
+	 * This operation returns the elements of each color.
+	 * @return the colors
+	 */
+	const std::vector<std::vector<long>> & colors() const {
+		return elementColors;
+	};
+
+};
+
+} /* namespace fire */
+
+#endif /* FEM_CSTSTIFFNESSOPERATOR_H_ */
@@ -192,9 +192,21 @@ void ConstantStrainTriangleElement::recomputeConstants() {
 	return;
 }
 
+/**
+ * The area coordinates of the centroid of the element.
+ */
+static const std::array<double,3> centroid = {{1.0/3.0,1.0/3.0,1.0/3.0}};
+
 double ConstantStrainTriangleElement::getStiffnessElement(const int & i,
 		const int & j) {
-	double result = triQuadRule.integrate(stiffnessKernel,i,j);
+	// Constant kernels are exactly integrated by a single evaluation.
+	if (constantStiffnessKernel) {
+		return fabs(eArea)*stiffnessKernel(centroid,i,j);
+	}
+	// The quadrature rule integrates over the reference triangle, which has
+	// an area of 1/2, so scale by the Jacobian. The area is signed by the
+	// ordering of the nodes, but the Jacobian is not.
+	double result = 2.0*fabs(eArea)*triQuadRule.integrate(stiffnessKernel,i,j);
 	return result;
 }
 
@@ -228,8 +240,7 @@ const std::vector<VectorElement<double>> & ConstantStrainTriangleElement::bodyFo
 
 	// For each node, compute body forces f_i.
 	for (int i = 0; i < bodyElements.size(); i++) {
-		double result = triQuadRule.integrate(bodyForceKernel,
-				bodyElements[i].first);
+		double result = 2.0*fabs(eArea)*triQuadRule.integrate(bodyForceKernel,i);
 		bodyElements[i].second = result;
 	}
 
@@ -276,6 +287,10 @@ double ConstantStrainTriangleElement::area() {
 	return eArea;
 }
 
+std::array<int,3> ConstantStrainTriangleElement::nodeIds() const {
+	return {{nodes[0].get().value, nodes[1].get().value, nodes[2].get().value}};
+}
+
 CSTLocalPoint ConstantStrainTriangleElement::computeLocalPoint(const double & x,
 		const double & y) const {
 	CSTLocalPoint localPoint;
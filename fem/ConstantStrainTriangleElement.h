@@ -181,6 +181,14 @@ protected:
 	 */
 	TriangularQuadratureRule triQuadRule;
 
+	/**
+	 * True if the stiffness kernel is constant across the element, in which
+	 * case its integral is simply its value times the area and it is only
+	 * evaluated once per matrix element instead of at every quadrature point.
+	 * Subclasses set this when their kernel is known to be constant.
+	 */
+	bool constantStiffnessKernel = false;
+
 	/**
 	 * This is a four point Gaussian Quadrature rule over a line that is used
 	 * to integrate the boundary condition kernels. It should be more
@@ -362,7 +370,10 @@ protected:
 
     /**
      * This operation computes the value of the stiffness matrix without
-     * consideration of Robin Boundary Conditions at the given indices.
+     * consideration of Robin Boundary Conditions at the given indices. The
+     * kernel is integrated over the area of the element, so the integral
+     * over the reference triangle from the quadrature rule is scaled by the
+     * Jacobian, 2|A|.
      * @param i the first index
      * @param j the second index
      * @return the result
@@ -429,6 +440,13 @@ public:
 	 */
 	CSTLocalPoint computeLocalPoint(const double & x, const double & y) const;
 
+	/**
+	 * This operation returns the global ids of the nodes in the element in
+	 * local order, which is the connectivity of the element.
+	 * @return the ids of the first, second and third nodes
+	 */
+	std::array<int,3> nodeIds() const;
+
 	/**
 	 * This operation checks to see if the element contains the given node.
 	 * @param node the node to check for containment within the element
@@ -0,0 +1,166 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+
+// See the header file for API documentation
+
+#include <DirichletLifting.h>
+#include <stdexcept>
+#include <utility>
+
+using namespace std;
+
+namespace fire {
+
+DirichletLifting::DirichletLifting(const int & size,
+		const DirichletMethod & type, const double & penalty,
+		ThreadPool & threadPool) : numNodes(size), method(type),
+		penaltyFactor(penalty), fixed(size, false), fixedValues(size, 0.0),
+		pool(threadPool) {
+	if (method == DirichletMethod::PENALTY && !(penalty > 1.0)) {
+		throw runtime_error("The penalty must be greater than one.");
+	}
+}
+
+void DirichletLifting::fix(const int & node, const double & value) {
+	if (node < 0 || node >= numNodes) {
+		throw out_of_range("Node is not in the system.");
+	}
+	if (!fixed[node]) {
+		fixed[node] = true;
+		fixedNodes.push_back(node);
+		applied = false;
+	}
+	fixedValues[node] = value;
+}
+
+void DirichletLifting::fixBoundary(const TwoDMesh & mesh, const int & marker,
+		const double & value) {
+	auto & edges = mesh.boundaryEdges();
+	auto & markers = mesh.boundaryMarkers();
+	for (long k = 0; k < (long) markers.size(); k++) {
+		if (markers[k] == marker) {
+			fix(edges[2*k], value);
+			fix(edges[2*k+1], value);
+		}
+	}
+}
+
+void DirichletLifting::fixBoundary(const TwoDMesh & mesh, const int & marker,
+		const function<double(const double &, const double &)> & f) {
+	auto & edges = mesh.boundaryEdges();
+	auto & markers = mesh.boundaryMarkers();
+	auto & x = mesh.x();
+	auto & y = mesh.y();
+	for (long k = 0; k < (long) markers.size(); k++) {
+		if (markers[k] == marker) {
+			for (int end = 0; end < 2; end++) {
+				int node = edges[2*k+end];
+				fix(node, f(x[node], y[node]));
+			}
+		}
+	}
+}
+
+void DirichletLifting::apply(CSRMatrix<double> & matrix) {
+	if (matrix.size() != numNodes) {
+		throw runtime_error("The matrix does not match the conditions.");
+	}
+
+	// Save the diagonal of each fixed row
+	diagonal.resize(fixedNodes.size());
+	vector<long> diagonalSlots(fixedNodes.size());
+	for (long k = 0; k < (long) fixedNodes.size(); k++) {
+		int node = fixedNodes[k];
+		long slot = matrix.slot(node, node);
+		if (slot < 0 || matrix.values[slot] == 0.0) {
+			throw runtime_error("A fixed node has no diagonal entry.");
+		}
+		diagonalSlots[k] = slot;
+		diagonal[k] = matrix.values[slot];
+	}
+
+	if (method == DirichletMethod::PENALTY) {
+		// Only the diagonal changes
+		for (long k = 0; k < (long) fixedNodes.size(); k++) {
+			diagonal[k] *= penaltyFactor;
+			matrix.values[diagonalSlots[k]] = diagonal[k];
+		}
+		coupling = CSRMatrix<double>();
+	} else {
+		// Move the free rows of the fixed columns into the coupling and clear
+		// the fixed rows and columns, keeping the diagonal
+		vector<pair<int,int>> entries;
+		for (int i = 0; i < numNodes; i++) {
+			if (fixed[i]) continue;
+			for (long m = matrix.rowOffsets[i]; m < matrix.rowOffsets[i+1];
+					m++) {
+				if (fixed[matrix.columns[m]]) {
+					entries.emplace_back(i, matrix.columns[m]);
+				}
+			}
+		}
+		coupling = CSRMatrix<double>(numNodes, entries);
+		for (int i = 0; i < numNodes; i++) {
+			for (long m = matrix.rowOffsets[i]; m < matrix.rowOffsets[i+1];
+					m++) {
+				int j = matrix.columns[m];
+				if (fixed[i] && i != j) {
+					matrix.values[m] = 0.0;
+				} else if (!fixed[i] && fixed[j]) {
+					coupling.values[coupling.slot(i, j)] = matrix.values[m];
+					matrix.values[m] = 0.0;
+				}
+			}
+		}
+	}
+
+	applied = true;
+}
+
+void DirichletLifting::lift(vector<double> & rhs) const {
+	if (!applied) {
+		throw logic_error("The conditions have not been applied to a matrix.");
+	}
+	if ((int) rhs.size() != numNodes) {
+		throw runtime_error("The right hand side does not match the conditions.");
+	}
+	// Move the known values to the right hand side of the free rows
+	if (method == DirichletMethod::ELIMINATION && coupling.nonZeros() > 0) {
+		coupling.multiply(fixedValues, work, pool);
+		for (int i = 0; i < numNodes; i++) rhs[i] -= work[i];
+	}
+	for (long k = 0; k < (long) fixedNodes.size(); k++) {
+		rhs[fixedNodes[k]] = diagonal[k]*fixedValues[fixedNodes[k]];
+	}
+}
+
+} /* namespace fire */
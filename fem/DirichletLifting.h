@@ -0,0 +1,263 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#ifndef FEM_DIRICHLETLIFTING_H_
+#define FEM_DIRICHLETLIFTING_H_
+
+#include <vector>
+#include <functional>
+#include <TwoDMesh.h>
+#include <CSRMatrix.h>
+#include <ThreadPool.h>
+
+namespace fire {
+
+/**
+ * This enumeration describes how DirichletLifting imposes fixed values on an
+ * assembled system. ELIMINATION replaces the rows and columns of the fixed
+ * nodes with those of a diagonal matrix and moves the known values to the
+ * right hand side, which keeps the matrix symmetric and imposes the values
+ * exactly. PENALTY multiplies the diagonal entries of the fixed nodes by a
+ * large factor instead, which leaves the other entries alone but only
+ * imposes the values approximately and worsens the conditioning of the
+ * matrix.
+ */
+enum class DirichletMethod {ELIMINATION, PENALTY};
+
+/**
+ * This class imposes Dirichlet (fixed value) conditions on a globally
+ * assembled system Ku = f. Elements do not need to know about the
+ * conditions at all: all of the constrained nodes are gathered first with
+ * fix() or fixBoundary(), the assembled matrix is modified once by apply()
+ * and each right hand side is then lifted by lift(). For elimination, the
+ * system becomes
+ * \f[
+ * \begin{bmatrix} K_{ff} & 0 \\ 0 & D_{cc} \end{bmatrix}
+ * \begin{bmatrix} u_{f} \\ u_{c} \end{bmatrix} =
+ * \begin{bmatrix} f_{f} - K_{fc}g \\ D_{cc}g \end{bmatrix}
+ * \f]
+ * where f and c denote the free and constrained nodes, g holds the fixed
+ * values and D is the diagonal of K, which is kept so that the scale of the
+ * constrained rows matches the rest of the matrix. apply() saves the
+ * coupling block K_fc, so changing the fixed values with fix() and lifting
+ * again costs one sparse matrix-vector product with K_fc and the matrix does
+ * not need to be assembled, modified or factored again. This is what makes
+ * repeated solves with changing boundary values, for example in a transient
+ * or parametric study, cheap.
+ *
+ * @code
+ * TwoDMesh mesh = TwoDMesh::rectangle(100,100);
+ * ... assemble K and f ...
+ * DirichletLifting conditions(mesh.numNodes());
+ * conditions.fixBoundary(mesh, 1, 100.0);
+ * conditions.fixBoundary(mesh, 3, [](const double & x, const double & y) {
+ *     return sin(x);
+ * });
+ * conditions.apply(K);
+ * vector<double> b(f);
+ * conditions.lift(b);
+ * ... solve Ku = b ...
+ * conditions.fix(42, 50.0);  // 42 is already fixed, so only lift again
+ * b = f;
+ * conditions.lift(b);
+ * @endcode
+ *
+ * Fixing a node that was not fixed before changes the structure of the
+ * conditions, so apply() must be called again on a newly assembled matrix
+ * before the next lift().
+ */
+class DirichletLifting {
+
+protected:
+
+	/**
+	 * The number of nodes, which is the size of the system.
+	 */
+	int numNodes;
+
+	/**
+	 * The method used to impose the values.
+	 */
+	DirichletMethod method;
+
+	/**
+	 * The factor that multiplies the diagonal entries of the fixed nodes for
+	 * the penalty method.
+	 */
+	double penaltyFactor;
+
+	/**
+	 * The fixed nodes in the order that they were fixed.
+	 */
+	std::vector<int> fixedNodes;
+
+	/**
+	 * True for the fixed nodes.
+	 */
+	std::vector<bool> fixed;
+
+	/**
+	 * The fixed values, which are zero for the free nodes.
+	 */
+	std::vector<double> fixedValues;
+
+	/**
+	 * The diagonal entries of the fixed rows of the modified matrix.
+	 */
+	std::vector<double> diagonal;
+
+	/**
+	 * The coupling between the free and fixed nodes, K_fc, as a matrix of the
+	 * full size with entries only in free rows and fixed columns.
+	 */
+	CSRMatrix<double> coupling;
+
+	/**
+	 * The product of the coupling and the fixed values.
+	 */
+	mutable std::vector<double> work;
+
+	/**
+	 * True if the matrix has been modified for the current set of fixed
+	 * nodes.
+	 */
+	bool applied = false;
+
+	/**
+	 * The threads used for the product with the coupling.
+	 */
+	ThreadPool & pool;
+
+public:
+
+	/**
+	 * Constructor
+	 * @param size the number of nodes
+	 * @param type the method used to impose the values
+	 * @param penalty the factor that multiplies the diagonal entries of the
+	 * fixed nodes for the penalty method, which bounds the relative error of
+	 * the fixed values by about 1/penalty
+	 * @param threadPool the threads used to lift the right hand side
+	 * @throw std::runtime_error if the penalty is not greater than one
+	 */
+	DirichletLifting(const int & size,
+			const DirichletMethod & type = DirichletMethod::ELIMINATION,
+			const double & penalty = 1.0e8,
+			ThreadPool & threadPool = ThreadPool::shared());
+
+	/**
+	 * This operation fixes the value of a node. If the node is already
+	 * fixed, only its value changes and the matrix does not need to be
+	 * modified again.
+	 * @param node the id of the node
+	 * @param value the value
+	 * @throw std::out_of_range if the node is not in the system
+	 */
+	void fix(const int & node, const double & value);
+
+	/**
+	 * This operation fixes the values of all of the nodes on the boundary
+	 * edges of a mesh with the given marker.
+	 * @param mesh the mesh
+	 * @param marker the marker of the boundary edges
+	 * @param value the value
+	 */
+	void fixBoundary(const TwoDMesh & mesh, const int & marker,
+			const double & value);
+
+	/**
+	 * This operation fixes the values of all of the nodes on the boundary
+	 * edges of a mesh with the given marker to the values of a function of
+	 * the coordinates of the nodes. The function is evaluated once per node,
+	 * here, and not during assembly or the solve.
+	 * @param mesh the mesh
+	 * @param marker the marker of the boundary edges
+	 * @param f the function, f(x,y)
+	 */
+	void fixBoundary(const TwoDMesh & mesh, const int & marker,
+			const std::function<double(const double &, const double &)> & f);
+
+	/**
+	 * This operation modifies an assembled matrix to impose the conditions
+	 * and saves the coupling between the free and fixed nodes from it. It
+	 * must be called once for each new set of fixed nodes and each time the
+	 * matrix is assembled again.
+	 * @param matrix the assembled matrix, which must have the diagonal entry
+	 * of every fixed node
+	 * @throw std::runtime_error if the size of the matrix is wrong or the
+	 * diagonal entry of a fixed node is missing or zero
+	 */
+	void apply(CSRMatrix<double> & matrix);
+
+	/**
+	 * This operation lifts a right hand side that was assembled without the
+	 * conditions so that the solution of the modified system has the fixed
+	 * values.
+	 * @param rhs the right hand side, which is modified in place
+	 * @throw std::logic_error if apply() has not been called since the set of
+	 * fixed nodes changed
+	 * @throw std::runtime_error if the size of the right hand side is wrong
+	 */
+	void lift(std::vector<double> & rhs) const;
+
+	/**
+	 * This operation returns true if the value of the node is fixed.
+	 * @param node the id of the node
+	 * @return true if fixed, false otherwise
+	 */
+	bool isFixed(const int & node) const { return fixed[node];};
+
+	/**
+	 * This operation returns the fixed nodes in the order that they were
+	 * fixed.
+	 * @return the ids of the fixed nodes
+	 */
+	const std::vector<int> & nodes() const { return fixedNodes;};
+
+	/**
+	 * This operation returns the fixed values of all nodes, which are zero
+	 * for the free nodes.
+	 * @return the values
+	 */
+	const std::vector<double> & values() const { return fixedValues;};
+
+	/**
+	 * This operation returns true if apply() has been called for the current
+	 * set of fixed nodes.
+	 * @return true if the matrix has been modified, false otherwise
+	 */
+	bool isApplied() const { return applied;};
+
+};
+
+} /* namespace fire */
+
+#endif /* FEM_DIRICHLETLIFTING_H_ */
@@ -0,0 +1,174 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+
+// See the header file for API documentation
+
+#include <DomainDecomposition.h>
+#include <GraphOrdering.h>
+#include <ElementColoring.h>
+#include <algorithm>
+
+using namespace std;
+
+namespace fire {
+
+const long DomainDecomposition::subdomainGrain;
+
+DomainDecomposition::DomainDecomposition(const vector<int> & meshConnectivity,
+		const int & nodesPerElement, const int & numNodes,
+		const int & numSubdomains, ThreadPool & threadPool) :
+		elementSize(nodesPerElement), meshNumNodes(numNodes),
+		connectivity(meshConnectivity), pool(threadPool) {
+
+	int n = elementSize;
+	long numElements = connectivity.size()/n;
+	for (int id : connectivity) {
+		if (id < 0 || id >= numNodes) {
+			throw out_of_range("DomainDecomposition node id is out of range.");
+		}
+	}
+	int numParts = (numSubdomains > 0) ? numSubdomains : pool.size();
+	numParts = (int) max(1L, min((long) numParts, numElements));
+
+	// Find the elements attached to each node
+	vector<long> nodeOffsets, nodeElements;
+	nodeToElements(connectivity, n, numNodes, nodeOffsets, nodeElements);
+
+	// Build the element graph and partition it
+	vector<long> offsets(numElements + 1, 0);
+	vector<int> neighbors;
+	vector<long> marks(numElements, -1);
+	for (long e = 0; e < numElements; e++) {
+		marks[e] = e;
+		for (int a = 0; a < n; a++) {
+			int id = connectivity[e*n + a];
+			for (long k = nodeOffsets[id]; k < nodeOffsets[id+1]; k++) {
+				long neighbor = nodeElements[k];
+				if (marks[neighbor] != e) {
+					marks[neighbor] = e;
+					neighbors.push_back(neighbor);
+				}
+			}
+		}
+		offsets[e+1] = neighbors.size();
+	}
+	elementParts = recursiveBisection(offsets, neighbors, numParts);
+	subdomainElements.assign(numParts, vector<long>());
+	for (long e = 0; e < numElements; e++) {
+		subdomainElements[elementParts[e]].push_back(e);
+	}
+
+	// The global sparsity pattern
+	vector<pair<int,int>> entries;
+	entries.reserve(connectivity.size()*n);
+	for (long e = 0; e < numElements; e++) {
+		for (int a = 0; a < n; a++) {
+			for (int b = 0; b < n; b++) {
+				entries.emplace_back(connectivity[e*n + a],
+						connectivity[e*n + b]);
+			}
+		}
+	}
+	pattern = CSRMatrix<double>(numNodes, entries);
+
+	// Number the nodes of each subdomain locally, in the order its elements
+	// touch them, and build the local matrices and maps
+	subdomainNodes.resize(numParts);
+	localMatrices.resize(numParts);
+	localVectors.resize(numParts);
+	localScatter.resize(numParts);
+	globalSlots.resize(numParts);
+	vector<int> localIds(numNodes, -1);
+	for (int s = 0; s < numParts; s++) {
+		auto & nodes = subdomainNodes[s];
+		auto & elements = subdomainElements[s];
+		vector<pair<int,int>> localEntries;
+		localEntries.reserve(elements.size()*n*n);
+		for (long e : elements) {
+			for (int a = 0; a < n; a++) {
+				int id = connectivity[e*n + a];
+				if (localIds[id] < 0) {
+					localIds[id] = nodes.size();
+					nodes.push_back(id);
+				}
+			}
+			for (int a = 0; a < n; a++) {
+				for (int b = 0; b < n; b++) {
+					localEntries.emplace_back(localIds[connectivity[e*n + a]],
+							localIds[connectivity[e*n + b]]);
+				}
+			}
+		}
+		CSRMatrix<double> local(nodes.size(), localEntries);
+		auto & scatter = localScatter[s];
+		scatter.resize(localEntries.size());
+		for (long k = 0; k < (long) localEntries.size(); k++) {
+			scatter[k] = local.slot(localEntries[k].first,
+					localEntries[k].second);
+		}
+		auto & slots = globalSlots[s];
+		slots.resize(local.nonZeros());
+		for (int r = 0; r < local.size(); r++) {
+			for (long k = local.rowOffsets[r]; k < local.rowOffsets[r+1]; k++) {
+				slots[k] = pattern.slot(nodes[r], nodes[local.columns[k]]);
+			}
+		}
+		localMatrices[s] = std::move(local);
+		for (int id : nodes) localIds[id] = -1;
+	}
+
+	// Find the copies of each node, its owner and the interface
+	copyOffsets.assign(numNodes + 1, 0);
+	for (auto & nodes : subdomainNodes) {
+		for (int id : nodes) copyOffsets[id + 1]++;
+	}
+	for (int i = 0; i < numNodes; i++) copyOffsets[i+1] += copyOffsets[i];
+	copies.resize(copyOffsets[numNodes]);
+	vector<long> next(copyOffsets.begin(), copyOffsets.end() - 1);
+	for (int s = 0; s < numParts; s++) {
+		for (int k = 0; k < (int) subdomainNodes[s].size(); k++) {
+			copies[next[subdomainNodes[s][k]]++] = make_pair(s, k);
+		}
+	}
+	nodeOwners.assign(numNodes, 0);
+	ownedNodes.assign(numParts, vector<int>());
+	for (int i = 0; i < numNodes; i++) {
+		// The copies are in order of subdomain, so the first is the lowest
+		if (copyOffsets[i+1] > copyOffsets[i]) {
+			nodeOwners[i] = copies[copyOffsets[i]].first;
+		}
+		ownedNodes[nodeOwners[i]].push_back(i);
+		if (copyOffsets[i+1] - copyOffsets[i] > 1) interfaceNodes.push_back(i);
+	}
+}
+
+} /* namespace fire */
@@ -0,0 +1,349 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#ifndef FEM_DOMAINDECOMPOSITION_H_
+#define FEM_DOMAINDECOMPOSITION_H_
+
+#include <vector>
+#include <utility>
+#include <stdexcept>
+#include <CSRMatrix.h>
+#include <ThreadPool.h>
+
+namespace fire {
+
+/**
+ * This class splits a mesh into subdomains for shared memory parallel
+ * assembly. The elements are partitioned with recursiveBisection() from
+ * GraphOrdering.h on the graph in which two elements are neighbors if they
+ * share a node, so each subdomain is a compact, connected block of elements
+ * and the subdomains are nearly equal in size.
+ *
+ * Each subdomain has its own local numbering of the nodes that its elements
+ * touch and its own local matrix. Assembly happens in two phases, each with
+ * one task per subdomain:
+ * 1) each subdomain adds the matrices of its elements into its local matrix,
+ * which no other thread touches, so no coloring or locking is needed and
+ * the writes stay in the subdomain's own cache; and
+ * 2) each subdomain fills the global rows of the nodes that it owns by
+ * adding up the copies of those rows in every subdomain that touches the
+ * node. Nodes inside a subdomain have one copy, while the interface nodes
+ * that several subdomains share exchange their contributions here.
+ * @code
+ * TwoDMesh mesh = TwoDMesh::rectangle(1000,500);
+ * CSTBatchStiffness batch(mesh);
+ * batch.compute();
+ * DomainDecomposition domains(mesh.connectivity(), 3, mesh.numNodes());
+ * CSRMatrix<double> stiffness = domains.matrix();
+ * domains.assemble([&](const long & e, double * k) {
+ *     batch.elementMatrix(e, k);
+ * }, stiffness);
+ * AdditiveSchwarzPreconditioner preconditioner(stiffness, domains.owners());
+ * @endcode
+ * The node owners give the AdditiveSchwarzPreconditioner the same
+ * subdomains for the solve. The local numbering, the list of interface
+ * nodes and the explicit exchange are also what a distributed memory run
+ * would need, with the exchange done by messages instead.
+ */
+class DomainDecomposition {
+
+protected:
+
+	/**
+	 * The number of nodes in each element.
+	 */
+	int elementSize;
+
+	/**
+	 * The number of nodes in the mesh.
+	 */
+	int meshNumNodes;
+
+	/**
+	 * The subdomain of each element.
+	 */
+	std::vector<int> elementParts;
+
+	/**
+	 * The elements of each subdomain.
+	 */
+	std::vector<std::vector<long>> subdomainElements;
+
+	/**
+	 * The global ids of the nodes that each subdomain's elements touch,
+	 * indexed by local id.
+	 */
+	std::vector<std::vector<int>> subdomainNodes;
+
+	/**
+	 * The subdomain that owns each node, which is the lowest one that
+	 * touches it.
+	 */
+	std::vector<int> nodeOwners;
+
+	/**
+	 * The nodes that are touched by more than one subdomain.
+	 */
+	std::vector<int> interfaceNodes;
+
+	/**
+	 * The copies of each node in the subdomains, as (subdomain, local id)
+	 * pairs stored from copyOffsets[i] to copyOffsets[i+1].
+	 */
+	std::vector<long> copyOffsets;
+	std::vector<std::pair<int,int>> copies;
+
+	/**
+	 * The owned nodes of each subdomain.
+	 */
+	std::vector<std::vector<int>> ownedNodes;
+
+	/**
+	 * A matrix that holds the sparsity pattern of the global matrix.
+	 */
+	CSRMatrix<double> pattern;
+
+	/**
+	 * The local matrix of each subdomain, in local ids.
+	 */
+	std::vector<CSRMatrix<double>> localMatrices;
+
+	/**
+	 * The local vectors of each subdomain.
+	 */
+	std::vector<std::vector<double>> localVectors;
+
+	/**
+	 * The slot in the local matrix of each (i,j) entry of each element of
+	 * each subdomain, elementSize^2 per element.
+	 */
+	std::vector<std::vector<long>> localScatter;
+
+	/**
+	 * The slot in the global matrix of each slot of each local matrix.
+	 */
+	std::vector<std::vector<long>> globalSlots;
+
+	/**
+	 * The node ids of the elements.
+	 */
+	const std::vector<int> & connectivity;
+
+	/**
+	 * The threads, which run one task per subdomain.
+	 */
+	ThreadPool & pool;
+
+	/**
+	 * The minimum number of subdomains per thread, which gives each subdomain
+	 * its own task.
+	 */
+	static const long subdomainGrain = 1;
+
+	/**
+	 * This operation throws an exception if a matrix was not created by
+	 * matrix().
+	 */
+	void checkMatrix(const CSRMatrix<double> & matrix) const {
+		if (matrix.nonZeros() != pattern.nonZeros()) {
+			throw std::runtime_error("DomainDecomposition matrix does not match the mesh.");
+		}
+	}
+
+public:
+
+	/**
+	 * The constructor. It partitions the elements and builds the local
+	 * numberings, matrices and scatter maps. The connectivity must outlive
+	 * the decomposition.
+	 * @param meshConnectivity the node ids of the elements, nodesPerElement
+	 * per element
+	 * @param nodesPerElement the number of nodes in each element
+	 * @param numNodes the number of nodes in the mesh. Node ids must be in
+	 * [0,numNodes).
+	 * @param numSubdomains the number of subdomains, which is the number of
+	 * threads in the pool by default
+	 * @param threadPool the threads used for assembly
+	 */
+	DomainDecomposition(const std::vector<int> & meshConnectivity,
+			const int & nodesPerElement, const int & numNodes,
+			const int & numSubdomains = 0,
+			ThreadPool & threadPool = ThreadPool::shared());
+
+	/**
+	 * This operation returns the number of subdomains.
+	 */
+	int numSubdomains() const { return subdomainElements.size();};
+
+	/**
+	 * This operation returns the subdomain of each element.
+	 */
+	const std::vector<int> & parts() const { return elementParts;};
+
+	/**
+	 * This operation returns the elements of a subdomain.
+	 * @param s the subdomain
+	 */
+	const std::vector<long> & elements(const int & s) const {
+		return subdomainElements[s];
+	};
+
+	/**
+	 * This operation returns the global ids of the nodes touched by a
+	 * subdomain, indexed by their local ids.
+	 * @param s the subdomain
+	 */
+	const std::vector<int> & nodes(const int & s) const {
+		return subdomainNodes[s];
+	};
+
+	/**
+	 * This operation returns the subdomain that owns each node.
+	 */
+	const std::vector<int> & owners() const { return nodeOwners;};
+
+	/**
+	 * This operation returns the nodes shared by more than one subdomain.
+	 */
+	const std::vector<int> & interface() const { return interfaceNodes;};
+
+	/**
+	 * This operation returns a matrix with the sparsity pattern of the
+	 * global matrix and all values set to zero.
+	 * @return the matrix
+	 */
+	CSRMatrix<double> matrix() const { return pattern;};
+
+	/**
+	 * This operation assembles a global matrix, one subdomain per task.
+	 * @param elementMatrix a function that can be called as
+	 * elementMatrix(const long & e, double * k) to fill the
+	 * nodesPerElement^2 entries of the matrix of element e in row major
+	 * order. It is called concurrently for elements of different subdomains.
+	 * @param global the matrix, which must have been created by matrix().
+	 * Its values are overwritten.
+	 */
+	template<typename F>
+	void assemble(const F & elementMatrix, CSRMatrix<double> & global) {
+		checkMatrix(global);
+		int n = elementSize;
+		// Assemble each subdomain locally
+		pool.parallelFor(0, numSubdomains(),
+				[&](const long & begin, const long & end) {
+			std::vector<double> k(n*n);
+			for (long s = begin; s < end; s++) {
+				auto & local = localMatrices[s];
+				auto & scatter = localScatter[s];
+				local.zero();
+				auto & elements = subdomainElements[s];
+				for (long m = 0; m < (long) elements.size(); m++) {
+					elementMatrix(elements[m], k.data());
+					const long * slots = &scatter[m*n*n];
+					for (int a = 0; a < n*n; a++) {
+						local.values[slots[a]] += k[a];
+					}
+				}
+			}
+		}, subdomainGrain);
+		// Exchange: each subdomain sums the copies of the rows it owns
+		pool.parallelFor(0, numSubdomains(),
+				[&](const long & begin, const long & end) {
+			for (long s = begin; s < end; s++) {
+				for (int node : ownedNodes[s]) {
+					for (long k = global.rowOffsets[node];
+							k < global.rowOffsets[node+1]; k++) {
+						global.values[k] = 0.0;
+					}
+					for (long c = copyOffsets[node]; c < copyOffsets[node+1];
+							c++) {
+						int t = copies[c].first, row = copies[c].second;
+						auto & local = localMatrices[t];
+						auto & slots = globalSlots[t];
+						for (long k = local.rowOffsets[row];
+								k < local.rowOffsets[row+1]; k++) {
+							global.values[slots[k]] += local.values[k];
+						}
+					}
+				}
+			}
+		}, subdomainGrain);
+	}
+
+	/**
+	 * This operation assembles a global vector, one subdomain per task.
+	 * @param elementVector a function that can be called as
+	 * elementVector(const long & e, double * f) to fill the nodesPerElement
+	 * entries of the vector of element e
+	 * @param global the vector, which is resized to the number of nodes and
+	 * overwritten
+	 */
+	template<typename F>
+	void assembleVector(const F & elementVector, std::vector<double> & global) {
+		global.resize(meshNumNodes);
+		int n = elementSize;
+		pool.parallelFor(0, numSubdomains(),
+				[&](const long & begin, const long & end) {
+			std::vector<double> f(n);
+			for (long s = begin; s < end; s++) {
+				auto & local = localVectors[s];
+				local.assign(subdomainNodes[s].size(), 0.0);
+				auto & elements = subdomainElements[s];
+				auto & scatter = localScatter[s];
+				for (long m = 0; m < (long) elements.size(); m++) {
+					elementVector(elements[m], f.data());
+					// The diagonal slots of the scatter map give the rows
+					const long * slots = &scatter[m*n*n];
+					for (int a = 0; a < n; a++) {
+						local[localMatrices[s].columns[slots[a*n + a]]] += f[a];
+					}
+				}
+			}
+		}, subdomainGrain);
+		pool.parallelFor(0, numSubdomains(),
+				[&](const long & begin, const long & end) {
+			for (long s = begin; s < end; s++) {
+				for (int node : ownedNodes[s]) {
+					double sum = 0.0;
+					for (long c = copyOffsets[node]; c < copyOffsets[node+1];
+							c++) {
+						sum += localVectors[copies[c].first][copies[c].second];
+					}
+					global[node] = sum;
+				}
+			}
+		}, subdomainGrain);
+	}
+
+};
+
+} /* namespace fire */
+
+#endif /* FEM_DOMAINDECOMPOSITION_H_ */
@@ -0,0 +1,80 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+
+// See the header file for API documentation
+
+#include <EdgeIndex.h>
+#include <stdexcept>
+
+using namespace std;
+
+namespace fire {
+
+EdgeIndex::EdgeIndex(const TwoDMesh & mesh) {
+
+	auto & ids = mesh.connectivity();
+	long numElements = mesh.numElements();
+	// A triangulation has about 1.5 edges per element
+	long expected = 3*numElements/2 + mesh.numNodes();
+	edgeIds.reserve(expected);
+	edgeNodes.reserve(2*expected);
+	edgeElements.reserve(2*expected);
+	elementEdges.reserve(2*expected);
+
+	for (long e = 0; e < numElements; e++) {
+		for (int l = 0; l < 3; l++) {
+			int first = ids[3*e+l], second = ids[3*e+(l+1)%3];
+			auto inserted = edgeIds.emplace(key(first, second), numEdges());
+			if (inserted.second) {
+				edgeNodes.push_back(first);
+				edgeNodes.push_back(second);
+				edgeElements.push_back(e);
+				edgeElements.push_back(-1);
+				elementEdges.push_back(l);
+				elementEdges.push_back(-1);
+			} else {
+				long edge = inserted.first->second;
+				if (edgeElements[2*edge+1] >= 0) {
+					throw runtime_error("An edge has more than two elements.");
+				}
+				edgeElements[2*edge+1] = e;
+				elementEdges[2*edge+1] = l;
+			}
+		}
+	}
+
+	for (long edge = 0; edge < numEdges(); edge++) {
+		if (edgeElements[2*edge+1] < 0) boundaryIds.push_back(edge);
+	}
+}
+
+} /* namespace fire */
@@ -0,0 +1,167 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#ifndef FEM_EDGEINDEX_H_
+#define FEM_EDGEINDEX_H_
+
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+#include <TwoDMesh.h>
+
+namespace fire {
+
+/**
+ * This class indexes the edges of the triangles in a TwoDMesh so that the
+ * elements on either side of an edge can be found from its two nodes in
+ * constant time. The edges are found by hashing the sorted pair of node ids
+ * of each side of each element, so building the index takes one pass over
+ * the elements instead of comparing edges or nodes pairwise.
+ *
+ * Local edge l of an element runs from its local node l to local node
+ * (l+1)%3, so it is opposite local node (l+2)%3. Each edge stores the nodes
+ * in the order of the first element that contains it, which is
+ * counter-clockwise around that element for a counter-clockwise mesh. Edges
+ * on the boundary of the mesh have only one element and the second element
+ * is -1.
+ *
+ * @code
+ * TwoDMesh mesh = TwoDMesh::rectangle(100,100);
+ * EdgeIndex edges(mesh);
+ * long edge = edges.find(5,6);
+ * long element = edges.elements()[2*edge];
+ * int side = edges.localEdges()[2*edge];
+ * @endcode
+ *
+ * The index is not updated if the mesh changes.
+ */
+class EdgeIndex {
+
+protected:
+
+	/**
+	 * The map from the packed, sorted node ids of an edge to its id.
+	 */
+	std::unordered_map<std::uint64_t,long> edgeIds;
+
+	/**
+	 * The two nodes of each edge.
+	 */
+	std::vector<int> edgeNodes;
+
+	/**
+	 * The two elements of each edge, the second of which is -1 for boundary
+	 * edges.
+	 */
+	std::vector<long> edgeElements;
+
+	/**
+	 * The local edge number of each edge in each of its elements, or -1 if
+	 * there is no second element.
+	 */
+	std::vector<int> elementEdges;
+
+	/**
+	 * The ids of the edges on the boundary of the mesh.
+	 */
+	std::vector<long> boundaryIds;
+
+	/**
+	 * This operation packs the node ids of an edge into a key that does not
+	 * depend on the order of the nodes.
+	 * @param first the first node
+	 * @param second the second node
+	 * @return the key
+	 */
+	static std::uint64_t key(const int & first, const int & second) {
+		std::uint64_t low = (first < second) ? first : second;
+		std::uint64_t high = (first < second) ? second : first;
+		return (high << 32) | low;
+	};
+
+public:
+
+	/**
+	 * Constructor
+	 * @param mesh the mesh
+	 * @throw std::runtime_error if an edge is shared by more than two
+	 * elements
+	 */
+	EdgeIndex(const TwoDMesh & mesh);
+
+	/**
+	 * This operation finds the edge between two nodes.
+	 * @param first the first node
+	 * @param second the second node
+	 * @return the id of the edge or -1 if the nodes do not share an edge
+	 */
+	long find(const int & first, const int & second) const {
+		auto edge = edgeIds.find(key(first, second));
+		return (edge == edgeIds.end()) ? -1 : edge->second;
+	};
+
+	/**
+	 * This operation returns the number of edges.
+	 * @return the number of edges
+	 */
+	long numEdges() const { return edgeElements.size()/2;};
+
+	/**
+	 * This operation returns the nodes of the edges.
+	 * @return the nodes, two per edge
+	 */
+	const std::vector<int> & nodes() const { return edgeNodes;};
+
+	/**
+	 * This operation returns the elements on either side of the edges.
+	 * @return the elements, two per edge with -1 for the missing element of
+	 * a boundary edge
+	 */
+	const std::vector<long> & elements() const { return edgeElements;};
+
+	/**
+	 * This operation returns the local edge numbers of the edges in their
+	 * elements.
+	 * @return the local edge numbers, two per edge
+	 */
+	const std::vector<int> & localEdges() const { return elementEdges;};
+
+	/**
+	 * This operation returns the edges on the boundary of the mesh.
+	 * @return the ids of the boundary edges in increasing order
+	 */
+	const std::vector<long> & boundary() const { return boundaryIds;};
+
+};
+
+} /* namespace fire */
+
+#endif /* FEM_EDGEINDEX_H_ */
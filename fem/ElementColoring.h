@@ -0,0 +1,110 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#ifndef FEM_ELEMENTCOLORING_H_
+#define FEM_ELEMENTCOLORING_H_
+
+#include <vector>
+
+namespace fire {
+
+/**
+ * This operation inverts the connectivity of a mesh into compressed rows of
+ * the elements attached to each node, so that the elements of node i are
+ * elements[offsets[i]..offsets[i+1]) in increasing order. It also inverts
+ * other lists of node ids, such as the nodes of the edges of a mesh.
+ * @param connectivity the global node ids of the elements, nodesPerElement
+ * per element
+ * @param nodesPerElement the number of nodes in each element
+ * @param numNodes the number of nodes. Node ids must be in [0,numNodes).
+ * @param offsets the offsets of the rows, which are overwritten
+ * @param elements the elements of each node, which are overwritten
+ */
+inline void nodeToElements(const std::vector<int> & connectivity,
+		const int & nodesPerElement, const int & numNodes,
+		std::vector<long> & offsets, std::vector<long> & elements) {
+	offsets.assign(numNodes + 1, 0);
+	for (int id : connectivity) offsets[id + 1]++;
+	for (int i = 0; i < numNodes; i++) offsets[i+1] += offsets[i];
+	elements.resize(connectivity.size());
+	std::vector<long> next(offsets.begin(), offsets.end() - 1);
+	for (long k = 0; k < (long) connectivity.size(); k++) {
+		elements[next[connectivity[k]]++] = k/nodesPerElement;
+	}
+}
+
+/**
+ * This operation colors elements greedily such that no two elements that
+ * share a node have the same color. The elements of one color can then be
+ * assembled in parallel without locks because they never write to the same
+ * rows of the global matrix. Each element is given the lowest color that is
+ * not used by any element that shares a node with it, so meshes with a
+ * bounded number of elements per node need a bounded number of colors.
+ * @param connectivity the global node ids of the elements, nodesPerElement
+ * per element
+ * @param nodesPerElement the number of nodes in each element
+ * @param numNodes the number of nodes. Node ids must be in [0,numNodes).
+ * @return the indices of the elements of each color, in increasing order
+ */
+inline std::vector<std::vector<long>> colorElements(
+		const std::vector<int> & connectivity, const int & nodesPerElement,
+		const int & numNodes) {
+	long numElements = connectivity.size()/nodesPerElement;
+	std::vector<std::vector<long>> elementColors;
+	std::vector<long> nodeOffsets, nodeElements;
+	nodeToElements(connectivity, nodesPerElement, numNodes, nodeOffsets,
+			nodeElements);
+	// Give each element the lowest color not used by its neighbors
+	std::vector<int> colors(numElements, -1);
+	std::vector<long> usedBy;
+	for (long e = 0; e < numElements; e++) {
+		for (int a = 0; a < nodesPerElement; a++) {
+			int id = connectivity[e*nodesPerElement + a];
+			for (long k = nodeOffsets[id]; k < nodeOffsets[id+1]; k++) {
+				int c = colors[nodeElements[k]];
+				if (c >= 0) {
+					if (c >= (int) usedBy.size()) usedBy.resize(c + 1, -1);
+					usedBy[c] = e;
+				}
+			}
+		}
+		int c = 0;
+		while (c < (int) usedBy.size() && usedBy[c] == e) c++;
+		colors[e] = c;
+		if (c >= (int) elementColors.size()) elementColors.resize(c + 1);
+		elementColors[c].push_back(e);
+	}
+	return elementColors;
+}
+
+} /* namespace fire */
+
+#endif /* FEM_ELEMENTCOLORING_H_ */
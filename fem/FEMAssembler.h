@@ -0,0 +1,501 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#ifndef FEM_FEMASSEMBLER_H_
+#define FEM_FEMASSEMBLER_H_
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <FEMTypes.h>
+#include <CSRMatrix.h>
+#include <ThreadPool.h>
+#include <ElementColoring.h>
+
+namespace fire {
+
+/**
+ * This class assembles the global stiffness matrix and force vector of a mesh
+ * from the contributions of its elements, such as ConstantStrainTriangleElement
+ * or its subclasses. Elements must provide
+ * @code
+ * std::array<int,N> nodeIds() const;
+ * const std::vector<MatrixElement<double>> & stiffnessMatrix();
+ * const std::vector<VectorElement<double>> & bodyForceVector();
+ * @endcode
+ * where the matrix and vector elements are identified by global node ids.
+ *
+ * All of the bookkeeping is done once on construction. The CSR sparsity
+ * pattern is computed from the element connectivity, and the slot in the
+ * CSR values array of every local (i,j) entry of every element is stored in a
+ * scatter map. Assembly is then a direct indexed add of each element's
+ * contributions into the values array with no searching or hashing:
+ * @code
+ * FEMAssembler<LaplaceCSTElement> assembler(elements, numNodes);
+ * CSRMatrix<double> stiffness = assembler.matrix();
+ * std::vector<double> force;
+ * assembler.assemble(stiffness, force);
+ * @endcode
+ *
+ * The elements are also colored such that no two elements of the same color
+ * share a node. The elements of each color are assembled in parallel on a
+ * ThreadPool with no locks or atomics because they never write to the same
+ * slot. Colors are assembled one after the other.
+ *
+ * Elements that have been deflated by Dirichlet Boundary Conditions return
+ * fewer contributions, which are found in the element's local slot table
+ * instead of by position. The entries that they drop remain zero in the
+ * global matrix.
+ *
+ * The assembler can also patch an assembled matrix when only a few elements
+ * change, which is common in nonlinear iterations and for moving sources that
+ * only touch a small region. Elements whose coefficients changed are marked
+ * with markDirty() and nodes that moved are marked with markNodeMoved(), which
+ * marks every element of the node for a call to recomputeConstants().
+ * updateStiffness() then recomputes only the marked elements and adds the
+ * difference between their new and last assembled contributions to the
+ * matrix in place:
+ * @code
+ * assembler.assembleStiffness(stiffness);
+ * ...
+ * elements[42].transferCoefficient(5.0);
+ * assembler.markDirty(42);
+ * nodes[7].first += 0.01;
+ * assembler.markNodeMoved(7);
+ * assembler.updateStiffness(stiffness);
+ * @endcode
+ * The last assembled contribution of every element is kept for this, which
+ * costs nodesPerElement^2 doubles per element. Since the patch is a
+ * difference, the values may differ from a full assembly by round off. The
+ * force vector is not patched.
+ *
+ * The assembler keeps a reference to the elements, so they must not be moved
+ * or destroyed while it is in use. Elements are evaluated from multiple
+ * threads, so their kernels must not modify shared data.
+ */
+template<typename E>
+class FEMAssembler {
+
+protected:
+
+	/**
+	 * The elements in the mesh.
+	 */
+	std::vector<E> & elements;
+
+	/**
+	 * The number of nodes in the mesh.
+	 */
+	int numNodes;
+
+	/**
+	 * The number of nodes in each element.
+	 */
+	int nodesPerElement = 0;
+
+	/**
+	 * The global node ids of every element, nodesPerElement per element.
+	 */
+	std::vector<int> connectivity;
+
+	/**
+	 * The sparsity pattern of the global matrix. Its values are unused.
+	 */
+	CSRMatrix<double> pattern;
+
+	/**
+	 * The scatter map from the local (i,j) entries of each element to the
+	 * slots in the CSR values array, nodesPerElement^2 per element in row
+	 * major order.
+	 */
+	std::vector<long> scatter;
+
+	/**
+	 * The elements of each color.
+	 */
+	std::vector<std::vector<long>> elementColors;
+
+	/**
+	 * The color of each element.
+	 */
+	std::vector<int> colorIds;
+
+	/**
+	 * The elements that contain each node in compressed rows, such that the
+	 * elements of node i are nodeElements[nodeOffsets[i]] to
+	 * nodeElements[nodeOffsets[i+1]-1].
+	 */
+	std::vector<long> nodeOffsets, nodeElements;
+
+	/**
+	 * The stiffness contributions that were last added to the global matrix
+	 * by each element, nodesPerElement^2 per element in row major order.
+	 */
+	std::vector<double> contributions;
+
+	/**
+	 * The state of each element for updateStiffness(): CLEAN, COEFFICIENTS if
+	 * only its stiffness must be recomputed or GEOMETRY if its constants must
+	 * also be recomputed.
+	 */
+	enum DirtyState : char {CLEAN, COEFFICIENTS, GEOMETRY};
+	std::vector<DirtyState> dirtyStates;
+
+	/**
+	 * The elements that are not CLEAN.
+	 */
+	std::vector<long> dirtyElements;
+
+	/**
+	 * The thread pool used for parallel assembly.
+	 */
+	ThreadPool & pool;
+
+	/**
+	 * The minimum number of elements per thread. Evaluating an element is far
+	 * more expensive than a vector operation, so the loops are split between
+	 * threads when they are much shorter than the default of the pool.
+	 */
+	static const long elementGrain = 64;
+
+	/**
+	 * This operation finds the local id of a global node id in an element.
+	 */
+	int localId(const long & e, const int & id) const {
+		const int * ids = &connectivity[e*nodesPerElement];
+		for (int a = 0; a < nodesPerElement; a++) {
+			if (ids[a] == id) return a;
+		}
+		throw std::runtime_error("FEMAssembler found a node that is not in the element.");
+	}
+
+	/**
+	 * This operation computes the stiffness matrix of an element in local row
+	 * major order. Entries dropped by deflated elements are zero.
+	 */
+	void computeStiffness(const long & e, double * local) {
+		auto & entries = elements[e].stiffnessMatrix();
+		const int * ids = &connectivity[e*nodesPerElement];
+		int n = nodesPerElement, numEntries = entries.size();
+		for (int k = 0; k < n*n; k++) local[k] = 0.0;
+		for (int k = 0; k < numEntries; k++) {
+			auto & entry = entries[k];
+			// Full elements list their entries in local row major order.
+			// Deflated elements have to be looked up.
+			int index = (numEntries == n*n && entry.first == ids[k/n]
+					&& entry.second == ids[k%n]) ? k
+					: localId(e,entry.first)*n + localId(e,entry.second);
+			local[index] += entry.value;
+		}
+	}
+
+	/**
+	 * This operation adds the stiffness matrix contributions of an element
+	 * and keeps them for updateStiffness().
+	 */
+	void addStiffness(const long & e, std::vector<double> & values) {
+		int n = nodesPerElement;
+		double * local = &contributions[e*n*n];
+		const long * slots = &scatter[e*n*n];
+		computeStiffness(e, local);
+		for (int k = 0; k < n*n; k++) values[slots[k]] += local[k];
+	}
+
+	/**
+	 * This operation recomputes the stiffness matrix contributions of a dirty
+	 * element and adds the change to the values.
+	 */
+	void patchStiffness(const long & e, std::vector<double> & values) {
+		int n = nodesPerElement;
+		double * local = &contributions[e*n*n];
+		const long * slots = &scatter[e*n*n];
+		if (dirtyStates[e] == GEOMETRY) elements[e].recomputeConstants();
+		std::vector<double> updated(n*n);
+		computeStiffness(e, updated.data());
+		for (int k = 0; k < n*n; k++) {
+			values[slots[k]] += updated[k] - local[k];
+			local[k] = updated[k];
+		}
+		dirtyStates[e] = CLEAN;
+	}
+
+	/**
+	 * This operation marks an element as dirty.
+	 */
+	void mark(const long & e, const DirtyState & state) {
+		if (dirtyStates[e] == CLEAN) dirtyElements.push_back(e);
+		if (state > dirtyStates[e]) dirtyStates[e] = state;
+	}
+
+	/**
+	 * This operation clears the elements whose coefficients changed, which a
+	 * full assembly recomputes. Elements with moved nodes stay dirty because
+	 * the assembly does not recompute their constants.
+	 */
+	void clearCoefficients() {
+		long numKept = 0;
+		for (long e : dirtyElements) {
+			if (dirtyStates[e] == GEOMETRY) dirtyElements[numKept++] = e;
+			else dirtyStates[e] = CLEAN;
+		}
+		dirtyElements.resize(numKept);
+	}
+
+	/**
+	 * This operation adds the force vector contributions of an element.
+	 */
+	void addForce(const long & e, std::vector<double> & force) {
+		for (auto & entry : elements[e].bodyForceVector()) {
+			force[entry.first] += entry.second;
+		}
+	}
+
+public:
+
+	/**
+	 * The constructor. It computes the sparsity pattern, scatter map and
+	 * coloring for the mesh.
+	 * @param meshElements the elements in the mesh
+	 * @param meshNumNodes the number of nodes in the mesh. Node ids must be in
+	 * [0,meshNumNodes).
+	 * @param threadPool the pool of threads that should be used for parallel
+	 * assembly. Loops of more than 64 elements are split between threads.
+	 */
+	FEMAssembler(std::vector<E> & meshElements, const int & meshNumNodes,
+			ThreadPool & threadPool = ThreadPool::shared()) :
+			elements(meshElements), numNodes(meshNumNodes), pool(threadPool) {
+		// Gather the connectivity and the positions of all the entries
+		std::vector<std::pair<int,int>> entries;
+		for (auto & element : elements) {
+			auto ids = element.nodeIds();
+			nodesPerElement = ids.size();
+			for (int i : ids) {
+				if (i < 0 || i >= numNodes) {
+					throw std::out_of_range("FEMAssembler node id is out of range.");
+				}
+				connectivity.push_back(i);
+				for (int j : ids) entries.emplace_back(i,j);
+			}
+		}
+		pattern = CSRMatrix<double>(numNodes,entries);
+		// Find the slot of every local entry
+		int n = nodesPerElement;
+		scatter.resize(elements.size()*n*n);
+		for (long e = 0; e < (long) elements.size(); e++) {
+			const int * ids = &connectivity[e*n];
+			for (int i = 0; i < n; i++) {
+				for (int j = 0; j < n; j++) {
+					scatter[e*n*n + i*n + j] = pattern.slot(ids[i],ids[j]);
+				}
+			}
+		}
+		elementColors = colorElements(connectivity, nodesPerElement, numNodes);
+		colorIds.resize(elements.size());
+		for (int color = 0; color < (int) elementColors.size(); color++) {
+			for (long e : elementColors[color]) colorIds[e] = color;
+		}
+		nodeToElements(connectivity, n, numNodes, nodeOffsets, nodeElements);
+		dirtyStates.assign(elements.size(), CLEAN);
+	};
+
+	/**
+	 * This operation returns a matrix with the sparsity pattern of the global
+	 * stiffness matrix and all values set to zero.
+	 * @return the matrix
+	 */
+	CSRMatrix<double> matrix() const { return pattern;};
+
+	/**
+	 * This operation returns the elements of each color. No two elements of
+	 * the same color share a node.
+	 * @return the element indices for each color
+	 */
+	const std::vector<std::vector<long>> & colors() const {
+		return elementColors;
+	};
+
+	/**
+	 * This operation returns the scatter map, which holds the slot in the
+	 * CSR values array for each local (i,j) entry of each element.
+	 * @return the scatter map with nodesPerElement^2 entries per element
+	 */
+	const std::vector<long> & scatterMap() const { return scatter;};
+
+	/**
+	 * This operation assembles the global stiffness matrix in parallel.
+	 * Elements marked by markDirty() are no longer dirty afterwards, but
+	 * those marked by markNodeMoved() are until updateStiffness() recomputes
+	 * their constants.
+	 * @param stiffness the matrix, which must have been created by matrix().
+	 * Its values are overwritten.
+	 */
+	void assembleStiffness(CSRMatrix<double> & stiffness) {
+		if (stiffness.nonZeros() != pattern.nonZeros()) {
+			throw std::runtime_error("FEMAssembler matrix does not match the mesh.");
+		}
+		stiffness.zero();
+		contributions.resize(scatter.size());
+		clearCoefficients();
+		for (auto & elementColor : elementColors) {
+			pool.parallelFor(0, elementColor.size(),
+					[&](const long & begin, const long & end) {
+				for (long k = begin; k < end; k++) {
+					addStiffness(elementColor[k], stiffness.values);
+				}
+			}, elementGrain);
+		}
+	}
+
+	/**
+	 * This operation marks an element whose coefficients changed so that its
+	 * stiffness is recomputed by the next call to updateStiffness().
+	 * @param e the index of the element
+	 * @throw std::out_of_range if the element is not in the mesh
+	 */
+	void markDirty(const long & e) {
+		if (e < 0 || e >= (long) elements.size()) {
+			throw std::out_of_range("FEMAssembler element is out of range.");
+		}
+		mark(e, COEFFICIENTS);
+	}
+
+	/**
+	 * This operation marks a node that moved so that the constants and
+	 * stiffness of all of its elements are recomputed by the next call to
+	 * updateStiffness(). The elements must provide recomputeConstants().
+	 * @param id the global id of the node
+	 * @throw std::out_of_range if the node is not in the mesh
+	 */
+	void markNodeMoved(const int & id) {
+		if (id < 0 || id >= numNodes) {
+			throw std::out_of_range("FEMAssembler node id is out of range.");
+		}
+		for (long k = nodeOffsets[id]; k < nodeOffsets[id+1]; k++) {
+			mark(nodeElements[k], GEOMETRY);
+		}
+	}
+
+	/**
+	 * This operation returns the number of elements that are marked for the
+	 * next call to updateStiffness().
+	 * @return the number of dirty elements
+	 */
+	long numDirty() const { return dirtyElements.size();};
+
+	/**
+	 * This operation recomputes the stiffness contributions of the dirty
+	 * elements and patches them into an assembled matrix in place. The dirty
+	 * elements of each color are patched in parallel.
+	 * @param stiffness the matrix, which must have been assembled by
+	 * assembleStiffness(), assemble() or assembleSerial() and only changed
+	 * by updateStiffness() since
+	 * @return the number of elements that were recomputed
+	 * @throw std::logic_error if the matrix has not been assembled
+	 */
+	long updateStiffness(CSRMatrix<double> & stiffness) {
+		if (stiffness.nonZeros() != pattern.nonZeros()) {
+			throw std::runtime_error("FEMAssembler matrix does not match the mesh.");
+		}
+		if (contributions.size() != scatter.size()) {
+			throw std::logic_error("FEMAssembler matrix has not been assembled.");
+		}
+		std::vector<std::vector<long>> dirtyColors(elementColors.size());
+		for (long e : dirtyElements) dirtyColors[colorIds[e]].push_back(e);
+		for (auto & dirtyColor : dirtyColors) {
+			pool.parallelFor(0, dirtyColor.size(),
+					[&](const long & begin, const long & end) {
+				for (long k = begin; k < end; k++) {
+					patchStiffness(dirtyColor[k], stiffness.values);
+				}
+			}, elementGrain);
+		}
+		long numUpdated = dirtyElements.size();
+		dirtyElements.clear();
+		return numUpdated;
+	}
+
+	/**
+	 * This operation assembles the global force vector in parallel.
+	 * @param force the force vector, which is resized to the number of nodes
+	 * and overwritten.
+	 */
+	void assembleForce(std::vector<double> & force) {
+		force.assign(numNodes, 0.0);
+		for (auto & elementColor : elementColors) {
+			pool.parallelFor(0, elementColor.size(),
+					[&](const long & begin, const long & end) {
+				for (long k = begin; k < end; k++) {
+					addForce(elementColor[k], force);
+				}
+			}, elementGrain);
+		}
+	}
+
+	/**
+	 * This operation assembles the global stiffness matrix and force vector
+	 * in parallel.
+	 * @param stiffness the matrix, which must have been created by matrix()
+	 * @param force the force vector
+	 */
+	void assemble(CSRMatrix<double> & stiffness, std::vector<double> & force) {
+		assembleStiffness(stiffness);
+		assembleForce(force);
+	}
+
+	/**
+	 * This operation assembles the global stiffness matrix and force vector
+	 * serially, element by element, which is useful for checking the
+	 * parallel assembly and for small meshes. Dirty elements are cleared as
+	 * by assembleStiffness().
+	 * @param stiffness the matrix, which must have been created by matrix()
+	 * @param force the force vector
+	 */
+	void assembleSerial(CSRMatrix<double> & stiffness,
+			std::vector<double> & force) {
+		stiffness.zero();
+		force.assign(numNodes, 0.0);
+		contributions.resize(scatter.size());
+		clearCoefficients();
+		for (long e = 0; e < (long) elements.size(); e++) {
+			addStiffness(e, stiffness.values);
+			addForce(e, force);
+		}
+	}
+
+};
+
+template<typename E>
+const long FEMAssembler<E>::elementGrain;
+
+} /* namespace fire */
+
+#endif /* FEM_FEMASSEMBLER_H_ */
@@ -0,0 +1,324 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+
+// See the header file for API documentation
+
+#include <GeometricMultigrid.h>
+#include <CSTBatchStiffness.h>
+#include <EdgeIndex.h>
+#include <stdexcept>
+#include <math.h>
+
+using namespace std;
+
+namespace fire {
+
+/**
+ * The weight of the damped Jacobi smoother, which damps the high frequency
+ * error of the Laplacian best.
+ */
+static const double jacobiWeight = 2.0/3.0;
+
+GeometricMultigrid::GeometricMultigrid(const TwoDMesh & coarse,
+		const int & numRefinements, const vector<int> & fixedMarkers,
+		const double & kappa, const MultigridSmoother & smoother,
+		const int & smoothingSteps, ThreadPool & threadPool) :
+		markers(fixedMarkers), smootherType(smoother),
+		numSmoothingSteps(smoothingSteps), pool(threadPool) {
+
+	if (numRefinements < 0) {
+		throw runtime_error("The number of refinements must not be negative.");
+	}
+	if (smoothingSteps < 1) {
+		throw runtime_error("At least one smoothing step is required.");
+	}
+
+	// Build the hierarchy. The new nodes of each refinement are numbered in
+	// the order of the edges that they split.
+	int numLevels = numRefinements + 1;
+	meshes.reserve(numLevels);
+	parents.resize(numLevels);
+	meshes.push_back(coarse);
+	for (int level = 1; level < numLevels; level++) {
+		EdgeIndex edges(meshes.back());
+		parents[level] = edges.nodes();
+		TwoDMesh fine = meshes.back().refine();
+		meshes.push_back(std::move(fine));
+	}
+
+	// Create the sparsity patterns and fix the boundaries of every level
+	levelConditions.reserve(numLevels);
+	matrices.resize(numLevels);
+	for (int level = 0; level < numLevels; level++) {
+		auto & levelMesh = meshes[level];
+		auto & connectivity = levelMesh.connectivity();
+		vector<pair<int,int>> entries;
+		entries.reserve(9*connectivity.size()/3);
+		for (long e = 0; e < levelMesh.numElements(); e++) {
+			for (int a = 0; a < 3; a++) {
+				for (int b = 0; b < 3; b++) {
+					entries.emplace_back(connectivity[3*e + a],
+							connectivity[3*e + b]);
+				}
+			}
+		}
+		matrices[level] = CSRMatrix<double>(levelMesh.numNodes(), entries);
+		levelConditions.emplace_back(levelMesh.numNodes(),
+				DirichletMethod::ELIMINATION, 1.0e8, pool);
+		for (int marker : markers) {
+			levelConditions.back().fixBoundary(levelMesh, marker, 0.0);
+		}
+	}
+
+	inverseDiagonals.resize(numLevels);
+	rhs.resize(numLevels);
+	solutions.resize(numLevels);
+	residuals.resize(numLevels);
+	for (int level = 0; level < numLevels; level++) {
+		int n = meshes[level].numNodes();
+		rhs[level].resize(n);
+		solutions[level].resize(n);
+		residuals[level].resize(n);
+	}
+
+	coefficient(vector<double>(meshes.back().numElements(), kappa));
+}
+
+void GeometricMultigrid::assemble(const int & level,
+		const vector<double> & kappa) {
+	auto & levelMesh = meshes[level];
+	auto & matrix = matrices[level];
+	auto & connectivity = levelMesh.connectivity();
+	CSTBatchStiffness batch(levelMesh, pool);
+	batch.compute(kappa);
+	matrix.zero();
+	double k[9];
+	for (long e = 0; e < levelMesh.numElements(); e++) {
+		batch.elementMatrix(e, k);
+		for (int a = 0; a < 3; a++) {
+			int row = connectivity[3*e + a];
+			for (int b = 0; b < 3; b++) {
+				matrix.values[matrix.slot(row, connectivity[3*e + b])] +=
+						k[3*a + b];
+			}
+		}
+	}
+	levelConditions[level].apply(matrix);
+}
+
+void GeometricMultigrid::factor(const int & level) {
+	auto & matrix = matrices[level];
+	auto & inverseDiagonal = inverseDiagonals[level];
+	inverseDiagonal.resize(matrix.size());
+	for (int i = 0; i < matrix.size(); i++) {
+		long slot = matrix.slot(i, i);
+		if (slot < 0 || matrix.values[slot] == 0.0) {
+			throw runtime_error("Multigrid matrices must have nonzero "
+					"diagonals.");
+		}
+		inverseDiagonal[i] = 1.0/matrix.values[slot];
+	}
+	if (level == 0) coarseFactors.factor(matrix);
+}
+
+void GeometricMultigrid::coefficient(const vector<double> & kappa) {
+	if ((long) kappa.size() != meshes.back().numElements()) {
+		throw runtime_error("One transfer coefficient is required per element.");
+	}
+	// Element e of a level is split into elements 4e to 4e+3 of the next
+	vector<double> levelKappa(kappa), coarseKappa;
+	for (int level = numLevels() - 1; level >= 0; level--) {
+		assemble(level, levelKappa);
+		factor(level);
+		if (level > 0) {
+			coarseKappa.resize(levelKappa.size()/4);
+			for (long e = 0; e < (long) coarseKappa.size(); e++) {
+				coarseKappa[e] = 0.25*(levelKappa[4*e] + levelKappa[4*e+1] +
+						levelKappa[4*e+2] + levelKappa[4*e+3]);
+			}
+			levelKappa.swap(coarseKappa);
+		}
+	}
+}
+
+void GeometricMultigrid::update(const CSRMatrix<double> & matrix) {
+	auto & fine = matrices.back();
+	if (matrix.size() != fine.size() || matrix.nonZeros() != fine.nonZeros()) {
+		throw runtime_error("The matrix does not match the finest level.");
+	}
+	fine.values = matrix.values;
+	factor(numLevels() - 1);
+}
+
+void GeometricMultigrid::prolong(const int & level,
+		const vector<double> & coarse, vector<double> & fine) const {
+	int numCoarse = meshes[level].numNodes();
+	auto & edgeNodes = parents[level + 1];
+	fine.resize(meshes[level + 1].numNodes());
+	pool.parallelFor(0, fine.size(), [&](const long & begin, const long & end) {
+		for (long i = begin; i < end; i++) {
+			if (i < numCoarse) {
+				fine[i] = coarse[i];
+			} else {
+				long k = i - numCoarse;
+				fine[i] = 0.5*(coarse[edgeNodes[2*k]] + coarse[edgeNodes[2*k+1]]);
+			}
+		}
+	});
+}
+
+void GeometricMultigrid::restrict(const int & level,
+		const vector<double> & fine, vector<double> & coarse) const {
+	int numCoarse = meshes[level - 1].numNodes();
+	auto & edgeNodes = parents[level];
+	coarse.assign(fine.begin(), fine.begin() + numCoarse);
+	// The new nodes scatter to their parents, which is cheap next to the
+	// smoothing, so it is done serially
+	for (long k = 0; k < (long) fine.size() - numCoarse; k++) {
+		double half = 0.5*fine[numCoarse + k];
+		coarse[edgeNodes[2*k]] += half;
+		coarse[edgeNodes[2*k+1]] += half;
+	}
+}
+
+void GeometricMultigrid::smooth(const int & level, const bool & forward) const {
+	auto & matrix = matrices[level];
+	auto & b = rhs[level];
+	auto & x = solutions[level];
+	auto & inverseDiagonal = inverseDiagonals[level];
+	int n = matrix.size();
+	if (smootherType == MultigridSmoother::JACOBI) {
+		auto & r = residuals[level];
+		matrix.multiply(x, r, pool);
+		pool.parallelFor(0, n, [&](const long & begin, const long & end) {
+			for (long i = begin; i < end; i++) {
+				x[i] += jacobiWeight*inverseDiagonal[i]*(b[i] - r[i]);
+			}
+		});
+		return;
+	}
+	// Gauss-Seidel uses the new values as soon as they are computed
+	for (int m = 0; m < n; m++) {
+		int i = forward ? m : n - 1 - m;
+		double sum = b[i];
+		for (long k = matrix.rowOffsets[i]; k < matrix.rowOffsets[i+1]; k++) {
+			sum -= matrix.values[k]*x[matrix.columns[k]];
+		}
+		x[i] += inverseDiagonal[i]*sum;
+	}
+}
+
+void GeometricMultigrid::cycle(const int & level) const {
+	auto & x = solutions[level];
+	if (level == 0) {
+		coarseFactors.solve(rhs[0], x);
+		return;
+	}
+	auto & conditions = levelConditions[level];
+	auto & coarseConditions = levelConditions[level - 1];
+	auto & r = residuals[level];
+	std::fill(x.begin(), x.end(), 0.0);
+	for (int s = 0; s < numSmoothingSteps; s++) smooth(level, true);
+
+	// Restrict the residual and solve for the correction on the next level.
+	// The fixed nodes have no error, so they are masked on both levels.
+	matrices[level].multiply(x, r, pool);
+	auto & b = rhs[level];
+	for (long i = 0; i < (long) r.size(); i++) r[i] = b[i] - r[i];
+	auto & coarseRHS = rhs[level - 1];
+	restrict(level, r, coarseRHS);
+	for (int node : coarseConditions.nodes()) coarseRHS[node] = 0.0;
+	cycle(level - 1);
+	prolong(level - 1, solutions[level - 1], r);
+	for (int node : conditions.nodes()) r[node] = 0.0;
+	pool.parallelFor(0, x.size(), [&](const long & begin, const long & end) {
+		for (long i = begin; i < end; i++) x[i] += r[i];
+	});
+
+	for (int s = 0; s < numSmoothingSteps; s++) smooth(level, false);
+}
+
+void GeometricMultigrid::apply(const vector<double> & r,
+		vector<double> & z) const {
+	int top = numLevels() - 1;
+	auto & b = rhs[top];
+	if (r.size() != b.size()) {
+		throw runtime_error("The residual does not match the finest level.");
+	}
+	auto & fixedNodes = levelConditions[top].nodes();
+	b = r;
+	for (int node : fixedNodes) b[node] = 0.0;
+	cycle(top);
+	z = solutions[top];
+	// The fixed rows only have their diagonals, so they are solved exactly
+	auto & inverseDiagonal = inverseDiagonals[top];
+	for (int node : fixedNodes) z[node] = r[node]*inverseDiagonal[node];
+}
+
+PCGResult GeometricMultigrid::solve(const vector<double> & b,
+		vector<double> & x, const double & tol, const int & maxCycles) const {
+	auto & matrix = matrices.back();
+	int n = matrix.size();
+	if ((int) b.size() != n) {
+		throw runtime_error("The right hand side does not match the finest "
+				"level.");
+	}
+	if ((int) x.size() != n) x.assign(n, 0.0);
+	vector<double> r(n), z(n);
+	auto residual = [&]() {
+		matrix.multiply(x, r, pool);
+		double norm = 0.0;
+		for (int i = 0; i < n; i++) {
+			r[i] = b[i] - r[i];
+			norm += r[i]*r[i];
+		}
+		return sqrt(norm);
+	};
+	double bNorm = 0.0;
+	for (int i = 0; i < n; i++) bNorm += b[i]*b[i];
+	bNorm = sqrt(bNorm);
+
+	PCGResult result;
+	result.residualNorm = residual();
+	result.history.push_back(result.residualNorm);
+	while (result.residualNorm > tol*bNorm && result.iterations < maxCycles) {
+		apply(r, z);
+		for (int i = 0; i < n; i++) x[i] += z[i];
+		result.iterations++;
+		result.residualNorm = residual();
+		result.history.push_back(result.residualNorm);
+	}
+	result.converged = result.residualNorm <= tol*bNorm;
+	return result;
+}
+
+} /* namespace fire */
@@ -0,0 +1,306 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#ifndef FEM_GEOMETRICMULTIGRID_H_
+#define FEM_GEOMETRICMULTIGRID_H_
+
+#include <vector>
+#include <TwoDMesh.h>
+#include <CSRMatrix.h>
+#include <DirichletLifting.h>
+#include <Preconditioner.h>
+#include <PCGSolver.h>
+#include <SkylineCholesky.h>
+#include <ThreadPool.h>
+
+namespace fire {
+
+/**
+ * This enumeration describes the smoothers used by the GeometricMultigrid.
+ * JACOBI is damped Jacobi with a weight of 2/3, which runs in parallel.
+ * GAUSS_SEIDEL is a forward sweep before the coarse grid correction and a
+ * backward sweep after it, which is sequential but smooths much better.
+ */
+enum class MultigridSmoother {JACOBI, GAUSS_SEIDEL};
+
+/**
+ * This class solves or preconditions Laplace's equation with Constant Strain
+ * Triangles on a hierarchy of nested meshes by geometric multigrid. The
+ * hierarchy is built by refining a coarse mesh with TwoDMesh::refine(), so
+ * the prolongation from one level to the next is exact linear interpolation:
+ * coarse nodes keep their values and each new node is the average of the two
+ * ends of the edge that it splits. The restriction is its transpose.
+ *
+ * The stiffness matrix of every level is assembled from the mesh of that
+ * level (see CSTBatchStiffness), which for nested linear elements is the
+ * same as the Galerkin product of the fine matrix and the transfers, and the
+ * Dirichlet boundaries are eliminated on every level with a DirichletLifting.
+ * The coarsest level is factored with a SkylineCholesky. The number of
+ * iterations needed with a V-cycle does not grow as the mesh is refined,
+ * unlike single level preconditioners. For example:
+ * @code
+ * TwoDMesh coarse = TwoDMesh::rectangle(4,4);
+ * GeometricMultigrid multigrid(coarse, 6, {0, 2});
+ * DirichletLifting & conditions = multigrid.conditions();
+ * conditions.fixBoundary(multigrid.fineMesh(), 0, 1.0);
+ * vector<double> b(multigrid.fineMesh().numNodes(), 0.0), x;
+ * conditions.lift(b);
+ * PCGSolver solver;
+ * solver.solve(multigrid.matrix(), b, x, multigrid);
+ * @endcode
+ * Each application of the preconditioner is one V-cycle, which is
+ * symmetric, so it can be used with the PCGSolver. The V-cycle can also be
+ * iterated on its own with solve().
+ */
+class GeometricMultigrid : public IPreconditioner {
+
+protected:
+
+	/**
+	 * The meshes of the levels, from the coarsest to the finest.
+	 */
+	std::vector<TwoDMesh> meshes;
+
+	/**
+	 * The stiffness matrices of the levels.
+	 */
+	std::vector<CSRMatrix<double>> matrices;
+
+	/**
+	 * The Dirichlet conditions of the levels, which fix the nodes on the
+	 * boundary edges with the fixed markers.
+	 */
+	std::vector<DirichletLifting> levelConditions;
+
+	/**
+	 * The markers of the fixed boundary edges.
+	 */
+	std::vector<int> markers;
+
+	/**
+	 * The two coarse nodes of the edge split by each new node of a level,
+	 * two per node, for all levels but the coarsest.
+	 */
+	std::vector<std::vector<int>> parents;
+
+	/**
+	 * The inverse of the diagonal of the matrix of each level.
+	 */
+	std::vector<std::vector<double>> inverseDiagonals;
+
+	/**
+	 * The right hand side, solution and residual of each level, which are
+	 * reused by every cycle.
+	 */
+	mutable std::vector<std::vector<double>> rhs, solutions, residuals;
+
+	/**
+	 * The factors of the coarsest matrix.
+	 */
+	SkylineCholesky coarseFactors;
+
+	/**
+	 * The smoother.
+	 */
+	MultigridSmoother smootherType;
+
+	/**
+	 * The number of smoothing steps before and after each coarse grid
+	 * correction.
+	 */
+	int numSmoothingSteps;
+
+	/**
+	 * The threads used by the smoothers and transfers.
+	 */
+	ThreadPool & pool;
+
+	/**
+	 * This operation assembles the matrix of a level for a transfer
+	 * coefficient on each of its elements and eliminates the fixed nodes.
+	 */
+	void assemble(const int & level, const std::vector<double> & kappa);
+
+	/**
+	 * This operation updates the inverse diagonal of a level, or factors the
+	 * matrix of the coarsest level.
+	 */
+	void factor(const int & level);
+
+	/**
+	 * This operation applies the smoother to the solution of a level.
+	 * @param level the level
+	 * @param forward true for a forward Gauss-Seidel sweep, false for a
+	 * backward sweep. It is ignored by the Jacobi smoother.
+	 */
+	void smooth(const int & level, const bool & forward) const;
+
+	/**
+	 * This operation runs a V-cycle from a level, solving the matrix of the
+	 * level with its right hand side approximately, starting from zero.
+	 */
+	void cycle(const int & level) const;
+
+public:
+
+	/**
+	 * Constructor
+	 * @param coarse the coarsest mesh
+	 * @param numRefinements the number of times that the coarse mesh is
+	 * refined, so there are numRefinements + 1 levels
+	 * @param fixedMarkers the markers of the boundary edges with Dirichlet
+	 * conditions. At least one node must be fixed or the matrices are
+	 * singular.
+	 * @param kappa the transfer coefficient of all elements
+	 * @param smoother the smoother
+	 * @param smoothingSteps the number of smoothing steps before and after
+	 * each coarse grid correction
+	 * @param threadPool the threads used by the smoothers and transfers
+	 * @throw std::runtime_error if the number of refinements is negative,
+	 * there are no smoothing steps or the coarse matrix is singular
+	 */
+	GeometricMultigrid(const TwoDMesh & coarse, const int & numRefinements,
+			const std::vector<int> & fixedMarkers, const double & kappa = 1.0,
+			const MultigridSmoother & smoother = MultigridSmoother::JACOBI,
+			const int & smoothingSteps = 2,
+			ThreadPool & threadPool = ThreadPool::shared());
+
+	/**
+	 * This operation reassembles the matrices of all levels for a transfer
+	 * coefficient that is constant over each element of the finest mesh.
+	 * The coefficient of a coarse element is the average of its four
+	 * children.
+	 * @param kappa the transfer coefficient of each element of the finest
+	 * mesh
+	 * @throw std::runtime_error if there is not one coefficient per element
+	 */
+	void coefficient(const std::vector<double> & kappa);
+
+	/**
+	 * This operation replaces the matrix of the finest level, which must
+	 * have the sparsity pattern of matrix() and the fixed nodes eliminated.
+	 * The coarse levels are not changed, so the preconditioner remains
+	 * effective as long as the new matrix is close to the one that they
+	 * were built for. Use coefficient() to rebuild all of the levels.
+	 * See IPreconditioner::update().
+	 */
+	virtual void update(const CSRMatrix<double> & matrix);
+
+	/**
+	 * This operation applies one V-cycle to a residual of the finest level.
+	 * See IPreconditioner::apply().
+	 */
+	virtual void apply(const std::vector<double> & r,
+			std::vector<double> & z) const;
+
+	/**
+	 * This operation solves the finest system by repeated V-cycles.
+	 * @param b the right hand side, which is lifted with conditions()
+	 * @param x the solution. Its value on entry is the initial guess if it
+	 * has the right size and it is set to zero otherwise.
+	 * @param tol the relative tolerance on the 2-norm of the residual
+	 * @param maxCycles the maximum number of V-cycles
+	 * @return the number of cycles, residual and convergence history
+	 */
+	PCGResult solve(const std::vector<double> & b, std::vector<double> & x,
+			const double & tol = 1.0e-8, const int & maxCycles = 100) const;
+
+	/**
+	 * This operation returns the number of levels.
+	 * @return the number of levels
+	 */
+	int numLevels() const { return meshes.size();};
+
+	/**
+	 * This operation returns the mesh of a level, where level 0 is the
+	 * coarsest.
+	 * @param level the level
+	 * @return the mesh
+	 */
+	const TwoDMesh & mesh(const int & level) const { return meshes[level];};
+
+	/**
+	 * This operation returns the finest mesh.
+	 * @return the mesh
+	 */
+	const TwoDMesh & fineMesh() const { return meshes.back();};
+
+	/**
+	 * This operation returns the stiffness matrix of a level with the fixed
+	 * nodes eliminated.
+	 * @param level the level
+	 * @return the matrix
+	 */
+	const CSRMatrix<double> & matrix(const int & level) const {
+		return matrices[level];
+	};
+
+	/**
+	 * This operation returns the stiffness matrix of the finest level with
+	 * the fixed nodes eliminated.
+	 * @return the matrix
+	 */
+	const CSRMatrix<double> & matrix() const { return matrices.back();};
+
+	/**
+	 * This operation returns the Dirichlet conditions of the finest level,
+	 * which have been applied to matrix(). The values of the fixed nodes can
+	 * be changed and used to lift right hand sides, but no other nodes may
+	 * be fixed.
+	 * @return the conditions
+	 */
+	DirichletLifting & conditions() { return levelConditions.back();};
+
+	/**
+	 * This operation interpolates a vector from a level to the next finer
+	 * level.
+	 * @param level the coarse level, which must be less than numLevels() - 1
+	 * @param coarse the values on the coarse level
+	 * @param fine the values on the fine level, which are resized
+	 */
+	void prolong(const int & level, const std::vector<double> & coarse,
+			std::vector<double> & fine) const;
+
+	/**
+	 * This operation restricts a vector from a level to the next coarser
+	 * level with the transpose of the prolongation.
+	 * @param level the fine level, which must be greater than 0
+	 * @param fine the values on the fine level
+	 * @param coarse the values on the coarse level, which are resized
+	 */
+	void restrict(const int & level, const std::vector<double> & fine,
+			std::vector<double> & coarse) const;
+
+};
+
+} /* namespace fire */
+
+#endif /* FEM_GEOMETRICMULTIGRID_H_ */
@@ -52,6 +52,8 @@ LaplaceCSTElement::LaplaceCSTElement(const TwoDNode & node1,
 		double result = (kFunction(coords,i,j)/(4.0*eArea*eArea))*(b[i]*b[j]+c[i]*c[j]);
 	    return result;
 	};
+	// The default coefficient is constant
+	constantStiffnessKernel = true;
 	// f = 0 for Laplace's equation
 	bodyForceKernel = [&](const std::array<double,3> & coords, const int & i) {
 	    return 0.0;
@@ -62,6 +64,19 @@ LaplaceCSTElement::LaplaceCSTElement(const TwoDNode & node1,
 void LaplaceCSTElement::transferCoefficient(const std::function<double(const std::array<double,3> &,
 		const int &, const int &)> & function) {
 	kFunction = function;
+	constantStiffnessKernel = false;
+}
+
+void LaplaceCSTElement::transferCoefficient(const double & k) {
+	kFunction = [k](const std::array<double,3> &, const int &,
+			const int &) {
+		return k;
+	};
+	constantStiffnessKernel = true;
+}
+
+bool LaplaceCSTElement::constantTransferCoefficient() const {
+	return constantStiffnessKernel;
 }
 
 const std::function<double(const std::array<double,3> &,
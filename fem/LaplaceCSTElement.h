@@ -55,6 +55,11 @@ namespace fire {
  * \f[
  * k_{ij} = \frac{\kappa}{4A} (b_{i}b_{j} + c_{i}c_{j})
  * \f]
+ * The transfer coefficient is constant (1.0) by default and when it is set
+ * with transferCoefficient(const double &), in which case this closed form is
+ * used. The quadrature rule is only used when a spatially varying function is
+ * provided. (See CSTBatchStiffness for computing the matrices of many
+ * elements at once.)
  */
 class LaplaceCSTElement: public ConstantStrainTriangleElement {
 protected:
@@ -88,6 +93,21 @@ public:
 	void transferCoefficient(const std::function<double(const std::array<double,3> &,
 			const int &, const int &)> & function);
 
+	/**
+	 * This operation sets a constant transfer coefficient, which allows the
+	 * stiffness matrix to be computed in closed form.
+	 * @param k the transfer coefficient
+	 */
+	void transferCoefficient(const double & k);
+
+	/**
+	 * This operation indicates whether or not the transfer coefficient is
+	 * constant.
+	 * @return true if the coefficient was set as a constant, false if it is a
+	 * function
+	 */
+	bool constantTransferCoefficient() const;
+
 	/**
 	 * This operations returns a reference to the function that is used for
 	 * computing the transfer coefficient.
@@ -0,0 +1,146 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+
+// See the header file for API documentation
+
+#include <MeshDeformation.h>
+#include <ElementColoring.h>
+#include <algorithm>
+#include <stdexcept>
+#include <math.h>
+
+using namespace std;
+
+namespace fire {
+
+MeshDeformation::MeshDeformation(TwoDMesh & deformingMesh) :
+		mesh(deformingMesh), index(deformingMesh),
+		edgeLengths(index.numEdges()),
+		orientations(deformingMesh.numElements()),
+		invertedFlags(deformingMesh.numElements(), 0),
+		movedFlags(deformingMesh.numNodes(), 0),
+		elementStamps(deformingMesh.numElements(), -1),
+		edgeStamps(index.numEdges(), -1) {
+	int numNodes = mesh.numNodes();
+	nodeToElements(mesh.connectivity(), 3, numNodes, elementOffsets,
+			nodeElements);
+	nodeToElements(index.nodes(), 2, numNodes, edgeOffsets, nodeEdges);
+
+	auto & areas = mesh.areas();
+	for (long e = 0; e < mesh.numElements(); e++) {
+		orientations[e] = (areas[e] < 0.0) ? -1 : 1;
+	}
+	vector<long> all(index.numEdges());
+	for (long k = 0; k < index.numEdges(); k++) all[k] = k;
+	computeLengths(all);
+}
+
+void MeshDeformation::computeLengths(const vector<long> & edges) {
+	auto & x = mesh.x();
+	auto & y = mesh.y();
+	auto & nodes = index.nodes();
+	long n = edges.size();
+	const int blockSize = 256;
+	double dx[blockSize], dy[blockSize], length[blockSize];
+	for (long begin = 0; begin < n; begin += blockSize) {
+		int size = min((long) blockSize, n - begin);
+		const long * block = &edges[begin];
+		for (int k = 0; k < size; k++) {
+			const int * ids = &nodes[2*block[k]];
+			dx[k] = x[ids[1]] - x[ids[0]];
+			dy[k] = y[ids[1]] - y[ids[0]];
+		}
+		for (int k = 0; k < size; k++) {
+			length[k] = sqrt(dx[k]*dx[k] + dy[k]*dy[k]);
+		}
+		for (int k = 0; k < size; k++) edgeLengths[block[k]] = length[k];
+	}
+}
+
+void MeshDeformation::checkInversion(const vector<long> & elements) {
+	auto & areas = mesh.areas();
+	for (long e : elements) {
+		char inverted = (orientations[e]*areas[e] <= 0.0);
+		invertedCount += inverted - invertedFlags[e];
+		invertedFlags[e] = inverted;
+	}
+}
+
+void MeshDeformation::moveNode(const int & node, const double & x,
+		const double & y) {
+	markNode(node);
+	mesh.x()[node] = x;
+	mesh.y()[node] = y;
+}
+
+void MeshDeformation::markNode(const int & node) {
+	if (node < 0 || node >= mesh.numNodes()) {
+		throw out_of_range("Node is not in the mesh.");
+	}
+	if (!movedFlags[node]) {
+		movedFlags[node] = 1;
+		movedNodes.push_back(node);
+	}
+}
+
+long MeshDeformation::update() {
+	// Gather the elements and edges of the moved nodes once each
+	stamp++;
+	elementsUpdated.clear();
+	edgesUpdated.clear();
+	for (int node : movedNodes) {
+		for (long k = elementOffsets[node]; k < elementOffsets[node+1]; k++) {
+			long e = nodeElements[k];
+			if (elementStamps[e] != stamp) {
+				elementStamps[e] = stamp;
+				elementsUpdated.push_back(e);
+			}
+		}
+		for (long k = edgeOffsets[node]; k < edgeOffsets[node+1]; k++) {
+			long edge = nodeEdges[k];
+			if (edgeStamps[edge] != stamp) {
+				edgeStamps[edge] = stamp;
+				edgesUpdated.push_back(edge);
+			}
+		}
+		movedFlags[node] = 0;
+	}
+	movedNodes.clear();
+
+	mesh.computeGeometry(elementsUpdated);
+	computeLengths(edgesUpdated);
+	checkInversion(elementsUpdated);
+
+	return elementsUpdated.size();
+}
+
+} /* namespace fire */
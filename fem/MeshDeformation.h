@@ -0,0 +1,227 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#ifndef FEM_MESHDEFORMATION_H_
+#define FEM_MESHDEFORMATION_H_
+
+#include <vector>
+#include <TwoDMesh.h>
+#include <EdgeIndex.h>
+
+namespace fire {
+
+/**
+ * This class keeps the geometry of a deforming TwoDMesh up to date in
+ * proportion to the part of the mesh that moves. Nodes are moved with
+ * moveNode(), or marked with markNode() if their coordinates were changed
+ * directly, and update() then recomputes the b and c constants and areas of
+ * only the elements around the moved nodes (with
+ * TwoDMesh::computeGeometry(const std::vector<long> &)) and the lengths of
+ * only the edges that touch them.
+ *
+ * Elements whose area changes sign or vanishes are inverted and flagged. The
+ * orientation of each element is taken from its area when the deformation
+ * is created, so both clockwise and counter-clockwise elements are handled.
+ *
+ * @code
+ * TwoDMesh mesh = TwoDMesh::rectangle(500,500);
+ * MeshDeformation deformation(mesh);
+ * for (int step = 0; step < numSteps; step++) {
+ *     for (int node : shrinkingNodes) deformation.moveNode(node, x, y);
+ *     deformation.update();
+ *     if (deformation.numInverted() > 0) ... remesh ...
+ *     for (long e : deformation.updatedElements()) assembler.markDirty(e);
+ * }
+ * @endcode
+ *
+ * The mesh must outlive the deformation and its connectivity must not
+ * change.
+ */
+class MeshDeformation {
+
+protected:
+
+	/**
+	 * The mesh.
+	 */
+	TwoDMesh & mesh;
+
+	/**
+	 * The edges of the mesh.
+	 */
+	EdgeIndex index;
+
+	/**
+	 * The elements of each node in compressed rows.
+	 */
+	std::vector<long> elementOffsets, nodeElements;
+
+	/**
+	 * The edges of each node in compressed rows.
+	 */
+	std::vector<long> edgeOffsets, nodeEdges;
+
+	/**
+	 * The lengths of the edges.
+	 */
+	std::vector<double> edgeLengths;
+
+	/**
+	 * The orientation of each element, +1 for counter-clockwise and -1 for
+	 * clockwise, when the deformation was created.
+	 */
+	std::vector<signed char> orientations;
+
+	/**
+	 * True for inverted elements.
+	 */
+	std::vector<char> invertedFlags;
+
+	/**
+	 * The number of inverted elements.
+	 */
+	long invertedCount = 0;
+
+	/**
+	 * The nodes that moved since the last update and their flags.
+	 */
+	std::vector<int> movedNodes;
+	std::vector<char> movedFlags;
+
+	/**
+	 * The elements and edges of the last update.
+	 */
+	std::vector<long> elementsUpdated, edgesUpdated;
+
+	/**
+	 * The update in which each element and edge was last gathered, which
+	 * avoids gathering them twice.
+	 */
+	std::vector<long> elementStamps, edgeStamps;
+	long stamp = 0;
+
+	/**
+	 * This operation computes the lengths of some edges.
+	 * @param edges the edges
+	 */
+	void computeLengths(const std::vector<long> & edges);
+
+	/**
+	 * This operation updates the inverted flags of some elements.
+	 * @param elements the elements
+	 */
+	void checkInversion(const std::vector<long> & elements);
+
+public:
+
+	/**
+	 * Constructor
+	 * @param deformingMesh the mesh, which must outlive this object
+	 */
+	MeshDeformation(TwoDMesh & deformingMesh);
+
+	/**
+	 * This operation moves a node. The geometry is updated by update().
+	 * @param node the id of the node
+	 * @param x the new x coordinate
+	 * @param y the new y coordinate
+	 * @throw std::out_of_range if the node is not in the mesh
+	 */
+	void moveNode(const int & node, const double & x, const double & y);
+
+	/**
+	 * This operation marks a node whose coordinates were changed directly in
+	 * the mesh.
+	 * @param node the id of the node
+	 * @throw std::out_of_range if the node is not in the mesh
+	 */
+	void markNode(const int & node);
+
+	/**
+	 * This operation recomputes the geometry of the elements and edges around
+	 * the nodes that moved since the last update.
+	 * @return the number of elements that were updated
+	 */
+	long update();
+
+	/**
+	 * This operation returns the number of nodes that moved since the last
+	 * update.
+	 * @return the number of nodes
+	 */
+	long numMoved() const { return movedNodes.size();};
+
+	/**
+	 * This operation returns the elements that were updated by the last call
+	 * to update().
+	 * @return the elements
+	 */
+	const std::vector<long> & updatedElements() const {
+		return elementsUpdated;
+	};
+
+	/**
+	 * This operation returns the edges that were updated by the last call to
+	 * update().
+	 * @return the ids of the edges in edges()
+	 */
+	const std::vector<long> & updatedEdges() const { return edgesUpdated;};
+
+	/**
+	 * This operation returns the lengths of all of the edges.
+	 * @return the lengths, indexed by the ids of the edges in edges()
+	 */
+	const std::vector<double> & lengths() const { return edgeLengths;};
+
+	/**
+	 * This operation returns true if an element is inverted.
+	 * @param e the element
+	 * @return true if the area of the element changed sign or vanished
+	 */
+	bool isInverted(const long & e) const { return invertedFlags[e];};
+
+	/**
+	 * This operation returns the number of inverted elements.
+	 * @return the number of elements
+	 */
+	long numInverted() const { return invertedCount;};
+
+	/**
+	 * This operation returns the edges of the mesh.
+	 * @return the edge index
+	 */
+	const EdgeIndex & edges() const { return index;};
+
+};
+
+} /* namespace fire */
+
+#endif /* FEM_MESHDEFORMATION_H_ */
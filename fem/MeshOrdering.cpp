@@ -0,0 +1,212 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+
+// See the header file for API documentation
+
+#include <MeshOrdering.h>
+#include <GraphOrdering.h>
+#include <array>
+#include <limits>
+#include <cstdint>
+#include <algorithm>
+
+using namespace std;
+
+namespace fire {
+
+/**
+ * This operation computes the node graph of a mesh, in which two nodes are
+ * neighbors if they share an element, and its Reverse Cuthill-McKee order.
+ */
+static vector<int> nodeGraphOrder(const vector<int> & connectivity,
+		const int & nodesPerElement, const int & numNodes) {
+	// Count the element nodes attached to each node, an upper bound on the
+	// number of neighbors
+	vector<long> offsets(numNodes + 1, 0);
+	for (int id : connectivity) offsets[id + 1] += nodesPerElement - 1;
+	for (int i = 0; i < numNodes; i++) offsets[i+1] += offsets[i];
+	vector<int> neighbors(offsets[numNodes]);
+	vector<long> next(offsets.begin(), offsets.end() - 1);
+	for (long k = 0; k < (long) connectivity.size(); k += nodesPerElement) {
+		for (int a = 0; a < nodesPerElement; a++) {
+			for (int b = 0; b < nodesPerElement; b++) {
+				if (a != b) {
+					neighbors[next[connectivity[k+a]]++] = connectivity[k+b];
+				}
+			}
+		}
+	}
+	// Remove the duplicates and compact the lists
+	long count = 0;
+	for (int i = 0; i < numNodes; i++) {
+		auto begin = neighbors.begin() + offsets[i],
+				end = neighbors.begin() + offsets[i+1];
+		sort(begin, end);
+		end = unique(begin, end);
+		long first = count;
+		for (auto it = begin; it != end; it++) neighbors[count++] = *it;
+		offsets[i] = first;
+	}
+	offsets[numNodes] = count;
+	neighbors.resize(count);
+	return reverseCuthillMcKee(offsets, neighbors);
+}
+
+/**
+ * This operation computes the distance of a point along a Hilbert curve
+ * that fills the cube of side 2^bits in D dimensions, with John Skilling's
+ * transpose algorithm ("Programming the Hilbert curve", AIP Conference
+ * Proceedings 707, 2004).
+ */
+template<int D>
+static uint64_t hilbertIndex(array<uint32_t,D> X, const int & bits) {
+	uint32_t M = 1u << (bits - 1);
+	// Undo the excess work
+	for (uint32_t Q = M; Q > 1; Q >>= 1) {
+		uint32_t P = Q - 1;
+		for (int i = 0; i < D; i++) {
+			if (X[i] & Q) {
+				X[0] ^= P;
+			} else {
+				uint32_t t = (X[0] ^ X[i]) & P;
+				X[0] ^= t;
+				X[i] ^= t;
+			}
+		}
+	}
+	// Gray encode
+	for (int i = 1; i < D; i++) X[i] ^= X[i-1];
+	uint32_t t = 0;
+	for (uint32_t Q = M; Q > 1; Q >>= 1) {
+		if (X[D-1] & Q) t ^= Q - 1;
+	}
+	for (int i = 0; i < D; i++) X[i] ^= t;
+	// Interleave the bits of the transposed index
+	uint64_t index = 0;
+	for (int bit = bits - 1; bit >= 0; bit--) {
+		for (int i = 0; i < D; i++) index = (index << 1) | ((X[i] >> bit) & 1);
+	}
+	return index;
+}
+
+/**
+ * This operation sorts points along a Hilbert curve through their bounding
+ * box.
+ */
+template<int D>
+static vector<long> hilbertOrder(const vector<array<double,D>> & points) {
+	// 31 bits per coordinate in 2D and 21 in 3D fit in 64 bits
+	const int bits = (D == 2) ? 31 : 21;
+	long n = points.size();
+	array<double,D> lower, upper;
+	lower.fill(numeric_limits<double>::max());
+	upper.fill(-numeric_limits<double>::max());
+	for (auto & point : points) {
+		for (int d = 0; d < D; d++) {
+			lower[d] = min(lower[d], point[d]);
+			upper[d] = max(upper[d], point[d]);
+		}
+	}
+	// Use the same scale in every direction so the curve is not stretched
+	double extent = 0.0;
+	for (int d = 0; d < D; d++) extent = max(extent, upper[d] - lower[d]);
+	double scale = (extent > 0.0) ? ((1u << bits) - 1)/extent : 0.0;
+	vector<pair<uint64_t,long>> keys(n);
+	for (long k = 0; k < n; k++) {
+		array<uint32_t,D> X;
+		for (int d = 0; d < D; d++) {
+			X[d] = (uint32_t) ((points[k][d] - lower[d])*scale);
+		}
+		keys[k] = make_pair(hilbertIndex<D>(X, bits), k);
+	}
+	sort(keys.begin(), keys.end());
+	vector<long> order(n);
+	for (long k = 0; k < n; k++) order[k] = keys[k].second;
+	return order;
+}
+
+vector<int> reverseCuthillMcKee(const TwoDMesh & mesh) {
+	return nodeGraphOrder(mesh.connectivity(), 3, mesh.numNodes());
+}
+
+vector<int> reverseCuthillMcKee(const ThreeDMesh & mesh) {
+	return nodeGraphOrder(mesh.connectivity(), mesh.nodesPerElement(),
+			mesh.numNodes());
+}
+
+vector<int> hilbertNodeOrder(const TwoDMesh & mesh) {
+	vector<array<double,2>> points(mesh.numNodes());
+	for (int i = 0; i < mesh.numNodes(); i++) {
+		points[i] = {{mesh.x()[i], mesh.y()[i]}};
+	}
+	vector<long> order = hilbertOrder<2>(points);
+	return vector<int>(order.begin(), order.end());
+}
+
+vector<int> hilbertNodeOrder(const ThreeDMesh & mesh) {
+	vector<array<double,3>> points(mesh.numNodes());
+	for (int i = 0; i < mesh.numNodes(); i++) {
+		points[i] = {{mesh.x()[i], mesh.y()[i], mesh.z()[i]}};
+	}
+	vector<long> order = hilbertOrder<3>(points);
+	return vector<int>(order.begin(), order.end());
+}
+
+vector<long> hilbertElementOrder(const TwoDMesh & mesh) {
+	auto & ids = mesh.connectivity();
+	vector<array<double,2>> centroids(mesh.numElements());
+	for (long e = 0; e < mesh.numElements(); e++) {
+		const int * nodes = &ids[3*e];
+		for (int a = 0; a < 3; a++) {
+			centroids[e][0] += mesh.x()[nodes[a]]/3.0;
+			centroids[e][1] += mesh.y()[nodes[a]]/3.0;
+		}
+	}
+	return hilbertOrder<2>(centroids);
+}
+
+vector<long> hilbertElementOrder(const ThreeDMesh & mesh) {
+	auto & ids = mesh.connectivity();
+	int n = mesh.nodesPerElement();
+	vector<array<double,3>> centroids(mesh.numElements());
+	for (long e = 0; e < mesh.numElements(); e++) {
+		const int * nodes = &ids[n*e];
+		for (int a = 0; a < 4; a++) {
+			centroids[e][0] += 0.25*mesh.x()[nodes[a]];
+			centroids[e][1] += 0.25*mesh.y()[nodes[a]];
+			centroids[e][2] += 0.25*mesh.z()[nodes[a]];
+		}
+	}
+	return hilbertOrder<3>(centroids);
+}
+
+} /* namespace fire */
@@ -0,0 +1,111 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#ifndef FEM_MESHORDERING_H_
+#define FEM_MESHORDERING_H_
+
+#include <vector>
+#include <TwoDMesh.h>
+#include <ThreeDMesh.h>
+
+namespace fire {
+
+/**
+ * The operations in this file compute new orders for the nodes and elements
+ * of meshes, which can be applied with renumberNodes() and
+ * reorderElements(). Mesh generators number nodes in arbitrary orders, so
+ * the matrices assembled on their meshes have large bandwidths and the
+ * entries of x read by each row of y = Ax are scattered through memory.
+ *
+ * Reverse Cuthill-McKee orders minimize the bandwidth and profile of the
+ * assembled matrices, which is what the BandedSolver and SkylineCholesky
+ * need. Hilbert curve orders sort nodes or elements along a space-filling
+ * curve through the bounding box of the mesh, so things that are close in
+ * space are close in memory, which improves the cache behavior of assembly
+ * and matrix-vector products. A typical sequence is
+ * @code
+ * mesh.renumberNodes(reverseCuthillMcKee(mesh));
+ * mesh.reorderElements(hilbertElementOrder(mesh));
+ * @endcode
+ * All orders list the original index of the item in each new position.
+ */
+
+/**
+ * This operation computes the Reverse Cuthill-McKee order of the nodes of a
+ * triangular mesh, where two nodes are neighbors if they share an element.
+ * @param mesh the mesh
+ * @return the order, where order[k] is the original id of new node k
+ */
+std::vector<int> reverseCuthillMcKee(const TwoDMesh & mesh);
+
+/**
+ * This operation computes the Reverse Cuthill-McKee order of the nodes of a
+ * tetrahedral mesh, where two nodes are neighbors if they share an element.
+ * @param mesh the mesh
+ * @return the order, where order[k] is the original id of new node k
+ */
+std::vector<int> reverseCuthillMcKee(const ThreeDMesh & mesh);
+
+/**
+ * This operation sorts the nodes of a triangular mesh along a Hilbert
+ * curve.
+ * @param mesh the mesh
+ * @return the order, where order[k] is the original id of new node k
+ */
+std::vector<int> hilbertNodeOrder(const TwoDMesh & mesh);
+
+/**
+ * This operation sorts the nodes of a tetrahedral mesh along a Hilbert
+ * curve.
+ * @param mesh the mesh
+ * @return the order, where order[k] is the original id of new node k
+ */
+std::vector<int> hilbertNodeOrder(const ThreeDMesh & mesh);
+
+/**
+ * This operation sorts the elements of a triangular mesh along a Hilbert
+ * curve through their centroids.
+ * @param mesh the mesh
+ * @return the order, where order[k] is the original index of new element k
+ */
+std::vector<long> hilbertElementOrder(const TwoDMesh & mesh);
+
+/**
+ * This operation sorts the elements of a tetrahedral mesh along a Hilbert
+ * curve through the centroids of their corners.
+ * @param mesh the mesh
+ * @return the order, where order[k] is the original index of new element k
+ */
+std::vector<long> hilbertElementOrder(const ThreeDMesh & mesh);
+
+} /* namespace fire */
+
+#endif /* FEM_MESHORDERING_H_ */
@@ -0,0 +1,271 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+
+// See the header file for API documentation
+
+#include <NonlinearConduction.h>
+#include <CSTBatchStiffness.h>
+#include <ElementColoring.h>
+#include <GraphOrdering.h>
+#include <PCGSolver.h>
+#include <stdexcept>
+#include <utility>
+#include <math.h>
+
+using namespace std;
+
+namespace fire {
+
+NonlinearConduction::NonlinearConduction(const TwoDMesh & mesh,
+		const function<double(const double &)> & conductivityFunction,
+		const double & heatSource, ThreadPool & threadPool) :
+		numNodes(mesh.numNodes()), connectivity(mesh.connectivity()),
+		elementColors(colorElements(mesh.connectivity(), 3, mesh.numNodes())),
+		kappa(conductivityFunction), conductivity(mesh.numElements(), 0.0),
+		source(numNodes, 0.0), temperatures(numNodes, 0.0),
+		fixed(numNodes, false), residualVector(numNodes),
+		correction(numNodes), pool(threadPool) {
+
+	// Every pair of nodes in an element couples
+	long numElements = mesh.numElements();
+	vector<pair<int,int>> entries;
+	entries.reserve(9*numElements);
+	for (long e = 0; e < numElements; e++) {
+		for (int i = 0; i < 3; i++) {
+			for (int j = 0; j < 3; j++) {
+				entries.push_back(make_pair(connectivity[3*e+i],
+						connectivity[3*e+j]));
+			}
+		}
+	}
+	matrix = CSRMatrix<double>(numNodes, entries);
+	elementSlots.resize(9*numElements);
+	for (long k = 0; k < (long) entries.size(); k++) {
+		elementSlots[k] = matrix.slot(entries[k].first, entries[k].second);
+	}
+
+	// The geometry does not change, so the unit matrices are computed once
+	CSTBatchStiffness batch(mesh, pool);
+	batch.compute(1.0);
+	unitStiffness.resize(9*numElements);
+	auto & areas = batch.areas();
+	for (long e = 0; e < numElements; e++) {
+		batch.elementMatrix(e, &unitStiffness[9*e]);
+		for (int i = 0; i < 3; i++) {
+			source[connectivity[3*e+i]] += heatSource*fabs(areas[e])/3.0;
+		}
+	}
+}
+
+void NonlinearConduction::conductivityDerivative(
+		const function<double(const double &)> & derivative) {
+	kappaDerivative = derivative;
+}
+
+void NonlinearConduction::invalidate() {
+	preconditioner.reset();
+	factored = false;
+}
+
+void NonlinearConduction::fixTemperature(const int & node,
+		const double & value) {
+	if (node < 0 || node >= numNodes) {
+		throw out_of_range("Node is not in the mesh.");
+	}
+	if (!fixed[node]) {
+		fixed[node] = true;
+		fixedChanged = true;
+		invalidate();
+	}
+	temperatures[node] = value;
+}
+
+void NonlinearConduction::fixBoundaryTemperature(const TwoDMesh & mesh,
+		const int & marker, const double & value) {
+	auto & edges = mesh.boundaryEdges();
+	auto & markers = mesh.boundaryMarkers();
+	for (long k = 0; k < (long) markers.size(); k++) {
+		if (markers[k] == marker) {
+			fixTemperature(edges[2*k], value);
+			fixTemperature(edges[2*k+1], value);
+		}
+	}
+}
+
+void NonlinearConduction::temperature(const double & value) {
+	for (int i = 0; i < numNodes; i++) {
+		if (!fixed[i]) temperatures[i] = value;
+	}
+}
+
+double NonlinearConduction::assemble(const bool & jacobian) {
+	if (fixedChanged) {
+		eliminatedSlots.assign(matrix.nonZeros(), 0);
+		for (int i = 0; i < numNodes; i++) {
+			for (long k = matrix.rowOffsets[i]; k < matrix.rowOffsets[i+1];
+					k++) {
+				int j = matrix.columns[k];
+				eliminatedSlots[k] = (i != j && (fixed[i] || fixed[j]));
+			}
+		}
+		fixedChanged = false;
+	}
+
+	// The elements of a color share no nodes, so they are added in parallel
+	matrix.zero();
+	for (int i = 0; i < numNodes; i++) residualVector[i] = -source[i];
+	for (auto & elements : elementColors) {
+		pool.parallelFor(0, elements.size(),
+				[&](const long & begin, const long & end) {
+			for (long m = begin; m < end; m++) {
+				long e = elements[m];
+				const int * ids = &connectivity[3*e];
+				const double * s = &unitStiffness[9*e];
+				const long * slots = &elementSlots[9*e];
+				double t[3] = {temperatures[ids[0]], temperatures[ids[1]],
+						temperatures[ids[2]]};
+				double average = (t[0] + t[1] + t[2])/3.0;
+				double k = kappa(average);
+				double dk = jacobian ? kappaDerivative(average)/3.0 : 0.0;
+				conductivity[e] = k;
+				for (int i = 0; i < 3; i++) {
+					double st = s[3*i]*t[0] + s[3*i+1]*t[1] + s[3*i+2]*t[2];
+					residualVector[ids[i]] += k*st;
+					for (int j = 0; j < 3; j++) {
+						matrix.values[slots[3*i+j]] += k*s[3*i+j] + dk*st;
+					}
+				}
+			}
+		});
+	}
+
+	// Eliminate the fixed nodes, which have no residual
+	pool.parallelFor(0, matrix.nonZeros(),
+			[&](const long & begin, const long & end) {
+		for (long k = begin; k < end; k++) {
+			if (eliminatedSlots[k]) matrix.values[k] = 0.0;
+		}
+	});
+	double norm = 0.0;
+	for (int i = 0; i < numNodes; i++) {
+		if (fixed[i]) residualVector[i] = 0.0;
+		norm += residualVector[i]*residualVector[i];
+	}
+	return sqrt(norm);
+}
+
+void NonlinearConduction::residual(vector<double> & r) {
+	assemble(false);
+	r = residualVector;
+}
+
+NonlinearResult NonlinearConduction::solve() {
+	bool newton = (iteration == NonlinearMethod::NEWTON);
+	if (newton && !kappaDerivative) {
+		throw runtime_error("Newton iterations require the derivative of the "
+				"conductivity.");
+	}
+	if (newton && !BandedSolver::lapackAvailable()) {
+		throw runtime_error("Newton iterations require LAPACK. Use Picard "
+				"iterations instead.");
+	}
+
+	NonlinearResult result;
+	vector<double> rhs(numNodes);
+	PCGSolver solver(pool);
+	solver.tolerance(pcgTolerance);
+	double norm = assemble(newton);
+	double target = relativeTolerance*norm;
+	result.history.push_back(norm);
+	while (norm > target && result.iterations < maxNumIterations) {
+		for (int i = 0; i < numNodes; i++) rhs[i] = -residualVector[i];
+		if (!newton) {
+			// Rebuild the preconditioner only if the conductivity moved
+			bool rebuild = !preconditioner;
+			for (long e = 0; !rebuild && e < (long) conductivity.size(); e++) {
+				double reference = preconditionedConductivity[e];
+				rebuild = fabs(conductivity[e] - reference) >
+						rebuildChange*fabs(reference);
+			}
+			if (rebuild) {
+				if (preconditioner) preconditioner->update(matrix);
+				else preconditioner.reset(
+						new IncompleteCholeskyPreconditioner(matrix));
+				preconditionedConductivity = conductivity;
+				result.rebuilds++;
+			}
+			std::fill(correction.begin(), correction.end(), 0.0);
+			auto linear = solver.solve(matrix, rhs, correction, *preconditioner);
+			result.linearIterations += linear.iterations;
+		} else {
+			// Refactor only if the last step with these factors was slow,
+			// which may have been taken by the last solve
+			if (!factored || lastReduction > refactorReduction) {
+				if (order.empty()) {
+					order = reverseCuthillMcKee(matrix);
+					ordered = permute(matrix, order);
+					vector<int> newIndex = inversePermutation(order);
+					orderedSlots.resize(matrix.nonZeros());
+					for (int i = 0; i < numNodes; i++) {
+						for (long k = matrix.rowOffsets[i];
+								k < matrix.rowOffsets[i+1]; k++) {
+							orderedSlots[k] = ordered.slot(newIndex[i],
+									newIndex[matrix.columns[k]]);
+						}
+					}
+				}
+				for (long k = 0; k < matrix.nonZeros(); k++) {
+					ordered.values[orderedSlots[k]] = matrix.values[k];
+				}
+				factors.factor(ordered, BandedFactorization::LU);
+				factored = true;
+				result.rebuilds++;
+			}
+			vector<double> orderedCorrection;
+			factors.solve(permute(rhs, order), orderedCorrection);
+			correction = unpermute(orderedCorrection, order);
+		}
+		for (int i = 0; i < numNodes; i++) {
+			if (!fixed[i]) temperatures[i] += correction[i];
+		}
+		result.iterations++;
+		double lastNorm = norm;
+		norm = assemble(newton);
+		if (newton) lastReduction = norm/lastNorm;
+		result.history.push_back(norm);
+	}
+	result.residualNorm = norm;
+	result.converged = (norm <= target);
+	return result;
+}
+
+} /* namespace fire */
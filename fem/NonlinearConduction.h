@@ -0,0 +1,424 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#ifndef FEM_NONLINEARCONDUCTION_H_
+#define FEM_NONLINEARCONDUCTION_H_
+
+#include <vector>
+#include <memory>
+#include <functional>
+#include <TwoDMesh.h>
+#include <CSRMatrix.h>
+#include <Preconditioner.h>
+#include <BandedSolver.h>
+#include <ThreadPool.h>
+
+namespace fire {
+
+/**
+ * This enumeration describes the iterations used by NonlinearConduction.
+ * PICARD lags the conductivity, so each iteration solves a symmetric system
+ * with the conductivity of the last temperatures. NEWTON also includes the
+ * derivative of the conductivity with respect to the temperature, which
+ * converges quadratically but gives a nonsymmetric Jacobian.
+ */
+enum class NonlinearMethod {PICARD, NEWTON};
+
+/**
+ * This structure describes the outcome of a NonlinearConduction solve.
+ */
+struct NonlinearResult {
+
+	/**
+	 * True if the residual met the tolerance.
+	 */
+	bool converged = false;
+
+	/**
+	 * The number of nonlinear iterations that were taken.
+	 */
+	int iterations = 0;
+
+	/**
+	 * The total number of PCG iterations of the Picard iterations.
+	 */
+	int linearIterations = 0;
+
+	/**
+	 * The number of times that the preconditioner (Picard) or factorization
+	 * (Newton) was rebuilt.
+	 */
+	int rebuilds = 0;
+
+	/**
+	 * The 2-norm of the final residual of the free nodes.
+	 */
+	double residualNorm = 0.0;
+
+	/**
+	 * The 2-norm of the residual before the first iteration and after each
+	 * iteration, so it has iterations + 1 entries.
+	 */
+	std::vector<double> history;
+};
+
+/**
+ * This class solves steady heat conduction with a temperature dependent
+ * conductivity,
+ * \f[
+ * -\nabla \cdot (\kappa(T) \nabla T) = q
+ * \f]
+ * on a TwoDMesh of Constant Strain Triangles. The conductivity of each
+ * element is evaluated at the average temperature of its nodes, so the
+ * stiffness matrix of element e is \f$ \kappa(\bar{T}_{e}) S_{e} \f$, where
+ * \f$ S_{e} \f$ is the matrix for unit conductivity. S is computed once with
+ * CSTBatchStiffness when the problem is created, so each iteration only
+ * evaluates the conductivity and scales and assembles the stored matrices.
+ * The elements are colored (see colorElements()) and assembled in parallel.
+ *
+ * Each iteration solves for a correction to the temperatures from the
+ * residual
+ * \f[
+ * \vec{R}(\vec{T}) = K(\vec{T})\vec{T} - \vec{f}
+ * \f]
+ * of the free nodes. Picard iterations solve \f$ K\delta = -\vec{R} \f$, which
+ * gives the same temperatures as solving \f$ K\vec{T} = \vec{f} \f$ with the
+ * lagged conductivity, with the PCGSolver and an incomplete Cholesky
+ * preconditioner. Newton iterations solve \f$ J\delta = -\vec{R} \f$ with the
+ * Jacobian
+ * \f[
+ * J_{ij} = \kappa(\bar{T}_{e})S_{ij} + \frac{\kappa'(\bar{T}_{e})}{3}
+ * \sum_{k} S_{ik}T_{k}
+ * \f]
+ * summed over elements, which is factored by LU with the BandedSolver after
+ * reordering it with reverseCuthillMcKee(). Newton requires the derivative
+ * of the conductivity and LAPACK, and solve() throws without them.
+ *
+ * Rebuilding the preconditioner or factorization is the most expensive part
+ * of an iteration, so both are reused while the conductivity changes only a
+ * little. The Picard preconditioner is rebuilt when the conductivity of any
+ * element has changed by more than a relative threshold since the last
+ * rebuild, which only slows PCG down, since the residual is always computed
+ * with the current conductivity. The Newton factorization is reused, which
+ * is the chord method, until an iteration reduces the residual by less than
+ * a ratio, including between solves. For example:
+ * @code
+ * TwoDMesh mesh = TwoDMesh::rectangle(100,100);
+ * NonlinearConduction conduction(mesh,
+ *     [](const double & T) { return 1.0 + 0.01*T;}, 10.0);
+ * conduction.conductivityDerivative([](const double & T) { return 0.01;});
+ * conduction.fixBoundaryTemperature(mesh, 3, 1500.0);
+ * conduction.method(NonlinearMethod::NEWTON);
+ * NonlinearResult result = conduction.solve();
+ * @endcode
+ * The iteration stops when the 2-norm of the residual is less than the
+ * tolerance times the 2-norm of the first residual.
+ */
+class NonlinearConduction {
+
+protected:
+
+	/**
+	 * The number of nodes in the mesh.
+	 */
+	int numNodes;
+
+	/**
+	 * The node ids of the elements.
+	 */
+	std::vector<int> connectivity;
+
+	/**
+	 * The elements of each color.
+	 */
+	std::vector<std::vector<long>> elementColors;
+
+	/**
+	 * The stiffness matrices of the elements for unit conductivity, nine per
+	 * element in row major order.
+	 */
+	std::vector<double> unitStiffness;
+
+	/**
+	 * The slots of the entries of each element matrix in the global matrix,
+	 * nine per element.
+	 */
+	std::vector<long> elementSlots;
+
+	/**
+	 * The conductivity and its derivative.
+	 */
+	std::function<double(const double &)> kappa, kappaDerivative;
+
+	/**
+	 * The conductivity of each element at the last assembly and when the
+	 * preconditioner was last rebuilt.
+	 */
+	std::vector<double> conductivity, preconditionedConductivity;
+
+	/**
+	 * The global source vector, f.
+	 */
+	std::vector<double> source;
+
+	/**
+	 * The temperatures of the nodes.
+	 */
+	std::vector<double> temperatures;
+
+	/**
+	 * True for nodes with fixed temperatures.
+	 */
+	std::vector<bool> fixed;
+
+	/**
+	 * True for the off-diagonal slots in the rows and columns of fixed
+	 * nodes, which are zeroed to eliminate the fixed nodes.
+	 */
+	std::vector<char> eliminatedSlots;
+
+	/**
+	 * True if eliminatedSlots must be recomputed.
+	 */
+	bool fixedChanged = true;
+
+	/**
+	 * The global matrix of the last iteration: the stiffness matrix for
+	 * Picard and the Jacobian for Newton, with the fixed nodes eliminated.
+	 */
+	CSRMatrix<double> matrix;
+
+	/**
+	 * The residual and correction.
+	 */
+	std::vector<double> residualVector, correction;
+
+	/**
+	 * The incomplete Cholesky preconditioner used by Picard iterations.
+	 */
+	std::unique_ptr<IncompleteCholeskyPreconditioner> preconditioner;
+
+	/**
+	 * The ordering of the Jacobian, the reordered Jacobian, the slot of each
+	 * entry of the matrix in it, its factors and true if they are current.
+	 */
+	std::vector<int> order;
+	CSRMatrix<double> ordered;
+	std::vector<long> orderedSlots;
+	BandedSolver factors;
+	bool factored = false;
+
+	/**
+	 * The ratio of the residual to the last residual for the last Newton
+	 * iteration. It is kept between solves so that a solve that starts close
+	 * to the last solution reuses the factorization.
+	 */
+	double lastReduction = 1.0;
+
+	/**
+	 * The iteration and the convergence controls.
+	 */
+	NonlinearMethod iteration = NonlinearMethod::PICARD;
+	double relativeTolerance = 1.0e-8;
+	int maxNumIterations = 100;
+	double pcgTolerance = 1.0e-2;
+	double rebuildChange = 0.25;
+	double refactorReduction = 0.25;
+
+	/**
+	 * The threads used for the assembly and the PCG solves.
+	 */
+	ThreadPool & pool;
+
+	/**
+	 * This operation assembles the residual of the current temperatures and
+	 * the matrix of the current iteration and eliminates the fixed nodes.
+	 * @param jacobian true to assemble the Newton Jacobian, false for the
+	 * stiffness matrix
+	 * @return the 2-norm of the residual of the free nodes
+	 */
+	double assemble(const bool & jacobian);
+
+	/**
+	 * This operation discards the preconditioner and factorization.
+	 */
+	void invalidate();
+
+public:
+
+	/**
+	 * Constructor. This computes the unit element matrices and the source.
+	 * @param mesh the mesh, which is not referenced after construction
+	 * @param conductivity the thermal conductivity as a function of the
+	 * temperature, kappa(T)
+	 * @param heatSource the volumetric heat source, q
+	 * @param threadPool the threads used for the assembly and solves
+	 */
+	NonlinearConduction(const TwoDMesh & mesh,
+			const std::function<double(const double &)> & conductivity,
+			const double & heatSource = 0.0,
+			ThreadPool & threadPool = ThreadPool::shared());
+
+	/**
+	 * This operation sets the derivative of the conductivity with respect
+	 * to the temperature, which is required by Newton iterations.
+	 * @param derivative dkappa/dT as a function of the temperature
+	 */
+	void conductivityDerivative(
+			const std::function<double(const double &)> & derivative);
+
+	/**
+	 * This operation fixes the temperature of a node. The node's temperature
+	 * is set immediately and does not change afterwards.
+	 * @param node the id of the node
+	 * @param value the temperature
+	 * @throw std::out_of_range if the node is not in the mesh
+	 */
+	void fixTemperature(const int & node, const double & value);
+
+	/**
+	 * This operation fixes the temperature of all of the nodes on the
+	 * boundary edges of a mesh with the given marker.
+	 * @param mesh the mesh used to create the problem
+	 * @param marker the marker of the boundary edges
+	 * @param value the temperature
+	 */
+	void fixBoundaryTemperature(const TwoDMesh & mesh, const int & marker,
+			const double & value);
+
+	/**
+	 * This operation returns true if the temperature of the node is fixed.
+	 * @param node the id of the node
+	 * @return true if fixed, false otherwise
+	 */
+	bool isFixed(const int & node) const { return fixed[node];};
+
+	/**
+	 * This operation returns the temperatures of the nodes. They may be
+	 * modified to set the initial guess, but the fixed temperatures must not
+	 * be changed.
+	 * @return the temperatures
+	 */
+	std::vector<double> & temperature() { return temperatures;};
+
+	/**
+	 * This operation sets the temperatures of all of the nodes that are not
+	 * fixed.
+	 * @param value the temperature
+	 */
+	void temperature(const double & value);
+
+	/**
+	 * This operation sets the iteration.
+	 * @param type Picard or Newton
+	 */
+	void method(const NonlinearMethod & type) { iteration = type;};
+
+	/**
+	 * This operation sets the relative tolerance on the residual.
+	 * @param tol the tolerance
+	 */
+	void tolerance(const double & tol) { relativeTolerance = tol;};
+
+	/**
+	 * This operation sets the maximum number of iterations.
+	 * @param maxIterations the maximum number of iterations
+	 */
+	void maxIterations(const int & maxIterations) {
+		maxNumIterations = maxIterations;
+	};
+
+	/**
+	 * This operation sets the relative tolerance of the PCG solves of the
+	 * Picard iterations, which only need to reduce the residual of the
+	 * correction by a modest factor. It is 1e-2 by default.
+	 * @param tol the tolerance
+	 */
+	void linearTolerance(const double & tol) { pcgTolerance = tol;};
+
+	/**
+	 * This operation sets the largest relative change in the conductivity of
+	 * an element before the Picard preconditioner is rebuilt. It is 0.25 by
+	 * default and zero rebuilds it every iteration.
+	 * @param change the relative change
+	 */
+	void rebuildThreshold(const double & change) { rebuildChange = change;};
+
+	/**
+	 * This operation sets the smallest reduction of the residual by a Newton
+	 * iteration for which the factorization is reused by the next one. It
+	 * is 0.25 by default and zero refactors every iteration.
+	 * @param ratio the ratio of the new residual to the last
+	 */
+	void refactorThreshold(const double & ratio) { refactorReduction = ratio;};
+
+	/**
+	 * This operation solves the problem, starting from the current
+	 * temperatures.
+	 * @return the number of iterations, rebuilds, residual and convergence
+	 * history
+	 * @throw std::runtime_error if Newton iterations are requested without
+	 * the derivative of the conductivity or without LAPACK (see
+	 * BandedSolver::lapackAvailable()), or if a matrix is singular
+	 */
+	NonlinearResult solve();
+
+	/**
+	 * This operation computes the residual of the current temperatures,
+	 * K(T)T - f, which is zero for the fixed nodes.
+	 * @param r the residual, which is resized
+	 */
+	void residual(std::vector<double> & r);
+
+	/**
+	 * This operation returns the conductivity of each element at the last
+	 * assembly.
+	 * @return the conductivities
+	 */
+	const std::vector<double> & conductivities() const { return conductivity;};
+
+	/**
+	 * This operation returns the global source vector.
+	 * @return f
+	 */
+	const std::vector<double> & sourceVector() const { return source;};
+
+	/**
+	 * This operation returns the number of nodes.
+	 * @return the number of nodes, which is the size of the system
+	 */
+	int size() const { return numNodes;};
+
+};
+
+} /* namespace fire */
+
+#endif /* FEM_NONLINEARCONDUCTION_H_ */
@@ -0,0 +1,190 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+
+// See the header file for API documentation
+
+#include <RobinBoundaryIntegrals.h>
+#include <LineQuadratureRule.h>
+#include <array>
+#include <stdexcept>
+#include <math.h>
+
+using namespace std;
+
+namespace fire {
+
+/**
+ * The products of the weights and the shape functions at the quadrature
+ * points, w N1 N1, w N1 N2, w N2 N2, w N1 and w N2, times the factor 1/2 from
+ * the change of variables.
+ */
+typedef array<array<double,LineQuadratureRule::numPoints>,5> ShapeProducts;
+
+static ShapeProducts computeShapeProducts() {
+	ShapeProducts products;
+	for (int q = 0; q < LineQuadratureRule::numPoints; q++) {
+		double x = LineQuadratureRule::points[q];
+		double w = 0.5*LineQuadratureRule::weights[q];
+		double n1 = 0.5*(1.0 - x), n2 = 0.5*(1.0 + x);
+		products[0][q] = w*n1*n1;
+		products[1][q] = w*n1*n2;
+		products[2][q] = w*n2*n2;
+		products[3][q] = w*n1;
+		products[4][q] = w*n2;
+	}
+	return products;
+}
+
+static const ShapeProducts shapeProducts = computeShapeProducts();
+
+RobinBoundaryIntegrals::RobinBoundaryIntegrals(const TwoDMesh & robinMesh) :
+		mesh(robinMesh), index(robinMesh), positions(index.numEdges(), -1) {
+}
+
+int RobinBoundaryIntegrals::addCondition(
+		const function<double(const double &)> & sigma,
+		const function<double(const double &)> & h) {
+	sigmas.push_back(sigma);
+	hs.push_back(h);
+	// Evaluate the functions once for all of the edges
+	array<double,LineQuadratureRule::numPoints> s, f;
+	for (int q = 0; q < LineQuadratureRule::numPoints; q++) {
+		s[q] = sigma(LineQuadratureRule::points[q]);
+		f[q] = h(LineQuadratureRule::points[q]);
+	}
+	for (int i = 0; i < 5; i++) {
+		auto & values = (i < 3) ? s : f;
+		double sum = 0.0;
+		for (int q = 0; q < LineQuadratureRule::numPoints; q++) {
+			sum += shapeProducts[i][q]*values[q];
+		}
+		referenceIntegrals.push_back(sum);
+	}
+	return sigmas.size() - 1;
+}
+
+void RobinBoundaryIntegrals::addEdge(const int & first, const int & second,
+		const int & condition) {
+	long edge = index.find(first, second);
+	if (edge < 0) {
+		throw runtime_error("The nodes of the condition do not share an edge.");
+	}
+	if (positions[edge] >= 0) {
+		throw runtime_error("The edge already has a Robin condition.");
+	}
+	positions[edge] = edgeConditions.size();
+	edgeNodes.push_back(first);
+	edgeNodes.push_back(second);
+	edgeConditions.push_back(condition);
+	edgeElements.push_back(index.elements()[2*edge]);
+}
+
+void RobinBoundaryIntegrals::add(const TwoDRobinBoundaryCondition & condition) {
+	auto & first = condition.firstNode.value;
+	auto & second = condition.secondNode.value;
+	// Check the edge before the condition is stored
+	long edge = index.find(first, second);
+	if (edge < 0) {
+		throw runtime_error("The nodes of the condition do not share an edge.");
+	}
+	if (positions[edge] >= 0) {
+		throw runtime_error("The edge already has a Robin condition.");
+	}
+	addEdge(first, second, addCondition(condition.sigma, condition.h));
+}
+
+void RobinBoundaryIntegrals::addBoundary(const int & marker,
+		const function<double(const double &)> & sigma,
+		const function<double(const double &)> & h) {
+	int condition = addCondition(sigma, h);
+	auto & edges = mesh.boundaryEdges();
+	auto & markers = mesh.boundaryMarkers();
+	for (long k = 0; k < (long) markers.size(); k++) {
+		if (markers[k] == marker) addEdge(edges[2*k], edges[2*k+1], condition);
+	}
+}
+
+void RobinBoundaryIntegrals::compute() {
+	long n = numEdges();
+	edgeLengths.resize(n);
+	k11.resize(n);
+	k12.resize(n);
+	k22.resize(n);
+	f1.resize(n);
+	f2.resize(n);
+
+	auto & x = mesh.x();
+	auto & y = mesh.y();
+	for (long k = 0; k < n; k++) {
+		double dx = x[edgeNodes[2*k+1]] - x[edgeNodes[2*k]];
+		double dy = y[edgeNodes[2*k+1]] - y[edgeNodes[2*k]];
+		edgeLengths[k] = sqrt(dx*dx + dy*dy);
+	}
+
+	// Scale the reference integrals of the conditions by the lengths
+	const double * integrals = referenceIntegrals.data();
+	const int * conditions = edgeConditions.data();
+	for (long k = 0; k < n; k++) {
+		const double * reference = integrals + 5*conditions[k];
+		double length = edgeLengths[k];
+		k11[k] = length*reference[0];
+		k12[k] = length*reference[1];
+		k22[k] = length*reference[2];
+		f1[k] = length*reference[3];
+		f2[k] = length*reference[4];
+	}
+}
+
+void RobinBoundaryIntegrals::assemble(CSRMatrix<double> & matrix) const {
+	for (long k = 0; k < (long) k11.size(); k++) {
+		int first = edgeNodes[2*k], second = edgeNodes[2*k+1];
+		long s11 = matrix.slot(first, first), s12 = matrix.slot(first, second),
+				s21 = matrix.slot(second, first),
+				s22 = matrix.slot(second, second);
+		if (s11 < 0 || s12 < 0 || s21 < 0 || s22 < 0) {
+			throw runtime_error("The matrix does not contain a Robin edge.");
+		}
+		matrix.values[s11] += k11[k];
+		matrix.values[s12] += k12[k];
+		matrix.values[s21] += k12[k];
+		matrix.values[s22] += k22[k];
+	}
+}
+
+void RobinBoundaryIntegrals::assemble(vector<double> & force) const {
+	for (long k = 0; k < (long) f1.size(); k++) {
+		force[edgeNodes[2*k]] += f1[k];
+		force[edgeNodes[2*k+1]] += f2[k];
+	}
+}
+
+} /* namespace fire */
@@ -0,0 +1,269 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#ifndef FEM_ROBINBOUNDARYINTEGRALS_H_
+#define FEM_ROBINBOUNDARYINTEGRALS_H_
+
+#include <vector>
+#include <functional>
+#include <TwoDMesh.h>
+#include <TwoDRobinBoundaryCondition.h>
+#include <EdgeIndex.h>
+#include <CSRMatrix.h>
+
+namespace fire {
+
+/**
+ * This class computes the Robin boundary contributions of all of the
+ * boundary edges of a TwoDMesh at once. For the condition
+ * \f[
+ * k(s)\frac{\partial u}{\partial n} + \sigma(s) u = h(s)
+ * \f]
+ * on an edge from node 1 to node 2 with length L, the contributions to the
+ * stiffness matrix and force vector are
+ * \f[
+ * k_{ab} = \frac{L}{2}\int_{-1}^{1} \sigma(x) N_{a}(x) N_{b}(x) dx,
+ * \quad
+ * f_{a} = \frac{L}{2}\int_{-1}^{1} h(x) N_{a}(x) dx
+ * \f]
+ * with \f$ N_{1} = (1-x)/2 \f$ and \f$ N_{2} = (1+x)/2 \f$. As with
+ * TwoDRobinBoundaryCondition in ConstantStrainTriangleElement, sigma and h
+ * are called with the reference coordinate x in [-1,1] from the first node
+ * to the second. Unlike ConstantStrainTriangleElement, the force is scaled
+ * by the length of the edge, so h is a flux.
+ *
+ * Since sigma and h only depend on the reference coordinate, they are
+ * evaluated at the points of the LineQuadratureRule once per condition, not
+ * once per edge, and combined with the shape function products, which are
+ * computed once for all instances. Each edge integral is then the length of
+ * the edge times one of five numbers of its condition, so compute() is a
+ * single sweep over arrays of lengths with no function calls. Conditions are
+ * attached to edges through an EdgeIndex in constant time.
+ *
+ * @code
+ * TwoDMesh mesh = TwoDMesh::rectangle(1000,1000);
+ * RobinBoundaryIntegrals robin(mesh);
+ * robin.addBoundary(1, [](const double & x) { return 2.0;},
+ *         [](const double & x) { return 10.0;});
+ * robin.compute();
+ * robin.assemble(stiffness);
+ * robin.assemble(force);
+ * @endcode
+ *
+ * compute() may be called again after the nodes move.
+ */
+class RobinBoundaryIntegrals {
+
+protected:
+
+	/**
+	 * The mesh.
+	 */
+	const TwoDMesh & mesh;
+
+	/**
+	 * The index of the edges of the mesh.
+	 */
+	EdgeIndex index;
+
+	/**
+	 * The position of each edge of the mesh in the arrays of boundary edges
+	 * below, or -1 if no condition is attached to it.
+	 */
+	std::vector<long> positions;
+
+	/**
+	 * The sigma and h functions of each condition.
+	 */
+	std::vector<std::function<double(const double &)>> sigmas, hs;
+
+	/**
+	 * The reference integrals of each condition: the stiffness integrals for
+	 * (1,1), (1,2) and (2,2) followed by the force integrals for 1 and 2,
+	 * including the factor 1/2 from the change of variables.
+	 */
+	std::vector<double> referenceIntegrals;
+
+	/**
+	 * The nodes of each boundary edge, in the order of its condition.
+	 */
+	std::vector<int> edgeNodes;
+
+	/**
+	 * The condition of each boundary edge.
+	 */
+	std::vector<int> edgeConditions;
+
+	/**
+	 * The element that contains each boundary edge.
+	 */
+	std::vector<long> edgeElements;
+
+	/**
+	 * The lengths of the boundary edges.
+	 */
+	std::vector<double> edgeLengths;
+
+	/**
+	 * The stiffness contributions of the boundary edges.
+	 */
+	std::vector<double> k11, k12, k22;
+
+	/**
+	 * The force contributions of the boundary edges.
+	 */
+	std::vector<double> f1, f2;
+
+	/**
+	 * This operation adds a condition and returns its id.
+	 * @param sigma the sigma function
+	 * @param h the h function
+	 * @return the id of the condition
+	 */
+	int addCondition(const std::function<double(const double &)> & sigma,
+			const std::function<double(const double &)> & h);
+
+	/**
+	 * This operation attaches a condition to the edge between two nodes.
+	 * @param first the first node of the edge
+	 * @param second the second node of the edge
+	 * @param condition the id of the condition
+	 * @throw std::runtime_error if the nodes do not share an edge or the edge
+	 * already has a condition
+	 */
+	void addEdge(const int & first, const int & second, const int & condition);
+
+public:
+
+	/**
+	 * Constructor
+	 * @param robinMesh the mesh, which must outlive this object
+	 */
+	RobinBoundaryIntegrals(const TwoDMesh & robinMesh);
+
+	/**
+	 * This operation attaches a condition to the edge between its two nodes.
+	 * @param condition the condition, which is copied
+	 * @throw std::runtime_error if the nodes do not share an edge or the edge
+	 * already has a condition
+	 */
+	void add(const TwoDRobinBoundaryCondition & condition);
+
+	/**
+	 * This operation attaches one condition to all of the boundary edges of
+	 * the mesh with a marker. The edges run in the direction in which they
+	 * were added to the mesh.
+	 * @param marker the marker of the edges
+	 * @param sigma the sigma function
+	 * @param h the h function
+	 * @throw std::runtime_error if an edge already has a condition
+	 */
+	void addBoundary(const int & marker,
+			const std::function<double(const double &)> & sigma,
+			const std::function<double(const double &)> & h);
+
+	/**
+	 * This operation computes the lengths of the edges and all of the
+	 * contributions.
+	 */
+	void compute();
+
+	/**
+	 * This operation adds the stiffness contributions to a global matrix.
+	 * @param matrix the matrix, which must have the entries of every edge
+	 * @throw std::runtime_error if an entry is missing
+	 */
+	void assemble(CSRMatrix<double> & matrix) const;
+
+	/**
+	 * This operation adds the force contributions to a global vector.
+	 * @param force the vector, which must have an entry for every node
+	 */
+	void assemble(std::vector<double> & force) const;
+
+	/**
+	 * This operation returns the number of edges with conditions.
+	 * @return the number of edges
+	 */
+	long numEdges() const { return edgeConditions.size();};
+
+	/**
+	 * This operation returns the nodes of the edges with conditions.
+	 * @return the nodes, two per edge
+	 */
+	const std::vector<int> & nodes() const { return edgeNodes;};
+
+	/**
+	 * This operation returns the elements that contain the edges with
+	 * conditions.
+	 * @return the elements, one per edge
+	 */
+	const std::vector<long> & elements() const { return edgeElements;};
+
+	/**
+	 * This operation returns the lengths of the edges from the last call to
+	 * compute().
+	 * @return the lengths, one per edge
+	 */
+	const std::vector<double> & lengths() const { return edgeLengths;};
+
+	/**
+	 * This operation returns a stiffness contribution of an edge.
+	 * @param edge the position of the edge in nodes()
+	 * @param a the first local node, 0 or 1
+	 * @param b the second local node, 0 or 1
+	 * @return the contribution
+	 */
+	double stiffness(const long & edge, const int & a, const int & b) const {
+		return (a != b) ? k12[edge] : ((a == 0) ? k11[edge] : k22[edge]);
+	};
+
+	/**
+	 * This operation returns a force contribution of an edge.
+	 * @param edge the position of the edge in nodes()
+	 * @param a the local node, 0 or 1
+	 * @return the contribution
+	 */
+	double force(const long & edge, const int & a) const {
+		return (a == 0) ? f1[edge] : f2[edge];
+	};
+
+	/**
+	 * This operation returns the index of the edges of the mesh.
+	 * @return the index
+	 */
+	const EdgeIndex & edges() const { return index;};
+
+};
+
+} /* namespace fire */
+
+#endif /* FEM_ROBINBOUNDARYINTEGRALS_H_ */
@@ -0,0 +1,540 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#ifndef FEM_TETCONDUCTION_H_
+#define FEM_TETCONDUCTION_H_
+
+#include <array>
+#include <cmath>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <ThreeDMesh.h>
+#include <TetShapeFunctions.h>
+#include <ElementColoring.h>
+#include <GaussQuadratureRules.h>
+#include <CSRMatrix.h>
+#include <ThreadPool.h>
+
+namespace fire {
+
+/**
+ * This class assembles the global conductivity (stiffness) and heat capacity
+ * (mass) matrices and the heat source vector of the heat equation
+ * \f[
+ * \rho c \frac{\partial T}{\partial t} = \nabla \cdot (\kappa \nabla T) + Q
+ * \f]
+ * on a tetrahedral ThreeDMesh. The Shape policy selects the element:
+ * Tet4Conduction for linear and Tet10Conduction for quadratic tetrahedra.
+ *
+ * Since the elements are straight sided, the gradient of each shape function
+ * is a combination of the constant gradients G_a of the volume coordinates,
+ * and the element matrices reduce to
+ * \f[
+ * k_{ij} = \kappa |V| \sum_{a \le b} R_{ij}^{ab} G_{a} \cdot G_{b}, \quad
+ * m_{ij} = \rho c |V| M_{ij}
+ * \f]
+ * where the reference tensors R and M do not depend on the element. They are
+ * integrated once, in the constructor, with the Gauss tetrahedron rules that
+ * are exact for the shape functions: degree 2p-2 for the stiffness and 2p
+ * for the mass. The stiffness of an element then only needs the ten dot
+ * products of its volume coordinate gradients.
+ *
+ * The elements are colored such that no two elements of the same color share
+ * a node, as in FEMAssembler, and the elements of each color are assembled
+ * in parallel on a ThreadPool. Each thread processes its elements in blocks
+ * of blockSize: the dot products of a block are gathered into small local
+ * arrays, the unique entries of the block's matrices are computed by loops
+ * over the elements that the compiler can vectorize, and the entries are
+ * then added to the global matrix through a scatter map that holds the CSR
+ * slot of every local entry. The element matrices are never stored, so the
+ * memory needed beyond the mesh and the matrix is the scatter map.
+ * @code
+ * ThreeDMesh mesh = ThreeDMesh::readWarp3D("cube_tet10.inp");
+ * Tet10Conduction conduction(mesh);
+ * CSRMatrix<double> stiffness = conduction.matrix();
+ * conduction.assembleStiffness(stiffness, 45.0);
+ * @endcode
+ */
+template<typename Shape>
+class TetConduction {
+
+public:
+
+	/**
+	 * The number of nodes in an element.
+	 */
+	static const int numNodes = Shape::numNodes;
+
+	/**
+	 * The number of unique entries in a symmetric element matrix.
+	 */
+	static const int numEntries = numNodes*(numNodes + 1)/2;
+
+	/**
+	 * The number of elements processed at once in a block.
+	 */
+	static const int blockSize = 256;
+
+	/**
+	 * The rule used to integrate the stiffness reference tensor.
+	 */
+	typedef typename TetrahedronRuleForDegree<2*Shape::degree - 2>::type
+			StiffnessRule;
+
+	/**
+	 * The rule used to integrate the mass reference tensor.
+	 */
+	typedef typename TetrahedronRuleForDegree<2*Shape::degree>::type
+			MassRule;
+
+protected:
+
+	/**
+	 * The mesh.
+	 */
+	const ThreeDMesh & mesh;
+
+	/**
+	 * The pool used for parallel assembly.
+	 */
+	ThreadPool & pool;
+
+	/**
+	 * The stiffness reference tensor, with the ten (a,b) pairs of each unique
+	 * (i,j) entry stored consecutively.
+	 */
+	std::array<double,10*numEntries> stiffnessTensor;
+
+	/**
+	 * The unique entries of the mass reference tensor.
+	 */
+	std::array<double,numEntries> massTensor;
+
+	/**
+	 * The integrals of the shape functions over the reference element times
+	 * six, which are the fractions of the volume that go to each node.
+	 */
+	std::array<double,numNodes> loadTensor;
+
+	/**
+	 * A matrix that holds the sparsity pattern of the global matrices.
+	 */
+	CSRMatrix<double> pattern;
+
+	/**
+	 * The slot of each local (i,j) entry of each element in the global
+	 * matrix, numNodes*numNodes per element.
+	 */
+	std::vector<long> scatter;
+
+	/**
+	 * The elements of each color.
+	 */
+	std::vector<std::vector<long>> elementColors;
+
+	/**
+	 * The minimum number of elements per thread in the assembly loops.
+	 */
+	static const long elementGrain = 64;
+
+	/**
+	 * This operation returns the position of the local (i,j) entry in the
+	 * unique entries, which are stored by rows of the upper triangle.
+	 */
+	static int entry(const int & i, const int & j) {
+		int r = std::min(i,j), c = std::max(i,j);
+		return r*numNodes - r*(r - 1)/2 + c - r;
+	}
+
+	/**
+	 * This operation integrates the reference tensors.
+	 */
+	void computeReferenceTensors() {
+		std::array<double,4*numNodes> dN;
+		std::array<double,numNodes> N;
+		stiffnessTensor.fill(0.0);
+		for (int q = 0; q < StiffnessRule::numPoints; q++) {
+			Shape::derivatives(StiffnessRule::points[q], dN.data());
+			double w = 6.0*StiffnessRule::weights[q];
+			for (int i = 0; i < numNodes; i++) {
+				for (int j = i; j < numNodes; j++) {
+					double * r = &stiffnessTensor[10*entry(i,j)];
+					int ab = 0;
+					for (int a = 0; a < 4; a++) {
+						for (int b = a; b < 4; b++, ab++) {
+							double value = dN[4*i + a]*dN[4*j + b];
+							if (a != b) value += dN[4*i + b]*dN[4*j + a];
+							r[ab] += w*value;
+						}
+					}
+				}
+			}
+		}
+		massTensor.fill(0.0);
+		loadTensor.fill(0.0);
+		for (int q = 0; q < MassRule::numPoints; q++) {
+			Shape::values(MassRule::points[q], N.data());
+			double w = 6.0*MassRule::weights[q];
+			for (int i = 0; i < numNodes; i++) {
+				loadTensor[i] += w*N[i];
+				for (int j = i; j < numNodes; j++) {
+					massTensor[entry(i,j)] += w*N[i]*N[j];
+				}
+			}
+		}
+	}
+
+	/**
+	 * This operation computes the unique stiffness entries of a block of
+	 * elements.
+	 * @param elements the indices of the elements
+	 * @param count the number of elements, at most blockSize
+	 * @param scales the conductivity times the volume of each element
+	 * @param entries the entries, stride per unique entry
+	 * @param stride the distance between the unique entries, at least count
+	 */
+	void computeStiffnessBlock(const long * elements, const int & count,
+			const double * scales, double * entries,
+			const int & stride = blockSize) const {
+		// Gather the dot products of the volume coordinate gradients
+		double dots[10][blockSize];
+		const double * gradients = mesh.gradients().data();
+		for (int k = 0; k < count; k++) {
+			const double * g = &gradients[12*elements[k]];
+			int ab = 0;
+			for (int a = 0; a < 4; a++) {
+				for (int b = a; b < 4; b++, ab++) {
+					dots[ab][k] = g[3*a]*g[3*b] + g[3*a+1]*g[3*b+1]
+							+ g[3*a+2]*g[3*b+2];
+				}
+			}
+		}
+		// The reference tensor is constant in the inner loops
+		for (int p = 0; p < numEntries; p++) {
+			const double * r = &stiffnessTensor[10*p];
+			double * k = &entries[p*stride];
+			for (int e = 0; e < count; e++) k[e] = r[0]*dots[0][e];
+			for (int ab = 1; ab < 10; ab++) {
+				for (int e = 0; e < count; e++) k[e] += r[ab]*dots[ab][e];
+			}
+			for (int e = 0; e < count; e++) k[e] *= scales[e];
+		}
+	}
+
+	/**
+	 * This operation assembles the stiffness with the conductivity of each
+	 * element given by a function of its index.
+	 */
+	template<typename F>
+	void assembleStiffnessBlocks(CSRMatrix<double> & stiffness,
+			const F & conductivity) {
+		checkMatrix(stiffness);
+		stiffness.zero();
+		const double * volumes = mesh.volumes().data();
+		for (auto & elementColor : elementColors) {
+			pool.parallelFor(0, elementColor.size(),
+					[&](const long & begin, const long & end) {
+				std::vector<double> entries(numEntries*blockSize);
+				double scales[blockSize];
+				for (long first = begin; first < end; first += blockSize) {
+					const long * elements = &elementColor[first];
+					int count = std::min((long) blockSize, end - first);
+					for (int k = 0; k < count; k++) {
+						scales[k] = conductivity(elements[k])
+								*std::fabs(volumes[elements[k]]);
+					}
+					computeStiffnessBlock(elements, count, scales,
+							entries.data());
+					for (int k = 0; k < count; k++) {
+						const long * slots =
+								&scatter[elements[k]*numNodes*numNodes];
+						for (int i = 0; i < numNodes; i++) {
+							for (int j = 0; j < numNodes; j++) {
+								stiffness.values[slots[i*numNodes + j]] +=
+										entries[entry(i,j)*blockSize + k];
+							}
+						}
+					}
+				}
+			}, elementGrain);
+		}
+	}
+
+	/**
+	 * This operation throws an exception if a matrix was not created by
+	 * matrix().
+	 */
+	void checkMatrix(const CSRMatrix<double> & matrix) const {
+		if (matrix.nonZeros() != pattern.nonZeros()) {
+			throw std::runtime_error("TetConduction matrix does not match the "
+					"mesh.");
+		}
+	}
+
+public:
+
+	/**
+	 * The constructor. It integrates the reference tensors and computes the
+	 * sparsity pattern, scatter map and coloring for the mesh.
+	 * @param threeDMesh the mesh, which must have numNodes nodes per element
+	 * @param threadPool the pool of threads that should be used for parallel
+	 * assembly. Loops of more than 64 elements are split between threads.
+	 */
+	TetConduction(const ThreeDMesh & threeDMesh,
+			ThreadPool & threadPool = ThreadPool::shared()) :
+			mesh(threeDMesh), pool(threadPool) {
+		if (mesh.nodesPerElement() != numNodes) {
+			throw std::runtime_error("TetConduction mesh has the wrong element "
+					"type.");
+		}
+		computeReferenceTensors();
+		auto & connectivity = mesh.connectivity();
+		std::vector<std::pair<int,int>> entries;
+		entries.reserve(connectivity.size()*numNodes);
+		for (long e = 0; e < mesh.numElements(); e++) {
+			const int * ids = &connectivity[e*numNodes];
+			for (int i = 0; i < numNodes; i++) {
+				for (int j = 0; j < numNodes; j++) {
+					entries.emplace_back(ids[i],ids[j]);
+				}
+			}
+		}
+		pattern = CSRMatrix<double>(mesh.numNodes(),entries);
+		// Find the slot of every local entry
+		scatter.resize(entries.size());
+		for (long k = 0; k < (long) entries.size(); k++) {
+			scatter[k] = pattern.slot(entries[k].first,entries[k].second);
+		}
+		elementColors = colorElements(connectivity, numNodes, mesh.numNodes());
+	};
+
+	/**
+	 * This operation returns a matrix with the sparsity pattern of the global
+	 * matrices and all values set to zero.
+	 * @return the matrix
+	 */
+	CSRMatrix<double> matrix() const { return pattern;};
+
+	/**
+	 * This operation returns the elements of each color. No two elements of
+	 * the same color share a node.
+	 * @return the element indices for each color
+	 */
+	const std::vector<std::vector<long>> & colors() const {
+		return elementColors;
+	};
+
+	/**
+	 * This operation computes the full stiffness matrix of one element.
+	 * @param e the index of the element
+	 * @param conductivity the conductivity of the element
+	 * @param k the numNodes*numNodes entries in row major order
+	 */
+	void elementStiffness(const long & e, const double & conductivity,
+			double * k) const {
+		// One element needs one slot per unique entry, not a block
+		double entries[numEntries];
+		double scale = conductivity*std::fabs(mesh.volumes()[e]);
+		computeStiffnessBlock(&e, 1, &scale, entries, 1);
+		for (int i = 0; i < numNodes; i++) {
+			for (int j = 0; j < numNodes; j++) {
+				k[i*numNodes + j] = entries[entry(i,j)];
+			}
+		}
+	}
+
+	/**
+	 * This operation computes the full consistent mass matrix of one
+	 * element.
+	 * @param e the index of the element
+	 * @param heatCapacity the volumetric heat capacity of the element
+	 * @param m the numNodes*numNodes entries in row major order
+	 */
+	void elementMass(const long & e, const double & heatCapacity,
+			double * m) const {
+		double scale = heatCapacity*std::fabs(mesh.volumes()[e]);
+		for (int i = 0; i < numNodes; i++) {
+			for (int j = 0; j < numNodes; j++) {
+				m[i*numNodes + j] = scale*massTensor[entry(i,j)];
+			}
+		}
+	}
+
+	/**
+	 * This operation assembles the global stiffness matrix in parallel for a
+	 * conductivity that is the same in every element.
+	 * @param stiffness the matrix, which must have been created by matrix().
+	 * Its values are overwritten.
+	 * @param conductivity the conductivity
+	 */
+	void assembleStiffness(CSRMatrix<double> & stiffness,
+			const double & conductivity = 1.0) {
+		assembleStiffnessBlocks(stiffness, [&](const long &) {
+			return conductivity;
+		});
+	}
+
+	/**
+	 * This operation assembles the global stiffness matrix in parallel for a
+	 * conductivity that is constant within each element.
+	 * @param stiffness the matrix, which must have been created by matrix().
+	 * Its values are overwritten.
+	 * @param conductivities the conductivity of each element
+	 */
+	void assembleStiffness(CSRMatrix<double> & stiffness,
+			const std::vector<double> & conductivities) {
+		if ((long) conductivities.size() != mesh.numElements()) {
+			throw std::runtime_error("TetConduction needs one conductivity per "
+					"element.");
+		}
+		assembleStiffnessBlocks(stiffness, [&](const long & e) {
+			return conductivities[e];
+		});
+	}
+
+	/**
+	 * This operation assembles the global consistent mass matrix in
+	 * parallel.
+	 * @param mass the matrix, which must have been created by matrix(). Its
+	 * values are overwritten.
+	 * @param heatCapacity the volumetric heat capacity, rho*c
+	 */
+	void assembleMass(CSRMatrix<double> & mass,
+			const double & heatCapacity = 1.0) {
+		checkMatrix(mass);
+		mass.zero();
+		const double * volumes = mesh.volumes().data();
+		for (auto & elementColor : elementColors) {
+			pool.parallelFor(0, elementColor.size(),
+					[&](const long & begin, const long & end) {
+				for (long k = begin; k < end; k++) {
+					long e = elementColor[k];
+					double scale = heatCapacity*std::fabs(volumes[e]);
+					const long * slots = &scatter[e*numNodes*numNodes];
+					for (int i = 0; i < numNodes; i++) {
+						for (int j = 0; j < numNodes; j++) {
+							mass.values[slots[i*numNodes + j]] +=
+									scale*massTensor[entry(i,j)];
+						}
+					}
+				}
+			}, elementGrain);
+		}
+	}
+
+	/**
+	 * This operation assembles the lumped mass matrix. Row sums are not used
+	 * because they are negative at the corners of quadratic elements.
+	 * Instead the diagonal of each element's consistent mass matrix is scaled
+	 * to the element's total mass (HRZ lumping), which gives |V|/4 at each
+	 * corner of a linear element.
+	 * @param mass the diagonal, which is resized to the number of nodes and
+	 * overwritten
+	 * @param heatCapacity the volumetric heat capacity, rho*c
+	 */
+	void assembleLumpedMass(std::vector<double> & mass,
+			const double & heatCapacity = 1.0) {
+		double diagonalSum = 0.0;
+		for (int i = 0; i < numNodes; i++) diagonalSum += massTensor[entry(i,i)];
+		std::array<double,numNodes> fractions;
+		for (int i = 0; i < numNodes; i++) {
+			fractions[i] = massTensor[entry(i,i)]/diagonalSum;
+		}
+		assembleNodal(mass, heatCapacity, fractions);
+	}
+
+	/**
+	 * This operation assembles the global heat source vector for a source
+	 * that is the same everywhere.
+	 * @param source the vector, which is resized to the number of nodes and
+	 * overwritten
+	 * @param heatSource the heat generated per unit volume
+	 */
+	void assembleSource(std::vector<double> & source,
+			const double & heatSource) {
+		assembleNodal(source, heatSource, loadTensor);
+	}
+
+protected:
+
+	/**
+	 * This operation adds the given fraction of each element's volume, times
+	 * a constant, to each of its nodes.
+	 */
+	void assembleNodal(std::vector<double> & vector, const double & constant,
+			const std::array<double,numNodes> & fractions) {
+		vector.assign(mesh.numNodes(), 0.0);
+		auto & connectivity = mesh.connectivity();
+		const double * volumes = mesh.volumes().data();
+		for (auto & elementColor : elementColors) {
+			pool.parallelFor(0, elementColor.size(),
+					[&](const long & begin, const long & end) {
+				for (long k = begin; k < end; k++) {
+					long e = elementColor[k];
+					double scale = constant*std::fabs(volumes[e]);
+					const int * ids = &connectivity[e*numNodes];
+					for (int i = 0; i < numNodes; i++) {
+						vector[ids[i]] += scale*fractions[i];
+					}
+				}
+			}, elementGrain);
+		}
+	}
+
+};
+
+template<typename Shape>
+const int TetConduction<Shape>::numNodes;
+
+template<typename Shape>
+const int TetConduction<Shape>::numEntries;
+
+template<typename Shape>
+const int TetConduction<Shape>::blockSize;
+
+template<typename Shape>
+const long TetConduction<Shape>::elementGrain;
+
+/**
+ * Heat conduction on linear, four node tetrahedra.
+ */
+typedef TetConduction<Tet4Shape> Tet4Conduction;
+
+/**
+ * Heat conduction on quadratic, ten node tetrahedra.
+ */
+typedef TetConduction<Tet10Shape> Tet10Conduction;
+
+} /* namespace fire */
+
+#endif /* FEM_TETCONDUCTION_H_ */
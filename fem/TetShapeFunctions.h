@@ -0,0 +1,149 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#ifndef FEM_TETSHAPEFUNCTIONS_H_
+#define FEM_TETSHAPEFUNCTIONS_H_
+
+#include <array>
+
+namespace fire {
+
+/**
+ * This class holds the shape functions of the linear, four node tetrahedron
+ * in volume coordinates, N_i = L_i. It is used as the Shape policy of
+ * TetConduction.
+ */
+struct Tet4Shape {
+
+	/**
+	 * The number of nodes in the element.
+	 */
+	static const int numNodes = 4;
+
+	/**
+	 * The polynomial degree of the shape functions.
+	 */
+	static const int degree = 1;
+
+	/**
+	 * This operation evaluates the shape functions.
+	 * @param L the volume coordinates of the point
+	 * @param N the values of the numNodes shape functions
+	 */
+	static void values(const std::array<double,4> & L, double * N) {
+		for (int i = 0; i < 4; i++) N[i] = L[i];
+	}
+
+	/**
+	 * This operation evaluates the derivatives of the shape functions with
+	 * respect to the volume coordinates. They are constant, so the volume
+	 * coordinates of the point are not used.
+	 * @param dN dN_i/dL_a stored at dN[4*i + a]
+	 */
+	static void derivatives(const std::array<double,4> &, double * dN) {
+		for (int i = 0; i < 4; i++) {
+			for (int a = 0; a < 4; a++) dN[4*i + a] = (i == a) ? 1.0 : 0.0;
+		}
+	}
+
+};
+
+/**
+ * This class holds the shape functions of the quadratic, ten node
+ * tetrahedron in volume coordinates. The corner nodes have
+ * \f[
+ * N_i = L_i(2L_i - 1)
+ * \f]
+ * and the midside node of the edge between corners p and q has
+ * \f[
+ * N = 4L_pL_q
+ * \f]
+ * The nodes are in the Warp3D order used by ThreeDMesh: the corners, then
+ * the edges 1-2, 2-3, 3-1, 1-4, 2-4 and 3-4.
+ */
+struct Tet10Shape {
+
+	/**
+	 * The number of nodes in the element.
+	 */
+	static const int numNodes = 10;
+
+	/**
+	 * The polynomial degree of the shape functions.
+	 */
+	static const int degree = 2;
+
+	/**
+	 * This operation returns one of the corners of the edge of a midside
+	 * node.
+	 * @param m the index of the edge, from 0 to 5
+	 * @param end 0 for the first corner and 1 for the second
+	 * @return the local id of the corner
+	 */
+	static int edgeCorner(const int & m, const int & end) {
+		static const int edges[6][2] = {{0,1}, {1,2}, {2,0}, {0,3}, {1,3},
+				{2,3}};
+		return edges[m][end];
+	}
+
+	/**
+	 * This operation evaluates the shape functions.
+	 * @param L the volume coordinates of the point
+	 * @param N the values of the numNodes shape functions
+	 */
+	static void values(const std::array<double,4> & L, double * N) {
+		for (int i = 0; i < 4; i++) N[i] = L[i]*(2.0*L[i] - 1.0);
+		for (int m = 0; m < 6; m++) {
+			N[4+m] = 4.0*L[edgeCorner(m,0)]*L[edgeCorner(m,1)];
+		}
+	}
+
+	/**
+	 * This operation evaluates the derivatives of the shape functions with
+	 * respect to the volume coordinates.
+	 * @param L the volume coordinates of the point
+	 * @param dN dN_i/dL_a stored at dN[4*i + a]
+	 */
+	static void derivatives(const std::array<double,4> & L, double * dN) {
+		for (int k = 0; k < 40; k++) dN[k] = 0.0;
+		for (int i = 0; i < 4; i++) dN[4*i + i] = 4.0*L[i] - 1.0;
+		for (int m = 0; m < 6; m++) {
+			int p = edgeCorner(m,0), q = edgeCorner(m,1);
+			dN[4*(4+m) + p] = 4.0*L[q];
+			dN[4*(4+m) + q] = 4.0*L[p];
+		}
+	}
+
+};
+
+} /* namespace fire */
+
+#endif /* FEM_TETSHAPEFUNCTIONS_H_ */
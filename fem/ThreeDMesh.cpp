@@ -0,0 +1,644 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+
+// See the header file for API documentation
+
+#include <ThreeDMesh.h>
+#include <GraphOrdering.h>
+#include <algorithm>
+#include <map>
+#include <cctype>
+#include <fstream>
+#include <utility>
+#include <stdexcept>
+#include <iterator>
+#include <cstring>
+#include <cstdlib>
+#include <math.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define FIRE_WARP3D_MMAP
+#endif
+
+using namespace std;
+
+namespace fire {
+
+const long ThreeDMesh::readerGrain;
+
+ThreeDMesh::ThreeDMesh(const int & nodesPerElement) :
+		elementSize(nodesPerElement) {
+	if (elementSize != 4 && elementSize != 10) {
+		throw runtime_error("Tetrahedra must have 4 or 10 nodes.");
+	}
+}
+
+int ThreeDMesh::addNode(const double & x, const double & y,
+		const double & z) {
+	xCoords.push_back(x);
+	yCoords.push_back(y);
+	zCoords.push_back(z);
+	return xCoords.size() - 1;
+}
+
+long ThreeDMesh::addElement(const vector<int> & nodes) {
+	if ((int) nodes.size() != elementSize) {
+		throw runtime_error("Element has the wrong number of nodes.");
+	}
+	int n = numNodes();
+	for (int id : nodes) {
+		if (id < 0 || id >= n) {
+			throw out_of_range("Element node id is not in the mesh.");
+		}
+	}
+	for (int a = 0; a < 4; a++) {
+		for (int b = a + 1; b < 4; b++) {
+			if (nodes[a] == nodes[b]) {
+				throw runtime_error("Element corners must be distinct.");
+			}
+		}
+	}
+	elementNodes.insert(elementNodes.end(), nodes.begin(), nodes.end());
+	volumeGradients.resize(volumeGradients.size() + 12);
+	elementVolumes.push_back(0.0);
+	long e = numElements() - 1;
+	try {
+		computeGeometry(e);
+	} catch (...) {
+		elementNodes.resize(elementSize*e);
+		volumeGradients.resize(12*e);
+		elementVolumes.pop_back();
+		throw;
+	}
+	return e;
+}
+
+void ThreeDMesh::reserve(const int & nodes, const long & elements) {
+	xCoords.reserve(nodes);
+	yCoords.reserve(nodes);
+	zCoords.reserve(nodes);
+	elementNodes.reserve(elementSize*elements);
+	volumeGradients.reserve(12*elements);
+	elementVolumes.reserve(elements);
+}
+
+void ThreeDMesh::computeGeometry(const long & e) {
+	const int * ids = &elementNodes[elementSize*e];
+	double x0 = xCoords[ids[0]], y0 = yCoords[ids[0]], z0 = zCoords[ids[0]];
+	// The columns of the Jacobian are the edges from the first corner
+	double d[3][3];
+	for (int a = 0; a < 3; a++) {
+		d[a][0] = xCoords[ids[a+1]] - x0;
+		d[a][1] = yCoords[ids[a+1]] - y0;
+		d[a][2] = zCoords[ids[a+1]] - z0;
+	}
+	// The rows of its inverse are the gradients of L2, L3 and L4, which are
+	// the cross products of the other two edges over the determinant.
+	double cross[3][3];
+	for (int a = 0; a < 3; a++) {
+		const double * u = d[(a+1)%3], * v = d[(a+2)%3];
+		cross[a][0] = u[1]*v[2] - u[2]*v[1];
+		cross[a][1] = u[2]*v[0] - u[0]*v[2];
+		cross[a][2] = u[0]*v[1] - u[1]*v[0];
+	}
+	double det = d[0][0]*cross[0][0] + d[0][1]*cross[0][1]
+			+ d[0][2]*cross[0][2];
+	// The determinant is at most the product of the edge lengths, so a
+	// small ratio is a flat element. The factors are only written if the
+	// element is valid.
+	double lengths = 1.0;
+	for (int a = 0; a < 3; a++) {
+		lengths *= sqrt(d[a][0]*d[a][0] + d[a][1]*d[a][1] + d[a][2]*d[a][2]);
+	}
+	if (!(det > 1.0e-12*lengths)) {
+		throw runtime_error("Tetrahedron " + to_string(e)
+				+ " is degenerate or inverted.");
+	}
+	double * g = &volumeGradients[12*e];
+	for (int a = 0; a < 3; a++) {
+		for (int k = 0; k < 3; k++) g[3*(a+1)+k] = cross[a][k]/det;
+	}
+	// The volume coordinates sum to one, so their gradients sum to zero.
+	for (int k = 0; k < 3; k++) g[k] = -(g[3+k] + g[6+k] + g[9+k]);
+	elementVolumes[e] = det/6.0;
+}
+
+void ThreeDMesh::computeGeometry() {
+	for (long e = 0; e < numElements(); e++) computeGeometry(e);
+}
+
+void ThreeDMesh::renumberNodes(const vector<int> & order) {
+	if ((int) order.size() != numNodes()) {
+		throw runtime_error("Order is not a permutation.");
+	}
+	vector<int> newIds = inversePermutation(order);
+	reorder(xCoords, order, 1);
+	reorder(yCoords, order, 1);
+	reorder(zCoords, order, 1);
+	for (auto & id : elementNodes) id = newIds[id];
+}
+
+void ThreeDMesh::reorderElements(const vector<long> & order) {
+	checkOrder(order, numElements());
+	reorder(elementNodes, order, elementSize);
+	reorder(volumeGradients, order, 12);
+	reorder(elementVolumes, order, 1);
+}
+
+long ThreeDMesh::memoryUsage() const {
+	return (xCoords.size() + yCoords.size() + zCoords.size()
+			+ volumeGradients.size() + elementVolumes.size())*sizeof(double)
+			+ elementNodes.size()*sizeof(int);
+}
+
+ThreeDMesh ThreeDMesh::box(const int & nx, const int & ny, const int & nz,
+		const double & width, const double & height, const double & depth,
+		const int & nodesPerElement) {
+	if (nx < 1 || ny < 1 || nz < 1) {
+		throw runtime_error("Box mesh needs at least one cube.");
+	}
+	ThreeDMesh mesh(nodesPerElement);
+	long numCubes = (long) nx*ny*nz;
+	int numCorners = (nx+1)*(ny+1)*(nz+1);
+	mesh.reserve((nodesPerElement == 4) ? numCorners : 8*numCorners,
+			6*numCubes);
+	for (int k = 0; k <= nz; k++) {
+		for (int j = 0; j <= ny; j++) {
+			for (int i = 0; i <= nx; i++) {
+				mesh.addNode(width*i/nx, height*j/ny, depth*k/nz);
+			}
+		}
+	}
+	// Each tetrahedron walks from the lower to the upper corner of the cube
+	// along the axes in a different order. The odd orders are flipped so
+	// that all of the volumes are positive.
+	const int axes[6][3] = {{0,1,2}, {1,2,0}, {2,0,1}, {0,2,1}, {2,1,0},
+			{1,0,2}};
+	const int stride[3] = {1, nx+1, (nx+1)*(ny+1)};
+	// The local corners of the Tet10 edges in Warp3D order
+	const int edges[6][2] = {{0,1}, {1,2}, {2,0}, {0,3}, {1,3}, {2,3}};
+	map<pair<int,int>,int> midsideNodes;
+	vector<int> nodes(nodesPerElement);
+	for (int k = 0; k < nz; k++) {
+		for (int j = 0; j < ny; j++) {
+			for (int i = 0; i < nx; i++) {
+				int lower = (k*(ny+1) + j)*(nx+1) + i;
+				for (int t = 0; t < 6; t++) {
+					nodes[0] = lower;
+					nodes[1] = nodes[0] + stride[axes[t][0]];
+					nodes[2] = nodes[1] + stride[axes[t][1]];
+					nodes[3] = nodes[2] + stride[axes[t][2]];
+					if (t > 2) swap(nodes[1], nodes[2]);
+					for (int m = 4; m < nodesPerElement; m++) {
+						int a = nodes[edges[m-4][0]], b = nodes[edges[m-4][1]];
+						auto key = make_pair(min(a,b), max(a,b));
+						auto found = midsideNodes.find(key);
+						if (found == midsideNodes.end()) {
+							auto & x = mesh.xCoords, & y = mesh.yCoords,
+									& z = mesh.zCoords;
+							int id = mesh.addNode(0.5*(x[a] + x[b]),
+									0.5*(y[a] + y[b]), 0.5*(z[a] + z[b]));
+							found = midsideNodes.insert(make_pair(key, id)).first;
+						}
+						nodes[m] = found->second;
+					}
+					mesh.addElement(nodes);
+				}
+			}
+		}
+	}
+	return mesh;
+}
+
+/**
+ * This class holds the text of a file. It is memory mapped where the
+ * platform supports it, so large files are paged in by the threads that
+ * parse them instead of being copied, and read into memory otherwise.
+ */
+class Warp3DFile {
+
+	/**
+	 * The text and its length.
+	 */
+	const char * text = nullptr;
+	size_t length = 0;
+
+	/**
+	 * The mapping, which is null if the file was read into the buffer.
+	 */
+	void * mapping = nullptr;
+	string buffer;
+
+public:
+
+	Warp3DFile(const string & fileName) {
+#ifdef FIRE_WARP3D_MMAP
+		int descriptor = open(fileName.c_str(), O_RDONLY);
+		if (descriptor < 0) {
+			throw runtime_error("Unable to open Warp3D file " + fileName + ".");
+		}
+		struct stat info;
+		if (fstat(descriptor, &info) == 0 && S_ISREG(info.st_mode)
+				&& info.st_size > 0) {
+			void * address = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE,
+					descriptor, 0);
+			if (address != MAP_FAILED) {
+				mapping = address;
+				length = info.st_size;
+				text = (const char *) address;
+				madvise(address, length, MADV_WILLNEED);
+			}
+		}
+		close(descriptor);
+		if (mapping) return;
+#endif
+		ifstream stream(fileName, ios::binary);
+		if (!stream) {
+			throw runtime_error("Unable to open Warp3D file " + fileName + ".");
+		}
+		buffer.assign(istreambuf_iterator<char>(stream),
+				istreambuf_iterator<char>());
+		text = buffer.data();
+		length = buffer.size();
+	}
+
+	~Warp3DFile() {
+#ifdef FIRE_WARP3D_MMAP
+		if (mapping) munmap(mapping, length);
+#endif
+	}
+
+	Warp3DFile(const Warp3DFile &) = delete;
+	Warp3DFile & operator=(const Warp3DFile &) = delete;
+
+	const char * begin() const { return text;};
+	const char * end() const { return text + length;};
+};
+
+/**
+ * The kinds of lines in a Warp3D file.
+ */
+enum class Warp3DLine {BLANK, COMMENT, DATA, COORDINATES, INCIDENCES, OTHER};
+
+/**
+ * This operation returns true for the characters that separate the fields
+ * of a line.
+ */
+static inline bool isSeparator(const char & c) {
+	return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+/**
+ * This operation returns the end of the line that starts at line, which is
+ * its newline or the end of the text.
+ */
+static inline const char * lineEnd(const char * line, const char * end) {
+	const char * newline = (const char *) memchr(line, '\n', end - line);
+	return newline ? newline : end;
+}
+
+/**
+ * This operation classifies a line by its first field. Comments start with
+ * "c", "!" or "*", data starts with a digit and anything else starts a new
+ * block.
+ */
+static Warp3DLine classify(const char * line, const char * end) {
+	while (line < end && isSeparator(*line)) line++;
+	if (line == end) return Warp3DLine::BLANK;
+	const char * last = line;
+	while (last < end && !isSeparator(*last)) last++;
+	long size = last - line;
+	if ((size == 1 && (*line == 'c' || *line == 'C')) || *line == '!'
+			|| *line == '*') {
+		return Warp3DLine::COMMENT;
+	}
+	if (isdigit((unsigned char) *line)) return Warp3DLine::DATA;
+	string word(line, last);
+	for (auto & letter : word) letter = tolower(letter);
+	return (word == "coordinates") ? Warp3DLine::COORDINATES :
+			(word == "incidences") ? Warp3DLine::INCIDENCES : Warp3DLine::OTHER;
+}
+
+/**
+ * This operation returns true if only separators are left before the end
+ * of a line.
+ */
+static inline bool atLineEnd(const char * p, const char * end) {
+	while (p < end && isSeparator(*p)) p++;
+	return p == end;
+}
+
+/**
+ * This operation splits the text between begin and end into at most
+ * numChunks chunks of whole lines.
+ * @return the numChunks + 1 or fewer bounds of the chunks
+ */
+static vector<const char *> splitLines(const char * begin, const char * end,
+		const long & numChunks) {
+	vector<const char *> bounds(1, begin);
+	for (long k = 1; k < numChunks; k++) {
+		const char * split = begin + ((end - begin)*k)/numChunks;
+		if (split < bounds.back()) continue;
+		split = lineEnd(split, end);
+		if (split < end) split++;
+		if (split > bounds.back() && split < end) bounds.push_back(split);
+	}
+	bounds.push_back(end);
+	return bounds;
+}
+
+/**
+ * This operation parses a nonnegative integer field and moves the position
+ * past it.
+ * @return true if a field was parsed, false otherwise
+ */
+static inline bool parseField(const char * & p, const char * end,
+		long & value) {
+	while (p < end && isSeparator(*p)) p++;
+	if (p == end || !isdigit((unsigned char) *p)) return false;
+	value = 0;
+	while (p < end && isdigit((unsigned char) *p)) value = 10*value + (*p++ - '0');
+	return p == end || isSeparator(*p);
+}
+
+/**
+ * This operation parses a floating point field and moves the position past
+ * it. Decimals with up to 15 significant digits and a power of ten up to 22,
+ * which covers what the exporters write, are converted with one exact
+ * multiplication or division, which is correctly rounded. Everything else
+ * is converted by strtod().
+ * @return true if a field was parsed, false otherwise
+ */
+static bool parseField(const char * & p, const char * end, double & value) {
+	static const double powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+			1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18,
+			1e19, 1e20, 1e21, 1e22};
+	while (p < end && isSeparator(*p)) p++;
+	const char * start = p;
+	bool negative = (p < end && *p == '-');
+	if (p < end && (*p == '-' || *p == '+')) p++;
+	unsigned long long mantissa = 0;
+	int digits = 0, exponent = 0;
+	bool any = false;
+	while (p < end && isdigit((unsigned char) *p)) {
+		if (digits > 0 || *p != '0') digits++;
+		if (digits <= 19) mantissa = 10*mantissa + (*p - '0');
+		else exponent++;
+		p++;
+		any = true;
+	}
+	if (p < end && *p == '.') {
+		p++;
+		while (p < end && isdigit((unsigned char) *p)) {
+			if (digits > 0 || *p != '0') digits++;
+			if (digits <= 19) {
+				mantissa = 10*mantissa + (*p - '0');
+				exponent--;
+			}
+			p++;
+			any = true;
+		}
+	}
+	if (!any) return false;
+	if (p < end && (*p == 'e' || *p == 'E')) {
+		p++;
+		bool negativeExponent = (p < end && *p == '-');
+		if (p < end && (*p == '-' || *p == '+')) p++;
+		if (p == end || !isdigit((unsigned char) *p)) return false;
+		int power = 0;
+		while (p < end && isdigit((unsigned char) *p)) {
+			if (power < 10000) power = 10*power + (*p - '0');
+			p++;
+		}
+		exponent += negativeExponent ? -power : power;
+	}
+	if (p < end && !isSeparator(*p)) return false;
+	if (digits <= 15 && exponent >= -22 && exponent <= 22) {
+		value = (double) mantissa;
+		value = (exponent < 0) ? value/powers[-exponent] :
+				value*powers[exponent];
+		if (negative) value = -value;
+	} else {
+		// The field is not terminated in the text, so it is copied
+		string field(start, p);
+		value = strtod(field.c_str(), nullptr);
+	}
+	return true;
+}
+
+ThreeDMesh ThreeDMesh::parseWarp3D(const char * begin, const char * end,
+		ThreadPool & pool) {
+
+	// The chunks are large enough to amortize the tasks but there are
+	// several per thread to balance the load
+	const long chunkSize = 1L << 16;
+	auto numChunks = [&](const char * first, const char * last) {
+		return max(1L, min((long) (last - first)/chunkSize + 1,
+				4L*pool.size()));
+	};
+	auto lineNumber = [&](const char * position) {
+		return to_string(count(begin, position, '\n') + 1);
+	};
+
+	// Find the lines that start blocks in parallel
+	struct Block {
+		Warp3DLine type;
+		const char * begin;
+		const char * end;
+	};
+	auto bounds = splitLines(begin, end, numChunks(begin, end));
+	long numTextChunks = bounds.size() - 1;
+	vector<vector<Block>> chunkKeywords(numTextChunks);
+	pool.parallelFor(0, numTextChunks, [&](const long & first,
+			const long & last) {
+		for (long k = first; k < last; k++) {
+			for (const char * line = bounds[k]; line < bounds[k+1];) {
+				const char * next = lineEnd(line, bounds[k+1]);
+				Warp3DLine type = classify(line, next);
+				if (type == Warp3DLine::COORDINATES
+						|| type == Warp3DLine::INCIDENCES
+						|| type == Warp3DLine::OTHER) {
+					chunkKeywords[k].push_back({type, line, next});
+				}
+				line = next + 1;
+			}
+		}
+	}, readerGrain);
+
+	// The blocks run from the line after each keyword to the next keyword.
+	// They are split into chunks of whole lines and the data lines of each
+	// chunk are counted in parallel, which gives the index of the first
+	// node or element in each chunk.
+	vector<Block> keywords;
+	for (auto & found : chunkKeywords) {
+		keywords.insert(keywords.end(), found.begin(), found.end());
+	}
+	vector<Block> chunks;
+	for (long k = 0; k < (long) keywords.size(); k++) {
+		if (keywords[k].type == Warp3DLine::OTHER) continue;
+		const char * first = (keywords[k].end < end) ? keywords[k].end + 1 : end;
+		const char * last = (k + 1 < (long) keywords.size()) ?
+				keywords[k+1].begin : end;
+		auto blockBounds = splitLines(first, last, numChunks(first, last));
+		for (long c = 0; c + 1 < (long) blockBounds.size(); c++) {
+			chunks.push_back({keywords[k].type, blockBounds[c],
+				blockBounds[c+1]});
+		}
+	}
+	long numChunksTotal = chunks.size();
+	vector<long> firstIds(numChunksTotal, 0);
+	pool.parallelFor(0, numChunksTotal, [&](const long & first,
+			const long & last) {
+		for (long k = first; k < last; k++) {
+			long lines = 0;
+			for (const char * line = chunks[k].begin; line < chunks[k].end;) {
+				const char * next = lineEnd(line, chunks[k].end);
+				if (classify(line, next) == Warp3DLine::DATA) lines++;
+				line = next + 1;
+			}
+			firstIds[k] = lines;
+		}
+	}, readerGrain);
+	long numNodes = 0, numElements = 0;
+	const char * firstIncidence = nullptr;
+	for (long k = 0; k < numChunksTotal; k++) {
+		long & total = (chunks[k].type == Warp3DLine::COORDINATES) ?
+				numNodes : numElements;
+		long lines = firstIds[k];
+		firstIds[k] = total;
+		total += lines;
+		if (!firstIncidence && lines > 0
+				&& chunks[k].type == Warp3DLine::INCIDENCES) {
+			firstIncidence = chunks[k].begin;
+		}
+	}
+	if (numElements == 0) {
+		throw runtime_error("Warp3D file has no incidences.");
+	}
+
+	// The number of nodes per element is taken from the first incidence
+	while (classify(firstIncidence, lineEnd(firstIncidence, end))
+			!= Warp3DLine::DATA) {
+		firstIncidence = lineEnd(firstIncidence, end) + 1;
+	}
+	int size = 0;
+	long field;
+	for (const char * p = firstIncidence, * last = lineEnd(p, end);
+			parseField(p, last, field);) size++;
+	size--;
+	if (size != 4 && size != 10) {
+		throw runtime_error("Malformed Warp3D incidence on line "
+				+ lineNumber(firstIncidence) + ".");
+	}
+
+	// Parse the chunks directly into the arrays. Errors are recorded by
+	// position so that the first one in the file is reported whichever
+	// thread finds it.
+	ThreeDMesh mesh(size);
+	mesh.xCoords.resize(numNodes);
+	mesh.yCoords.resize(numNodes);
+	mesh.zCoords.resize(numNodes);
+	mesh.elementNodes.resize(size*numElements);
+	mesh.volumeGradients.resize(12*numElements);
+	mesh.elementVolumes.resize(numElements);
+	vector<const char *> errors(numChunksTotal, nullptr);
+	pool.parallelFor(0, numChunksTotal, [&](const long & first,
+			const long & last) {
+		for (long k = first; k < last; k++) {
+			bool coordinates = (chunks[k].type == Warp3DLine::COORDINATES);
+			long index = firstIds[k];
+			for (const char * line = chunks[k].begin;
+					line < chunks[k].end && !errors[k];) {
+				const char * next = lineEnd(line, chunks[k].end);
+				if (classify(line, next) == Warp3DLine::DATA) {
+					const char * p = line;
+					long id;
+					bool valid = parseField(p, next, id) && id == index + 1;
+					if (coordinates) {
+						valid = valid && parseField(p, next, mesh.xCoords[index])
+								&& parseField(p, next, mesh.yCoords[index])
+								&& parseField(p, next, mesh.zCoords[index])
+								&& atLineEnd(p, next);
+					} else {
+						int * ids = &mesh.elementNodes[size*index];
+						int a = 0;
+						long node;
+						for (; valid && parseField(p, next, node); a++) {
+							valid = (a < size && node >= 1 && node <= numNodes);
+							if (valid) ids[a] = node - 1;
+						}
+						valid = valid && (a == size) && atLineEnd(p, next);
+						for (int b = 0; valid && b < 4; b++) {
+							for (int c = b + 1; c < 4; c++) {
+								valid = valid && (ids[b] != ids[c]);
+							}
+						}
+					}
+					if (!valid) errors[k] = line;
+					index++;
+				}
+				line = next + 1;
+			}
+		}
+	}, readerGrain);
+	for (long k = 0; k < numChunksTotal; k++) {
+		if (errors[k]) {
+			string type = (chunks[k].type == Warp3DLine::COORDINATES) ?
+					"coordinate" : "incidence";
+			throw runtime_error("Malformed Warp3D " + type + " on line "
+					+ lineNumber(errors[k]) + ".");
+		}
+	}
+
+	pool.parallelFor(0, numElements, [&](const long & first,
+			const long & last) {
+		for (long e = first; e < last; e++) mesh.computeGeometry(e);
+	}, readerGrain);
+	return mesh;
+}
+
+ThreeDMesh ThreeDMesh::readWarp3D(istream & stream, ThreadPool & pool) {
+	string text((istreambuf_iterator<char>(stream)),
+			istreambuf_iterator<char>());
+	return parseWarp3D(text.data(), text.data() + text.size(), pool);
+}
+
+ThreeDMesh ThreeDMesh::readWarp3D(const string & fileName, ThreadPool & pool) {
+	Warp3DFile file(fileName);
+	return parseWarp3D(file.begin(), file.end(), pool);
+}
+
+} /* namespace fire */
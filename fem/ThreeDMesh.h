@@ -0,0 +1,310 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#ifndef FEM_THREEDMESH_H_
+#define FEM_THREEDMESH_H_
+
+#include <vector>
+#include <string>
+#include <istream>
+#include <ThreadPool.h>
+
+namespace fire {
+
+/**
+ * This class is a three dimensional tetrahedral mesh stored as a structure
+ * of arrays, like TwoDMesh. It holds either linear tetrahedra with four
+ * nodes (Tet4) or quadratic tetrahedra with ten nodes (Tet10). The node
+ * coordinates, the element connectivity and the geometric factors of each
+ * element - its volume and the gradients of its four volume coordinates -
+ * are each held in a single contiguous array.
+ *
+ * The nodes of each element follow the Warp3D ordering that the ganjiang
+ * ExportTet4.py and ExportTet10.py scripts write: the four corners first
+ * and, for Tet10, the midside nodes of the edges 1-2, 2-3, 3-1, 1-4, 2-4 and
+ * 3-4 after them. The geometric factors only depend on the corners, so the
+ * quadratic elements are treated as straight sided (sub-parametric).
+ *
+ * A Tet4 mesh takes 120 bytes per element and 24 bytes per node, so the
+ * millions of tetrahedra in a welding model fit in a few hundred MB.
+ * @code
+ * ThreeDMesh mesh = ThreeDMesh::readWarp3D("cube_tet10.inp");
+ * double total = 0.0;
+ * for (long e = 0; e < mesh.numElements(); e++) total += mesh.volumes()[e];
+ * @endcode
+ *
+ * Meshes are built by adding nodes and elements, with box(), or by reading
+ * a Warp3D input file. The geometric factors are computed when elements are
+ * added and must be recomputed with computeGeometry() if the coordinates
+ * change.
+ */
+class ThreeDMesh {
+
+protected:
+
+	/**
+	 * The number of nodes in each element, 4 or 10.
+	 */
+	int elementSize;
+
+	/**
+	 * The x coordinates of the nodes.
+	 */
+	std::vector<double> xCoords;
+
+	/**
+	 * The y coordinates of the nodes.
+	 */
+	std::vector<double> yCoords;
+
+	/**
+	 * The z coordinates of the nodes.
+	 */
+	std::vector<double> zCoords;
+
+	/**
+	 * The global node ids of the elements, elementSize per element.
+	 */
+	std::vector<int> elementNodes;
+
+	/**
+	 * The gradients of the four volume coordinates of the elements, twelve
+	 * per element ordered as (dL1/dx, dL1/dy, dL1/dz, dL2/dx, ...).
+	 */
+	std::vector<double> volumeGradients;
+
+	/**
+	 * The volumes of the elements.
+	 */
+	std::vector<double> elementVolumes;
+
+	/**
+	 * This operation computes the geometric factors of one element. An
+	 * exception is thrown without changing them if the element is
+	 * degenerate or inverted.
+	 */
+	void computeGeometry(const long & e);
+
+	/**
+	 * This operation parses the text of a Warp3D input file. See
+	 * readWarp3D().
+	 * @param begin the first character of the text
+	 * @param end one past the last character of the text
+	 * @param pool the threads used to parse the blocks
+	 * @return the mesh
+	 */
+	static ThreeDMesh parseWarp3D(const char * begin, const char * end,
+			ThreadPool & pool);
+
+	/**
+	 * The minimum number of iterations per thread when a Warp3D file is
+	 * read. The chunks of a file are few and large, so the loops are split
+	 * over as few as one chunk per thread.
+	 */
+	static const long readerGrain = 1;
+
+public:
+
+	/**
+	 * The constructor
+	 * @param nodesPerElement the number of nodes in each element, which must
+	 * be 4 for linear or 10 for quadratic tetrahedra
+	 */
+	ThreeDMesh(const int & nodesPerElement = 4);
+
+	/**
+	 * This operation adds a node to the mesh.
+	 * @param x the x coordinate
+	 * @param y the y coordinate
+	 * @param z the z coordinate
+	 * @return the id of the node
+	 */
+	int addNode(const double & x, const double & y, const double & z);
+
+	/**
+	 * This operation adds an element to the mesh and computes its geometric
+	 * factors. An exception is thrown and the element is not added if the
+	 * number of node ids is wrong, if the ids are not in the mesh, if the
+	 * corners are not distinct or if the element is degenerate or inverted
+	 * (see volumes()).
+	 * @param nodes the ids of the nodes in Warp3D order
+	 * @return the index of the element
+	 */
+	long addElement(const std::vector<int> & nodes);
+
+	/**
+	 * This operation reserves memory for the given numbers of nodes and
+	 * elements.
+	 */
+	void reserve(const int & nodes, const long & elements);
+
+	/**
+	 * This operation recomputes the geometric factors of all elements, which
+	 * is required after the coordinates change.
+	 * @throw std::runtime_error if an element is degenerate or inverted
+	 */
+	void computeGeometry();
+
+	/**
+	 * This operation returns the number of nodes in each element.
+	 */
+	int nodesPerElement() const { return elementSize;};
+
+	/**
+	 * This operation returns the number of nodes.
+	 */
+	int numNodes() const { return xCoords.size();};
+
+	/**
+	 * This operation returns the number of elements.
+	 */
+	long numElements() const { return elementVolumes.size();};
+
+	/**
+	 * The x coordinates of the nodes, which may be modified as long as
+	 * computeGeometry() is called afterwards.
+	 */
+	std::vector<double> & x() { return xCoords;};
+	const std::vector<double> & x() const { return xCoords;};
+
+	/**
+	 * The y coordinates of the nodes, which may be modified as long as
+	 * computeGeometry() is called afterwards.
+	 */
+	std::vector<double> & y() { return yCoords;};
+	const std::vector<double> & y() const { return yCoords;};
+
+	/**
+	 * The z coordinates of the nodes, which may be modified as long as
+	 * computeGeometry() is called afterwards.
+	 */
+	std::vector<double> & z() { return zCoords;};
+	const std::vector<double> & z() const { return zCoords;};
+
+	/**
+	 * The node ids of the elements, nodesPerElement() per element.
+	 */
+	const std::vector<int> & connectivity() const { return elementNodes;};
+
+	/**
+	 * The gradients of the volume coordinates, twelve per element.
+	 */
+	const std::vector<double> & gradients() const { return volumeGradients;};
+
+	/**
+	 * The volumes of the elements. The fourth corner of each element must be
+	 * on the side of the first three that their right-handed normal points
+	 * to, so the volumes are positive.
+	 */
+	const std::vector<double> & volumes() const { return elementVolumes;};
+
+	/**
+	 * This operation renumbers the nodes, for example with an order from
+	 * MeshOrdering.h. The coordinates are moved and the connectivity is
+	 * rewritten, so the geometric factors do not change.
+	 * @param order the new order, where order[k] is the current id of the
+	 * node that becomes node k. An exception is thrown if it is not a
+	 * permutation of the nodes.
+	 */
+	void renumberNodes(const std::vector<int> & order);
+
+	/**
+	 * This operation reorders the elements, for example with an order from
+	 * MeshOrdering.h, moving their connectivity and geometric factors.
+	 * @param order the new order, where order[k] is the current index of the
+	 * element that becomes element k. An exception is thrown if it is not a
+	 * permutation of the elements.
+	 */
+	void reorderElements(const std::vector<long> & order);
+
+	/**
+	 * This operation returns the number of bytes used by the mesh's arrays.
+	 * @return the size of the data in bytes
+	 */
+	long memoryUsage() const;
+
+	/**
+	 * This operation creates a structured mesh of the box
+	 * [0,width]x[0,height]x[0,depth] with nx by ny by nz cubes, each split
+	 * into six tetrahedra that share its diagonal from the lower corner.
+	 * Corner node (i,j,k) has id (k*(ny+1) + j)*(nx+1) + i. The midside
+	 * nodes of quadratic meshes are numbered after the corners.
+	 * @param nx the number of cubes along x
+	 * @param ny the number of cubes along y
+	 * @param nz the number of cubes along z
+	 * @param width the size of the box along x
+	 * @param height the size of the box along y
+	 * @param depth the size of the box along z
+	 * @param nodesPerElement 4 for linear or 10 for quadratic tetrahedra
+	 * @return the mesh
+	 */
+	static ThreeDMesh box(const int & nx, const int & ny, const int & nz,
+			const double & width = 1.0, const double & height = 1.0,
+			const double & depth = 1.0, const int & nodesPerElement = 4);
+
+	/**
+	 * This operation reads the coordinates and incidences blocks of a Warp3D
+	 * input file such as those written by ganjiang's ExportTet4.py and
+	 * ExportTet10.py. Comment lines that start with "c", "!" or "*" and
+	 * other blocks are skipped. Node and element ids are one-based in the
+	 * file and zero-based in the mesh. The number of nodes per element is
+	 * taken from the first incidence. An exception is thrown if the file can
+	 * not be read, if a line is malformed or has fields after the expected
+	 * ones, or if the ids are not contiguous. The error gives the line. The
+	 * stream is read into memory and parsed like a file (see
+	 * readWarp3D(const std::string &, ThreadPool &)).
+	 * @param stream the stream to read
+	 * @param pool the threads used to parse the blocks
+	 * @return the mesh
+	 */
+	static ThreeDMesh readWarp3D(std::istream & stream,
+			ThreadPool & pool = ThreadPool::shared());
+
+	/**
+	 * This operation reads a Warp3D input file. The file is memory mapped
+	 * where the platform supports it, so it is never copied. The lines of
+	 * each block are split into chunks that are counted and then parsed in
+	 * parallel directly into the coordinate and connectivity arrays, with
+	 * a number conversion that is exact and avoids strtod() for the short
+	 * decimals that the exporters write, and the geometry of the elements
+	 * is computed in parallel.
+	 * @param fileName the name of the file
+	 * @param pool the threads used to parse the blocks
+	 * @return the mesh
+	 */
+	static ThreeDMesh readWarp3D(const std::string & fileName,
+			ThreadPool & pool = ThreadPool::shared());
+
+};
+
+} /* namespace fire */
+
+#endif /* FEM_THREEDMESH_H_ */
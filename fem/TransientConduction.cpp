@@ -0,0 +1,298 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+
+// See the header file for API documentation
+
+#include <TransientConduction.h>
+#include <CSTBatchStiffness.h>
+#include <stdexcept>
+#include <utility>
+#include <math.h>
+
+using namespace std;
+
+namespace fire {
+
+TransientConduction::TransientConduction(const TwoDMesh & mesh,
+		const double & conductivity, const double & heatCapacity,
+		const double & heatSource, const MassMatrixType & type,
+		ThreadPool & pool) : numNodes(mesh.numNodes()), massType(type),
+		lumpedMass(numNodes, 0.0), source(numNodes, 0.0),
+		temperatures(numNodes, 0.0), rates(numNodes, 0.0),
+		fixed(numNodes, false), fixedTemperatures(numNodes, 0.0),
+		work(numNodes), lifting(numNodes) {
+
+	// Every pair of nodes in an element couples
+	auto & ids = mesh.connectivity();
+	long numElements = mesh.numElements();
+	vector<pair<int,int>> entries;
+	entries.reserve(9*numElements);
+	for (long e = 0; e < numElements; e++) {
+		for (int i = 0; i < 3; i++) {
+			for (int j = 0; j < 3; j++) {
+				entries.push_back(make_pair(ids[3*e+i],ids[3*e+j]));
+			}
+		}
+	}
+	stiffness = CSRMatrix<double>(numNodes, entries);
+	mass = stiffness;
+
+	// Compute the element stiffness matrices and assemble everything
+	CSTBatchStiffness batch(mesh, pool);
+	batch.compute(conductivity);
+	auto & areas = batch.areas();
+	for (long e = 0; e < numElements; e++) {
+		double area = fabs(areas[e]);
+		for (int i = 0; i < 3; i++) {
+			int row = ids[3*e+i];
+			for (int j = 0; j < 3; j++) {
+				long slot = stiffness.slot(row,ids[3*e+j]);
+				stiffness.values[slot] += batch.stiffness(e,i,j);
+				mass.values[slot] += heatCapacity*area*((i == j) ? 2.0 : 1.0)
+						/12.0;
+			}
+			lumpedMass[row] += heatCapacity*area/3.0;
+			source[row] += heatSource*area/3.0;
+		}
+	}
+}
+
+void TransientConduction::invalidateFactors() {
+	massFactors = SkylineCholesky();
+	stepFactors = SkylineCholesky();
+	jacobianMatrix = CSRMatrix<double>();
+}
+
+CSRMatrix<double> TransientConduction::eliminateFixed(
+		const CSRMatrix<double> & matrix) const {
+	CSRMatrix<double> eliminated(matrix);
+	for (int i = 0; i < numNodes; i++) {
+		for (long k = matrix.rowOffsets[i]; k < matrix.rowOffsets[i+1]; k++) {
+			int j = matrix.columns[k];
+			if (fixed[i] || fixed[j]) {
+				eliminated.values[k] = (i == j) ? 1.0 : 0.0;
+			}
+		}
+	}
+	return eliminated;
+}
+
+void TransientConduction::fixTemperature(const int & node,
+		const double & value) {
+	if (node < 0 || node >= numNodes) {
+		throw out_of_range("Node is not in the mesh.");
+	}
+	if (!fixed[node]) {
+		fixed[node] = true;
+		invalidateFactors();
+	}
+	fixedTemperatures[node] = value;
+	temperatures[node] = value;
+}
+
+void TransientConduction::fixBoundaryTemperature(const TwoDMesh & mesh,
+		const int & marker, const double & value) {
+	auto & edges = mesh.boundaryEdges();
+	auto & markers = mesh.boundaryMarkers();
+	for (long k = 0; k < (long) markers.size(); k++) {
+		if (markers[k] == marker) {
+			fixTemperature(edges[2*k], value);
+			fixTemperature(edges[2*k+1], value);
+		}
+	}
+}
+
+void TransientConduction::temperature(const double & value) {
+	for (int i = 0; i < numNodes; i++) {
+		temperatures[i] = fixed[i] ? fixedTemperatures[i] : value;
+	}
+}
+
+void TransientConduction::computeRates(const double * u, double * dudt) {
+
+	// The net heat flow into each node, f - Ku
+	for (int i = 0; i < numNodes; i++) {
+		double sum = source[i];
+		for (long k = stiffness.rowOffsets[i]; k < stiffness.rowOffsets[i+1];
+				k++) {
+			sum -= stiffness.values[k]*u[stiffness.columns[k]];
+		}
+		work[i] = fixed[i] ? 0.0 : sum;
+	}
+
+	// Divide by the mass
+	if (massType == MassMatrixType::LUMPED) {
+		for (int i = 0; i < numNodes; i++) dudt[i] = work[i]/lumpedMass[i];
+	} else {
+		if (!massFactors.factored()) massFactors.factor(eliminateFixed(mass));
+		massFactors.solve(work, work);
+		for (int i = 0; i < numNodes; i++) dudt[i] = work[i];
+	}
+
+	return;
+}
+
+void TransientConduction::jacobianVectorProduct(const double * v,
+		double * jv) {
+
+	// -Kv with zero rows for the fixed nodes
+	for (int i = 0; i < numNodes; i++) {
+		double sum = 0.0;
+		for (long k = stiffness.rowOffsets[i]; k < stiffness.rowOffsets[i+1];
+				k++) {
+			sum -= stiffness.values[k]*v[stiffness.columns[k]];
+		}
+		work[i] = fixed[i] ? 0.0 : sum;
+	}
+
+	if (massType == MassMatrixType::LUMPED) {
+		for (int i = 0; i < numNodes; i++) jv[i] = work[i]/lumpedMass[i];
+	} else {
+		if (!massFactors.factored()) massFactors.factor(eliminateFixed(mass));
+		massFactors.solve(work, work);
+		for (int i = 0; i < numNodes; i++) jv[i] = work[i];
+	}
+
+	return;
+}
+
+void TransientConduction::jacobianDiagonal(double * diag) const {
+	for (int i = 0; i < numNodes; i++) {
+		diag[i] = fixed[i] ? 0.0 : -stiffness(i,i)/lumpedMass[i];
+	}
+}
+
+const CSRMatrix<double> & TransientConduction::jacobian() {
+	if (massType != MassMatrixType::LUMPED) {
+		throw logic_error("The Jacobian is dense for a consistent mass matrix.");
+	}
+	if (jacobianMatrix.size() != numNodes) {
+		jacobianMatrix = stiffness;
+		for (int i = 0; i < numNodes; i++) {
+			for (long k = stiffness.rowOffsets[i];
+					k < stiffness.rowOffsets[i+1]; k++) {
+				jacobianMatrix.values[k] = fixed[i] ? 0.0
+						: -stiffness.values[k]/lumpedMass[i];
+			}
+		}
+	}
+	return jacobianMatrix;
+}
+
+void TransientConduction::step(const double & dt, const double & theta) {
+
+	// Factor M + theta dt K, but only if it changed
+	if (!stepFactors.factored() || dt != factoredStep
+			|| theta != factoredTheta) {
+		stepMatrix = stiffness;
+		for (int i = 0; i < numNodes; i++) {
+			for (long k = stiffness.rowOffsets[i];
+					k < stiffness.rowOffsets[i+1]; k++) {
+				double m = (massType == MassMatrixType::LUMPED) ?
+						((stiffness.columns[k] == i) ? lumpedMass[i] : 0.0)
+						: mass.values[k];
+				stepMatrix.values[k] = m + theta*dt*stiffness.values[k];
+			}
+		}
+		stepFactors.factor(eliminateFixed(stepMatrix));
+		factoredStep = dt;
+		factoredTheta = theta;
+		numFactorizations++;
+	}
+
+	// The right hand side, (M - (1-theta) dt K)T + dt f, is (M + theta dt K)T
+	// - dt(KT - f)
+	for (int i = 0; i < numNodes; i++) {
+		if (fixed[i]) temperatures[i] = fixedTemperatures[i];
+		lifting[i] = fixed[i] ? fixedTemperatures[i] : 0.0;
+	}
+	for (int i = 0; i < numNodes; i++) {
+		double a = 0.0, k = 0.0;
+		for (long n = stiffness.rowOffsets[i]; n < stiffness.rowOffsets[i+1];
+				n++) {
+			int j = stiffness.columns[n];
+			a += stepMatrix.values[n]*temperatures[j];
+			k += stiffness.values[n]*temperatures[j];
+		}
+		work[i] = a - dt*(k - source[i]);
+	}
+
+	// Move the known temperatures of the fixed nodes to the right hand side
+	stepMatrix.multiply(lifting, rates);
+	for (int i = 0; i < numNodes; i++) {
+		work[i] = fixed[i] ? fixedTemperatures[i] : work[i] - rates[i];
+	}
+
+	stepFactors.solve(work, temperatures);
+	currentTime += dt;
+
+	return;
+}
+
+template<>
+double * State<TransientConduction>::u() {
+	return state.temperature().data();
+}
+
+template<>
+void State<TransientConduction>::u(double * uData) {
+	auto & temperatures = state.temperature();
+	for (int i = 0; i < systemSize; i++) temperatures[i] = uData[i];
+	notifyMonitors();
+	return;
+}
+
+template<>
+double * State<TransientConduction>::dudt(const double &) {
+	// The derivatives are stored in the utility array, which is allocated on
+	// first use since the State may have been created with only its size.
+	if (!dudtArr) dudtArr = std::unique_ptr<double>(new double[systemSize]);
+	state.computeRates(state.temperature().data(), dudtArr.get());
+	return dudtArr.get();
+}
+
+template<>
+void State<TransientConduction>::jv(const double &, const double * v,
+		double * jvData) {
+	// The system is linear, so the Jacobian is exact and constant.
+	state.jacobianVectorProduct(v, jvData);
+	return;
+}
+
+template<>
+bool State<TransientConduction>::jacobianDiagonal(const double &,
+		double * diag) {
+	state.jacobianDiagonal(diag);
+	return true;
+}
+
+} /* namespace fire */
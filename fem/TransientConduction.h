@@ -0,0 +1,377 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#ifndef FEM_TRANSIENTCONDUCTION_H_
+#define FEM_TRANSIENTCONDUCTION_H_
+
+#include <vector>
+#include <TwoDMesh.h>
+#include <CSRMatrix.h>
+#include <SkylineCholesky.h>
+#include <State.h>
+#include <ThreadPool.h>
+
+namespace fire {
+
+/**
+ * This enumeration describes how the mass (capacity) matrix of a
+ * TransientConduction problem is formed. LUMPED puts the row sums of the
+ * consistent matrix on the diagonal, so the semi-discrete system is an
+ * explicit ODE with a sparse Jacobian. CONSISTENT uses the full Galerkin
+ * matrix, which is more accurate but requires a solve with the mass matrix
+ * for every evaluation of the derivatives.
+ */
+enum class MassMatrixType {LUMPED, CONSISTENT};
+
+/**
+ * This class solves transient heat conduction on a TwoDMesh of Constant
+ * Strain Triangles by the method of lines. The Galerkin discretization of
+ * \f[
+ * \rho c \frac{\partial T}{\partial t} = \nabla \cdot (\kappa \nabla T) + q
+ * \f]
+ * is the semi-discrete system
+ * \f[
+ * M\frac{d\vec{T}}{dt} = -K\vec{T} + \vec{f}
+ * \f]
+ * where K is the stiffness matrix of LaplaceCSTElement (computed with
+ * CSTBatchStiffness), M is the mass matrix with entries
+ * \f$ \rho c |A| (1 + \delta_{ij})/12 \f$ and f holds the source q|A|/3 for
+ * each node of each element. K, M and f are assembled once, when the problem
+ * is created, since they do not change for constant coefficients.
+ *
+ * Fixed (Dirichlet) temperatures are applied to nodes with fixTemperature()
+ * or to marked boundary edges of the mesh with fixBoundaryTemperature(). The
+ * derivatives of fixed nodes are zero.
+ *
+ * There are two ways to integrate the system. First, the class can be used
+ * as the type of a State, which implements u(), dudt(), jv() and
+ * jacobianDiagonal(), so any of Fire's ODE solvers can integrate it:
+ * @code
+ * TwoDMesh mesh = TwoDMesh::rectangle(50,50);
+ * TransientConduction conduction(mesh, 1.0, 1.0);
+ * conduction.fixBoundaryTemperature(mesh, 3, 100.0);
+ * State<TransientConduction> state(std::move(conduction), mesh.numNodes());
+ * RKSolver<TransientConduction> solver;
+ * ...
+ * @endcode
+ * With the lumped mass matrix, the Jacobian is the sparse matrix -M^{-1}K and
+ * is available from jacobian(). With the consistent mass matrix, the mass
+ * matrix is factored once and the factors are reused for every evaluation.
+ *
+ * Second, step() advances the system with the theta method
+ * \f[
+ * (M + \theta\Delta t K)\vec{T}^{n+1} = (M - (1-\theta)\Delta t K)\vec{T}^{n}
+ * + \Delta t\vec{f}
+ * \f]
+ * which is unconditionally stable for theta >= 1/2 (theta = 1 is backward
+ * Euler and theta = 1/2 is Crank-Nicolson). The matrix on the left is
+ * factored with SkylineCholesky the first time and reused for every step
+ * with the same time step size and theta, so a run of thousands of steps
+ * with a fixed time step costs one factorization and one pair of triangular
+ * solves per step.
+ */
+class TransientConduction {
+
+protected:
+
+	/**
+	 * The number of nodes in the mesh.
+	 */
+	int numNodes;
+
+	/**
+	 * The type of mass matrix.
+	 */
+	MassMatrixType massType;
+
+	/**
+	 * The global stiffness matrix, K.
+	 */
+	CSRMatrix<double> stiffness;
+
+	/**
+	 * The global consistent mass matrix, M.
+	 */
+	CSRMatrix<double> mass;
+
+	/**
+	 * The diagonal of the lumped mass matrix.
+	 */
+	std::vector<double> lumpedMass;
+
+	/**
+	 * The global source vector, f.
+	 */
+	std::vector<double> source;
+
+	/**
+	 * The temperatures of the nodes.
+	 */
+	std::vector<double> temperatures;
+
+	/**
+	 * The time derivatives of the temperatures from the last call to
+	 * computeRates().
+	 */
+	std::vector<double> rates;
+
+	/**
+	 * True for nodes with fixed temperatures.
+	 */
+	std::vector<bool> fixed;
+
+	/**
+	 * The fixed temperatures, which are only used for fixed nodes.
+	 */
+	std::vector<double> fixedTemperatures;
+
+	/**
+	 * The factors of the mass matrix with the fixed nodes eliminated, used
+	 * for the consistent mass matrix.
+	 */
+	SkylineCholesky massFactors;
+
+	/**
+	 * The matrix M + theta dt K of the last step and its factors with the
+	 * fixed nodes eliminated.
+	 */
+	CSRMatrix<double> stepMatrix;
+	SkylineCholesky stepFactors;
+
+	/**
+	 * The time step size and theta of the factored step matrix.
+	 */
+	double factoredStep = 0.0, factoredTheta = 0.0;
+
+	/**
+	 * The number of factorizations of the step matrix.
+	 */
+	int numFactorizations = 0;
+
+	/**
+	 * The lumped Jacobian, which is computed on first use.
+	 */
+	CSRMatrix<double> jacobianMatrix;
+
+	/**
+	 * Work vectors.
+	 */
+	std::vector<double> work, lifting;
+
+	/**
+	 * The current time.
+	 */
+	double currentTime = 0.0;
+
+	/**
+	 * This operation clears the factors and Jacobian that depend on the set
+	 * of fixed nodes.
+	 */
+	void invalidateFactors();
+
+	/**
+	 * This operation copies a matrix, replacing the rows and columns of the
+	 * fixed nodes with those of the identity so that the fixed nodes are
+	 * eliminated symmetrically.
+	 * @param matrix the matrix
+	 * @return the copy with the fixed nodes eliminated
+	 */
+	CSRMatrix<double> eliminateFixed(const CSRMatrix<double> & matrix) const;
+
+public:
+
+	/**
+	 * Constructor. This assembles the stiffness, mass and source.
+	 * @param mesh the mesh, which is not referenced after construction
+	 * @param conductivity the thermal conductivity, kappa
+	 * @param heatCapacity the volumetric heat capacity, rho*c
+	 * @param heatSource the volumetric heat source, q
+	 * @param type the type of mass matrix
+	 * @param pool the threads used to compute the element matrices
+	 */
+	TransientConduction(const TwoDMesh & mesh, const double & conductivity = 1.0,
+			const double & heatCapacity = 1.0, const double & heatSource = 0.0,
+			const MassMatrixType & type = MassMatrixType::LUMPED,
+			ThreadPool & pool = ThreadPool::shared());
+
+	/**
+	 * This operation fixes the temperature of a node. The node's temperature
+	 * is set immediately and does not change afterwards.
+	 * @param node the id of the node
+	 * @param value the temperature
+	 * @throw std::out_of_range if the node is not in the mesh
+	 */
+	void fixTemperature(const int & node, const double & value);
+
+	/**
+	 * This operation fixes the temperature of all of the nodes on the
+	 * boundary edges of a mesh with the given marker.
+	 * @param mesh the mesh used to create the problem
+	 * @param marker the marker of the boundary edges
+	 * @param value the temperature
+	 */
+	void fixBoundaryTemperature(const TwoDMesh & mesh, const int & marker,
+			const double & value);
+
+	/**
+	 * This operation returns true if the temperature of the node is fixed.
+	 * @param node the id of the node
+	 * @return true if fixed, false otherwise
+	 */
+	bool isFixed(const int & node) const { return fixed[node];};
+
+	/**
+	 * This operation returns the temperatures of the nodes, which may be
+	 * modified to set the initial conditions. Fixed temperatures are
+	 * restored by the next step.
+	 * @return the temperatures
+	 */
+	std::vector<double> & temperature() { return temperatures;};
+
+	/**
+	 * This operation sets the temperatures of all of the nodes that are not
+	 * fixed.
+	 * @param value the temperature
+	 */
+	void temperature(const double & value);
+
+	/**
+	 * This operation computes the time derivatives of the temperatures.
+	 * @param u the temperatures
+	 * @param dudt the derivatives, of size numNodes
+	 */
+	void computeRates(const double * u, double * dudt);
+
+	/**
+	 * This operation computes the product of the Jacobian and a vector. The
+	 * system is linear, so the product does not depend on the temperatures.
+	 * @param v the vector
+	 * @param jv the product
+	 */
+	void jacobianVectorProduct(const double * v, double * jv);
+
+	/**
+	 * This operation computes the diagonal of the Jacobian. It is exact for
+	 * the lumped mass matrix and uses the lumped mass matrix as an
+	 * approximation for the consistent mass matrix.
+	 * @param diag the diagonal
+	 */
+	void jacobianDiagonal(double * diag) const;
+
+	/**
+	 * This operation returns the sparse Jacobian, -M^{-1}K, with zero rows for
+	 * the fixed nodes.
+	 * @return the Jacobian
+	 * @throw std::logic_error if the mass matrix is consistent, for which the
+	 * Jacobian is dense
+	 */
+	const CSRMatrix<double> & jacobian();
+
+	/**
+	 * This operation advances the temperatures by one step of the theta
+	 * method. The step matrix is only factored if the time step size or
+	 * theta differ from the last step or the fixed nodes changed.
+	 * @param dt the time step size
+	 * @param theta the implicitness, 1/2 <= theta <= 1 for unconditional
+	 * stability
+	 */
+	void step(const double & dt, const double & theta = 1.0);
+
+	/**
+	 * This operation returns the current time, which is advanced by step().
+	 * @return the time
+	 */
+	double time() const { return currentTime;};
+
+	/**
+	 * This operation sets the current time.
+	 * @param t the time
+	 */
+	void time(const double & t) { currentTime = t;};
+
+	/**
+	 * This operation returns the number of times that the step matrix has
+	 * been factored.
+	 * @return the number of factorizations
+	 */
+	int factorizations() const { return numFactorizations;};
+
+	/**
+	 * This operation returns the global stiffness matrix.
+	 * @return K
+	 */
+	const CSRMatrix<double> & stiffnessMatrix() const { return stiffness;};
+
+	/**
+	 * This operation returns the global consistent mass matrix.
+	 * @return M
+	 */
+	const CSRMatrix<double> & massMatrix() const { return mass;};
+
+	/**
+	 * This operation returns the global source vector.
+	 * @return f
+	 */
+	const std::vector<double> & sourceVector() const { return source;};
+
+	/**
+	 * This operation returns the number of nodes.
+	 * @return the number of nodes, which is the size of the system
+	 */
+	int size() const { return numNodes;};
+
+};
+
+/**
+ * The following operations are explicit specializations for the State class
+ * so that TransientConduction can be used in the solvers. See State.h in
+ * solvers/ for more information.
+ */
+template<>
+double * State<TransientConduction>::u();
+
+template<>
+void State<TransientConduction>::u(double * uData);
+
+template<>
+double * State<TransientConduction>::dudt(const double & t);
+
+template<>
+void State<TransientConduction>::jv(const double & t, const double * v,
+		double * jvData);
+
+template<>
+bool State<TransientConduction>::jacobianDiagonal(const double & t,
+		double * diag);
+
+} /* namespace fire */
+
+#endif /* FEM_TRANSIENTCONDUCTION_H_ */
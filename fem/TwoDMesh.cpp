@@ -0,0 +1,281 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+
+// See the header file for API documentation
+
+#include <TwoDMesh.h>
+#include <EdgeIndex.h>
+#include <GraphOrdering.h>
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+namespace fire {
+
+double TwoDMeshElement::a(const int & i) const {
+	auto ids = nodeIds();
+	int j = ids[(i+1)%3], k = ids[(i+2)%3];
+	auto & x = mesh->x();
+	auto & y = mesh->y();
+	return x[j]*y[k] - x[k]*y[j];
+}
+
+CSTLocalPoint TwoDMeshElement::computeLocalPoint(const double & x,
+		const double & y) const {
+	CSTLocalPoint localPoint;
+	double twoArea = 2.0*area();
+	localPoint.first = (a(0) + b(0)*x + c(0)*y)/twoArea;
+	localPoint.second = (a(1) + b(1)*x + c(1)*y)/twoArea;
+	localPoint.third = (a(2) + b(2)*x + c(2)*y)/twoArea;
+	return localPoint;
+}
+
+int TwoDMeshElement::getLocalNodeId(const int & nodeId) const {
+	auto ids = nodeIds();
+	for (int i = 0; i < 3; i++) {
+		if (ids[i] == nodeId) return i;
+	}
+	return -1;
+}
+
+int TwoDMesh::addNode(const double & x, const double & y) {
+	xCoords.push_back(x);
+	yCoords.push_back(y);
+	return xCoords.size() - 1;
+}
+
+long TwoDMesh::addElement(const int & node1, const int & node2,
+		const int & node3) {
+	int n = numNodes();
+	if (node1 < 0 || node1 >= n || node2 < 0 || node2 >= n || node3 < 0
+			|| node3 >= n) {
+		throw out_of_range("Element node id is not in the mesh.");
+	}
+	if (node1 == node2 || node2 == node3 || node1 == node3) {
+		throw runtime_error("Element nodes must be distinct.");
+	}
+	elementNodes.push_back(node1);
+	elementNodes.push_back(node2);
+	elementNodes.push_back(node3);
+	bConstants.resize(bConstants.size() + 3);
+	cConstants.resize(cConstants.size() + 3);
+	elementAreas.push_back(0.0);
+	long e = numElements() - 1;
+	computeGeometry(e);
+	return e;
+}
+
+long TwoDMesh::addBoundaryEdge(const int & node1, const int & node2,
+		const int & marker) {
+	int n = numNodes();
+	if (node1 < 0 || node1 >= n || node2 < 0 || node2 >= n) {
+		throw out_of_range("Edge node id is not in the mesh.");
+	}
+	edgeNodes.push_back(node1);
+	edgeNodes.push_back(node2);
+	edgeMarkers.push_back(marker);
+	return numBoundaryEdges() - 1;
+}
+
+void TwoDMesh::reserve(const int & nodes, const long & elements,
+		const long & edges) {
+	xCoords.reserve(nodes);
+	yCoords.reserve(nodes);
+	elementNodes.reserve(3*elements);
+	bConstants.reserve(3*elements);
+	cConstants.reserve(3*elements);
+	elementAreas.reserve(elements);
+	edgeNodes.reserve(2*edges);
+	edgeMarkers.reserve(edges);
+}
+
+void TwoDMesh::computeGeometry(const long & e) {
+	const int * ids = &elementNodes[3*e];
+	double x1 = xCoords[ids[0]], x2 = xCoords[ids[1]], x3 = xCoords[ids[2]];
+	double y1 = yCoords[ids[0]], y2 = yCoords[ids[1]], y3 = yCoords[ids[2]];
+	double * b = &bConstants[3*e], * c = &cConstants[3*e];
+	// Same constants as ConstantStrainTriangleElement::recomputeConstants()
+	b[0] = y2 - y3;
+	b[1] = y3 - y1;
+	b[2] = y1 - y2;
+	c[0] = x3 - x2;
+	c[1] = x1 - x3;
+	c[2] = x2 - x1;
+	elementAreas[e] = 0.5*(b[1]*c[2] - b[2]*c[1]);
+}
+
+void TwoDMesh::computeGeometry() {
+	for (long e = 0; e < numElements(); e++) computeGeometry(e);
+}
+
+void TwoDMesh::computeGeometry(const vector<long> & elements) {
+	const int blockSize = 256;
+	double x1[blockSize], x2[blockSize], x3[blockSize];
+	double y1[blockSize], y2[blockSize], y3[blockSize];
+	double b[3][blockSize], c[3][blockSize], area[blockSize];
+	// Check all of the elements first so a bad one leaves the mesh unchanged
+	for (long e : elements) {
+		if (e < 0 || e >= numElements()) {
+			throw out_of_range("Element is not in the mesh.");
+		}
+	}
+	long numUpdated = elements.size();
+	for (long begin = 0; begin < numUpdated; begin += blockSize) {
+		int n = min((long) blockSize, numUpdated - begin);
+		const long * block = &elements[begin];
+		// Gather the coordinates
+		for (int k = 0; k < n; k++) {
+			const int * ids = &elementNodes[3*block[k]];
+			x1[k] = xCoords[ids[0]];
+			x2[k] = xCoords[ids[1]];
+			x3[k] = xCoords[ids[2]];
+			y1[k] = yCoords[ids[0]];
+			y2[k] = yCoords[ids[1]];
+			y3[k] = yCoords[ids[2]];
+		}
+		// The factors, as in computeGeometry(e)
+		for (int k = 0; k < n; k++) {
+			b[0][k] = y2[k] - y3[k];
+			b[1][k] = y3[k] - y1[k];
+			b[2][k] = y1[k] - y2[k];
+			c[0][k] = x3[k] - x2[k];
+			c[1][k] = x1[k] - x3[k];
+			c[2][k] = x2[k] - x1[k];
+			area[k] = 0.5*(b[1][k]*c[2][k] - b[2][k]*c[1][k]);
+		}
+		// Scatter them back
+		for (int k = 0; k < n; k++) {
+			long e = block[k];
+			for (int i = 0; i < 3; i++) {
+				bConstants[3*e+i] = b[i][k];
+				cConstants[3*e+i] = c[i][k];
+			}
+			elementAreas[e] = area[k];
+		}
+	}
+}
+
+void TwoDMesh::renumberNodes(const vector<int> & order) {
+	if ((int) order.size() != numNodes()) {
+		throw runtime_error("Order is not a permutation.");
+	}
+	vector<int> newIds = inversePermutation(order);
+	reorder(xCoords, order, 1);
+	reorder(yCoords, order, 1);
+	for (auto & id : elementNodes) id = newIds[id];
+	for (auto & id : edgeNodes) id = newIds[id];
+}
+
+void TwoDMesh::reorderElements(const vector<long> & order) {
+	checkOrder(order, numElements());
+	reorder(elementNodes, order, 3);
+	reorder(bConstants, order, 3);
+	reorder(cConstants, order, 3);
+	reorder(elementAreas, order, 1);
+}
+
+long TwoDMesh::memoryUsage() const {
+	return (xCoords.size() + yCoords.size() + bConstants.size()
+			+ cConstants.size() + elementAreas.size())*sizeof(double)
+			+ (elementNodes.size() + edgeNodes.size()
+			+ edgeMarkers.size())*sizeof(int);
+}
+
+TwoDMesh TwoDMesh::rectangle(const int & nx, const int & ny,
+		const double & width, const double & height) {
+	if (nx < 1 || ny < 1) {
+		throw runtime_error("Rectangular mesh needs at least one square.");
+	}
+	TwoDMesh mesh;
+	mesh.reserve((nx+1)*(ny+1), 2L*nx*ny, 2*(nx+ny));
+	for (int j = 0; j <= ny; j++) {
+		for (int i = 0; i <= nx; i++) {
+			mesh.addNode(width*i/nx, height*j/ny);
+		}
+	}
+	for (int j = 0; j < ny; j++) {
+		for (int i = 0; i < nx; i++) {
+			int k = j*(nx+1) + i;
+			mesh.addElement(k, k+1, k+nx+2);
+			mesh.addElement(k, k+nx+2, k+nx+1);
+		}
+	}
+	// Boundary edges, counter-clockwise around the rectangle
+	for (int i = 0; i < nx; i++) mesh.addBoundaryEdge(i, i+1, 0);
+	for (int j = 0; j < ny; j++) {
+		mesh.addBoundaryEdge(j*(nx+1) + nx, (j+1)*(nx+1) + nx, 1);
+	}
+	for (int i = nx; i > 0; i--) {
+		mesh.addBoundaryEdge(ny*(nx+1) + i, ny*(nx+1) + i - 1, 2);
+	}
+	for (int j = ny; j > 0; j--) {
+		mesh.addBoundaryEdge(j*(nx+1), (j-1)*(nx+1), 3);
+	}
+	return mesh;
+}
+
+TwoDMesh TwoDMesh::refine() const {
+	EdgeIndex edges(*this);
+	int n = numNodes();
+	TwoDMesh fine;
+	fine.reserve(n + edges.numEdges(), 4*numElements(),
+			2*numBoundaryEdges());
+	for (int i = 0; i < n; i++) fine.addNode(xCoords[i], yCoords[i]);
+	auto & edgeNodeIds = edges.nodes();
+	for (long k = 0; k < edges.numEdges(); k++) {
+		int a = edgeNodeIds[2*k], b = edgeNodeIds[2*k+1];
+		fine.addNode(0.5*(xCoords[a] + xCoords[b]),
+				0.5*(yCoords[a] + yCoords[b]));
+	}
+	for (long e = 0; e < numElements(); e++) {
+		const int * ids = &elementNodes[3*e];
+		// The midpoint of local edge l, from node l to node l+1
+		int m[3];
+		for (int l = 0; l < 3; l++) {
+			m[l] = n + edges.find(ids[l], ids[(l+1)%3]);
+		}
+		fine.addElement(ids[0], m[0], m[2]);
+		fine.addElement(m[0], ids[1], m[1]);
+		fine.addElement(m[2], m[1], ids[2]);
+		fine.addElement(m[0], m[1], m[2]);
+	}
+	for (long k = 0; k < numBoundaryEdges(); k++) {
+		int a = edgeNodes[2*k], b = edgeNodes[2*k+1];
+		int m = n + edges.find(a, b);
+		fine.addBoundaryEdge(a, m, edgeMarkers[k]);
+		fine.addBoundaryEdge(m, b, edgeMarkers[k]);
+	}
+	return fine;
+}
+
+} /* namespace fire */
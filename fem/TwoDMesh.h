@@ -0,0 +1,422 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#ifndef FEM_TWODMESH_H_
+#define FEM_TWODMESH_H_
+
+#include <array>
+#include <vector>
+#include <FEMTypes.h>
+
+namespace fire {
+
+class TwoDMesh;
+
+/**
+ * This class is a lightweight view of a triangle in a TwoDMesh. It holds only
+ * a pointer to the mesh and the index of the triangle, so it is cheap to
+ * create and copy, and all of its data comes from the mesh's flat arrays. It
+ * provides the same geometric information as a ConstantStrainTriangleElement,
+ * using the same a, b, c and area constants, without storing any of it.
+ *
+ * Views are invalidated if the mesh is destroyed.
+ */
+class TwoDMeshElement {
+
+protected:
+
+	/**
+	 * The mesh that holds the element's data.
+	 */
+	const TwoDMesh * mesh;
+
+	/**
+	 * The index of the element in the mesh.
+	 */
+	long index;
+
+public:
+
+	/**
+	 * The constructor
+	 * @param elementMesh the mesh
+	 * @param elementIndex the index of the element in the mesh
+	 */
+	TwoDMeshElement(const TwoDMesh & elementMesh, const long & elementIndex) :
+		mesh(&elementMesh), index(elementIndex) {};
+
+	/**
+	 * This operation returns the index of the element in the mesh.
+	 * @return the index
+	 */
+	long id() const { return index;};
+
+	/**
+	 * This operation returns the global ids of the nodes in the element in
+	 * local order.
+	 * @return the ids of the first, second and third nodes
+	 */
+	std::array<int,3> nodeIds() const;
+
+	/**
+	 * This operation returns the (signed) area of the element.
+	 * @return the area, which is positive if the nodes are ordered
+	 * counter-clockwise
+	 */
+	double area() const;
+
+	/**
+	 * This operation returns the constant a_i = x_j*y_k - x_k*y_j for the
+	 * area coordinates, where (i,j,k) is a cyclic permutation of (0,1,2).
+	 * @param i the local node id
+	 * @return a_i
+	 */
+	double a(const int & i) const;
+
+	/**
+	 * This operation returns the constant b_i = y_j - y_k for the area
+	 * coordinates.
+	 * @param i the local node id
+	 * @return b_i
+	 */
+	double b(const int & i) const;
+
+	/**
+	 * This operation returns the constant c_i = x_k - x_j for the area
+	 * coordinates.
+	 * @param i the local node id
+	 * @return c_i
+	 */
+	double c(const int & i) const;
+
+	/**
+	 * This operation computes the local coordinates of a global point (x,y),
+	 * exactly as ConstantStrainTriangleElement::computeLocalPoint().
+	 * @param x the global coordinate x
+	 * @param y the global coordinate y
+	 * @return the area coordinates (L_1,L_2,L_3).
+	 */
+	CSTLocalPoint computeLocalPoint(const double & x, const double & y) const;
+
+	/**
+	 * This operation returns the local id of a node in the element.
+	 * @param nodeId the global id of the node
+	 * @return 0, 1, or 2 if the element contains the node, -1 otherwise.
+	 */
+	int getLocalNodeId(const int & nodeId) const;
+
+};
+
+/**
+ * This class is a two dimensional triangular mesh stored as a structure of
+ * arrays. The node coordinates, the element connectivity, the boundary edges
+ * and the geometric factors of each element - the b and c constants and the
+ * area used by the Constant Strain Triangle - are each held in a single
+ * contiguous array. Elements are accessed through TwoDMeshElement views,
+ * which store nothing but their index.
+ *
+ * Compared to a vector of ConstantStrainTriangleElements, which each hold
+ * node references, matrix and vector buffers, kernels and quadrature rules,
+ * this takes 68 bytes per triangle and 16 bytes per node, so a mesh with a
+ * million triangles fits in about 80 MB. Loops over the elements stream
+ * through memory:
+ * @code
+ * TwoDMesh mesh = TwoDMesh::rectangle(1000,500,2.0,1.0);
+ * double total = 0.0;
+ * for (long e = 0; e < mesh.numElements(); e++) total += mesh.areas()[e];
+ * @endcode
+ *
+ * Meshes are built by adding nodes, elements and boundary edges, or with
+ * rectangle(). The geometric factors are computed when elements are added
+ * and must be recomputed with computeGeometry() if the coordinates change.
+ * The a constants are not stored because they are rarely needed and follow
+ * from the coordinates.
+ */
+class TwoDMesh {
+
+protected:
+
+	/**
+	 * The x coordinates of the nodes.
+	 */
+	std::vector<double> xCoords;
+
+	/**
+	 * The y coordinates of the nodes.
+	 */
+	std::vector<double> yCoords;
+
+	/**
+	 * The global node ids of the elements, three per element.
+	 */
+	std::vector<int> elementNodes;
+
+	/**
+	 * The b constants of the elements, three per element.
+	 */
+	std::vector<double> bConstants;
+
+	/**
+	 * The c constants of the elements, three per element.
+	 */
+	std::vector<double> cConstants;
+
+	/**
+	 * The (signed) areas of the elements.
+	 */
+	std::vector<double> elementAreas;
+
+	/**
+	 * The node ids of the boundary edges, two per edge.
+	 */
+	std::vector<int> edgeNodes;
+
+	/**
+	 * The markers of the boundary edges, which identify the part of the
+	 * boundary to which each edge belongs.
+	 */
+	std::vector<int> edgeMarkers;
+
+	/**
+	 * This operation computes the geometric factors of one element.
+	 */
+	void computeGeometry(const long & e);
+
+public:
+
+	/**
+	 * This operation adds a node to the mesh.
+	 * @param x the x coordinate
+	 * @param y the y coordinate
+	 * @return the id of the node
+	 */
+	int addNode(const double & x, const double & y);
+
+	/**
+	 * This operation adds a triangle to the mesh and computes its geometric
+	 * factors. An exception is thrown if the node ids are not in the mesh or
+	 * are not distinct.
+	 * @param node1 the id of the first node
+	 * @param node2 the id of the second node
+	 * @param node3 the id of the third node
+	 * @return the index of the element
+	 */
+	long addElement(const int & node1, const int & node2, const int & node3);
+
+	/**
+	 * This operation adds a boundary edge to the mesh. An exception is thrown
+	 * if the node ids are not in the mesh.
+	 * @param node1 the id of the first node
+	 * @param node2 the id of the second node
+	 * @param marker the marker of the part of the boundary that contains the
+	 * edge
+	 * @return the index of the edge
+	 */
+	long addBoundaryEdge(const int & node1, const int & node2,
+			const int & marker = 0);
+
+	/**
+	 * This operation reserves memory for the given numbers of nodes,
+	 * elements and edges.
+	 */
+	void reserve(const int & nodes, const long & elements,
+			const long & edges = 0);
+
+	/**
+	 * This operation recomputes the geometric factors of all elements, which
+	 * is required after the coordinates change.
+	 */
+	void computeGeometry();
+
+	/**
+	 * This operation recomputes the geometric factors of some of the
+	 * elements, such as those around nodes that moved. The coordinates of the
+	 * elements are gathered in blocks so that the factors are computed by
+	 * loops that the compiler can vectorize.
+	 * @param elements the indices of the elements
+	 * @throw std::out_of_range if an element is not in the mesh, in which
+	 * case no factors are changed
+	 */
+	void computeGeometry(const std::vector<long> & elements);
+
+	/**
+	 * This operation returns the number of nodes.
+	 */
+	int numNodes() const { return xCoords.size();};
+
+	/**
+	 * This operation returns the number of elements.
+	 */
+	long numElements() const { return elementAreas.size();};
+
+	/**
+	 * This operation returns the number of boundary edges.
+	 */
+	long numBoundaryEdges() const { return edgeMarkers.size();};
+
+	/**
+	 * This operation returns a view of an element.
+	 * @param e the index of the element
+	 * @return the view
+	 */
+	TwoDMeshElement element(const long & e) const {
+		return TwoDMeshElement(*this, e);
+	};
+
+	/**
+	 * This operation returns a copy of a node as a TwoDNode for use with the
+	 * boundary conditions and other classes that work with nodes.
+	 * @param id the id of the node
+	 * @return the node
+	 */
+	TwoDNode node(const int & id) const {
+		return TwoDNode(xCoords[id], yCoords[id], id);
+	};
+
+	/**
+	 * The x coordinates of the nodes, which may be modified as long as
+	 * computeGeometry() is called afterwards.
+	 */
+	std::vector<double> & x() { return xCoords;};
+	const std::vector<double> & x() const { return xCoords;};
+
+	/**
+	 * The y coordinates of the nodes, which may be modified as long as
+	 * computeGeometry() is called afterwards.
+	 */
+	std::vector<double> & y() { return yCoords;};
+	const std::vector<double> & y() const { return yCoords;};
+
+	/**
+	 * The node ids of the elements, three per element.
+	 */
+	const std::vector<int> & connectivity() const { return elementNodes;};
+
+	/**
+	 * The b constants of the elements, three per element.
+	 */
+	const std::vector<double> & b() const { return bConstants;};
+
+	/**
+	 * The c constants of the elements, three per element.
+	 */
+	const std::vector<double> & c() const { return cConstants;};
+
+	/**
+	 * The (signed) areas of the elements.
+	 */
+	const std::vector<double> & areas() const { return elementAreas;};
+
+	/**
+	 * The node ids of the boundary edges, two per edge.
+	 */
+	const std::vector<int> & boundaryEdges() const { return edgeNodes;};
+
+	/**
+	 * The markers of the boundary edges.
+	 */
+	const std::vector<int> & boundaryMarkers() const { return edgeMarkers;};
+
+	/**
+	 * This operation renumbers the nodes, for example with an order from
+	 * MeshOrdering.h. The coordinates are moved and the connectivity and
+	 * boundary edges are rewritten, so the geometric factors do not change.
+	 * @param order the new order, where order[k] is the current id of the
+	 * node that becomes node k. An exception is thrown if it is not a
+	 * permutation of the nodes.
+	 */
+	void renumberNodes(const std::vector<int> & order);
+
+	/**
+	 * This operation reorders the elements, for example with an order from
+	 * MeshOrdering.h, moving their connectivity and geometric factors.
+	 * @param order the new order, where order[k] is the current index of the
+	 * element that becomes element k. An exception is thrown if it is not a
+	 * permutation of the elements.
+	 */
+	void reorderElements(const std::vector<long> & order);
+
+	/**
+	 * This operation returns the number of bytes used by the mesh's arrays.
+	 * @return the size of the data in bytes
+	 */
+	long memoryUsage() const;
+
+	/**
+	 * This operation creates a structured mesh of the rectangle
+	 * [0,width]x[0,height] with nx by ny squares, each split into two
+	 * counter-clockwise triangles along the diagonal from the lower left
+	 * corner. Node (i,j) has id j*(nx+1) + i. The boundary edges are marked
+	 * 0 for the bottom, 1 for the right, 2 for the top and 3 for the left.
+	 * @param nx the number of squares along x
+	 * @param ny the number of squares along y
+	 * @param width the width of the rectangle
+	 * @param height the height of the rectangle
+	 * @return the mesh
+	 */
+	static TwoDMesh rectangle(const int & nx, const int & ny,
+			const double & width = 1.0, const double & height = 1.0);
+
+	/**
+	 * This operation creates a uniform (red) refinement of the mesh in which
+	 * every triangle is split into four by the midpoints of its edges. The
+	 * nodes of this mesh keep their ids and the midpoint of edge k of
+	 * EdgeIndex(*this) has id numNodes() + k. Element e is split into
+	 * elements 4e to 4e+3, the first three of which contain its nodes 0, 1
+	 * and 2 and the last of which is the middle triangle, all with the same
+	 * orientation. Each boundary edge is split into two edges with the same
+	 * marker.
+	 * @return the refined mesh
+	 */
+	TwoDMesh refine() const;
+
+};
+
+inline std::array<int,3> TwoDMeshElement::nodeIds() const {
+	auto & nodes = mesh->connectivity();
+	return {{nodes[3*index], nodes[3*index+1], nodes[3*index+2]}};
+}
+
+inline double TwoDMeshElement::area() const {
+	return mesh->areas()[index];
+}
+
+inline double TwoDMeshElement::b(const int & i) const {
+	return mesh->b()[3*index + i];
+}
+
+inline double TwoDMeshElement::c(const int & i) const {
+	return mesh->c()[3*index + i];
+}
+
+} /* namespace fire */
+
+#endif /* FEM_TWODMESH_H_ */
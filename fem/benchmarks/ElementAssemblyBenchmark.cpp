@@ -0,0 +1,147 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+
+/**
+ * This program measures the throughput of element stiffness matrix
+ * computations for Laplace's equation on a structured mesh with
+ *
+ * 1) LaplaceCSTElement, where the kernels are std::functions,
+ * 2) CSTKernelElement with the FunctionKernel compatibility adapter, and
+ * 3) CSTKernelElement with the LaplaceKernel policy, which is inlined, and
+ * 4) CSTBatchStiffness, which computes all of the matrices in blocks.
+ *
+ * Usage: ElementAssemblyBenchmark [number of squares per side, default 300]
+ */
+
+#include <LaplaceCSTElement.h>
+#include <CSTKernelElement.h>
+#include <CSTBatchStiffness.h>
+#include <TwoDMesh.h>
+#include <chrono>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdlib>
+
+using namespace std;
+using namespace fire;
+
+/**
+ * This operation times a loop and reports the number of elements per second.
+ */
+template<typename F>
+double time(const string & name, const long & numElements, const F & loop) {
+	auto start = chrono::steady_clock::now();
+	double checksum = loop();
+	chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+	cout << name << ": " << elapsed.count() << " s, "
+			<< numElements/elapsed.count() << " elements/s (checksum "
+			<< checksum << ")" << endl;
+	return elapsed.count();
+}
+
+int main(int argc, char ** argv) {
+
+	int n = (argc > 1) ? atoi(argv[1]) : 300;
+	TwoDMesh mesh = TwoDMesh::rectangle(n, n);
+	long numElements = mesh.numElements();
+	cout << "Computing " << numElements << " element stiffness matrices."
+			<< endl;
+
+	// Build the std::function elements. They hold references to the nodes
+	// and capture themselves in their kernels, so nothing may reallocate.
+	vector<TwoDNode> nodes;
+	nodes.reserve(mesh.numNodes());
+	for (int i = 0; i < mesh.numNodes(); i++) nodes.push_back(mesh.node(i));
+	vector<LaplaceCSTElement> elements;
+	elements.reserve(numElements);
+	auto & ids = mesh.connectivity();
+	for (long e = 0; e < numElements; e++) {
+		elements.emplace_back(nodes[ids[3*e]], nodes[ids[3*e+1]],
+				nodes[ids[3*e+2]]);
+	}
+
+	double before = time("LaplaceCSTElement (std::function)", numElements,
+			[&]() {
+		double sum = 0.0;
+		for (auto & element : elements) {
+			for (auto & entry : element.stiffnessMatrix()) sum += entry.value;
+		}
+		return sum;
+	});
+
+	FunctionKernel functionKernel;
+	functionKernel.stiffnessFunction = [](const std::array<double,3> &,
+			const CSTGeometry & geometry, const int & i, const int & j) {
+		return (geometry.b[i]*geometry.b[j] + geometry.c[i]*geometry.c[j])
+				/(4.0*geometry.area*geometry.area);
+	};
+	CSTKernelElement<FunctionKernel> adapter(functionKernel);
+	time("CSTKernelElement<FunctionKernel>", numElements, [&]() {
+		double sum = 0.0;
+		std::array<double,9> k;
+		for (long e = 0; e < numElements; e++) {
+			adapter.stiffnessMatrix(CSTGeometry::fromMesh(mesh, e), k.data());
+			for (auto & value : k) sum += value;
+		}
+		return sum;
+	});
+
+	CSTKernelElement<LaplaceKernel> policy;
+	double after = time("CSTKernelElement<LaplaceKernel>", numElements, [&]() {
+		double sum = 0.0;
+		std::array<double,9> k;
+		for (long e = 0; e < numElements; e++) {
+			policy.stiffnessMatrix(CSTGeometry::fromMesh(mesh, e), k.data());
+			for (auto & value : k) sum += value;
+		}
+		return sum;
+	});
+
+	cout << "Speedup: " << before/after << endl;
+
+	CSTBatchStiffness batch(mesh);
+	double batched = time("CSTBatchStiffness", numElements, [&]() {
+		batch.compute();
+		double sum = 0.0;
+		for (int i = 0; i < 3; i++) {
+			for (int j = 0; j < 3; j++) {
+				for (auto & value : batch.entries(i,j)) sum += value;
+			}
+		}
+		return sum;
+	});
+
+	cout << "Batch speedup: " << before/batched << endl;
+
+	return 0;
+}
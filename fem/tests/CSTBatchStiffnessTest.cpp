@@ -0,0 +1,202 @@
+
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE FEM
+
+#include <boost/test/included/unit_test.hpp>
+#include <CSTBatchStiffness.h>
+#include <LaplaceCSTElement.h>
+#include <TwoDMesh.h>
+#include <array>
+#include <cmath>
+
+using namespace std;
+using namespace fire;
+
+/**
+ * This operation creates a rectangular mesh with its interior nodes moved so
+ * that the elements are irregular and have different areas.
+ * @param nx the number of squares in x
+ * @param ny the number of squares in y
+ * @return the mesh
+ */
+static TwoDMesh irregularMesh(const int & nx, const int & ny) {
+	TwoDMesh mesh = TwoDMesh::rectangle(nx,ny,2.0,1.0);
+	for (int j = 1; j < ny; j++) {
+		for (int i = 1; i < nx; i++) {
+			int id = j*(nx+1) + i;
+			mesh.x()[id] += 0.2*sin(3.0*id)/nx;
+			mesh.y()[id] += 0.2*cos(5.0*id)/ny;
+		}
+	}
+	mesh.computeGeometry();
+	return mesh;
+}
+
+/**
+ * This operation checks that the batch stiffness matrices match
+ * LaplaceCSTElement on irregular elements for a constant coefficient, and
+ * that the geometric factors match the mesh.
+ */
+BOOST_AUTO_TEST_CASE(checkConstantCoefficient) {
+
+	TwoDMesh mesh = irregularMesh(3,2);
+	CSTBatchStiffness batch(mesh);
+	batch.compute(2.5);
+	BOOST_REQUIRE_EQUAL(mesh.numElements(),batch.size());
+
+	for (long e = 0; e < mesh.numElements(); e++) {
+		auto view = mesh.element(e);
+		BOOST_REQUIRE_CLOSE(view.area(),batch.areas()[e],1.0e-12);
+		for (int i = 0; i < 3; i++) {
+			BOOST_REQUIRE_CLOSE(view.a(i) + 1.0,batch.a(i)[e] + 1.0,1.0e-12);
+			BOOST_REQUIRE_EQUAL(view.b(i),batch.b(i)[e]);
+			BOOST_REQUIRE_EQUAL(view.c(i),batch.c(i)[e]);
+		}
+
+		// The original element with the same coefficient
+		auto ids = view.nodeIds();
+		auto n1 = mesh.node(ids[0]), n2 = mesh.node(ids[1]),
+				n3 = mesh.node(ids[2]);
+		LaplaceCSTElement cst(n1,n2,n3);
+		cst.transferCoefficient(2.5);
+		BOOST_REQUIRE(cst.constantTransferCoefficient());
+		array<double,9> k;
+		batch.elementMatrix(e,k.data());
+		for (auto & entry : cst.stiffnessMatrix()) {
+			int i = cst.getLocalNodeId(entry.first),
+					j = cst.getLocalNodeId(entry.second);
+			BOOST_REQUIRE_CLOSE(entry.value,k[3*i+j],1.0e-10);
+			BOOST_REQUIRE_EQUAL(batch.stiffness(e,i,j),batch.stiffness(e,j,i));
+			BOOST_REQUIRE_EQUAL(k[3*i+j],batch.entries(i,j)[e]);
+		}
+	}
+
+	// Per-element coefficients
+	vector<double> kappa(mesh.numElements());
+	for (long e = 0; e < mesh.numElements(); e++) kappa[e] = 1.0 + e;
+	CSTBatchStiffness perElement(mesh);
+	perElement.compute(kappa);
+	for (long e = 0; e < mesh.numElements(); e++) {
+		for (int i = 0; i < 3; i++) {
+			for (int j = 0; j < 3; j++) {
+				BOOST_REQUIRE_CLOSE(kappa[e]*batch.stiffness(e,i,j)/2.5,
+						perElement.stiffness(e,i,j),1.0e-10);
+			}
+		}
+	}
+	BOOST_REQUIRE_THROW(perElement.compute(vector<double>(2,1.0)),
+			std::runtime_error);
+
+	// The stiffness does not depend on the ordering of the nodes
+	TwoDMesh clockwise;
+	clockwise.addNode(0.0,0.0);
+	clockwise.addNode(0.5,1.5);
+	clockwise.addNode(2.0,0.5);
+	clockwise.addElement(0,1,2);
+	BOOST_REQUIRE(clockwise.areas()[0] < 0.0);
+	auto c1 = clockwise.node(0), c2 = clockwise.node(1), c3 = clockwise.node(2);
+	LaplaceCSTElement cst(c1,c2,c3);
+	CSTBatchStiffness clockwiseBatch(clockwise);
+	clockwiseBatch.compute();
+	for (auto & entry : cst.stiffnessMatrix()) {
+		int i = cst.getLocalNodeId(entry.first),
+				j = cst.getLocalNodeId(entry.second);
+		BOOST_REQUIRE_CLOSE(entry.value,clockwiseBatch.stiffness(0,i,j),1.0e-10);
+		if (i == j) BOOST_REQUIRE(entry.value > 0.0);
+	}
+
+	return;
+}
+
+/**
+ * This operation checks the quadrature fallback for a spatially varying
+ * coefficient against LaplaceCSTElement with the same coefficient.
+ */
+BOOST_AUTO_TEST_CASE(checkVaryingCoefficient) {
+
+	TwoDMesh mesh = irregularMesh(3,2);
+	auto kappa = [](const double & x, const double & y) {
+		return 1.0 + x*x + 2.0*x*y;
+	};
+	CSTBatchStiffness batch(mesh);
+	batch.compute(kappa);
+
+	for (long e = 0; e < mesh.numElements(); e++) {
+		auto ids = mesh.element(e).nodeIds();
+		auto n1 = mesh.node(ids[0]), n2 = mesh.node(ids[1]),
+				n3 = mesh.node(ids[2]);
+		LaplaceCSTElement cst(n1,n2,n3);
+		cst.transferCoefficient([&](const std::array<double,3> & point,
+				const int &, const int &) {
+			double x = point[0]*n1.first + point[1]*n2.first
+					+ point[2]*n3.first;
+			double y = point[0]*n1.second + point[1]*n2.second
+					+ point[2]*n3.second;
+			return kappa(x,y);
+		});
+		BOOST_REQUIRE(!cst.constantTransferCoefficient());
+		for (auto & entry : cst.stiffnessMatrix()) {
+			int i = cst.getLocalNodeId(entry.first),
+					j = cst.getLocalNodeId(entry.second);
+			BOOST_REQUIRE_CLOSE(entry.value,batch.stiffness(e,i,j),1.0e-10);
+		}
+	}
+
+	return;
+}
+
+/**
+ * This operation checks that splitting a mesh with many blocks across
+ * threads gives the same results as computing it on one thread.
+ */
+BOOST_AUTO_TEST_CASE(checkThreadedBlocks) {
+
+	TwoDMesh mesh = irregularMesh(40,30);
+	BOOST_REQUIRE(mesh.numElements() > 8*CSTBatchStiffness::blockSize);
+	ThreadPool serialPool(1), threadedPool(4,1);
+	CSTBatchStiffness serial(mesh, serialPool), threaded(mesh, threadedPool);
+	serial.compute(1.5);
+	threaded.compute(1.5);
+	for (long e = 0; e < mesh.numElements(); e++) {
+		BOOST_REQUIRE_EQUAL(serial.areas()[e],threaded.areas()[e]);
+		for (int i = 0; i < 3; i++) {
+			for (int j = 0; j < 3; j++) {
+				BOOST_REQUIRE_EQUAL(serial.stiffness(e,i,j),
+						threaded.stiffness(e,i,j));
+			}
+		}
+	}
+
+	return;
+}
@@ -0,0 +1,141 @@
+
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE FEM
+
+#include <boost/test/included/unit_test.hpp>
+#include <CSTKernelElement.h>
+#include <LaplaceCSTElement.h>
+#include <TwoDMesh.h>
+#include <array>
+
+using namespace std;
+using namespace fire;
+
+/**
+ * A kernel policy with a body force, f = s L_i, for checking the force
+ * vector, which is sA/3 for every node.
+ */
+struct SourceKernel : public LaplaceKernel {
+	double source = 3.0;
+	double bodyForce(const std::array<double,3> & point,
+			const CSTGeometry &, const int & i) const {
+		return source*point[i];
+	}
+};
+
+/**
+ * This operation checks the policy-based element against the analytic
+ * Laplace stiffness matrix, the compatibility adapter and the original
+ * std::function element.
+ */
+BOOST_AUTO_TEST_CASE(checkKernelElement) {
+
+	// An irregular triangle
+	TwoDMesh mesh;
+	mesh.addNode(0.0,0.0);
+	mesh.addNode(2.0,0.5);
+	mesh.addNode(0.5,1.5);
+	mesh.addElement(0,1,2);
+	auto geometry = CSTGeometry::fromMesh(mesh,0);
+	BOOST_REQUIRE_CLOSE(1.375,geometry.area,1.0e-12);
+
+	LaplaceKernel laplace;
+	laplace.kappa = 2.0;
+	CSTKernelElement<LaplaceKernel> element(laplace);
+	BOOST_REQUIRE_EQUAL(2.0,element.getKernel().kappa);
+	array<double,9> k;
+	element.stiffnessMatrix(geometry,k.data());
+	for (int i = 0; i < 3; i++) {
+		double rowSum = 0.0;
+		for (int j = 0; j < 3; j++) {
+			double exact = 2.0*(geometry.b[i]*geometry.b[j]
+					+ geometry.c[i]*geometry.c[j])/(4.0*geometry.area);
+			BOOST_REQUIRE_CLOSE(exact,k[3*i+j],1.0e-10);
+			BOOST_REQUIRE_CLOSE(k[3*j+i],k[3*i+j],1.0e-10);
+			rowSum += k[3*i+j];
+		}
+		BOOST_REQUIRE_SMALL(rowSum,1.0e-12);
+	}
+
+	// The adapter gives the same answer
+	FunctionKernel functionKernel;
+	functionKernel.stiffnessFunction = [&](const std::array<double,3> & point,
+			const CSTGeometry & g, const int & i, const int & j) {
+		return laplace.stiffness(point,g,i,j);
+	};
+	functionKernel.bodyForceFunction = [](const std::array<double,3> &,
+			const CSTGeometry &, const int &) {
+		return 0.0;
+	};
+	CSTKernelElement<FunctionKernel> adapter(functionKernel);
+	array<double,9> kAdapter;
+	array<double,3> f;
+	adapter.stiffnessMatrix(geometry,kAdapter.data());
+	adapter.bodyForceVector(geometry,f.data());
+	for (int i = 0; i < 9; i++) BOOST_REQUIRE_CLOSE(k[i],kAdapter[i],1.0e-12);
+	for (auto & value : f) BOOST_REQUIRE_EQUAL(0.0,value);
+
+	// Body forces
+	CSTKernelElement<SourceKernel> sourceElement;
+	sourceElement.bodyForceVector(geometry,f.data());
+	for (auto & value : f) BOOST_REQUIRE_CLOSE(3.0*1.375/3.0,value,1.0e-10);
+
+	return;
+}
+
+/**
+ * This operation checks that the policy-based element matches
+ * LaplaceCSTElement on the unit square example, where the elements have an
+ * area of 1/2.
+ */
+BOOST_AUTO_TEST_CASE(checkLaplaceCSTCompatibility) {
+
+	TwoDMesh mesh = TwoDMesh::rectangle(1,1);
+	TwoDNode nodes[4] = {mesh.node(0),mesh.node(1),mesh.node(2),mesh.node(3)};
+	CSTKernelElement<LaplaceKernel> element;
+	auto & ids = mesh.connectivity();
+	for (long e = 0; e < mesh.numElements(); e++) {
+		LaplaceCSTElement cst(nodes[ids[3*e]],nodes[ids[3*e+1]],
+				nodes[ids[3*e+2]]);
+		array<double,9> k;
+		element.stiffnessMatrix(CSTGeometry::fromMesh(mesh,e),k.data());
+		for (auto & entry : cst.stiffnessMatrix()) {
+			int i = cst.getLocalNodeId(entry.first),
+					j = cst.getLocalNodeId(entry.second);
+			BOOST_REQUIRE_CLOSE(entry.value + 1.0,k[3*i+j] + 1.0,1.0e-10);
+		}
+	}
+
+	return;
+}
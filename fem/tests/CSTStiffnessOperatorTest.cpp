@@ -0,0 +1,174 @@
+
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE FEM
+
+#include <boost/test/included/unit_test.hpp>
+#include <CSTStiffnessOperator.h>
+#include <CSTBatchStiffness.h>
+#include <PCGSolver.h>
+#include <vector>
+#include <utility>
+#include <stdexcept>
+#include <math.h>
+
+using namespace std;
+using namespace fire;
+
+/**
+ * This operation assembles the stiffness matrix of a mesh from the batch
+ * stiffness.
+ */
+static CSRMatrix<double> assemble(const TwoDMesh & mesh,
+		const CSTBatchStiffness & batch) {
+	auto & ids = mesh.connectivity();
+	vector<pair<int,int>> entries;
+	for (long e = 0; e < mesh.numElements(); e++) {
+		for (int i = 0; i < 3; i++) {
+			for (int j = 0; j < 3; j++) {
+				entries.emplace_back(ids[3*e+i],ids[3*e+j]);
+			}
+		}
+	}
+	CSRMatrix<double> matrix(mesh.numNodes(),entries);
+	for (long e = 0; e < mesh.numElements(); e++) {
+		for (int i = 0; i < 3; i++) {
+			for (int j = 0; j < 3; j++) {
+				matrix.values[matrix.slot(ids[3*e+i],ids[3*e+j])] +=
+						batch.stiffness(e,i,j);
+			}
+		}
+	}
+	return matrix;
+}
+
+/**
+ * This operation checks that the products match the assembled matrix.
+ */
+BOOST_AUTO_TEST_CASE(checkProducts) {
+
+	TwoDMesh mesh = TwoDMesh::rectangle(25,15,2.0,1.0);
+	// Distort the mesh so that the elements differ
+	for (int i = 0; i < mesh.numNodes(); i++) {
+		mesh.x()[i] += 0.01*sin(7.0*mesh.y()[i]);
+		mesh.y()[i] += 0.01*cos(5.0*mesh.x()[i]);
+	}
+	mesh.computeGeometry();
+	ThreadPool pool(4,1);
+	CSTStiffnessOperator stiffness(mesh,pool);
+	BOOST_REQUIRE_EQUAL(mesh.numNodes(),stiffness.size());
+	CSTBatchStiffness batch(mesh);
+	vector<double> x(mesh.numNodes()), y, expected, diag;
+	for (int i = 0; i < mesh.numNodes(); i++) x[i] = sin(0.37*i*i);
+
+	// Constant and varying coefficients
+	vector<double> kappa(mesh.numElements());
+	for (long e = 0; e < mesh.numElements(); e++) kappa[e] = 1.0 + 0.01*e;
+	for (int pass = 0; pass < 2; pass++) {
+		if (pass == 0) {
+			stiffness.coefficient(2.5);
+			batch.compute(2.5);
+		} else {
+			stiffness.coefficient(kappa);
+			batch.compute(kappa);
+		}
+		CSRMatrix<double> matrix = assemble(mesh,batch);
+		stiffness.multiply(x,y);
+		matrix.multiply(x,expected);
+		for (int i = 0; i < mesh.numNodes(); i++) {
+			BOOST_REQUIRE_SMALL(expected[i] - y[i],1.0e-10);
+		}
+		stiffness.diagonal(diag);
+		for (int i = 0; i < mesh.numNodes(); i++) {
+			BOOST_REQUIRE_CLOSE(matrix(i,i),diag[i],1.0e-10);
+		}
+	}
+	BOOST_REQUIRE_THROW(stiffness.coefficient(vector<double>(3,1.0)),
+			runtime_error);
+
+	return;
+}
+
+/**
+ * This operation checks the constrained operator and PCG against the
+ * assembled system with DirichletLifting.
+ */
+BOOST_AUTO_TEST_CASE(checkConstrainedSolve) {
+
+	TwoDMesh mesh = TwoDMesh::rectangle(30,30);
+	CSTStiffnessOperator stiffness(mesh);
+	CSTBatchStiffness batch(mesh);
+	batch.compute(1.0);
+	CSRMatrix<double> matrix = assemble(mesh,batch);
+	DirichletLifting conditions(mesh.numNodes());
+	conditions.fixBoundary(mesh,0,[](const double & x, const double &) {
+		return sin(3.0*x);
+	});
+	conditions.fixBoundary(mesh,2,1.0);
+	conditions.apply(matrix);
+	stiffness.constrain(conditions);
+
+	// The products and lifted right hand sides agree
+	vector<double> x(mesh.numNodes()), y, expected;
+	for (int i = 0; i < mesh.numNodes(); i++) x[i] = cos(0.11*i);
+	stiffness.multiply(x,y);
+	matrix.multiply(x,expected);
+	for (int i = 0; i < mesh.numNodes(); i++) {
+		BOOST_REQUIRE_SMALL(expected[i] - y[i],1.0e-10);
+	}
+	vector<double> b(mesh.numNodes(),1.0e-3), freeB(b);
+	conditions.lift(b);
+	stiffness.lift(conditions,freeB);
+	for (int i = 0; i < mesh.numNodes(); i++) {
+		BOOST_REQUIRE_SMALL(b[i] - freeB[i],1.0e-12);
+	}
+
+	// So do the solutions
+	PCGSolver solver;
+	solver.tolerance(1.0e-10);
+	vector<double> diag, assembledX, freeX;
+	stiffness.diagonal(diag);
+	JacobiPreconditioner jacobi(diag);
+	auto assembled = solver.solve(matrix,b,assembledX,jacobi);
+	auto free = solver.solve(stiffness,freeB,freeX,jacobi);
+	BOOST_REQUIRE(free.converged);
+	BOOST_REQUIRE(abs(assembled.iterations - free.iterations) <= 1);
+	for (int i = 0; i < mesh.numNodes(); i++) {
+		BOOST_REQUIRE_SMALL(assembledX[i] - freeX[i],1.0e-8);
+	}
+	for (int i : conditions.nodes()) {
+		BOOST_REQUIRE_SMALL(conditions.values()[i] - freeX[i],1.0e-8);
+	}
+
+	return;
+}
@@ -0,0 +1,178 @@
+
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE FEM
+
+#include <boost/test/included/unit_test.hpp>
+#include <DirichletLifting.h>
+#include <CSTBatchStiffness.h>
+#include <SkylineCholesky.h>
+#include <vector>
+#include <stdexcept>
+#include <utility>
+
+using namespace std;
+using namespace fire;
+
+/**
+ * This operation assembles the stiffness matrix of Laplace's equation on a
+ * mesh.
+ */
+static CSRMatrix<double> assemble(const TwoDMesh & mesh) {
+	auto & ids = mesh.connectivity();
+	vector<pair<int,int>> entries;
+	for (long e = 0; e < mesh.numElements(); e++) {
+		for (int i = 0; i < 3; i++) {
+			for (int j = 0; j < 3; j++) {
+				entries.emplace_back(ids[3*e+i],ids[3*e+j]);
+			}
+		}
+	}
+	CSRMatrix<double> matrix(mesh.numNodes(),entries);
+	CSTBatchStiffness batch(mesh);
+	batch.compute(1.0);
+	for (long e = 0; e < mesh.numElements(); e++) {
+		for (int i = 0; i < 3; i++) {
+			for (int j = 0; j < 3; j++) {
+				matrix.values[matrix.slot(ids[3*e+i],ids[3*e+j])] +=
+						batch.stiffness(e,i,j);
+			}
+		}
+	}
+	return matrix;
+}
+
+/**
+ * This operation checks that elimination gives the exact solution for
+ * linear boundary values, which linear elements reproduce, and that new
+ * values only need a new right hand side.
+ */
+BOOST_AUTO_TEST_CASE(checkElimination) {
+
+	TwoDMesh mesh = TwoDMesh::rectangle(20,10,2.0,1.0);
+	CSRMatrix<double> original = assemble(mesh);
+	CSRMatrix<double> matrix(original);
+	DirichletLifting conditions(mesh.numNodes());
+	for (int marker = 0; marker < 4; marker++) {
+		conditions.fixBoundary(mesh,marker,
+				[](const double & x, const double & y) {
+			return 1.0 + 2.0*x + 3.0*y;
+		});
+	}
+	BOOST_REQUIRE_EQUAL(2*21 + 2*9,conditions.nodes().size());
+	BOOST_REQUIRE(conditions.isFixed(0));
+	BOOST_REQUIRE(!conditions.isFixed(22));
+	BOOST_REQUIRE(!conditions.isApplied());
+	vector<double> b(mesh.numNodes(),0.0), u;
+	BOOST_REQUIRE_THROW(conditions.lift(b),logic_error);
+	conditions.apply(matrix);
+	BOOST_REQUIRE(conditions.isApplied());
+
+	// The modified matrix is symmetric and the diagonal is kept
+	for (int i = 0; i < mesh.numNodes(); i++) {
+		for (long m = matrix.rowOffsets[i]; m < matrix.rowOffsets[i+1]; m++) {
+			int j = matrix.columns[m];
+			BOOST_REQUIRE_EQUAL(matrix.values[m],matrix(j,i));
+			if (i == j) {
+				BOOST_REQUIRE_EQUAL(original.values[m],matrix.values[m]);
+			} else if (conditions.isFixed(i) || conditions.isFixed(j)) {
+				BOOST_REQUIRE_EQUAL(0.0,matrix.values[m]);
+			}
+		}
+	}
+
+	SkylineCholesky cholesky;
+	cholesky.factor(matrix);
+	conditions.lift(b);
+	cholesky.solve(b,u);
+	auto & x = mesh.x();
+	auto & y = mesh.y();
+	for (int i = 0; i < mesh.numNodes(); i++) {
+		BOOST_REQUIRE_SMALL(u[i] - (1.0 + 2.0*x[i] + 3.0*y[i]),1.0e-10);
+	}
+
+	// Changing the values of fixed nodes only needs a new right hand side
+	for (int id : conditions.nodes()) conditions.fix(id,x[id] - y[id]);
+	BOOST_REQUIRE(conditions.isApplied());
+	b.assign(mesh.numNodes(),0.0);
+	conditions.lift(b);
+	cholesky.solve(b,u);
+	for (int i = 0; i < mesh.numNodes(); i++) {
+		BOOST_REQUIRE_SMALL(u[i] - (x[i] - y[i]),1.0e-10);
+	}
+
+	// Fixing a new node needs a new matrix
+	conditions.fix(22,0.0);
+	BOOST_REQUIRE(!conditions.isApplied());
+	BOOST_REQUIRE_THROW(conditions.lift(b),logic_error);
+	BOOST_REQUIRE_THROW(conditions.fix(mesh.numNodes(),0.0),out_of_range);
+	CSRMatrix<double> empty;
+	BOOST_REQUIRE_THROW(conditions.apply(empty),runtime_error);
+
+	return;
+}
+
+/**
+ * This operation checks the penalty method with a source.
+ */
+BOOST_AUTO_TEST_CASE(checkPenalty) {
+
+	// A uniform source between two walls at zero and one gives a parabola
+	TwoDMesh mesh = TwoDMesh::rectangle(10,30);
+	CSRMatrix<double> matrix = assemble(mesh);
+	DirichletLifting conditions(mesh.numNodes(),DirichletMethod::PENALTY,
+			1.0e10);
+	conditions.fixBoundary(mesh,0,0.0);
+	conditions.fixBoundary(mesh,2,1.0);
+	conditions.apply(matrix);
+	vector<double> f(mesh.numNodes(),0.0), b, u;
+	for (long e = 0; e < mesh.numElements(); e++) {
+		for (int i = 0; i < 3; i++) {
+			f[mesh.connectivity()[3*e+i]] += 2.0*mesh.areas()[e]/3.0;
+		}
+	}
+	b = f;
+	conditions.lift(b);
+	SkylineCholesky cholesky;
+	cholesky.factor(matrix);
+	cholesky.solve(b,u);
+	for (int i = 0; i < mesh.numNodes(); i++) {
+		double y = mesh.y()[i];
+		BOOST_REQUIRE_SMALL(u[i] - y*(2.0 - y),1.0e-8);
+	}
+
+	BOOST_REQUIRE_THROW(DirichletLifting(4,DirichletMethod::PENALTY,0.5),
+			runtime_error);
+
+	return;
+}
@@ -0,0 +1,217 @@
+
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE FEM
+
+#include <boost/test/included/unit_test.hpp>
+#include <DomainDecomposition.h>
+#include <TwoDMesh.h>
+#include <ThreeDMesh.h>
+#include <CSTBatchStiffness.h>
+#include <TetConduction.h>
+#include <Preconditioner.h>
+#include <PCGSolver.h>
+#include <vector>
+#include <stdexcept>
+#include <cmath>
+
+using namespace std;
+using namespace fire;
+
+/**
+ * This operation checks the partition of a rectangle into subdomains.
+ */
+BOOST_AUTO_TEST_CASE(checkPartition) {
+
+	int nx = 40, ny = 20;
+	TwoDMesh mesh = TwoDMesh::rectangle(nx,ny,2.0,1.0);
+	ThreadPool pool(4,1);
+	DomainDecomposition domains(mesh.connectivity(),3,mesh.numNodes(),4,
+			pool);
+	BOOST_REQUIRE_EQUAL(4,domains.numSubdomains());
+	BOOST_REQUIRE_EQUAL(mesh.numElements(),domains.parts().size());
+
+	// Balanced subdomains that cover the elements once
+	long total = 0;
+	for (int s = 0; s < 4; s++) {
+		auto & elements = domains.elements(s);
+		BOOST_REQUIRE(labs((long) elements.size() - mesh.numElements()/4) <= 1);
+		total += elements.size();
+		for (long e : elements) BOOST_REQUIRE_EQUAL(s,domains.parts()[e]);
+	}
+	BOOST_REQUIRE_EQUAL(mesh.numElements(),total);
+
+	// The owner of each node touches it, and the interface is short
+	for (int i = 0; i < mesh.numNodes(); i++) {
+		auto & nodes = domains.nodes(domains.owners()[i]);
+		BOOST_REQUIRE(find(nodes.begin(),nodes.end(),i) != nodes.end());
+	}
+	BOOST_REQUIRE(domains.interface().size() > 0);
+	BOOST_REQUIRE((int) domains.interface().size() < 4*(nx + ny));
+	for (int id : domains.interface()) {
+		int count = 0;
+		for (int s = 0; s < 4; s++) {
+			auto & nodes = domains.nodes(s);
+			if (find(nodes.begin(),nodes.end(),id) != nodes.end()) count++;
+		}
+		BOOST_REQUIRE(count > 1);
+	}
+
+	// The number of subdomains defaults to the size of the pool and is
+	// limited by the number of elements
+	DomainDecomposition byPool(mesh.connectivity(),3,mesh.numNodes(),0,pool);
+	BOOST_REQUIRE_EQUAL(pool.size(),byPool.numSubdomains());
+	TwoDMesh small = TwoDMesh::rectangle(1,1);
+	DomainDecomposition limited(small.connectivity(),3,small.numNodes(),8,
+			pool);
+	BOOST_REQUIRE_EQUAL(2,limited.numSubdomains());
+	vector<int> bad = {0,1,7};
+	BOOST_REQUIRE_THROW(DomainDecomposition(bad,3,3),std::out_of_range);
+
+	return;
+}
+
+/**
+ * This operation checks that subdomain assembly matches serial assembly and
+ * that PCG with the additive Schwarz preconditioner on the same subdomains
+ * solves the system.
+ */
+BOOST_AUTO_TEST_CASE(checkAssembly) {
+
+	TwoDMesh mesh = TwoDMesh::rectangle(30,30);
+	CSTBatchStiffness batch(mesh);
+	batch.compute(2.0);
+	ThreadPool pool(4,1);
+	DomainDecomposition domains(mesh.connectivity(),3,mesh.numNodes(),4,
+			pool);
+	auto elementMatrix = [&](const long & e, double * k) {
+		batch.elementMatrix(e,k);
+	};
+	CSRMatrix<double> stiffness = domains.matrix();
+	domains.assemble(elementMatrix,stiffness);
+
+	// Serial assembly
+	CSRMatrix<double> serial = domains.matrix();
+	array<double,9> k;
+	for (long e = 0; e < mesh.numElements(); e++) {
+		auto ids = mesh.element(e).nodeIds();
+		batch.elementMatrix(e,k.data());
+		for (int a = 0; a < 3; a++) {
+			for (int b = 0; b < 3; b++) {
+				serial.values[serial.slot(ids[a],ids[b])] += k[3*a+b];
+			}
+		}
+	}
+	for (long m = 0; m < serial.nonZeros(); m++) {
+		BOOST_REQUIRE_SMALL(serial.values[m] - stiffness.values[m],1.0e-12);
+	}
+	// Reassembly overwrites the values
+	domains.assemble(elementMatrix,stiffness);
+	for (long m = 0; m < serial.nonZeros(); m++) {
+		BOOST_REQUIRE_SMALL(serial.values[m] - stiffness.values[m],1.0e-12);
+	}
+	CSRMatrix<double> empty;
+	BOOST_REQUIRE_THROW(domains.assemble(elementMatrix,empty),
+			std::runtime_error);
+
+	// A vector: the areas shared by the nodes of each element
+	vector<double> load;
+	domains.assembleVector([&](const long & e, double * f) {
+		for (int a = 0; a < 3; a++) f[a] = mesh.areas()[e]/3.0;
+	}, load);
+	double totalLoad = 0.0;
+	for (double value : load) totalLoad += value;
+	BOOST_REQUIRE_CLOSE(1.0,totalLoad,1.0e-10);
+	BOOST_REQUIRE_CLOSE(1.0/(30*30),load[31*15 + 15],1.0e-10);
+
+	// Fix the bottom and top and solve with additive Schwarz
+	vector<double> b(load), x(mesh.numNodes(),0.0);
+	for (int i = 0; i < mesh.numNodes(); i++) {
+		bool fixed = (i <= 30 || i >= 30*31);
+		if (!fixed) continue;
+		for (long m = stiffness.rowOffsets[i]; m < stiffness.rowOffsets[i+1];
+				m++) {
+			int j = stiffness.columns[m];
+			stiffness.values[m] = (i == j) ? 1.0 : 0.0;
+			if (i != j) stiffness.values[stiffness.slot(j,i)] = 0.0;
+		}
+		b[i] = 0.0;
+	}
+	PCGSolver solver(pool);
+	solver.tolerance(1.0e-10);
+	AdditiveSchwarzPreconditioner schwarz(stiffness,domains.owners(),1,pool);
+	PCGResult result = solver.solve(stiffness,b,x,schwarz);
+	BOOST_REQUIRE(result.converged);
+	// With a uniform source between two fixed walls the solution is the
+	// parabola y(1-y)/(2*kappa), which linear elements give at the nodes
+	for (int j = 0; j <= 30; j++) {
+		double y = j/30.0;
+		BOOST_REQUIRE_SMALL(x[31*j + 7] - y*(1.0 - y)/4.0,1.0e-8);
+	}
+
+	// A rough source needs fewer iterations than with Jacobi
+	for (int i = 31; i < 30*31; i++) b[i] = sin(0.37*i*i);
+	fill(x.begin(),x.end(),0.0);
+	vector<double> jacobiX(x);
+	result = solver.solve(stiffness,b,x,schwarz);
+	JacobiPreconditioner jacobi(stiffness,pool);
+	PCGResult jacobiResult = solver.solve(stiffness,b,jacobiX,jacobi);
+	BOOST_REQUIRE(result.converged);
+	BOOST_REQUIRE(result.iterations < jacobiResult.iterations/2);
+
+	return;
+}
+
+/**
+ * This operation checks subdomain assembly of quadratic tetrahedra.
+ */
+BOOST_AUTO_TEST_CASE(checkTetAssembly) {
+
+	ThreeDMesh mesh = ThreeDMesh::box(4,4,4,1.0,1.0,1.0,10);
+	Tet10Conduction conduction(mesh);
+	CSRMatrix<double> colored = conduction.matrix();
+	conduction.assembleStiffness(colored,3.0);
+	ThreadPool pool(3,1);
+	DomainDecomposition domains(mesh.connectivity(),10,mesh.numNodes(),3,
+			pool);
+	CSRMatrix<double> stiffness = domains.matrix();
+	BOOST_REQUIRE_EQUAL(colored.nonZeros(),stiffness.nonZeros());
+	domains.assemble([&](const long & e, double * k) {
+		conduction.elementStiffness(e,3.0,k);
+	}, stiffness);
+	for (long m = 0; m < colored.nonZeros(); m++) {
+		BOOST_REQUIRE_SMALL(colored.values[m] - stiffness.values[m],1.0e-12);
+	}
+
+	return;
+}
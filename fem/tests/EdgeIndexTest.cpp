@@ -0,0 +1,108 @@
+
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE FEM
+
+#include <boost/test/included/unit_test.hpp>
+#include <EdgeIndex.h>
+#include <stdexcept>
+
+using namespace std;
+using namespace fire;
+
+/**
+ * This operation checks the edges of a structured mesh.
+ */
+BOOST_AUTO_TEST_CASE(checkEdges) {
+
+	int nx = 7, ny = 4;
+	TwoDMesh mesh = TwoDMesh::rectangle(nx,ny);
+	EdgeIndex edges(mesh);
+	// Horizontal, vertical and diagonal edges
+	BOOST_REQUIRE_EQUAL(nx*(ny+1) + ny*(nx+1) + nx*ny,edges.numEdges());
+	BOOST_REQUIRE_EQUAL(2*(nx + ny),edges.boundary().size());
+
+	auto & ids = mesh.connectivity();
+	for (long edge = 0; edge < edges.numEdges(); edge++) {
+		int first = edges.nodes()[2*edge], second = edges.nodes()[2*edge+1];
+		BOOST_REQUIRE_EQUAL(edge,edges.find(first,second));
+		BOOST_REQUIRE_EQUAL(edge,edges.find(second,first));
+		// The first element runs from the first node to the second
+		long e = edges.elements()[2*edge];
+		int l = edges.localEdges()[2*edge];
+		BOOST_REQUIRE_EQUAL(first,ids[3*e+l]);
+		BOOST_REQUIRE_EQUAL(second,ids[3*e+(l+1)%3]);
+		// The second element runs the other way
+		long other = edges.elements()[2*edge+1];
+		if (other >= 0) {
+			l = edges.localEdges()[2*edge+1];
+			BOOST_REQUIRE_EQUAL(second,ids[3*other+l]);
+			BOOST_REQUIRE_EQUAL(first,ids[3*other+(l+1)%3]);
+		} else {
+			BOOST_REQUIRE_EQUAL(-1,edges.localEdges()[2*edge+1]);
+		}
+	}
+
+	// Every marked boundary edge is a boundary edge of the index
+	auto & boundary = mesh.boundaryEdges();
+	for (long k = 0; k < mesh.numBoundaryEdges(); k++) {
+		long edge = edges.find(boundary[2*k],boundary[2*k+1]);
+		BOOST_REQUIRE(edge >= 0);
+		BOOST_REQUIRE_EQUAL(-1,edges.elements()[2*edge+1]);
+	}
+	// Nodes that are not connected
+	BOOST_REQUIRE_EQUAL(-1,edges.find(0,nx));
+	BOOST_REQUIRE_EQUAL(-1,edges.find(0,mesh.numNodes()));
+
+	return;
+}
+
+/**
+ * This operation checks that edges with more than two elements are
+ * rejected.
+ */
+BOOST_AUTO_TEST_CASE(checkBadEdges) {
+
+	TwoDMesh mesh;
+	mesh.addNode(0.0,0.0);
+	mesh.addNode(1.0,0.0);
+	mesh.addNode(0.0,1.0);
+	mesh.addNode(0.0,-1.0);
+	mesh.addNode(1.0,1.0);
+	mesh.addElement(0,1,2);
+	mesh.addElement(1,0,3);
+	mesh.addElement(0,1,4);
+	BOOST_REQUIRE_THROW(EdgeIndex edges(mesh),runtime_error);
+
+	return;
+}
@@ -0,0 +1,280 @@
+
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE FEM
+
+#include <boost/test/included/unit_test.hpp>
+#include <LaplaceCSTElement.h>
+#include <FEMAssembler.h>
+#include <FEMTypes.h>
+#include <map>
+#include <set>
+#include <vector>
+
+using namespace std;
+using namespace fire;
+
+/**
+ * This operation creates the nodes of an n x n grid of squares on the unit
+ * square.
+ */
+vector<TwoDNode> createNodes(const int & n) {
+	vector<TwoDNode> nodes;
+	for (int j = 0; j <= n; j++) {
+		for (int i = 0; i <= n; i++) {
+			nodes.emplace_back(((double) i)/n,((double) j)/n,j*(n+1) + i);
+		}
+	}
+	return nodes;
+}
+
+/**
+ * This operation splits each square of the grid into two Laplace elements.
+ * The elements store references to the nodes and their kernels capture the
+ * element, so the vector is reserved up front and never reallocated.
+ */
+void createElements(const int & n, const vector<TwoDNode> & nodes,
+		vector<LaplaceCSTElement> & elements) {
+	elements.reserve(2*n*n);
+	for (int j = 0; j < n; j++) {
+		for (int i = 0; i < n; i++) {
+			int k = j*(n+1) + i;
+			elements.emplace_back(nodes[k],nodes[k+1],nodes[k+n+2]);
+			elements.emplace_back(nodes[k],nodes[k+n+2],nodes[k+n+1]);
+		}
+	}
+}
+
+/**
+ * This operation checks that the parallel, colored assembly matches a simple
+ * map-based accumulation of the element contributions.
+ */
+BOOST_AUTO_TEST_CASE(checkAssembly) {
+
+	int n = 12, numNodes = (n+1)*(n+1);
+	auto nodes = createNodes(n);
+	vector<LaplaceCSTElement> elements;
+	createElements(n,nodes,elements);
+
+	// Use a pool that splits even short loops to exercise the threading
+	ThreadPool pool(4, 1);
+	FEMAssembler<LaplaceCSTElement> assembler(elements,numNodes,pool);
+	CSRMatrix<double> stiffness = assembler.matrix();
+	vector<double> force;
+	assembler.assemble(stiffness,force);
+
+	// Each interior node couples to itself and six neighbors
+	BOOST_REQUIRE_EQUAL(numNodes,stiffness.size());
+	BOOST_REQUIRE_EQUAL(7*(n-1)*(n-1) + 4*5*(n-1) + 2*4 + 2*3,
+			stiffness.nonZeros());
+
+	// No two elements of the same color share a node
+	long numColored = 0;
+	for (auto & color : assembler.colors()) {
+		set<int> ids;
+		for (auto & e : color) {
+			for (auto & id : elements[e].nodeIds()) {
+				BOOST_REQUIRE(ids.insert(id).second);
+			}
+		}
+		numColored += color.size();
+	}
+	BOOST_REQUIRE_EQUAL(elements.size(),numColored);
+	BOOST_REQUIRE(assembler.colors().size() <= 12);
+
+	// Compare with the reference
+	map<pair<int,int>,double> reference;
+	for (auto & element : elements) {
+		for (auto & entry : element.stiffnessMatrix()) {
+			reference[make_pair(entry.first,entry.second)] += entry.value;
+		}
+	}
+	BOOST_REQUIRE_EQUAL(reference.size(),stiffness.nonZeros());
+	for (auto & entry : reference) {
+		BOOST_REQUIRE_CLOSE(entry.second,
+				stiffness(entry.first.first,entry.first.second),1.0e-10);
+	}
+
+	// The rows of the Laplacian sum to zero and f is zero
+	vector<double> ones(numNodes,1.0), product;
+	stiffness.multiply(ones,product);
+	for (int i = 0; i < numNodes; i++) {
+		BOOST_REQUIRE_SMALL(product[i],1.0e-12);
+		BOOST_REQUIRE_EQUAL(0.0,force[i]);
+	}
+
+	// Serial assembly gives the same answer and reassembly overwrites
+	CSRMatrix<double> serialStiffness = assembler.matrix();
+	vector<double> serialForce;
+	assembler.assembleSerial(serialStiffness,serialForce);
+	assembler.assembleStiffness(stiffness);
+	for (long k = 0; k < stiffness.nonZeros(); k++) {
+		BOOST_REQUIRE_CLOSE(serialStiffness.values[k],stiffness.values[k],1.0e-10);
+	}
+
+	// Matrices with a different pattern are rejected
+	CSRMatrix<double> wrongMatrix;
+	BOOST_REQUIRE_THROW(assembler.assembleStiffness(wrongMatrix),runtime_error);
+
+	return;
+}
+
+/**
+ * This operation checks that elements deflated by Dirichlet Boundary
+ * Conditions and modified by Robin Boundary Conditions are assembled
+ * correctly.
+ */
+BOOST_AUTO_TEST_CASE(checkBoundaryConditions) {
+
+	int n = 4, numNodes = (n+1)*(n+1);
+	auto nodes = createNodes(n);
+	vector<LaplaceCSTElement> elements;
+	createElements(n,nodes,elements);
+
+	// Robin condition along y = 1 on the top elements
+	std::function<double(const double &)> sigma = [](const double &) {
+		return 1.0;
+	};
+	std::function<double(const double &)> h = [](const double &) {
+		return 2.0;
+	};
+	vector<TwoDRobinBoundaryCondition> robinConds;
+	robinConds.reserve(n);
+	for (int i = 0; i < n; i++) {
+		int k = n*(n+1) + i;
+		robinConds.emplace_back(nodes[k+1],nodes[k],sigma,h);
+		elements[2*((n-1)*n + i) + 1].addRobinBoundary(robinConds.back());
+	}
+	// Dirichlet condition at the corner (0,0)
+	std::function<double(const double &, const double &)> dFunc =
+			[](const double &, const double &) {
+		return 1.0;
+	};
+	TwoDDirichletBoundaryCondition dCond(nodes[0],dFunc);
+	elements[0].addDirichletBoundary(dCond);
+	elements[1].addDirichletBoundary(dCond);
+
+	FEMAssembler<LaplaceCSTElement> assembler(elements,numNodes);
+	CSRMatrix<double> stiffness = assembler.matrix();
+	vector<double> force;
+	assembler.assemble(stiffness,force);
+
+	map<pair<int,int>,double> reference;
+	vector<double> forceRef(numNodes,0.0);
+	for (auto & element : elements) {
+		for (auto & entry : element.stiffnessMatrix()) {
+			reference[make_pair(entry.first,entry.second)] += entry.value;
+		}
+		for (auto & entry : element.bodyForceVector()) {
+			forceRef[entry.first] += entry.second;
+		}
+	}
+	for (auto & entry : reference) {
+		BOOST_REQUIRE_CLOSE(entry.second,
+				stiffness(entry.first.first,entry.first.second),1.0e-10);
+	}
+	for (int i = 0; i < numNodes; i++) {
+		BOOST_REQUIRE_CLOSE(forceRef[i],force[i],1.0e-10);
+	}
+	// The Dirichlet node is decoupled from the system
+	BOOST_REQUIRE_EQUAL(0.0,stiffness(0,0));
+	BOOST_REQUIRE_EQUAL(0.0,stiffness(1,0));
+
+	return;
+}
+
+/**
+ * This operation checks that patching the matrix after coefficients change
+ * and nodes move matches a full assembly, also after a full assembly.
+ */
+BOOST_AUTO_TEST_CASE(checkIncrementalUpdate) {
+
+	int n = 12, numNodes = (n+1)*(n+1);
+	auto nodes = createNodes(n);
+	vector<LaplaceCSTElement> elements;
+	createElements(n,nodes,elements);
+	ThreadPool pool(4, 1);
+	FEMAssembler<LaplaceCSTElement> assembler(elements,numNodes,pool);
+	CSRMatrix<double> stiffness = assembler.matrix();
+	BOOST_REQUIRE_THROW(assembler.updateStiffness(stiffness),logic_error);
+	assembler.assembleStiffness(stiffness);
+	BOOST_REQUIRE_EQUAL(0,assembler.updateStiffness(stiffness));
+
+	// Change the coefficients of a few elements, including one twice
+	for (long e : {3L, 40L, 41L, 200L}) {
+		elements[e].transferCoefficient(2.5);
+		assembler.markDirty(e);
+	}
+	elements[40].transferCoefficient(4.0);
+	assembler.markDirty(40);
+	BOOST_REQUIRE_EQUAL(4,assembler.numDirty());
+	// Move an interior node, which is in six elements, one of which is dirty
+	int moved = 5*(n+1) + 6;
+	nodes[moved].first += 0.02;
+	nodes[moved].second -= 0.01;
+	assembler.markNodeMoved(moved);
+	long numDirty = assembler.numDirty();
+	BOOST_REQUIRE(numDirty >= 9 && numDirty <= 10);
+	BOOST_REQUIRE_EQUAL(numDirty,assembler.updateStiffness(stiffness));
+	BOOST_REQUIRE_EQUAL(0,assembler.numDirty());
+
+	// Compare with a full assembly, which recomputes every element
+	for (auto & element : elements) element.recomputeConstants();
+	CSRMatrix<double> full = assembler.matrix();
+	vector<double> force;
+	assembler.assembleSerial(full,force);
+	for (long k = 0; k < full.nonZeros(); k++) {
+		BOOST_REQUIRE_SMALL(full.values[k] - stiffness.values[k],1.0e-12);
+	}
+	BOOST_REQUIRE(stiffness(moved,moved) != 0.0);
+
+	// A full assembly recomputes changed coefficients but not the constants
+	// of the elements of moved nodes, so those stay dirty
+	elements[3].transferCoefficient(1.5);
+	assembler.markDirty(3);
+	nodes[moved].first -= 0.03;
+	assembler.markNodeMoved(moved);
+	assembler.assembleStiffness(stiffness);
+	BOOST_REQUIRE_EQUAL(6,assembler.numDirty());
+	BOOST_REQUIRE_EQUAL(6,assembler.updateStiffness(stiffness));
+	for (auto & element : elements) element.recomputeConstants();
+	assembler.assembleSerial(full,force);
+	for (long k = 0; k < full.nonZeros(); k++) {
+		BOOST_REQUIRE_SMALL(full.values[k] - stiffness.values[k],1.0e-12);
+	}
+
+	BOOST_REQUIRE_THROW(assembler.markDirty(elements.size()),out_of_range);
+	BOOST_REQUIRE_THROW(assembler.markNodeMoved(-1),out_of_range);
+
+	return;
+}
@@ -0,0 +1,231 @@
+
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE FEM
+
+#include <boost/test/included/unit_test.hpp>
+#include <GeometricMultigrid.h>
+#include <CSTBatchStiffness.h>
+#include <SkylineCholesky.h>
+#include <PCGSolver.h>
+#include <vector>
+#include <stdexcept>
+#include <math.h>
+
+using namespace std;
+using namespace fire;
+
+/**
+ * This operation checks that the prolongation interpolates linear functions
+ * exactly and that the restriction is its transpose.
+ */
+BOOST_AUTO_TEST_CASE(checkTransfers) {
+	TwoDMesh coarse = TwoDMesh::rectangle(3,2,3.0,2.0);
+	GeometricMultigrid multigrid(coarse,2,{0});
+	BOOST_REQUIRE_EQUAL(3,multigrid.numLevels());
+	BOOST_REQUIRE_EQUAL(4*4*coarse.numElements(),
+			multigrid.fineMesh().numElements());
+
+	auto linear = [](double x, double y) { return 1.0 + 2.0*x - 3.0*y;};
+	auto & mesh = multigrid.mesh(1), & fine = multigrid.mesh(2);
+	vector<double> u(mesh.numNodes()), pu, v(fine.numNodes()), rv;
+	for (int i = 0; i < mesh.numNodes(); i++) u[i] = linear(mesh.x()[i],mesh.y()[i]);
+	multigrid.prolong(1,u,pu);
+	BOOST_REQUIRE_EQUAL(fine.numNodes(),pu.size());
+	for (int i = 0; i < fine.numNodes(); i++) {
+		BOOST_REQUIRE_CLOSE(linear(fine.x()[i],fine.y()[i]) + 20.0,
+				pu[i] + 20.0,1.0e-10);
+		v[i] = sin(0.3*i);
+	}
+	multigrid.restrict(2,v,rv);
+	BOOST_REQUIRE_EQUAL(mesh.numNodes(),rv.size());
+	double puv = 0.0, urv = 0.0;
+	for (int i = 0; i < fine.numNodes(); i++) puv += pu[i]*v[i];
+	for (int i = 0; i < mesh.numNodes(); i++) urv += u[i]*rv[i];
+	BOOST_REQUIRE_CLOSE(puv,urv,1.0e-10);
+
+	BOOST_REQUIRE_THROW(GeometricMultigrid bad(coarse,-1,{0}),runtime_error);
+
+	return;
+}
+
+/**
+ * This operation checks that the multigrid solution matches a direct solve,
+ * both as a preconditioner and on its own, and that linear boundary values
+ * are reproduced exactly.
+ */
+BOOST_AUTO_TEST_CASE(checkSolution) {
+	TwoDMesh coarse = TwoDMesh::rectangle(2,2);
+	GeometricMultigrid multigrid(coarse,4,{0,1,2,3});
+	auto & mesh = multigrid.fineMesh();
+	int n = mesh.numNodes();
+	auto & conditions = multigrid.conditions();
+	for (int marker = 0; marker < 4; marker++) {
+		conditions.fixBoundary(mesh,marker,[](double x, double y) {
+			return 1.0 + x + 2.0*y;
+		});
+	}
+	vector<double> b(n,0.0), x;
+	conditions.lift(b);
+	PCGSolver solver;
+	solver.tolerance(1.0e-12);
+	auto result = solver.solve(multigrid.matrix(),b,x,multigrid);
+	BOOST_REQUIRE(result.converged);
+	for (int i = 0; i < n; i++) {
+		BOOST_REQUIRE_CLOSE(1.0 + mesh.x()[i] + 2.0*mesh.y()[i],x[i],1.0e-8);
+	}
+
+	// A harmonic, but not linear, solution with a source
+	for (int marker = 0; marker < 4; marker++) {
+		conditions.fixBoundary(mesh,marker,[](double x, double y) {
+			return x*x - y*y;
+		});
+	}
+	b.assign(n,1.0e-3);
+	for (int node : conditions.nodes()) b[node] = 0.0;
+	conditions.lift(b);
+	SkylineCholesky direct;
+	vector<double> exact;
+	direct.factor(multigrid.matrix());
+	direct.solve(b,exact);
+	x.clear();
+	result = multigrid.solve(b,x,1.0e-12);
+	BOOST_REQUIRE(result.converged);
+	BOOST_REQUIRE_EQUAL(result.iterations + 1,result.history.size());
+	for (int i = 0; i < n; i++) BOOST_REQUIRE_CLOSE(exact[i] + 2.0,x[i] + 2.0,1.0e-8);
+	x.clear();
+	result = solver.solve(multigrid.matrix(),b,x,multigrid);
+	for (int i = 0; i < n; i++) BOOST_REQUIRE_CLOSE(exact[i] + 2.0,x[i] + 2.0,1.0e-8);
+
+	return;
+}
+
+/**
+ * This operation checks that the number of iterations does not grow as the
+ * mesh is refined and that a V-cycle reduces the residual by a fixed factor,
+ * with both smoothers.
+ */
+BOOST_AUTO_TEST_CASE(checkConvergence) {
+	TwoDMesh coarse = TwoDMesh::rectangle(2,2);
+	for (auto smoother : {MultigridSmoother::JACOBI,
+			MultigridSmoother::GAUSS_SEIDEL}) {
+		vector<int> iterations;
+		for (int levels = 2; levels <= 6; levels++) {
+			GeometricMultigrid multigrid(coarse,levels - 1,{0,3},1.0,smoother);
+			auto & mesh = multigrid.fineMesh();
+			int n = mesh.numNodes();
+			vector<double> b(n), x;
+			for (int i = 0; i < n; i++) {
+				b[i] = sin(0.37*i*i)/n;
+			}
+			for (int node : multigrid.conditions().nodes()) b[node] = 0.0;
+			PCGSolver solver;
+			solver.tolerance(1.0e-8);
+			auto result = solver.solve(multigrid.matrix(),b,x,multigrid);
+			BOOST_REQUIRE(result.converged);
+			iterations.push_back(result.iterations);
+
+			// The average reduction per V-cycle on its own
+			x.clear();
+			auto cycles = multigrid.solve(b,x,1.0e-8);
+			BOOST_REQUIRE(cycles.converged);
+			double factor = pow(cycles.residualNorm/cycles.history[0],
+					1.0/cycles.iterations);
+			BOOST_REQUIRE_LT(factor,
+					(smoother == MultigridSmoother::JACOBI) ? 0.35 : 0.2);
+		}
+		BOOST_REQUIRE_LE(iterations.back(),iterations.front() + 2);
+		BOOST_REQUIRE_LE(iterations.back(),12);
+	}
+
+	return;
+}
+
+/**
+ * This operation checks that the matrices of all levels are reassembled for
+ * a new transfer coefficient.
+ */
+BOOST_AUTO_TEST_CASE(checkCoefficient) {
+	TwoDMesh coarse = TwoDMesh::rectangle(2,3,1.0,1.5);
+	GeometricMultigrid multigrid(coarse,2,{1},2.0);
+	auto & fine = multigrid.fineMesh();
+	vector<double> kappa(fine.numElements());
+	for (long e = 0; e < fine.numElements(); e++) kappa[e] = 1.0 + (e % 4);
+	multigrid.coefficient(kappa);
+
+	// The coarse coefficient is the average of the children, 2.5
+	CSTBatchStiffness batch(coarse);
+	batch.compute(2.5);
+	CSRMatrix<double> expected = multigrid.matrix(0);
+	expected.zero();
+	auto & ids = coarse.connectivity();
+	double k[9];
+	for (long e = 0; e < coarse.numElements(); e++) {
+		batch.elementMatrix(e,k);
+		for (int a = 0; a < 3; a++) {
+			for (int b = 0; b < 3; b++) {
+				expected.values[expected.slot(ids[3*e+a],ids[3*e+b])] += k[3*a+b];
+			}
+		}
+	}
+	auto & matrix = multigrid.matrix(0);
+	for (int i = 0; i < matrix.size(); i++) {
+		bool fixed = false;
+		for (long m = 0; m < coarse.numBoundaryEdges(); m++) {
+			if (coarse.boundaryMarkers()[m] == 1 &&
+					(coarse.boundaryEdges()[2*m] == i ||
+					coarse.boundaryEdges()[2*m+1] == i)) fixed = true;
+		}
+		for (long s = matrix.rowOffsets[i]; s < matrix.rowOffsets[i+1]; s++) {
+			int j = matrix.columns[s];
+			if (fixed && i == j) {
+				BOOST_REQUIRE_CLOSE(expected.values[s],matrix.values[s],1.0e-10);
+			} else if (!fixed && s == expected.slot(i,j)) {
+				bool fixedColumn = false;
+				for (long m = 0; m < coarse.numBoundaryEdges(); m++) {
+					if (coarse.boundaryMarkers()[m] == 1 &&
+							(coarse.boundaryEdges()[2*m] == j ||
+							coarse.boundaryEdges()[2*m+1] == j)) fixedColumn = true;
+				}
+				if (!fixedColumn) {
+					BOOST_REQUIRE_CLOSE(expected.values[s] + 10.0,
+							matrix.values[s] + 10.0,1.0e-10);
+				}
+			}
+		}
+	}
+	BOOST_REQUIRE_THROW(multigrid.coefficient(vector<double>(3,1.0)),
+			runtime_error);
+
+	return;
+}
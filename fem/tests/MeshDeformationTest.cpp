@@ -0,0 +1,173 @@
+
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE FEM
+
+#include <boost/test/included/unit_test.hpp>
+#include <MeshDeformation.h>
+#include <stdexcept>
+#include <math.h>
+
+using namespace std;
+using namespace fire;
+
+/**
+ * This operation checks that the geometry matches a full recomputation.
+ */
+static void checkGeometry(const TwoDMesh & mesh,
+		const MeshDeformation & deformation) {
+	TwoDMesh full(mesh);
+	full.computeGeometry();
+	for (long k = 0; k < 3*mesh.numElements(); k++) {
+		BOOST_REQUIRE_EQUAL(full.b()[k],mesh.b()[k]);
+		BOOST_REQUIRE_EQUAL(full.c()[k],mesh.c()[k]);
+	}
+	for (long e = 0; e < mesh.numElements(); e++) {
+		BOOST_REQUIRE_EQUAL(full.areas()[e],mesh.areas()[e]);
+	}
+	auto & nodes = deformation.edges().nodes();
+	for (long edge = 0; edge < deformation.edges().numEdges(); edge++) {
+		double dx = mesh.x()[nodes[2*edge+1]] - mesh.x()[nodes[2*edge]];
+		double dy = mesh.y()[nodes[2*edge+1]] - mesh.y()[nodes[2*edge]];
+		BOOST_REQUIRE_CLOSE(sqrt(dx*dx + dy*dy),deformation.lengths()[edge],
+				1.0e-12);
+	}
+}
+
+/**
+ * This operation checks that moving a few nodes only updates the elements
+ * and edges around them.
+ */
+BOOST_AUTO_TEST_CASE(checkLocalUpdate) {
+
+	int n = 10;
+	TwoDMesh mesh = TwoDMesh::rectangle(n,n);
+	MeshDeformation deformation(mesh);
+	checkGeometry(mesh,deformation);
+	BOOST_REQUIRE_EQUAL(0,deformation.numInverted());
+	BOOST_REQUIRE_EQUAL(0,deformation.update());
+
+	// An interior node is in six elements and six edges
+	int node = 4*(n+1) + 5;
+	deformation.moveNode(node,0.52,0.43);
+	deformation.moveNode(node,0.53,0.42);
+	BOOST_REQUIRE_EQUAL(1,deformation.numMoved());
+	BOOST_REQUIRE_EQUAL(6,deformation.update());
+	BOOST_REQUIRE_EQUAL(0,deformation.numMoved());
+	BOOST_REQUIRE_EQUAL(6,deformation.updatedEdges().size());
+	for (long e : deformation.updatedElements()) {
+		auto ids = mesh.element(e).nodeIds();
+		BOOST_REQUIRE(ids[0] == node || ids[1] == node || ids[2] == node);
+	}
+	checkGeometry(mesh,deformation);
+
+	// Nodes that share elements only update them once
+	deformation.moveNode(node,0.5,0.41);
+	deformation.moveNode(node+1,0.61,0.4);
+	mesh.x()[node+n+1] = 0.49;
+	deformation.markNode(node+n+1);
+	long numTouched = 0;
+	for (long e = 0; e < mesh.numElements(); e++) {
+		for (int id : mesh.element(e).nodeIds()) {
+			if (id == node || id == node+1 || id == node+n+1) {
+				numTouched++;
+				break;
+			}
+		}
+	}
+	BOOST_REQUIRE_EQUAL(6 + 6 + 6 - 2 - 2,numTouched);
+	BOOST_REQUIRE_EQUAL(numTouched,deformation.update());
+	checkGeometry(mesh,deformation);
+
+	// Pushing a node past its neighbor inverts elements, and pulling it back
+	// fixes them
+	deformation.moveNode(node,0.65,0.42);
+	deformation.update();
+	BOOST_REQUIRE(deformation.numInverted() > 0);
+	long numInverted = 0;
+	for (long e = 0; e < mesh.numElements(); e++) {
+		if (deformation.isInverted(e)) {
+			numInverted++;
+			BOOST_REQUIRE(mesh.areas()[e] <= 0.0);
+		}
+	}
+	BOOST_REQUIRE_EQUAL(numInverted,deformation.numInverted());
+	deformation.moveNode(node,0.5,0.4);
+	deformation.update();
+	BOOST_REQUIRE_EQUAL(0,deformation.numInverted());
+	checkGeometry(mesh,deformation);
+
+	BOOST_REQUIRE_THROW(deformation.moveNode(-1,0.0,0.0),out_of_range);
+	BOOST_REQUIRE_THROW(deformation.markNode(mesh.numNodes()),out_of_range);
+
+	return;
+}
+
+/**
+ * This operation checks a uniform shrinkage of the whole mesh.
+ */
+BOOST_AUTO_TEST_CASE(checkShrinkage) {
+
+	TwoDMesh mesh = TwoDMesh::rectangle(20,10,2.0,1.0);
+	MeshDeformation deformation(mesh);
+	double area = mesh.areas()[0], length = deformation.lengths()[0];
+	for (int step = 0; step < 3; step++) {
+		for (int i = 0; i < mesh.numNodes(); i++) {
+			deformation.moveNode(i,0.9*mesh.x()[i],0.9*mesh.y()[i]);
+		}
+		BOOST_REQUIRE_EQUAL(mesh.numElements(),deformation.update());
+		BOOST_REQUIRE_EQUAL(deformation.edges().numEdges(),
+				deformation.updatedEdges().size());
+	}
+	for (long e = 0; e < mesh.numElements(); e++) {
+		BOOST_REQUIRE_CLOSE(pow(0.9,6)*area,mesh.areas()[e],1.0e-10);
+	}
+	BOOST_REQUIRE_CLOSE(pow(0.9,3)*length,deformation.lengths()[0],1.0e-10);
+	checkGeometry(mesh,deformation);
+
+	// Clockwise meshes are not inverted
+	TwoDMesh clockwise;
+	clockwise.addNode(0.0,0.0);
+	clockwise.addNode(0.0,1.0);
+	clockwise.addNode(1.0,0.0);
+	clockwise.addElement(0,1,2);
+	MeshDeformation clockwiseDeformation(clockwise);
+	clockwiseDeformation.moveNode(2,2.0,0.0);
+	clockwiseDeformation.update();
+	BOOST_REQUIRE_EQUAL(0,clockwiseDeformation.numInverted());
+	clockwiseDeformation.moveNode(2,-1.0,0.0);
+	clockwiseDeformation.update();
+	BOOST_REQUIRE(clockwiseDeformation.isInverted(0));
+
+	return;
+}
@@ -0,0 +1,213 @@
+
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE FEM
+
+#include <boost/test/included/unit_test.hpp>
+#include <MeshOrdering.h>
+#include <TwoDMesh.h>
+#include <ThreeDMesh.h>
+#include <GraphOrdering.h>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <stdexcept>
+#include <cmath>
+
+using namespace std;
+using namespace fire;
+
+/**
+ * This operation returns the bandwidth of the matrix assembled on a mesh,
+ * the largest difference between the ids of two nodes in one element.
+ */
+static int meshBandwidth(const vector<int> & connectivity,
+		const int & nodesPerElement) {
+	int width = 0;
+	for (long k = 0; k < (long) connectivity.size(); k += nodesPerElement) {
+		auto range = minmax_element(connectivity.begin() + k,
+				connectivity.begin() + k + nodesPerElement);
+		width = max(width, *range.second - *range.first);
+	}
+	return width;
+}
+
+/**
+ * This operation returns a random order of n items.
+ */
+static vector<int> randomOrder(const int & n) {
+	vector<int> order(n);
+	for (int k = 0; k < n; k++) order[k] = k;
+	shuffle(order.begin(), order.end(), mt19937(7));
+	return order;
+}
+
+/**
+ * This operation returns the average distance between the centroids of
+ * consecutive triangles.
+ */
+static double averageStep(const TwoDMesh & mesh) {
+	double total = 0.0, lastX = 0.0, lastY = 0.0;
+	for (long e = 0; e < mesh.numElements(); e++) {
+		auto ids = mesh.element(e).nodeIds();
+		double x = 0.0, y = 0.0;
+		for (int id : ids) {
+			x += mesh.x()[id]/3.0;
+			y += mesh.y()[id]/3.0;
+		}
+		if (e > 0) total += hypot(x - lastX, y - lastY);
+		lastX = x;
+		lastY = y;
+	}
+	return total/(mesh.numElements() - 1);
+}
+
+/**
+ * This operation checks renumbering the nodes of a triangular mesh.
+ */
+BOOST_AUTO_TEST_CASE(checkTwoDNodeOrders) {
+
+	int nx = 40, ny = 20;
+	TwoDMesh mesh = TwoDMesh::rectangle(nx,ny,2.0,1.0);
+	TwoDMesh original = mesh;
+	mesh.renumberNodes(randomOrder(mesh.numNodes()));
+	BOOST_REQUIRE(meshBandwidth(mesh.connectivity(),3) > 10*ny);
+
+	// The geometry is unchanged
+	for (long e = 0; e < mesh.numElements(); e++) {
+		BOOST_REQUIRE_EQUAL(original.areas()[e],mesh.areas()[e]);
+		auto ids = mesh.element(e).nodeIds(), oldIds =
+				original.element(e).nodeIds();
+		for (int a = 0; a < 3; a++) {
+			BOOST_REQUIRE_EQUAL(original.x()[oldIds[a]],mesh.x()[ids[a]]);
+			BOOST_REQUIRE_EQUAL(original.y()[oldIds[a]],mesh.y()[ids[a]]);
+		}
+	}
+	for (long k = 0; k < mesh.numBoundaryEdges(); k++) {
+		int id = mesh.boundaryEdges()[2*k];
+		int oldId = original.boundaryEdges()[2*k];
+		BOOST_REQUIRE_EQUAL(original.x()[oldId],mesh.x()[id]);
+	}
+
+	// Reverse Cuthill-McKee numbers across the short side of the rectangle
+	mesh.renumberNodes(reverseCuthillMcKee(mesh));
+	BOOST_REQUIRE(meshBandwidth(mesh.connectivity(),3) <= 2*(ny + 1));
+
+	// The Hilbert order keeps nodes that are close in space close in memory
+	mesh.renumberNodes(hilbertNodeOrder(mesh));
+	double step = 0.0;
+	for (int i = 1; i < mesh.numNodes(); i++) {
+		step += hypot(mesh.x()[i] - mesh.x()[i-1],mesh.y()[i] - mesh.y()[i-1]);
+	}
+	BOOST_REQUIRE(step/(mesh.numNodes() - 1) < 2.0*2.0/nx);
+
+	BOOST_REQUIRE_THROW(mesh.renumberNodes({0,1}),std::runtime_error);
+
+	return;
+}
+
+/**
+ * This operation checks reordering the elements of a triangular mesh.
+ */
+BOOST_AUTO_TEST_CASE(checkTwoDElementOrders) {
+
+	TwoDMesh mesh = TwoDMesh::rectangle(32,32);
+	TwoDMesh original = mesh;
+	vector<int> shuffled = randomOrder(mesh.numElements());
+	mesh.reorderElements(vector<long>(shuffled.begin(),shuffled.end()));
+	double randomStep = averageStep(mesh);
+	vector<long> order = hilbertElementOrder(mesh);
+	mesh.reorderElements(order);
+	BOOST_REQUIRE(averageStep(mesh) < randomStep/10.0);
+
+	// The elements and their factors move together
+	for (long e = 0; e < mesh.numElements(); e++) {
+		long oldE = shuffled[order[e]];
+		BOOST_REQUIRE_EQUAL(original.areas()[oldE],mesh.areas()[e]);
+		for (int a = 0; a < 3; a++) {
+			BOOST_REQUIRE_EQUAL(original.element(oldE).nodeIds()[a],
+					mesh.element(e).nodeIds()[a]);
+			BOOST_REQUIRE_EQUAL(original.element(oldE).b(a),
+					mesh.element(e).b(a));
+			BOOST_REQUIRE_EQUAL(original.element(oldE).c(a),
+					mesh.element(e).c(a));
+		}
+	}
+
+	BOOST_REQUIRE_THROW(mesh.reorderElements({0,1}),std::runtime_error);
+	order[1] = order[0];
+	BOOST_REQUIRE_THROW(mesh.reorderElements(order),std::runtime_error);
+
+	return;
+}
+
+/**
+ * This operation checks the orders of a quadratic tetrahedral mesh.
+ */
+BOOST_AUTO_TEST_CASE(checkThreeDOrders) {
+
+	int n = 6;
+	ThreeDMesh mesh = ThreeDMesh::box(n,n,n,1.0,1.0,1.0,10);
+	mesh.renumberNodes(randomOrder(mesh.numNodes()));
+	vector<int> shuffled = randomOrder(mesh.numElements());
+	mesh.reorderElements(vector<long>(shuffled.begin(),shuffled.end()));
+	int randomWidth = meshBandwidth(mesh.connectivity(),10);
+
+	mesh.renumberNodes(reverseCuthillMcKee(mesh));
+	BOOST_REQUIRE(meshBandwidth(mesh.connectivity(),10) < randomWidth/3);
+	mesh.reorderElements(hilbertElementOrder(mesh));
+
+	// The geometry is unchanged, so the volumes are still positive and the
+	// midside nodes are still at the midpoints of the edges
+	double volume = 0.0;
+	for (long e = 0; e < mesh.numElements(); e++) {
+		BOOST_REQUIRE(mesh.volumes()[e] > 0.0);
+		volume += mesh.volumes()[e];
+		const int * ids = &mesh.connectivity()[10*e];
+		BOOST_REQUIRE_SMALL(mesh.x()[ids[4]] - 0.5*(mesh.x()[ids[0]]
+				+ mesh.x()[ids[1]]),1.0e-12);
+		BOOST_REQUIRE_SMALL(mesh.z()[ids[9]] - 0.5*(mesh.z()[ids[2]]
+				+ mesh.z()[ids[3]]),1.0e-12);
+	}
+	BOOST_REQUIRE_CLOSE(1.0,volume,1.0e-10);
+	mesh.computeGeometry();
+	double recomputed = 0.0;
+	for (auto & value : mesh.volumes()) recomputed += value;
+	BOOST_REQUIRE_CLOSE(volume,recomputed,1.0e-12);
+
+	vector<int> nodeOrder = hilbertNodeOrder(mesh);
+	BOOST_REQUIRE_EQUAL(mesh.numNodes(),nodeOrder.size());
+	BOOST_REQUIRE_EQUAL(mesh.numNodes(),inversePermutation(nodeOrder).size());
+
+	return;
+}
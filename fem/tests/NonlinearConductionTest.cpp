@@ -0,0 +1,221 @@
+
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE FEM
+
+#include <boost/test/included/unit_test.hpp>
+#include <NonlinearConduction.h>
+#include <vector>
+#include <stdexcept>
+#include <math.h>
+
+using namespace std;
+using namespace fire;
+
+/**
+ * This operation creates a bar from x = 0 at 0 degrees to x = 1 at 1 degree
+ * with a conductivity of 1 + T. The Kirchhoff transform of the temperature,
+ * T + T^2/2, is linear, so T = sqrt(1 + 3x) - 1.
+ */
+static NonlinearConduction bar(const TwoDMesh & mesh) {
+	NonlinearConduction conduction(mesh,[](const double & T) {
+		return 1.0 + T;
+	});
+	conduction.conductivityDerivative([](const double &) { return 1.0;});
+	conduction.fixBoundaryTemperature(mesh,3,0.0);
+	conduction.fixBoundaryTemperature(mesh,1,1.0);
+	conduction.tolerance(1.0e-10);
+	return conduction;
+}
+
+/**
+ * This operation checks the Picard and Newton iterations against the exact
+ * solution and each other.
+ */
+BOOST_AUTO_TEST_CASE(checkSolution) {
+	TwoDMesh mesh = TwoDMesh::rectangle(40,2,1.0,0.1);
+	int n = mesh.numNodes();
+
+	auto picard = bar(mesh);
+	auto picardResult = picard.solve();
+	BOOST_REQUIRE(picardResult.converged);
+	BOOST_REQUIRE_EQUAL(picardResult.iterations + 1,
+			picardResult.history.size());
+	BOOST_REQUIRE_GT(picardResult.linearIterations,0);
+	auto & T = picard.temperature();
+	for (int i = 0; i < n; i++) {
+		double x = mesh.x()[i];
+		BOOST_REQUIRE_SMALL(sqrt(1.0 + 3.0*x) - 1.0 - T[i],1.0e-3);
+	}
+	BOOST_REQUIRE_EQUAL(0.0,T[0]);
+	BOOST_REQUIRE_EQUAL(1.0,T[40]);
+	vector<double> r;
+	picard.residual(r);
+	for (auto & value : r) BOOST_REQUIRE_SMALL(value,1.0e-8);
+	BOOST_REQUIRE_CLOSE(1.0 + (T[0] + T[1] + T[42])/3.0,
+			picard.conductivities()[0],1.0e-10);
+
+	// Newton converges quadratically to the same temperatures
+	auto newton = bar(mesh);
+	newton.method(NonlinearMethod::NEWTON);
+	newton.refactorThreshold(0.0);
+	if (!BandedSolver::lapackAvailable()) {
+		BOOST_REQUIRE_THROW(newton.solve(),runtime_error);
+		return;
+	}
+	auto newtonResult = newton.solve();
+	BOOST_REQUIRE(newtonResult.converged);
+	BOOST_REQUIRE_LT(newtonResult.iterations,picardResult.iterations);
+	BOOST_REQUIRE_EQUAL(newtonResult.iterations,newtonResult.rebuilds);
+	auto & history = newtonResult.history;
+	for (int k = 2; k < (int) history.size(); k++) {
+		double ratio = history[k]/history[k-1];
+		if (history[k] > 1.0e-12) {
+			BOOST_REQUIRE_LT(ratio,history[k-1]/history[k-2]);
+		}
+	}
+	for (int i = 0; i < n; i++) {
+		BOOST_REQUIRE_SMALL(T[i] - newton.temperature()[i],1.0e-8);
+	}
+
+	return;
+}
+
+/**
+ * This operation checks that the preconditioner is reused while the
+ * conductivity changes little.
+ */
+BOOST_AUTO_TEST_CASE(checkReuse) {
+	TwoDMesh mesh = TwoDMesh::rectangle(20,20);
+	int n = mesh.numNodes();
+
+	// The conductivity changes by a factor of two, so the preconditioner is
+	// rebuilt every iteration without reuse
+	auto picard = bar(mesh);
+	picard.rebuildThreshold(0.0);
+	auto always = picard.solve();
+	BOOST_REQUIRE(always.converged);
+	BOOST_REQUIRE_EQUAL(always.iterations,always.rebuilds);
+	auto reused = bar(mesh);
+	auto result = reused.solve();
+	BOOST_REQUIRE(result.converged);
+	BOOST_REQUIRE_LT(result.rebuilds,result.iterations);
+	for (int i = 0; i < n; i++) {
+		BOOST_REQUIRE_SMALL(picard.temperature()[i] -
+				reused.temperature()[i],1.0e-8);
+	}
+
+	return;
+}
+
+/**
+ * This operation checks that the Newton factorization is reused while the
+ * residual falls quickly, within a solve and between solves.
+ */
+BOOST_AUTO_TEST_CASE(checkNewtonReuse) {
+	if (!BandedSolver::lapackAvailable()) return;
+	TwoDMesh mesh = TwoDMesh::rectangle(20,20);
+	int n = mesh.numNodes();
+	auto reference = bar(mesh);
+	reference.method(NonlinearMethod::NEWTON);
+	reference.refactorThreshold(0.0);
+	reference.solve();
+
+	// Newton reuses the factorization in its quadratic phase
+	auto newton = bar(mesh);
+	newton.method(NonlinearMethod::NEWTON);
+	auto result = newton.solve();
+	BOOST_REQUIRE(result.converged);
+	BOOST_REQUIRE_LT(result.rebuilds,result.iterations);
+	for (int i = 0; i < n; i++) {
+		BOOST_REQUIRE_SMALL(reference.temperature()[i] -
+				newton.temperature()[i],1.0e-8);
+	}
+
+	// A small change to the boundary is solved by the chord method with the
+	// factorization of the last solve at the default threshold
+	newton.fixBoundaryTemperature(mesh,1,1.05);
+	result = newton.solve();
+	BOOST_REQUIRE(result.converged);
+	BOOST_REQUIRE_EQUAL(0,result.rebuilds);
+	reference.fixBoundaryTemperature(mesh,1,1.05);
+	reference.solve();
+	for (int i = 0; i < n; i++) {
+		BOOST_REQUIRE_SMALL(reference.temperature()[i] -
+				newton.temperature()[i],1.0e-8);
+	}
+
+	// A larger change makes the chord method slow, so it refactors
+	newton.fixBoundaryTemperature(mesh,1,2.0);
+	result = newton.solve();
+	BOOST_REQUIRE(result.converged);
+	BOOST_REQUIRE_GT(result.rebuilds,0);
+
+	return;
+}
+
+/**
+ * This operation checks that a constant conductivity with a source takes
+ * one Newton iteration and that Newton requires the derivative.
+ */
+BOOST_AUTO_TEST_CASE(checkLinear) {
+	TwoDMesh mesh = TwoDMesh::rectangle(10,10);
+	NonlinearConduction conduction(mesh,[](const double &) {
+		return 2.0;
+	}, 4.0);
+	double sum = 0.0;
+	for (auto & value : conduction.sourceVector()) sum += value;
+	BOOST_REQUIRE_CLOSE(4.0,sum,1.0e-10);
+	for (int marker = 0; marker < 4; marker++) {
+		conduction.fixBoundaryTemperature(mesh,marker,1.0);
+	}
+	conduction.method(NonlinearMethod::NEWTON);
+	BOOST_REQUIRE_THROW(conduction.solve(),runtime_error);
+	conduction.conductivityDerivative([](const double &) { return 0.0;});
+	if (!BandedSolver::lapackAvailable()) {
+		BOOST_REQUIRE_THROW(conduction.solve(),runtime_error);
+		return;
+	}
+	auto result = conduction.solve();
+	BOOST_REQUIRE(result.converged);
+	BOOST_REQUIRE_EQUAL(1,result.iterations);
+	// The center is the hottest node
+	auto & T = conduction.temperature();
+	for (int i = 0; i < mesh.numNodes(); i++) {
+		BOOST_REQUIRE_GE(T[i],1.0);
+		BOOST_REQUIRE_LE(T[i],T[60]);
+	}
+	BOOST_REQUIRE_THROW(conduction.fixTemperature(-1,0.0),out_of_range);
+
+	return;
+}
@@ -0,0 +1,152 @@
+
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE FEM
+
+#include <boost/test/included/unit_test.hpp>
+#include <RobinBoundaryIntegrals.h>
+#include <vector>
+#include <utility>
+#include <stdexcept>
+
+using namespace std;
+using namespace fire;
+
+/**
+ * This operation checks the integrals for constant and linear functions,
+ * which are known exactly.
+ */
+BOOST_AUTO_TEST_CASE(checkIntegrals) {
+
+	TwoDMesh mesh = TwoDMesh::rectangle(4,2,2.0,1.0);
+	RobinBoundaryIntegrals robin(mesh);
+	// Constant sigma and h on the right
+	robin.addBoundary(1,[](const double &) { return 2.0;},
+			[](const double &) { return 3.0;});
+	BOOST_REQUIRE_EQUAL(2,robin.numEdges());
+	// Linear sigma and h on the edge from node 0 to node 1 on the bottom
+	TwoDRobinBoundaryCondition condition(mesh.node(0),mesh.node(1),
+			[](const double & x) { return 1.0 + x;},
+			[](const double & x) { return x;});
+	robin.add(condition);
+	BOOST_REQUIRE_EQUAL(3,robin.numEdges());
+	robin.compute();
+
+	for (long k = 0; k < 2; k++) {
+		BOOST_REQUIRE_CLOSE(0.5,robin.lengths()[k],1.0e-12);
+		BOOST_REQUIRE_CLOSE(2.0*0.5/3.0,robin.stiffness(k,0,0),1.0e-10);
+		BOOST_REQUIRE_CLOSE(2.0*0.5/6.0,robin.stiffness(k,0,1),1.0e-10);
+		BOOST_REQUIRE_CLOSE(2.0*0.5/6.0,robin.stiffness(k,1,0),1.0e-10);
+		BOOST_REQUIRE_CLOSE(2.0*0.5/3.0,robin.stiffness(k,1,1),1.0e-10);
+		BOOST_REQUIRE_CLOSE(3.0*0.5/2.0,robin.force(k,0),1.0e-10);
+		BOOST_REQUIRE_CLOSE(3.0*0.5/2.0,robin.force(k,1),1.0e-10);
+		// The element contains the edge
+		auto ids = mesh.element(robin.elements()[k]).nodeIds();
+		for (int a = 0; a < 2; a++) {
+			BOOST_REQUIRE(find(ids.begin(),ids.end(),robin.nodes()[2*k+a])
+					!= ids.end());
+		}
+	}
+	// For sigma = 1 + x on an edge of length L, the integrals of sigma N1 N1,
+	// sigma N1 N2 and sigma N2 N2 over [-1,1] are 1/3, 1/3 and 1 and those of
+	// x N1 and x N2 are -1/3 and 1/3, all times L/2
+	double l = 0.5*robin.lengths()[2];
+	BOOST_REQUIRE_CLOSE(0.5,robin.lengths()[2],1.0e-12);
+	BOOST_REQUIRE_CLOSE(l/3.0,robin.stiffness(2,0,0),1.0e-10);
+	BOOST_REQUIRE_CLOSE(l/3.0,robin.stiffness(2,0,1),1.0e-10);
+	BOOST_REQUIRE_CLOSE(l,robin.stiffness(2,1,1),1.0e-10);
+	BOOST_REQUIRE_CLOSE(-l/3.0,robin.force(2,0),1.0e-10);
+	BOOST_REQUIRE_CLOSE(l/3.0,robin.force(2,1),1.0e-10);
+
+	// Moving the nodes changes the lengths
+	for (auto & x : mesh.x()) x *= 2.0;
+	for (auto & y : mesh.y()) y *= 3.0;
+	robin.compute();
+	BOOST_REQUIRE_CLOSE(1.5,robin.lengths()[0],1.0e-12);
+	BOOST_REQUIRE_CLOSE(2.0*1.5/3.0,robin.stiffness(0,0,0),1.0e-10);
+	BOOST_REQUIRE_CLOSE(1.0,robin.lengths()[2],1.0e-12);
+
+	return;
+}
+
+/**
+ * This operation checks assembly into the global system and the errors.
+ */
+BOOST_AUTO_TEST_CASE(checkAssembly) {
+
+	TwoDMesh mesh = TwoDMesh::rectangle(10,5,2.0,1.0);
+	RobinBoundaryIntegrals robin(mesh);
+	for (int marker = 0; marker < 4; marker++) {
+		robin.addBoundary(marker,[](const double &) { return 0.5;},
+				[](const double &) { return 4.0;});
+	}
+	BOOST_REQUIRE_EQUAL(30,robin.numEdges());
+	robin.compute();
+
+	auto & ids = mesh.connectivity();
+	vector<pair<int,int>> entries;
+	for (long e = 0; e < mesh.numElements(); e++) {
+		for (int i = 0; i < 3; i++) {
+			for (int j = 0; j < 3; j++) {
+				entries.emplace_back(ids[3*e+i],ids[3*e+j]);
+			}
+		}
+	}
+	CSRMatrix<double> matrix(mesh.numNodes(),entries);
+	vector<double> force(mesh.numNodes(),0.0);
+	robin.assemble(matrix);
+	robin.assemble(force);
+	// The sums are sigma and h times the perimeter
+	double matrixSum = 0.0, forceSum = 0.0;
+	for (double value : matrix.values) matrixSum += value;
+	for (double value : force) forceSum += value;
+	BOOST_REQUIRE_CLOSE(0.5*6.0,matrixSum,1.0e-10);
+	BOOST_REQUIRE_CLOSE(4.0*6.0,forceSum,1.0e-10);
+	// The corner has half of an edge on each side
+	BOOST_REQUIRE_CLOSE(0.5*(0.2 + 0.2)/3.0,matrix(0,0),1.0e-10);
+	BOOST_REQUIRE_CLOSE(4.0*(0.2 + 0.2)/2.0,force[0],1.0e-10);
+	// Interior nodes have nothing
+	BOOST_REQUIRE_EQUAL(0.0,force[12]);
+
+	// An edge can only have one condition, and the nodes must share an edge
+	auto sigma = [](const double &) { return 1.0;};
+	BOOST_REQUIRE_THROW(robin.add(TwoDRobinBoundaryCondition(mesh.node(1),
+			mesh.node(0),sigma,sigma)),runtime_error);
+	BOOST_REQUIRE_THROW(robin.add(TwoDRobinBoundaryCondition(mesh.node(0),
+			mesh.node(2),sigma,sigma)),runtime_error);
+	BOOST_REQUIRE_EQUAL(30,robin.numEdges());
+	CSRMatrix<double> small(2,vector<pair<int,int>>{{0,0},{1,1}});
+	BOOST_REQUIRE_THROW(robin.assemble(small),runtime_error);
+
+	return;
+}
@@ -0,0 +1,282 @@
+
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE FEM
+
+#include <boost/test/included/unit_test.hpp>
+#include <TetConduction.h>
+#include <ThreeDMesh.h>
+#include <SkylineCholesky.h>
+#include <CSRMatrix.h>
+#include <ThreadPool.h>
+#include <vector>
+#include <functional>
+#include <stdexcept>
+#include <cmath>
+
+using namespace std;
+using namespace fire;
+
+/**
+ * This operation returns true if a node is on the boundary of the
+ * 10x10x10 cube.
+ */
+static bool onBoundary(const ThreeDMesh & mesh, const int & id) {
+	for (double c : {mesh.x()[id], mesh.y()[id], mesh.z()[id]}) {
+		if (fabs(c) < 1.0e-12 || fabs(c - 10.0) < 1.0e-12) return true;
+	}
+	return false;
+}
+
+/**
+ * This operation evaluates a field at the nodes of a mesh.
+ */
+static vector<double> nodalField(const ThreeDMesh & mesh,
+		const function<double(double,double,double)> & field) {
+	vector<double> values(mesh.numNodes());
+	for (int i = 0; i < mesh.numNodes(); i++) {
+		values[i] = field(mesh.x()[i],mesh.y()[i],mesh.z()[i]);
+	}
+	return values;
+}
+
+/**
+ * This operation checks the element matrices against the closed forms for
+ * linear tetrahedra and the properties of the quadratic ones.
+ */
+BOOST_AUTO_TEST_CASE(checkElementMatrices) {
+
+	ThreeDMesh linear = ThreeDMesh::box(1,1,1,1.0,2.0,3.0);
+	Tet4Conduction tet4(linear);
+	array<double,16> k4, m4;
+	for (long e = 0; e < linear.numElements(); e++) {
+		double volume = linear.volumes()[e];
+		const double * g = &linear.gradients()[12*e];
+		tet4.elementStiffness(e,2.0,k4.data());
+		tet4.elementMass(e,3.0,m4.data());
+		for (int i = 0; i < 4; i++) {
+			for (int j = 0; j < 4; j++) {
+				double dot = g[3*i]*g[3*j] + g[3*i+1]*g[3*j+1]
+						+ g[3*i+2]*g[3*j+2];
+				BOOST_REQUIRE_CLOSE(2.0*volume*dot,k4[4*i+j],1.0e-10);
+				double mass = 3.0*volume*((i == j) ? 0.1 : 0.05);
+				BOOST_REQUIRE_CLOSE(mass,m4[4*i+j],1.0e-10);
+			}
+		}
+	}
+
+	ThreeDMesh quadratic = ThreeDMesh::box(1,1,1,1.0,2.0,3.0,10);
+	Tet10Conduction tet10(quadratic);
+	array<double,100> k10, m10;
+	for (long e = 0; e < quadratic.numElements(); e++) {
+		tet10.elementStiffness(e,2.0,k10.data());
+		tet10.elementMass(e,3.0,m10.data());
+		double massSum = 0.0;
+		for (int i = 0; i < 10; i++) {
+			double rowSum = 0.0;
+			BOOST_REQUIRE(k10[11*i] > 0.0);
+			for (int j = 0; j < 10; j++) {
+				BOOST_REQUIRE_EQUAL(k10[10*i+j],k10[10*j+i]);
+				BOOST_REQUIRE_EQUAL(m10[10*i+j],m10[10*j+i]);
+				rowSum += k10[10*i+j];
+				massSum += m10[10*i+j];
+			}
+			// Constants are in the null space of the stiffness
+			BOOST_REQUIRE_SMALL(rowSum,1.0e-12);
+		}
+		BOOST_REQUIRE_CLOSE(3.0*quadratic.volumes()[e],massSum,1.0e-10);
+		// The classical corner and edge entries of the consistent mass
+		BOOST_REQUIRE_CLOSE(3.0*quadratic.volumes()[e]/70.0,m10[0],1.0e-10);
+		BOOST_REQUIRE_CLOSE(3.0*quadratic.volumes()[e]*8.0/105.0,m10[44],
+				1.0e-10);
+	}
+
+	// The mesh must match the element
+	BOOST_REQUIRE_THROW(Tet10Conduction wrong(linear),std::runtime_error);
+
+	return;
+}
+
+/**
+ * This operation checks the patch test on the Warp3D cube meshes. The
+ * assembled stiffness times a field that the elements represent exactly and
+ * that satisfies Laplace's equation must vanish at the interior nodes.
+ */
+BOOST_AUTO_TEST_CASE(checkPatch) {
+
+	auto linearField = [](double x, double y, double z) {
+		return 1.0 + 2.0*x - y + 0.5*z;
+	};
+	auto quadraticField = [](double x, double y, double z) {
+		return x*x - y*y + y*z + 3.0*x;
+	};
+
+	ThreeDMesh linear = ThreeDMesh::readWarp3D("cube_tet4.inp");
+	Tet4Conduction tet4(linear);
+	CSRMatrix<double> k4 = tet4.matrix();
+	tet4.assembleStiffness(k4,45.0);
+	vector<double> field = nodalField(linear,linearField), result;
+	result.resize(field.size());
+	k4.multiply(field,result);
+	int interior = 0;
+	for (int i = 0; i < linear.numNodes(); i++) {
+		if (onBoundary(linear,i)) continue;
+		BOOST_REQUIRE_SMALL(result[i],1.0e-10);
+		interior++;
+	}
+	BOOST_REQUIRE_EQUAL(8,interior);
+
+	ThreeDMesh quadratic = ThreeDMesh::readWarp3D("cube_tet10.inp");
+	Tet10Conduction tet10(quadratic);
+	CSRMatrix<double> k10 = tet10.matrix();
+	tet10.assembleStiffness(k10,45.0);
+	for (auto f : {function<double(double,double,double)>(linearField),
+			function<double(double,double,double)>(quadraticField)}) {
+		field = nodalField(quadratic,f);
+		result.resize(field.size());
+		k10.multiply(field,result);
+		for (int i = 0; i < quadratic.numNodes(); i++) {
+			if (!onBoundary(quadratic,i)) {
+				BOOST_REQUIRE_SMALL(result[i],1.0e-9);
+			}
+		}
+	}
+
+	return;
+}
+
+/**
+ * This operation checks a steady state with a uniform heat source on the
+ * quadratic cube mesh, for which the exact temperature is quadratic and is
+ * reproduced at every node.
+ */
+BOOST_AUTO_TEST_CASE(checkSteadyState) {
+
+	double kappa = 2.0, source = 3.0;
+	auto exact = [&](double x, double y, double z) {
+		return 20.0 - source*x*x/(2.0*kappa) + 0.1*y*z;
+	};
+	ThreeDMesh mesh = ThreeDMesh::readWarp3D("cube_tet10.inp");
+	Tet10Conduction conduction(mesh);
+	CSRMatrix<double> stiffness = conduction.matrix();
+	conduction.assembleStiffness(stiffness,
+			vector<double>(mesh.numElements(),kappa));
+	vector<double> load, temperature(mesh.numNodes());
+	conduction.assembleSource(load,source);
+	double totalLoad = 0.0;
+	for (double value : load) totalLoad += value;
+	BOOST_REQUIRE_CLOSE(1000.0*source,totalLoad,1.0e-10);
+
+	// Fix the boundary by symmetric elimination
+	vector<double> fixed = nodalField(mesh,exact);
+	vector<bool> isFixed(mesh.numNodes());
+	for (int i = 0; i < mesh.numNodes(); i++) isFixed[i] = onBoundary(mesh,i);
+	for (int i = 0; i < mesh.numNodes(); i++) {
+		for (long k = stiffness.rowOffsets[i]; k < stiffness.rowOffsets[i+1];
+				k++) {
+			int j = stiffness.columns[k];
+			if (isFixed[i] || isFixed[j]) {
+				if (!isFixed[i]) load[i] -= stiffness.values[k]*fixed[j];
+				stiffness.values[k] = (i == j) ? 1.0 : 0.0;
+			}
+		}
+		if (isFixed[i]) load[i] = fixed[i];
+	}
+	SkylineCholesky cholesky;
+	cholesky.factor(stiffness);
+	cholesky.solve(load,temperature);
+	for (int i = 0; i < mesh.numNodes(); i++) {
+		BOOST_REQUIRE_CLOSE(fixed[i],temperature[i],1.0e-9);
+	}
+
+	return;
+}
+
+/**
+ * This operation checks that parallel assembly matches serial assembly
+ * exactly, that the coloring is valid and that the lumped mass is positive.
+ */
+BOOST_AUTO_TEST_CASE(checkParallelAssembly) {
+
+	ThreeDMesh mesh = ThreeDMesh::box(6,5,4,1.0,1.0,1.0,10);
+	ThreadPool serialPool(1), parallelPool(4,1);
+	Tet10Conduction serial(mesh,serialPool), parallel(mesh,parallelPool);
+
+	// No two elements of the same color share a node
+	long numColored = 0;
+	for (auto & color : parallel.colors()) {
+		vector<bool> used(mesh.numNodes(),false);
+		for (long e : color) {
+			for (int a = 0; a < 10; a++) {
+				int id = mesh.connectivity()[10*e + a];
+				BOOST_REQUIRE(!used[id]);
+				used[id] = true;
+			}
+		}
+		numColored += color.size();
+	}
+	BOOST_REQUIRE_EQUAL(mesh.numElements(),numColored);
+
+	vector<double> kappa(mesh.numElements());
+	for (long e = 0; e < mesh.numElements(); e++) kappa[e] = 1.0 + e%7;
+	CSRMatrix<double> serialK = serial.matrix(), parallelK = parallel.matrix();
+	serial.assembleStiffness(serialK,kappa);
+	parallel.assembleStiffness(parallelK,kappa);
+	BOOST_REQUIRE(serialK.values == parallelK.values);
+	CSRMatrix<double> serialM = serial.matrix(), parallelM = parallel.matrix();
+	serial.assembleMass(serialM,2.0);
+	parallel.assembleMass(parallelM,2.0);
+	BOOST_REQUIRE(serialM.values == parallelM.values);
+	double massSum = 0.0;
+	for (double value : parallelM.values) massSum += value;
+	BOOST_REQUIRE_CLOSE(2.0,massSum,1.0e-10);
+
+	vector<double> lumped;
+	parallel.assembleLumpedMass(lumped,2.0);
+	BOOST_REQUIRE_EQUAL(mesh.numNodes(),lumped.size());
+	double lumpedSum = 0.0;
+	for (double value : lumped) {
+		BOOST_REQUIRE(value > 0.0);
+		lumpedSum += value;
+	}
+	BOOST_REQUIRE_CLOSE(2.0,lumpedSum,1.0e-10);
+
+	// Errors
+	CSRMatrix<double> other = Tet4Conduction(ThreeDMesh::box(1,1,1)).matrix();
+	BOOST_REQUIRE_THROW(parallel.assembleStiffness(other),std::runtime_error);
+	BOOST_REQUIRE_THROW(parallel.assembleMass(other),std::runtime_error);
+	BOOST_REQUIRE_THROW(parallel.assembleStiffness(parallelK,
+			vector<double>(3,1.0)),std::runtime_error);
+
+	return;
+}
@@ -0,0 +1,336 @@
+
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE FEM
+
+#include <boost/test/included/unit_test.hpp>
+#include <ThreeDMesh.h>
+#include <vector>
+#include <sstream>
+#include <stdexcept>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <cstdio>
+
+using namespace std;
+using namespace fire;
+
+/**
+ * This operation checks that the gradients of the volume coordinates of an
+ * element are dual to its edges, grad L_a . (p_b - p_0) = delta_ab - delta_a0
+ * for the corners b = 1, 2, 3.
+ */
+static void checkGradients(const ThreeDMesh & mesh, const long & e) {
+	int n = mesh.nodesPerElement();
+	const int * ids = &mesh.connectivity()[n*e];
+	const double * g = &mesh.gradients()[12*e];
+	for (int a = 0; a < 4; a++) {
+		for (int b = 1; b < 4; b++) {
+			double dx = mesh.x()[ids[b]] - mesh.x()[ids[0]],
+					dy = mesh.y()[ids[b]] - mesh.y()[ids[0]],
+					dz = mesh.z()[ids[b]] - mesh.z()[ids[0]];
+			double dot = g[3*a]*dx + g[3*a+1]*dy + g[3*a+2]*dz;
+			double expected = (a == b) ? 1.0 : ((a == 0) ? -1.0 : 0.0);
+			BOOST_REQUIRE_SMALL(dot - expected,1.0e-12);
+		}
+	}
+}
+
+/**
+ * This operation checks that the midside nodes of a quadratic element are
+ * at the midpoints of its edges, in Warp3D order.
+ */
+static void checkMidsideNodes(const ThreeDMesh & mesh, const long & e) {
+	const int edges[6][2] = {{0,1}, {1,2}, {2,0}, {0,3}, {1,3}, {2,3}};
+	const int * ids = &mesh.connectivity()[10*e];
+	for (int m = 0; m < 6; m++) {
+		int p = ids[edges[m][0]], q = ids[edges[m][1]], mid = ids[4+m];
+		BOOST_REQUIRE_SMALL(mesh.x()[mid] - 0.5*(mesh.x()[p] + mesh.x()[q]),
+				1.0e-12);
+		BOOST_REQUIRE_SMALL(mesh.y()[mid] - 0.5*(mesh.y()[p] + mesh.y()[q]),
+				1.0e-12);
+		BOOST_REQUIRE_SMALL(mesh.z()[mid] - 0.5*(mesh.z()[p] + mesh.z()[q]),
+				1.0e-12);
+	}
+}
+
+/**
+ * This operation checks building a mesh by hand.
+ */
+BOOST_AUTO_TEST_CASE(checkAddElement) {
+
+	BOOST_REQUIRE_THROW(ThreeDMesh(8),std::runtime_error);
+
+	ThreeDMesh mesh;
+	BOOST_REQUIRE_EQUAL(4,mesh.nodesPerElement());
+	BOOST_REQUIRE_EQUAL(0,mesh.addNode(1.0,1.0,1.0));
+	mesh.addNode(3.0,1.0,1.0);
+	mesh.addNode(1.0,4.0,1.0);
+	mesh.addNode(1.0,1.0,5.0);
+	BOOST_REQUIRE_EQUAL(0,mesh.addElement({0,1,2,3}));
+	BOOST_REQUIRE_EQUAL(4,mesh.numNodes());
+	BOOST_REQUIRE_EQUAL(1,mesh.numElements());
+	// 2*3*4/6
+	BOOST_REQUIRE_CLOSE(4.0,mesh.volumes()[0],1.0e-12);
+	checkGradients(mesh,0);
+	BOOST_REQUIRE_CLOSE(0.5,mesh.gradients()[3],1.0e-12);
+	BOOST_REQUIRE_CLOSE(0.25,mesh.gradients()[11],1.0e-12);
+
+	// Swapping two corners inverts the element and flattening it makes it
+	// degenerate, and neither is added
+	BOOST_REQUIRE_THROW(mesh.addElement({0,2,1,3}),std::runtime_error);
+	int flat = mesh.addNode(2.0,2.0,1.0);
+	BOOST_REQUIRE_THROW(mesh.addElement({0,1,2,flat}),std::runtime_error);
+	BOOST_REQUIRE_EQUAL(1,mesh.numElements());
+	BOOST_REQUIRE_EQUAL(4,mesh.connectivity().size());
+	BOOST_REQUIRE_EQUAL(12,mesh.gradients().size());
+	BOOST_REQUIRE_EQUAL(1,mesh.volumes().size());
+
+	// Moving a node requires the geometry to be recomputed
+	mesh.z()[3] = 9.0;
+	BOOST_REQUIRE_CLOSE(4.0,mesh.volumes()[0],1.0e-12);
+	mesh.computeGeometry();
+	BOOST_REQUIRE_CLOSE(8.0,mesh.volumes()[0],1.0e-12);
+	checkGradients(mesh,0);
+
+	// Bad elements
+	BOOST_REQUIRE_THROW(mesh.addElement({0,1,2}),std::runtime_error);
+	BOOST_REQUIRE_THROW(mesh.addElement({0,1,2,5}),std::out_of_range);
+	BOOST_REQUIRE_THROW(mesh.addElement({0,1,1,3}),std::runtime_error);
+
+	BOOST_REQUIRE_EQUAL(15*sizeof(double) + 4*sizeof(int)
+			+ 13*sizeof(double),mesh.memoryUsage());
+
+	return;
+}
+
+/**
+ * This operation checks the structured box meshes.
+ */
+BOOST_AUTO_TEST_CASE(checkBox) {
+
+	int nx = 2, ny = 3, nz = 4;
+	int corners = (nx+1)*(ny+1)*(nz+1);
+	long cubes = nx*ny*nz;
+	ThreeDMesh linear = ThreeDMesh::box(nx,ny,nz,1.0,2.0,3.0);
+	BOOST_REQUIRE_EQUAL(corners,linear.numNodes());
+	BOOST_REQUIRE_EQUAL(6*cubes,linear.numElements());
+	double volume = 0.0;
+	for (long e = 0; e < linear.numElements(); e++) {
+		BOOST_REQUIRE(linear.volumes()[e] > 0.0);
+		volume += linear.volumes()[e];
+		checkGradients(linear,e);
+	}
+	BOOST_REQUIRE_CLOSE(6.0,volume,1.0e-10);
+	// Node (i,j,k)
+	int id = (3*(ny+1) + 2)*(nx+1) + 1;
+	BOOST_REQUIRE_CLOSE(0.5,linear.x()[id],1.0e-12);
+	BOOST_REQUIRE_CLOSE(4.0/3.0,linear.y()[id],1.0e-12);
+	BOOST_REQUIRE_CLOSE(2.25,linear.z()[id],1.0e-12);
+
+	// The quadratic mesh is conforming if every edge has one midside node.
+	// The edges are along the axes, across one diagonal of each face and
+	// across one diagonal of each cube.
+	ThreeDMesh quadratic = ThreeDMesh::box(nx,ny,nz,1.0,2.0,3.0,10);
+	int axisEdges = nx*(ny+1)*(nz+1) + ny*(nx+1)*(nz+1) + nz*(nx+1)*(ny+1);
+	int faceEdges = nx*ny*(nz+1) + ny*nz*(nx+1) + nx*nz*(ny+1);
+	BOOST_REQUIRE_EQUAL(corners + axisEdges + faceEdges + cubes,
+			quadratic.numNodes());
+	BOOST_REQUIRE_EQUAL(10,quadratic.nodesPerElement());
+	for (long e = 0; e < quadratic.numElements(); e++) {
+		BOOST_REQUIRE_EQUAL(linear.volumes()[e],quadratic.volumes()[e]);
+		checkMidsideNodes(quadratic,e);
+	}
+
+	BOOST_REQUIRE_THROW(ThreeDMesh::box(0,1,1),std::runtime_error);
+
+	return;
+}
+
+/**
+ * This operation checks reading the Warp3D meshes of the 10x10x10 cube in
+ * ganjiang/examples/cube.step that are written by ExportTet4.py and
+ * ExportTet10.py.
+ */
+BOOST_AUTO_TEST_CASE(checkReadWarp3D) {
+
+	ThreeDMesh linear = ThreeDMesh::readWarp3D("cube_tet4.inp");
+	ThreeDMesh quadratic = ThreeDMesh::readWarp3D("cube_tet10.inp");
+	BOOST_REQUIRE_EQUAL(4,linear.nodesPerElement());
+	BOOST_REQUIRE_EQUAL(10,quadratic.nodesPerElement());
+	BOOST_REQUIRE_EQUAL(64,linear.numNodes());
+	BOOST_REQUIRE_EQUAL(162,linear.numElements());
+	BOOST_REQUIRE_EQUAL(162,quadratic.numElements());
+	for (auto mesh : {&linear, &quadratic}) {
+		double volume = 0.0;
+		for (long e = 0; e < mesh->numElements(); e++) {
+			// Warp3D elements have positive volumes
+			BOOST_REQUIRE(mesh->volumes()[e] > 0.0);
+			volume += mesh->volumes()[e];
+			checkGradients(*mesh,e);
+		}
+		BOOST_REQUIRE_CLOSE(1000.0,volume,1.0e-10);
+	}
+	for (long e = 0; e < quadratic.numElements(); e++) {
+		checkMidsideNodes(quadratic,e);
+	}
+	// The first node and the last element
+	BOOST_REQUIRE_EQUAL(0.0,linear.x()[0]);
+	BOOST_REQUIRE_CLOSE(10.0,linear.z()[63],1.0e-12);
+	vector<int> last = {42,47,46,63};
+	for (int a = 0; a < 4; a++) {
+		BOOST_REQUIRE_EQUAL(last[a],linear.connectivity()[4*161 + a]);
+	}
+
+	// Errors
+	BOOST_REQUIRE_THROW(ThreeDMesh::readWarp3D("missing.inp"),
+			std::runtime_error);
+	stringstream skipped("c\ncoordinates\n  1\t0.0\t0.0\t0.0\n"
+			"  3\t1.0\t0.0\t0.0\n");
+	BOOST_REQUIRE_THROW(ThreeDMesh::readWarp3D(skipped),std::runtime_error);
+	stringstream noElements("coordinates\n  1\t0.0\t0.0\t0.0\n");
+	BOOST_REQUIRE_THROW(ThreeDMesh::readWarp3D(noElements),
+			std::runtime_error);
+	stringstream badElement("coordinates\n 1 0 0 0\n 2 1 0 0\n 3 0 1 0\n"
+			" 4 0 0 1\nincidences\n 1 1 2 3\n");
+	BOOST_REQUIRE_THROW(ThreeDMesh::readWarp3D(badElement),
+			std::runtime_error);
+	stringstream extraField("coordinates\n 1 0 0 0 0\n 2 1 0 0\n 3 0 1 0\n"
+			" 4 0 0 1\nincidences\n 1 1 2 3 4\n");
+	BOOST_REQUIRE_THROW(ThreeDMesh::readWarp3D(extraField),
+			std::runtime_error);
+	stringstream good("c comment\ncoordinates\n*echo off\n 1 0 0 0\n"
+			" 2 1 0 0\n 3 0 1 0\n 4 0 0 1\nc\nincidences\n 1 1 2 3 4\n"
+			"*echo on\nblocking\n 1 1 1\n");
+	ThreeDMesh mesh = ThreeDMesh::readWarp3D(good);
+	BOOST_REQUIRE_EQUAL(1,mesh.numElements());
+	BOOST_REQUIRE_CLOSE(1.0/6.0,mesh.volumes()[0],1.0e-12);
+
+	return;
+}
+
+/**
+ * This operation writes a mesh in the Warp3D format of ExportTet4.py and
+ * ExportTet10.py, one field per tab, with a line ending.
+ */
+static void writeWarp3D(const ThreeDMesh & mesh, ostream & stream,
+		const string & ending = "\n") {
+	stream << setprecision(17);
+	stream << "c" << ending << "c " << mesh.numNodes() << " nodes" << ending
+			<< "coordinates" << ending << "*echo off" << ending;
+	for (int i = 0; i < mesh.numNodes(); i++) {
+		stream << "  " << i + 1 << "\t" << mesh.x()[i] << "\t" << mesh.y()[i]
+				<< "\t" << mesh.z()[i] << "\t" << ending;
+	}
+	stream << "incidences" << ending;
+	int n = mesh.nodesPerElement();
+	for (long e = 0; e < mesh.numElements(); e++) {
+		stream << "  " << e + 1 << "\t";
+		for (int a = 0; a < n; a++) {
+			stream << mesh.connectivity()[n*e + a] + 1 << "\t";
+		}
+		stream << ending;
+	}
+	stream << "*echo on" << ending;
+}
+
+/**
+ * This operation checks that large files, which are split into many chunks,
+ * are read exactly by any number of threads and that errors are reported
+ * on the right line.
+ */
+BOOST_AUTO_TEST_CASE(checkReadWarp3DParallel) {
+
+	ThreeDMesh box = ThreeDMesh::box(10,11,12,1.0,2.0/3.0,0.7,10);
+	{
+		ofstream file("parallel_tet10.inp");
+		writeWarp3D(box,file);
+	}
+	ThreadPool serial(1,1), threaded(4,1);
+	stringstream windows;
+	writeWarp3D(box,windows,"\r\n");
+	vector<ThreeDMesh> meshes;
+	meshes.push_back(ThreeDMesh::readWarp3D("parallel_tet10.inp",threaded));
+	meshes.push_back(ThreeDMesh::readWarp3D("parallel_tet10.inp",serial));
+	meshes.push_back(ThreeDMesh::readWarp3D(windows,threaded));
+	for (auto & mesh : meshes) {
+		BOOST_REQUIRE_EQUAL(10,mesh.nodesPerElement());
+		BOOST_REQUIRE_EQUAL(box.numNodes(),mesh.numNodes());
+		BOOST_REQUIRE_EQUAL(box.numElements(),mesh.numElements());
+		BOOST_REQUIRE(box.x() == mesh.x());
+		BOOST_REQUIRE(box.y() == mesh.y());
+		BOOST_REQUIRE(box.z() == mesh.z());
+		BOOST_REQUIRE(box.connectivity() == mesh.connectivity());
+		BOOST_REQUIRE(box.volumes() == mesh.volumes());
+		BOOST_REQUIRE(box.gradients() == mesh.gradients());
+	}
+
+	// Break node 5000, which is on line 5004, and element 7000
+	stringstream text;
+	writeWarp3D(box,text);
+	string broken = text.str();
+	size_t line = broken.find("\n  5000\t");
+	stringstream badNode(broken.substr(0,line) + "\n  5000\t1.0e\t"
+			+ broken.substr(line + 9));
+	auto onLine = [](const string & number) {
+		return [number](const runtime_error & error) {
+			return string(error.what()).find(" line " + number + ".")
+					!= string::npos;
+		};
+	};
+	BOOST_REQUIRE_EXCEPTION(ThreeDMesh::readWarp3D(badNode,threaded),
+			runtime_error,onLine("5004"));
+	line = broken.find("\n  7000\t",broken.find("incidences"));
+	stringstream badElement(broken.substr(0,line) + "\n  7000\t1\t1\t"
+			+ broken.substr(line + 9));
+	string elementLine = to_string(5 + box.numNodes() + 7000);
+	BOOST_REQUIRE_EXCEPTION(ThreeDMesh::readWarp3D(badElement,threaded),
+			runtime_error,onLine(elementLine));
+
+	// Extra fields after the expected ones are errors too
+	line = broken.find("\n",broken.find("\n  5000\t") + 1);
+	stringstream extraNode(broken.substr(0,line) + "1.0"
+			+ broken.substr(line));
+	BOOST_REQUIRE_EXCEPTION(ThreeDMesh::readWarp3D(extraNode,threaded),
+			runtime_error,onLine("5004"));
+	line = broken.find("\n",broken.find("\n  7000\t",
+			broken.find("incidences")) + 1);
+	stringstream extraElement(broken.substr(0,line) + " x"
+			+ broken.substr(line));
+	BOOST_REQUIRE_EXCEPTION(ThreeDMesh::readWarp3D(extraElement,threaded),
+			runtime_error,onLine(elementLine));
+	remove("parallel_tet10.inp");
+
+	return;
+}
@@ -0,0 +1,212 @@
+
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE FEM
+
+#include <boost/test/included/unit_test.hpp>
+#include <TransientConduction.h>
+#include <RKSolver.h>
+#include <TwoDMesh.h>
+#include <vector>
+#include <cmath>
+
+using namespace std;
+using namespace fire;
+
+/**
+ * This operation checks the assembled matrices and source on the unit
+ * square: the mass and source sum to rho*c and q times the area and the rows
+ * of the stiffness matrix sum to zero.
+ */
+BOOST_AUTO_TEST_CASE(checkAssembly) {
+
+	TwoDMesh mesh = TwoDMesh::rectangle(4,3,2.0,1.0);
+	TransientConduction conduction(mesh, 3.0, 2.5, 4.0,
+			MassMatrixType::CONSISTENT);
+	BOOST_REQUIRE_EQUAL(mesh.numNodes(),conduction.size());
+
+	auto & mass = conduction.massMatrix();
+	auto & stiffness = conduction.stiffnessMatrix();
+	double massSum = 0.0, sourceSum = 0.0;
+	for (auto & value : mass.values) massSum += value;
+	for (auto & value : conduction.sourceVector()) sourceSum += value;
+	BOOST_REQUIRE_CLOSE(2.5*2.0,massSum,1.0e-10);
+	BOOST_REQUIRE_CLOSE(4.0*2.0,sourceSum,1.0e-10);
+	for (int i = 0; i < stiffness.size(); i++) {
+		double rowSum = 0.0;
+		for (long k = stiffness.rowOffsets[i]; k < stiffness.rowOffsets[i+1];
+				k++) {
+			rowSum += stiffness.values[k];
+			BOOST_REQUIRE_CLOSE(stiffness(stiffness.columns[k],i) + 1.0,
+					stiffness.values[k] + 1.0,1.0e-12);
+		}
+		BOOST_REQUIRE_SMALL(rowSum,1.0e-12);
+		BOOST_REQUIRE(stiffness(i,i) > 0.0);
+	}
+
+	BOOST_REQUIRE_THROW(conduction.fixTemperature(-1,0.0),std::out_of_range);
+	BOOST_REQUIRE_THROW(conduction.jacobian(),std::logic_error);
+
+	return;
+}
+
+/**
+ * This operation checks that backward Euler steps converge to the steady
+ * state of a uniformly heated bar with both ends at T = 0, which is
+ * T = qx(1-x)/(2 kappa), and that the step matrix is only factored once.
+ */
+BOOST_AUTO_TEST_CASE(checkSteadyState) {
+
+	double kappa = 2.0, q = 8.0;
+	TwoDMesh mesh = TwoDMesh::rectangle(10,3,1.0,0.3);
+	TransientConduction conduction(mesh, kappa, 1.0, q);
+	conduction.fixBoundaryTemperature(mesh, 1, 0.0);
+	conduction.fixBoundaryTemperature(mesh, 3, 0.0);
+	conduction.temperature(1.0);
+	for (int i = 0; i < 50; i++) conduction.step(10.0);
+	BOOST_REQUIRE_EQUAL(1,conduction.factorizations());
+	BOOST_REQUIRE_CLOSE(500.0,conduction.time(),1.0e-10);
+
+	auto & temperature = conduction.temperature();
+	for (int id = 0; id < mesh.numNodes(); id++) {
+		double x = mesh.x()[id];
+		double exact = q*x*(1.0 - x)/(2.0*kappa);
+		BOOST_REQUIRE_SMALL(temperature[id] - exact,1.0e-8);
+	}
+
+	// A new time step size requires a new factorization
+	conduction.step(5.0);
+	conduction.step(5.0);
+	BOOST_REQUIRE_EQUAL(2,conduction.factorizations());
+
+	return;
+}
+
+/**
+ * This operation checks Crank-Nicolson steps with the consistent mass matrix
+ * against the decay of the first mode of a bar, T = exp(-pi^2 t) sin(pi x).
+ */
+BOOST_AUTO_TEST_CASE(checkDecay) {
+
+	TwoDMesh mesh = TwoDMesh::rectangle(20,2,1.0,0.1);
+	TransientConduction conduction(mesh, 1.0, 1.0, 0.0,
+			MassMatrixType::CONSISTENT);
+	conduction.fixBoundaryTemperature(mesh, 1, 0.0);
+	conduction.fixBoundaryTemperature(mesh, 3, 0.0);
+	auto & temperature = conduction.temperature();
+	for (int id = 0; id < mesh.numNodes(); id++) {
+		temperature[id] = sin(M_PI*mesh.x()[id]);
+	}
+	for (int i = 0; i < 100; i++) conduction.step(1.0e-3, 0.5);
+	BOOST_REQUIRE_EQUAL(1,conduction.factorizations());
+
+	double decay = exp(-M_PI*M_PI*0.1);
+	for (int id = 0; id < mesh.numNodes(); id++) {
+		double exact = decay*sin(M_PI*mesh.x()[id]);
+		BOOST_REQUIRE_SMALL(temperature[id] - exact,5.0e-3);
+	}
+
+	return;
+}
+
+/**
+ * This operation checks the State specialization: the derivatives and
+ * Jacobian against the matrices, and an RKSolver integration against the
+ * theta method.
+ */
+BOOST_AUTO_TEST_CASE(checkState) {
+
+	TwoDMesh mesh = TwoDMesh::rectangle(6,2,1.0,0.3);
+	int n = mesh.numNodes();
+
+	// The consistent mass matrix solves M dT/dt = f - KT on the free nodes
+	TransientConduction consistent(mesh, 1.5, 1.0, 2.0,
+			MassMatrixType::CONSISTENT);
+	consistent.fixBoundaryTemperature(mesh, 3, 1.0);
+	for (int id = 0; id < n; id++) {
+		if (!consistent.isFixed(id)) consistent.temperature()[id] = mesh.y()[id];
+	}
+	State<TransientConduction> consistentState(consistent, n);
+	double * dudt = consistentState.dudt(0.0);
+	vector<double> rates(dudt, dudt + n), mDudt, kT;
+	vector<double> temperatures(consistentState.u(), consistentState.u() + n);
+	consistent.massMatrix().multiply(rates, mDudt);
+	consistent.stiffnessMatrix().multiply(temperatures, kT);
+	for (int id = 0; id < n; id++) {
+		if (consistent.isFixed(id)) {
+			BOOST_REQUIRE_EQUAL(0.0,rates[id]);
+		} else {
+			// The fixed nodes do not move, so their mass terms drop out
+			double m = 0.0;
+			auto & mass = consistent.massMatrix();
+			for (long k = mass.rowOffsets[id]; k < mass.rowOffsets[id+1]; k++) {
+				if (!consistent.isFixed(mass.columns[k])) {
+					m += mass.values[k]*rates[mass.columns[k]];
+				}
+			}
+			BOOST_REQUIRE_CLOSE(consistent.sourceVector()[id] - kT[id] + 10.0,
+					m + 10.0,1.0e-10);
+		}
+	}
+
+	// The lumped Jacobian matches the products and the diagonal
+	TransientConduction conduction(mesh, 1.5, 1.0, 2.0);
+	conduction.fixBoundaryTemperature(mesh, 3, 1.0);
+	conduction.temperature(0.0);
+	State<TransientConduction> state(conduction, n);
+	auto & jacobian = state.get().jacobian();
+	vector<double> v(n), jv(n), jvMatrix, diag(n);
+	for (int id = 0; id < n; id++) v[id] = cos(id);
+	state.jv(0.0, v.data(), jv.data());
+	jacobian.multiply(v, jvMatrix);
+	BOOST_REQUIRE(state.jacobianDiagonal(0.0, diag.data()));
+	for (int id = 0; id < n; id++) {
+		BOOST_REQUIRE_CLOSE(jvMatrix[id] + 1.0,jv[id] + 1.0,1.0e-10);
+		BOOST_REQUIRE_CLOSE(jacobian(id,id) + 1.0,diag[id] + 1.0,1.0e-10);
+	}
+
+	// Integrate with the RK solver and compare with small theta steps
+	state.t(0.0);
+	RKSolver<TransientConduction> solver;
+	solver.tInit(0.0);
+	solver.tFinal(0.05);
+	solver.tolerances(1.0e-8,1.0e-10);
+	solver.solve(state);
+	for (int i = 0; i < 500; i++) conduction.step(1.0e-4, 0.5);
+	for (int id = 0; id < n; id++) {
+		BOOST_REQUIRE_SMALL(state.u()[id] - conduction.temperature()[id],
+				1.0e-5);
+	}
+
+	return;
+}
@@ -0,0 +1,232 @@
+
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE FEM
+
+#include <boost/test/included/unit_test.hpp>
+#include <TwoDMesh.h>
+#include <LaplaceCSTElement.h>
+#include <FEMTypes.h>
+#include <vector>
+#include <algorithm>
+#include <math.h>
+
+using namespace std;
+using namespace fire;
+
+/**
+ * This operation checks that a mesh can be built by hand and that its
+ * element views match a ConstantStrainTriangleElement with the same nodes.
+ */
+BOOST_AUTO_TEST_CASE(checkElementViews) {
+
+	TwoDMesh mesh;
+	BOOST_REQUIRE_EQUAL(0,mesh.addNode(0.0,0.0));
+	BOOST_REQUIRE_EQUAL(1,mesh.addNode(2.0,0.5));
+	BOOST_REQUIRE_EQUAL(2,mesh.addNode(0.5,1.5));
+	BOOST_REQUIRE_EQUAL(0,mesh.addElement(0,1,2));
+	BOOST_REQUIRE_EQUAL(0,mesh.addBoundaryEdge(0,1,7));
+	BOOST_REQUIRE_EQUAL(3,mesh.numNodes());
+	BOOST_REQUIRE_EQUAL(1,mesh.numElements());
+	BOOST_REQUIRE_EQUAL(1,mesh.numBoundaryEdges());
+	BOOST_REQUIRE_EQUAL(7,mesh.boundaryMarkers()[0]);
+
+	// Bad elements and edges are rejected
+	BOOST_REQUIRE_THROW(mesh.addElement(0,1,3),out_of_range);
+	BOOST_REQUIRE_THROW(mesh.addElement(0,1,1),runtime_error);
+	BOOST_REQUIRE_THROW(mesh.addBoundaryEdge(-1,1),out_of_range);
+
+	// Compare with the full element
+	TwoDNode node1 = mesh.node(0), node2 = mesh.node(1), node3 = mesh.node(2);
+	LaplaceCSTElement cst(node1,node2,node3);
+	auto element = mesh.element(0);
+	BOOST_REQUIRE(cst.nodeIds() == element.nodeIds());
+	BOOST_REQUIRE_CLOSE(cst.area(),element.area(),1.0e-12);
+	BOOST_REQUIRE_CLOSE(1.375,element.area(),1.0e-12);
+	auto cstPoint = cst.computeLocalPoint(0.8,0.6);
+	auto point = element.computeLocalPoint(0.8,0.6);
+	BOOST_REQUIRE_CLOSE(cstPoint.first,point.first,1.0e-12);
+	BOOST_REQUIRE_CLOSE(cstPoint.second,point.second,1.0e-12);
+	BOOST_REQUIRE_CLOSE(cstPoint.third,point.third,1.0e-12);
+	BOOST_REQUIRE_CLOSE(1.0,point.first + point.second + point.third,1.0e-12);
+	BOOST_REQUIRE_EQUAL(2,element.getLocalNodeId(2));
+	BOOST_REQUIRE_EQUAL(-1,element.getLocalNodeId(5));
+
+	// Moving a node requires the geometry to be recomputed
+	mesh.x()[1] = 1.0;
+	mesh.y()[1] = 0.0;
+	mesh.computeGeometry();
+	BOOST_REQUIRE_CLOSE(0.75,element.area(),1.0e-12);
+
+	return;
+}
+
+/**
+ * This operation checks the structured rectangular mesh and its memory use.
+ */
+BOOST_AUTO_TEST_CASE(checkRectangle) {
+
+	int nx = 20, ny = 10;
+	TwoDMesh mesh = TwoDMesh::rectangle(nx,ny,2.0,1.0);
+	BOOST_REQUIRE_EQUAL((nx+1)*(ny+1),mesh.numNodes());
+	BOOST_REQUIRE_EQUAL(2*nx*ny,mesh.numElements());
+	BOOST_REQUIRE_EQUAL(2*(nx+ny),mesh.numBoundaryEdges());
+
+	// All elements are counter-clockwise and cover the rectangle
+	double total = 0.0;
+	for (long e = 0; e < mesh.numElements(); e++) {
+		BOOST_REQUIRE(mesh.areas()[e] > 0.0);
+		total += mesh.areas()[e];
+	}
+	BOOST_REQUIRE_CLOSE(2.0,total,1.0e-10);
+
+	// The boundary edges are on the boundary with the right markers and
+	// their total length is the perimeter
+	double perimeter = 0.0;
+	for (long k = 0; k < mesh.numBoundaryEdges(); k++) {
+		int n1 = mesh.boundaryEdges()[2*k], n2 = mesh.boundaryEdges()[2*k+1];
+		double x1 = mesh.x()[n1], y1 = mesh.y()[n1], x2 = mesh.x()[n2],
+				y2 = mesh.y()[n2];
+		perimeter += sqrt((x2-x1)*(x2-x1) + (y2-y1)*(y2-y1));
+		switch (mesh.boundaryMarkers()[k]) {
+		case 0: BOOST_REQUIRE(y1 == 0.0 && y2 == 0.0); break;
+		case 1: BOOST_REQUIRE(x1 == 2.0 && x2 == 2.0); break;
+		case 2: BOOST_REQUIRE(y1 == 1.0 && y2 == 1.0); break;
+		case 3: BOOST_REQUIRE(x1 == 0.0 && x2 == 0.0); break;
+		default: BOOST_FAIL("Bad boundary marker.");
+		}
+	}
+	BOOST_REQUIRE_CLOSE(6.0,perimeter,1.0e-10);
+
+	// 68 bytes per element, 16 bytes per node and 12 bytes per edge
+	BOOST_REQUIRE_EQUAL(68L*mesh.numElements() + 16L*mesh.numNodes()
+			+ 12L*mesh.numBoundaryEdges(),mesh.memoryUsage());
+
+	BOOST_REQUIRE_THROW(TwoDMesh::rectangle(0,1),runtime_error);
+
+	return;
+}
+
+/**
+ * This operation checks that recomputing the geometry of some of the
+ * elements only changes those elements and nothing if one is invalid.
+ */
+BOOST_AUTO_TEST_CASE(checkPartialGeometry) {
+
+	TwoDMesh mesh = TwoDMesh::rectangle(30,20);
+	for (auto & x : mesh.x()) x *= 3.0;
+	vector<long> elements;
+	for (long e = 7; e < mesh.numElements(); e += 3) elements.push_back(e);
+	mesh.computeGeometry(elements);
+	TwoDMesh full(mesh);
+	full.computeGeometry();
+	for (long e = 0; e < mesh.numElements(); e++) {
+		// Only the listed elements have the stretched areas
+		double expected = ((e - 7) % 3 == 0 && e >= 7) ? full.areas()[e]
+				: full.areas()[e]/3.0;
+		BOOST_REQUIRE_CLOSE(expected,mesh.areas()[e],1.0e-10);
+		if (expected == full.areas()[e]) {
+			for (int i = 0; i < 3; i++) {
+				BOOST_REQUIRE_EQUAL(full.b()[3*e+i],mesh.b()[3*e+i]);
+				BOOST_REQUIRE_EQUAL(full.c()[3*e+i],mesh.c()[3*e+i]);
+			}
+		}
+	}
+	BOOST_REQUIRE_THROW(mesh.computeGeometry(vector<long>(1,-1)),
+			out_of_range);
+
+	// A bad element after good ones leaves all of the factors unchanged
+	vector<double> areas = mesh.areas();
+	elements = {0, 1, mesh.numElements()};
+	BOOST_REQUIRE_THROW(mesh.computeGeometry(elements),out_of_range);
+	for (long e = 0; e < mesh.numElements(); e++) {
+		BOOST_REQUIRE_EQUAL(areas[e],mesh.areas()[e]);
+	}
+
+	return;
+}
+
+/**
+ * This operation checks the uniform refinement of a mesh.
+ */
+BOOST_AUTO_TEST_CASE(checkRefine) {
+
+	TwoDMesh coarse = TwoDMesh::rectangle(3,2,3.0,1.0);
+	TwoDMesh fine = coarse.refine();
+	int numEdges = 3*3 + 4*2 + 3*2;
+	BOOST_REQUIRE_EQUAL(coarse.numNodes() + numEdges,fine.numNodes());
+	BOOST_REQUIRE_EQUAL(4*coarse.numElements(),fine.numElements());
+	BOOST_REQUIRE_EQUAL(2*coarse.numBoundaryEdges(),fine.numBoundaryEdges());
+
+	// The coarse nodes keep their ids and the children are a quarter of
+	// their parent with the same orientation
+	for (int i = 0; i < coarse.numNodes(); i++) {
+		BOOST_REQUIRE_EQUAL(coarse.x()[i],fine.x()[i]);
+		BOOST_REQUIRE_EQUAL(coarse.y()[i],fine.y()[i]);
+	}
+	for (long e = 0; e < coarse.numElements(); e++) {
+		auto ids = coarse.element(e).nodeIds();
+		for (int c = 0; c < 4; c++) {
+			BOOST_REQUIRE_CLOSE(0.25*coarse.areas()[e],fine.areas()[4*e+c],
+					1.0e-10);
+		}
+		for (int i = 0; i < 3; i++) {
+			auto childIds = fine.element(4*e+i).nodeIds();
+			BOOST_REQUIRE(find(childIds.begin(),childIds.end(),ids[i])
+					!= childIds.end());
+		}
+	}
+	// It is the same mesh as a rectangle with twice the resolution, up to
+	// the numbering, and the markers are kept
+	TwoDMesh twice = TwoDMesh::rectangle(6,4,3.0,1.0);
+	for (int marker = 0; marker < 4; marker++) {
+		double fineLength = 0.0, twiceLength = 0.0;
+		for (long k = 0; k < fine.numBoundaryEdges(); k++) {
+			if (fine.boundaryMarkers()[k] != marker) continue;
+			int a = fine.boundaryEdges()[2*k], b = fine.boundaryEdges()[2*k+1];
+			fineLength += hypot(fine.x()[b] - fine.x()[a],
+					fine.y()[b] - fine.y()[a]);
+			BOOST_REQUIRE_CLOSE((marker % 2 == 0) ? 0.5 : 0.25,hypot(fine.x()[b] - fine.x()[a],
+					fine.y()[b] - fine.y()[a]),1.0e-10);
+		}
+		for (long k = 0; k < twice.numBoundaryEdges(); k++) {
+			if (twice.boundaryMarkers()[k] != marker) continue;
+			int a = twice.boundaryEdges()[2*k], b = twice.boundaryEdges()[2*k+1];
+			twiceLength += hypot(twice.x()[b] - twice.x()[a],
+					twice.y()[b] - twice.y()[a]);
+		}
+		BOOST_REQUIRE_CLOSE(twiceLength,fineLength,1.0e-10);
+	}
+
+	return;
+}
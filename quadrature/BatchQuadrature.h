@@ -0,0 +1,108 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#ifndef QUADRATURE_BATCHQUADRATURE_H_
+#define QUADRATURE_BATCHQUADRATURE_H_
+
+#include <algorithm>
+
+namespace fire {
+
+/**
+ * This class integrates a kernel over many elements in one call with any of
+ * the quadrature rules that publish their points and weights as static
+ * tables: LineQuadratureRule, TriangularQuadratureRule and the Gauss rules
+ * in GaussQuadratureRules.h.
+ *
+ * The kernel is called with a quadrature point, in the coordinates of the
+ * rule, and the index of an element:
+ * @code
+ * double f(const Rule point type & point, const long & e);
+ * @endcode
+ * It should read the geometry of element e from arrays that are indexed by
+ * element (a structure of arrays) and include the Jacobian of the element.
+ * For example, to integrate x over triangles whose vertex coordinates are
+ * stored in arrays x1, x2 and x3 and whose areas are in area:
+ * @code
+ * std::vector<double> integrals(n);
+ * BatchQuadrature<TriangularQuadratureRule>::integrate(
+ *     [&](const std::array<double,3> & L, const long & e) {
+ *         return 2.0*area[e]*(L[0]*x1[e] + L[1]*x2[e] + L[2]*x3[e]);
+ *     }, n, integrals.data());
+ * @endcode
+ *
+ * The elements are processed in blocks. Within a block, the loop over the
+ * quadrature points is outside and the loop over the elements is inside, so
+ * that the point and weight are constant in the inner loop and consecutive
+ * iterations read consecutive entries of the geometry arrays. Since the
+ * kernel is a compile-time type, it is inlined into the inner loop and the
+ * compiler can evaluate several elements per instruction.
+ */
+template<typename Rule>
+class BatchQuadrature {
+
+public:
+
+	/**
+	 * The number of elements in a block. The integrals of a block and the
+	 * geometry that the kernel reads for it stay in cache while all of the
+	 * quadrature points are evaluated.
+	 */
+	static const int blockSize = 256;
+
+	/**
+	 * This operation integrates a kernel over the elements [0,numElements).
+	 * @param f the kernel, as described above
+	 * @param numElements the number of elements
+	 * @param integrals the integrals of the elements, which are overwritten
+	 */
+	template<typename F>
+	static void integrate(const F & f, const long & numElements,
+			double * integrals) {
+		for (long begin = 0; begin < numElements; begin += blockSize) {
+			long end = std::min(begin + blockSize, numElements);
+			for (long e = begin; e < end; e++) integrals[e] = 0.0;
+			for (int q = 0; q < Rule::numPoints; q++) {
+				const auto & point = Rule::points[q];
+				const double weight = Rule::weights[q];
+				for (long e = begin; e < end; e++) {
+					integrals[e] += weight*f(point, e);
+				}
+			}
+		}
+		return;
+	}
+
+};
+
+} /* namespace fire */
+
+#endif /* QUADRATURE_BATCHQUADRATURE_H_ */
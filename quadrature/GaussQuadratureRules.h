@@ -0,0 +1,479 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#ifndef QUADRATURE_GAUSSQUADRATURERULES_H_
+#define QUADRATURE_GAUSSQUADRATURERULES_H_
+
+#include <array>
+
+namespace fire {
+
+/**
+ * The functions and types in this namespace generate the points and weights
+ * of the Gauss rules below at compile time. They are written as single
+ * return constexpr functions so that they can be evaluated by a C++11
+ * compiler and do not rely on the standard math functions being constexpr.
+ */
+namespace gauss {
+
+/**
+ * A list of indices, used to expand the rule tables element by element.
+ */
+template<int... I>
+struct IndexList {};
+
+/**
+ * This type generates the IndexList 0,1,...,N-1.
+ */
+template<int N, int... I>
+struct MakeIndexList : MakeIndexList<N-1, N-1, I...> {};
+
+template<int... I>
+struct MakeIndexList<0, I...> {
+	typedef IndexList<I...> type;
+};
+
+/**
+ * Pi to double precision.
+ */
+constexpr double pi = 3.14159265358979323846;
+
+/**
+ * This operation sums the Taylor series of cos(x) for |x| <= pi, where the
+ * next term is term and k is the order of the previous term.
+ */
+constexpr double cosSeries(const double x2, const double term, const int k,
+		const double sum) {
+	return (k > 60) ? sum : cosSeries(x2, -term*x2/((k + 1)*(k + 2)), k + 2,
+			sum + term);
+}
+
+/**
+ * This operation computes cos(x) for |x| <= pi.
+ */
+constexpr double cosine(const double x) {
+	return cosSeries(x*x, 1.0, 0, 0.0);
+}
+
+/**
+ * This operation carries the Legendre recurrence from P_k (p1) and P_{k-1}
+ * (p0) up to P_n.
+ */
+constexpr double legendreStep(const int k, const int n, const double x,
+		const double p0, const double p1) {
+	return (k == n) ? p1 : legendreStep(k + 1, n, x, p1,
+			((2*k + 1)*x*p1 - k*p0)/(k + 1));
+}
+
+/**
+ * This operation computes the Legendre polynomial P_n(x).
+ */
+constexpr double legendre(const int n, const double x) {
+	return (n == 0) ? 1.0 : legendreStep(1, n, x, 1.0, x);
+}
+
+/**
+ * This operation computes the derivative of the Legendre polynomial P_n(x)
+ * for |x| < 1.
+ */
+constexpr double legendreDerivative(const int n, const double x) {
+	return n*(x*legendre(n, x) - legendre(n - 1, x))/(x*x - 1.0);
+}
+
+/**
+ * This operation refines a root of P_n(x) with a fixed number of Newton
+ * iterations. Newton's method converges quadratically from the initial
+ * guesses used below, so the last iterations do not change the root.
+ */
+constexpr double newton(const int n, const double x, const int iterations) {
+	return (iterations == 0) ? x : newton(n,
+			x - legendre(n, x)/legendreDerivative(n, x), iterations - 1);
+}
+
+/**
+ * This operation computes the ith of the n Gauss-Legendre points on [-1,1]
+ * in increasing order.
+ */
+constexpr double legendrePoint(const int n, const int i) {
+	return newton(n, -cosine(pi*(i + 0.75)/(n + 0.5)), 12);
+}
+
+/**
+ * This operation computes the Gauss-Legendre weight of the point x on
+ * [-1,1].
+ */
+constexpr double legendreWeight(const int n, const double x) {
+	return 2.0/((1.0 - x*x)*legendreDerivative(n, x)
+			*legendreDerivative(n, x));
+}
+
+/**
+ * This operation computes the ith of the n Gauss-Legendre points mapped to
+ * [0,1].
+ */
+constexpr double unitPoint(const int n, const int i) {
+	return 0.5*(legendrePoint(n, i) + 1.0);
+}
+
+/**
+ * This operation computes the weight of the ith of the n Gauss-Legendre
+ * points mapped to [0,1].
+ */
+constexpr double unitWeight(const int n, const int i) {
+	return 0.5*legendreWeight(n, legendrePoint(n, i));
+}
+
+/**
+ * This operation creates the table of n Gauss-Legendre points.
+ */
+template<int N, int... I>
+constexpr std::array<double,N> linePoints(IndexList<I...>) {
+	return {{legendrePoint(N, I)...}};
+}
+
+/**
+ * This operation creates the table of n Gauss-Legendre weights.
+ */
+template<int N, int... I>
+constexpr std::array<double,N> lineWeights(IndexList<I...>) {
+	return {{legendreWeight(N, legendrePoint(N, I))...}};
+}
+
+/**
+ * This operation computes the area coordinates of a point of the collapsed
+ * triangle rule.
+ */
+constexpr std::array<double,3> trianglePoint(const double u, const double v) {
+	return {{u, (1.0 - u)*v, (1.0 - u)*(1.0 - v)}};
+}
+
+/**
+ * This operation creates the table of points of the triangle rule. Point k
+ * is the product of point k/NV in u and point k%NV in v.
+ */
+template<int NU, int NV, int... K>
+constexpr std::array<std::array<double,3>,NU*NV> trianglePoints(
+		IndexList<K...>) {
+	return {{trianglePoint(unitPoint(NU, K/NV),
+			unitPoint(NV, K%NV))...}};
+}
+
+/**
+ * This operation creates the table of weights of the triangle rule, which
+ * include the Jacobian 1-u of the collapsed coordinates.
+ */
+template<int NU, int NV, int... K>
+constexpr std::array<double,NU*NV> triangleWeights(IndexList<K...>) {
+	return {{unitWeight(NU, K/NV)*unitWeight(NV, K%NV)
+			*(1.0 - unitPoint(NU, K/NV))...}};
+}
+
+/**
+ * This operation computes the volume coordinates of a point of the collapsed
+ * tetrahedron rule.
+ */
+constexpr std::array<double,4> tetrahedronPoint(const double u, const double v,
+		const double w) {
+	return {{u, (1.0 - u)*v, (1.0 - u)*(1.0 - v)*w,
+			(1.0 - u)*(1.0 - v)*(1.0 - w)}};
+}
+
+/**
+ * This operation creates the table of points of the tetrahedron rule, with w
+ * varying fastest.
+ */
+template<int NU, int NV, int NW, int... K>
+constexpr std::array<std::array<double,4>,NU*NV*NW> tetrahedronPoints(
+		IndexList<K...>) {
+	return {{tetrahedronPoint(unitPoint(NU, K/(NV*NW)),
+			unitPoint(NV, (K/NW)%NV), unitPoint(NW, K%NW))...}};
+}
+
+/**
+ * This operation creates the table of weights of the tetrahedron rule, which
+ * include the Jacobian (1-u)^2(1-v) of the collapsed coordinates.
+ */
+template<int NU, int NV, int NW, int... K>
+constexpr std::array<double,NU*NV*NW> tetrahedronWeights(IndexList<K...>) {
+	return {{unitWeight(NU, K/(NV*NW))*unitWeight(NV, (K/NW)%NV)
+			*unitWeight(NW, K%NW)*(1.0 - unitPoint(NU, K/(NV*NW)))
+			*(1.0 - unitPoint(NU, K/(NV*NW)))
+			*(1.0 - unitPoint(NV, (K/NW)%NV))...}};
+}
+
+/**
+ * This type sums the weighted kernel over the points [I,N) of a rule with
+ * the loop fully unrolled at compile time.
+ */
+template<typename Rule, int I, int N>
+struct UnrolledSum {
+	template<typename F>
+	static double sum(const F & f) {
+		return Rule::weights[I]*f(Rule::points[I])
+				+ UnrolledSum<Rule,I+1,N>::sum(f);
+	}
+};
+
+template<typename Rule, int N>
+struct UnrolledSum<Rule,N,N> {
+	template<typename F>
+	static double sum(const F &) {
+		return 0.0;
+	}
+};
+
+} /* namespace gauss */
+
+/**
+ * This class is an N point Gauss-Legendre rule on [-1,1] that exactly
+ * integrates polynomials of degree 2N-1 or less. The points and weights are
+ * computed by the compiler, so rules of any order cost nothing at run time
+ * and integrate() is fully unrolled:
+ * @code
+ * double result = GaussLineRule<3>::integrate([](const double & x) {
+ *     return x*x*x*x;
+ * });
+ * @endcode
+ * GaussLineRule<4> is the same rule as LineQuadratureRule.
+ */
+template<int N>
+class GaussLineRule {
+
+	static_assert(N > 0, "Gauss rules need at least one point.");
+
+public:
+
+	/**
+	 * The number of points in the rule.
+	 */
+	static const int numPoints = N;
+
+	/**
+	 * The highest degree of polynomial that the rule integrates exactly.
+	 */
+	static const int degree = 2*N - 1;
+
+	/**
+	 * The points, in increasing order.
+	 */
+	static constexpr std::array<double,N> points =
+			gauss::linePoints<N>(typename gauss::MakeIndexList<N>::type());
+
+	/**
+	 * The weights, which sum to 2.
+	 */
+	static constexpr std::array<double,N> weights =
+			gauss::lineWeights<N>(typename gauss::MakeIndexList<N>::type());
+
+	/**
+	 * This operation integrates a kernel over [-1,1].
+	 * @param f the kernel, which is any type that can be called as
+	 * double f(const double &)
+	 * @return the integral
+	 */
+	template<typename F>
+	static double integrate(const F & f) {
+		return gauss::UnrolledSum<GaussLineRule,0,N>::sum(f);
+	}
+
+};
+
+template<int N>
+constexpr std::array<double,N> GaussLineRule<N>::points;
+
+template<int N>
+constexpr std::array<double,N> GaussLineRule<N>::weights;
+
+/**
+ * This class is a Gauss rule over the reference triangle in area coordinates
+ * with positive weights that sum to the area of the triangle, 1/2, as for
+ * TriangularQuadratureRule. It is the product of an NU point Gauss-Legendre
+ * rule in L_1 and an NV point rule in the collapsed direction, with the
+ * points
+ * \f[
+ * L_1 = u, L_2 = (1-u)v, L_3 = (1-u)(1-v)
+ * \f]
+ * The Jacobian 1-u raises the degree in u by one, so the rule exactly
+ * integrates polynomials of degree min(2NU-2,2NV-1) in the area coordinates.
+ * Use TriangleRuleForDegree to pick the smallest rule for a given degree.
+ */
+template<int NU, int NV = NU>
+class GaussTriangleRule {
+
+	static_assert(NU > 0 && NV > 0, "Gauss rules need at least one point.");
+
+public:
+
+	/**
+	 * The number of points in the rule.
+	 */
+	static const int numPoints = NU*NV;
+
+	/**
+	 * The highest degree of polynomial that the rule integrates exactly.
+	 */
+	static const int degree = (2*NU - 2 < 2*NV - 1) ? 2*NU - 2 : 2*NV - 1;
+
+	/**
+	 * The points in area coordinates.
+	 */
+	static constexpr std::array<std::array<double,3>,NU*NV> points =
+			gauss::trianglePoints<NU,NV>(
+					typename gauss::MakeIndexList<NU*NV>::type());
+
+	/**
+	 * The weights, which sum to 1/2.
+	 */
+	static constexpr std::array<double,NU*NV> weights =
+			gauss::triangleWeights<NU,NV>(
+					typename gauss::MakeIndexList<NU*NV>::type());
+
+	/**
+	 * This operation integrates a kernel over the reference triangle.
+	 * Multiply the result by twice the area of the element to integrate over
+	 * the element.
+	 * @param f the kernel, which is any type that can be called as
+	 * double f(const std::array<double,3> &)
+	 * @return the integral
+	 */
+	template<typename F>
+	static double integrate(const F & f) {
+		return gauss::UnrolledSum<GaussTriangleRule,0,NU*NV>::sum(f);
+	}
+
+};
+
+template<int NU, int NV>
+constexpr std::array<std::array<double,3>,NU*NV> GaussTriangleRule<NU,NV>::points;
+
+template<int NU, int NV>
+constexpr std::array<double,NU*NV> GaussTriangleRule<NU,NV>::weights;
+
+/**
+ * This class is a Gauss rule over the reference tetrahedron in volume
+ * coordinates with positive weights that sum to its volume, 1/6. It is the
+ * product of NU, NV and NW point Gauss-Legendre rules with the points
+ * \f[
+ * L_1 = u, L_2 = (1-u)v, L_3 = (1-u)(1-v)w, L_4 = (1-u)(1-v)(1-w)
+ * \f]
+ * and exactly integrates polynomials of degree min(2NU-3,2NV-2,2NW-1) in the
+ * volume coordinates. Use TetrahedronRuleForDegree to pick the smallest rule
+ * for a given degree.
+ */
+template<int NU, int NV = NU, int NW = NV>
+class GaussTetrahedronRule {
+
+	static_assert(NU > 1 && NV > 0 && NW > 0,
+			"Tetrahedron rules need at least two points in u.");
+
+public:
+
+	/**
+	 * The number of points in the rule.
+	 */
+	static const int numPoints = NU*NV*NW;
+
+	/**
+	 * The highest degree of polynomial that the rule integrates exactly.
+	 */
+	static const int degree = (2*NU - 3 < 2*NV - 2) ?
+			((2*NU - 3 < 2*NW - 1) ? 2*NU - 3 : 2*NW - 1) :
+			((2*NV - 2 < 2*NW - 1) ? 2*NV - 2 : 2*NW - 1);
+
+	/**
+	 * The points in volume coordinates.
+	 */
+	static constexpr std::array<std::array<double,4>,NU*NV*NW> points =
+			gauss::tetrahedronPoints<NU,NV,NW>(
+					typename gauss::MakeIndexList<NU*NV*NW>::type());
+
+	/**
+	 * The weights, which sum to 1/6.
+	 */
+	static constexpr std::array<double,NU*NV*NW> weights =
+			gauss::tetrahedronWeights<NU,NV,NW>(
+					typename gauss::MakeIndexList<NU*NV*NW>::type());
+
+	/**
+	 * This operation integrates a kernel over the reference tetrahedron.
+	 * Multiply the result by six times the volume of the element to
+	 * integrate over the element.
+	 * @param f the kernel, which is any type that can be called as
+	 * double f(const std::array<double,4> &)
+	 * @return the integral
+	 */
+	template<typename F>
+	static double integrate(const F & f) {
+		return gauss::UnrolledSum<GaussTetrahedronRule,0,NU*NV*NW>::sum(f);
+	}
+
+};
+
+template<int NU, int NV, int NW>
+constexpr std::array<std::array<double,4>,NU*NV*NW>
+		GaussTetrahedronRule<NU,NV,NW>::points;
+
+template<int NU, int NV, int NW>
+constexpr std::array<double,NU*NV*NW> GaussTetrahedronRule<NU,NV,NW>::weights;
+
+/**
+ * This type selects the line rule with the fewest points that exactly
+ * integrates polynomials of the given degree, as its type member.
+ */
+template<int Degree>
+struct LineRuleForDegree {
+	typedef GaussLineRule<(Degree + 2)/2> type;
+};
+
+/**
+ * This type selects the triangle rule with the fewest points that exactly
+ * integrates polynomials of the given degree, as its type member. For
+ * example, the rule for degree 1 has two points and the rule for degree 2
+ * (CST mass matrices) has four.
+ */
+template<int Degree>
+struct TriangleRuleForDegree {
+	typedef GaussTriangleRule<(Degree + 3)/2,(Degree + 2)/2> type;
+};
+
+/**
+ * This type selects the tetrahedron rule with the fewest points that exactly
+ * integrates polynomials of the given degree, as its type member.
+ */
+template<int Degree>
+struct TetrahedronRuleForDegree {
+	typedef GaussTetrahedronRule<(Degree + 4)/2,(Degree + 3)/2,
+			(Degree + 2)/2> type;
+};
+
+} /* namespace fire */
+
+#endif /* QUADRATURE_GAUSSQUADRATURERULES_H_ */
@@ -49,8 +49,10 @@ double LineQuadratureRule::integrate(const std::function<double(const double &,
 		int i, int j) const {
 
 	// Compute the integral.
-	double result = weights[0]*f(points[0],i,j) + weights[1]*f(points[2],i,j)
-			+ weights[2]*f(points[2],i,j) + weights[3]*f(points[3],i,j);
+	double result = 0.0;
+	for (int k = 0; k < numPoints; k++) {
+		result += weights[k]*f(points[k],i,j);
+	}
 
 	return result;
 }
@@ -60,8 +62,10 @@ double LineQuadratureRule::integrate(const std::function<double(const double &,
 		int i) const {
 
 	// Compute the integral.
-	double result = weights[0]*f(points[0],i) + weights[1]*f(points[1],i)
-			+ weights[2]*f(points[2],i) + weights[3]*f(points[3],i);
+	double result = 0.0;
+	for (int k = 0; k < numPoints; k++) {
+		result += weights[k]*f(points[k],i);
+	}
 
 	return result;
 }
@@ -34,6 +34,8 @@
 
 #include <functional>
 #include <array>
+#include <utility>
+#include <type_traits>
 #include <math.h>
 
 namespace fire {
@@ -93,13 +95,22 @@ namespace fire {
  * \int_{-1}^{1} f(x) dx = \int_{0}^{1} 2f(t) dt
  * \f]
  *
+ * Kernels that are compile-time types, such as lambdas or functors, can be
+ * passed to the templated integrate() operation instead. They take only the
+ * point and are inlined instead of being called through a std::function.
+ *
  * Note that the weights and area coordinates are defined statically because
  * they are used unmodified across all instances of this class. Failing to
  * declare them as such could lead to an explosion in memory use if a new
  * instance of the quadrature rule is used in many places.
  */
 class LineQuadratureRule {
-private:
+public:
+
+	/**
+	 * The number of quadrature points.
+	 */
+	static const int numPoints = 4;
 
 	/**
 	 * The 4-point quadrature weights:
@@ -130,8 +141,6 @@ private:
 			sqrt((3.0/7.0)-(2.0/7.0)*sqrt(6.0/5.0)),
 			sqrt((3.0/7.0)+(2.0/7.0)*sqrt(6.0/5.0))};
 
-public:
-
 	/**
 	 * Constructor
 	 */
@@ -156,6 +165,23 @@ public:
 	double integrate(const std::function<double(const double &,
 			const int &)> & f,
 			int i = 0) const;
+
+	/**
+	 * This operation integrates a kernel along the line. The kernel is called
+	 * with only the point. Any indices should be captured by the kernel.
+	 * Callables that also take indices do not match, so they go to the
+	 * operations above.
+	 * @param f the kernel, which is any type that can be called as
+	 * double f(const double &)
+	 * @return the integral
+	 */
+	template<typename F, typename = typename std::enable_if<
+			std::is_convertible<decltype(std::declval<const F &>()(
+			std::declval<const double &>())), double>::value>::type>
+	double integrate(const F & f) const {
+		return weights[0]*f(points[0]) + weights[1]*f(points[1])
+				+ weights[2]*f(points[2]) + weights[3]*f(points[3]);
+	}
 };
 
 } /* namespace fire */
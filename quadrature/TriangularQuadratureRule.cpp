@@ -43,6 +43,7 @@ constexpr std::array<double,3> const TriangularQuadratureRule::point1;
 constexpr std::array<double,3> const TriangularQuadratureRule::point2;
 constexpr std::array<double,3> const TriangularQuadratureRule::point3;
 constexpr std::array<double,3> const TriangularQuadratureRule::point4;
+constexpr std::array<std::array<double,3>,4> const TriangularQuadratureRule::points;
 
 TriangularQuadratureRule::TriangularQuadratureRule() {
 }
@@ -34,6 +34,8 @@
 
 #include <functional>
 #include <array>
+#include <utility>
+#include <type_traits>
 
 namespace fire {
 
@@ -77,6 +79,16 @@ namespace fire {
  * \omega_{i}f(L_{1,i},L_{2,i},L_{3,i})
  * \f]
  *
+ * Kernels that are compile-time types, such as lambdas or functors, can be
+ * passed to the templated integrate() operation instead. They take only the
+ * point and are inlined at each quadrature point instead of being called
+ * through a std::function, which is much faster in element loops:
+ * @code
+ * double result = rule.integrate([&](const std::array<double,3> & point) {
+ *		return kappa*point[0];
+ * });
+ * @endcode
+ *
  * Note that the weights and area coordinates are defined statically because
  * they are used unmodified across all instances of this class. Failing to
  * declare them as such could lead to an explosion in memory use if a new
@@ -85,11 +97,6 @@ namespace fire {
 class TriangularQuadratureRule {
 private:
 
-	/**
-	 * The 4-point quadrature weights: -9.0/32.0,25.0/96.0,25.0/96.0,25.0/96.0
-	 */
-	static constexpr std::array<double,4> const weights = {-9.0/32.0,25.0/96.0,25.0/96.0,25.0/96.0};
-
 	/**
 	 * Quadrature Point 1 - (1.0/3.0,1.0/3.0,1.0/3.0)
 	 */
@@ -112,6 +119,23 @@ private:
 
 public:
 
+	/**
+	 * The number of quadrature points.
+	 */
+	static const int numPoints = 4;
+
+	/**
+	 * The 4-point quadrature weights: -9.0/32.0,25.0/96.0,25.0/96.0,25.0/96.0
+	 */
+	static constexpr std::array<double,4> const weights = {-9.0/32.0,25.0/96.0,25.0/96.0,25.0/96.0};
+
+	/**
+	 * The quadrature points 1-4 in a table, for looping over them in
+	 * BatchQuadrature.
+	 */
+	static constexpr std::array<std::array<double,3>,4> const points = {{point1,
+			point2,point3,point4}};
+
 	/**
 	 * Constructor
 	 */
@@ -136,6 +160,23 @@ public:
 	double integrate(const std::function<double(const std::array<double,3> &,
 			const int &)> & f,
 			int i = 0) const;
+
+	/**
+	 * This operation integrates a kernel across the area of the triangle. The
+	 * kernel is called with only the area coordinates of each point. Any
+	 * indices should be captured by the kernel. Callables that also take
+	 * indices do not match, so they go to the operations above.
+	 * @param f the kernel, which is any type that can be called as
+	 * double f(const std::array<double,3> &)
+	 * @return the integral
+	 */
+	template<typename F, typename = typename std::enable_if<
+			std::is_convertible<decltype(std::declval<const F &>()(point1)),
+			double>::value>::type>
+	double integrate(const F & f) const {
+		return weights[0]*f(point1) + weights[1]*f(point2)
+				+ weights[2]*f(point3) + weights[3]*f(point4);
+	}
 };
 
 } /* namespace fire */
@@ -0,0 +1,123 @@
+
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE QUADRATURE
+
+#include <boost/test/included/unit_test.hpp>
+#include <BatchQuadrature.h>
+#include <TriangularQuadratureRule.h>
+#include <LineQuadratureRule.h>
+#include <GaussQuadratureRules.h>
+#include <array>
+#include <vector>
+#include <cmath>
+
+using namespace std;
+using namespace fire;
+
+/**
+ * This operation checks batched integration over triangles against the
+ * integrals of each element computed one at a time. The triangles have
+ * vertex coordinates stored as a structure of arrays and the integrand is
+ * f(x,y) = xy + x^2, which is integrated exactly by both rules.
+ */
+BOOST_AUTO_TEST_CASE(checkTriangleBatch) {
+
+	// More elements than fit in a block, so that the last block is partial
+	long n = 2*BatchQuadrature<TriangularQuadratureRule>::blockSize + 17;
+	vector<double> x1(n), x2(n), x3(n), y1(n), y2(n), y3(n), area(n);
+	for (long e = 0; e < n; e++) {
+		x1[e] = sin(e);
+		x2[e] = x1[e] + 1.0 + 0.5*cos(3.0*e);
+		x3[e] = x1[e] + 0.3*sin(7.0*e);
+		y1[e] = cos(e);
+		y2[e] = y1[e] + 0.2*sin(5.0*e);
+		y3[e] = y1[e] + 1.0 + 0.1*cos(e);
+		area[e] = 0.5*((x2[e] - x1[e])*(y3[e] - y1[e])
+				- (x3[e] - x1[e])*(y2[e] - y1[e]));
+	}
+	auto kernel = [&](const std::array<double,3> & L, const long & e) {
+		double x = L[0]*x1[e] + L[1]*x2[e] + L[2]*x3[e];
+		double y = L[0]*y1[e] + L[1]*y2[e] + L[2]*y3[e];
+		return 2.0*area[e]*(x*y + x*x);
+	};
+
+	vector<double> integrals(n, -1.0), gaussIntegrals(n, -1.0);
+	BatchQuadrature<TriangularQuadratureRule>::integrate(kernel, n,
+			integrals.data());
+	BatchQuadrature<TriangleRuleForDegree<2>::type>::integrate(kernel, n,
+			gaussIntegrals.data());
+
+	TriangularQuadratureRule rule;
+	for (long e = 0; e < n; e++) {
+		double single = rule.integrate([&](const std::array<double,3> & L) {
+			return kernel(L, e);
+		});
+		BOOST_REQUIRE_CLOSE(single, integrals[e], 1.0e-10);
+		BOOST_REQUIRE_CLOSE(single, gaussIntegrals[e], 1.0e-10);
+	}
+
+	return;
+}
+
+/**
+ * This operation checks batched integration over line segments [a_e,b_e]
+ * mapped to [-1,1] for the integrand x^3, which is integrated to
+ * (b^4 - a^4)/4.
+ */
+BOOST_AUTO_TEST_CASE(checkLineBatch) {
+
+	long n = 1000;
+	vector<double> a(n), b(n), integrals(n);
+	for (long e = 0; e < n; e++) {
+		a[e] = 0.01*e;
+		b[e] = a[e] + 0.5 + 0.001*e;
+	}
+	BatchQuadrature<LineQuadratureRule>::integrate([&](const double & t,
+			const long & e) {
+		double x = 0.5*(a[e] + b[e]) + 0.5*(b[e] - a[e])*t;
+		return 0.5*(b[e] - a[e])*x*x*x;
+	}, n, integrals.data());
+	for (long e = 0; e < n; e++) {
+		double exact = 0.25*(pow(b[e],4) - pow(a[e],4));
+		BOOST_REQUIRE_CLOSE(exact, integrals[e], 1.0e-10);
+	}
+
+	// No elements is not an error
+	BatchQuadrature<LineQuadratureRule>::integrate([&](const double &,
+			const long &) {
+		return 1.0;
+	}, 0, integrals.data());
+
+	return;
+}
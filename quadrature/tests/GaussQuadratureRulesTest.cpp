@@ -0,0 +1,202 @@
+
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE QUADRATURE
+
+#include <boost/test/included/unit_test.hpp>
+#include <GaussQuadratureRules.h>
+#include <LineQuadratureRule.h>
+#include <array>
+#include <cmath>
+
+using namespace std;
+using namespace fire;
+
+/**
+ * This operation computes n!.
+ */
+static double factorial(const int & n) {
+	return (n < 2) ? 1.0 : n*factorial(n-1);
+}
+
+/**
+ * This operation checks that a line rule integrates every monomial up to its
+ * degree exactly on [-1,1].
+ */
+template<int N>
+static void checkLineRule() {
+	typedef GaussLineRule<N> Rule;
+	BOOST_REQUIRE_EQUAL(N,(int) Rule::numPoints);
+	BOOST_REQUIRE_EQUAL(2*N-1,(int) Rule::degree);
+	for (int p = 0; p <= Rule::degree; p++) {
+		double result = Rule::integrate([&](const double & x) {
+			return pow(x,p);
+		});
+		double exact = (p % 2 == 0) ? 2.0/(p + 1) : 0.0;
+		BOOST_REQUIRE_SMALL(result - exact,1.0e-13);
+	}
+	// The points must be increasing and inside the interval
+	for (int i = 0; i < N; i++) {
+		BOOST_REQUIRE(Rule::points[i] > -1.0 && Rule::points[i] < 1.0);
+		if (i > 0) BOOST_REQUIRE(Rule::points[i] > Rule::points[i-1]);
+		BOOST_REQUIRE(Rule::weights[i] > 0.0);
+	}
+}
+
+/**
+ * This operation checks that a triangle rule integrates every monomial
+ * L_1^a L_2^b L_3^c up to its degree exactly, which for the reference
+ * triangle is a!b!c!/(a+b+c+2)!.
+ */
+template<typename Rule>
+static void checkTriangleRule() {
+	for (int a = 0; a <= Rule::degree; a++) {
+		for (int b = 0; a + b <= Rule::degree; b++) {
+			for (int c = 0; a + b + c <= Rule::degree; c++) {
+				double result = Rule::integrate([&](
+						const std::array<double,3> & L) {
+					return pow(L[0],a)*pow(L[1],b)*pow(L[2],c);
+				});
+				double exact = factorial(a)*factorial(b)*factorial(c)
+						/factorial(a + b + c + 2);
+				BOOST_REQUIRE_CLOSE(exact,result,1.0e-11);
+			}
+		}
+	}
+	for (int k = 0; k < Rule::numPoints; k++) {
+		auto & L = Rule::points[k];
+		BOOST_REQUIRE_SMALL(L[0] + L[1] + L[2] - 1.0,1.0e-14);
+		BOOST_REQUIRE(Rule::weights[k] > 0.0);
+	}
+}
+
+/**
+ * This operation checks that a tetrahedron rule integrates every monomial
+ * L_1^a L_2^b L_3^c L_4^d up to its degree exactly, which for the reference
+ * tetrahedron is a!b!c!d!/(a+b+c+d+3)!.
+ */
+template<typename Rule>
+static void checkTetrahedronRule() {
+	int n = Rule::degree;
+	for (int a = 0; a <= n; a++) {
+		for (int b = 0; a + b <= n; b++) {
+			for (int c = 0; a + b + c <= n; c++) {
+				for (int d = 0; a + b + c + d <= n; d++) {
+					double result = Rule::integrate([&](
+							const std::array<double,4> & L) {
+						return pow(L[0],a)*pow(L[1],b)*pow(L[2],c)*pow(L[3],d);
+					});
+					double exact = factorial(a)*factorial(b)*factorial(c)
+							*factorial(d)/factorial(a + b + c + d + 3);
+					BOOST_REQUIRE_CLOSE(exact,result,1.0e-11);
+				}
+			}
+		}
+	}
+	for (int k = 0; k < Rule::numPoints; k++) {
+		auto & L = Rule::points[k];
+		BOOST_REQUIRE_SMALL(L[0] + L[1] + L[2] + L[3] - 1.0,1.0e-14);
+		BOOST_REQUIRE(Rule::weights[k] > 0.0);
+	}
+}
+
+/**
+ * This operation checks the line rules of several orders and that the four
+ * point rule matches LineQuadratureRule.
+ */
+BOOST_AUTO_TEST_CASE(checkLineRules) {
+
+	checkLineRule<1>();
+	checkLineRule<2>();
+	checkLineRule<3>();
+	checkLineRule<4>();
+	checkLineRule<7>();
+	checkLineRule<12>();
+
+	// The tables are compile-time constants
+	static_assert(GaussLineRule<1>::points[0] == 0.0, "Midpoint rule");
+	static_assert(GaussLineRule<1>::weights[0] == 2.0, "Midpoint rule");
+
+	LineQuadratureRule rule;
+	auto f = [](const double & x) {
+		return exp(x)*(1.0 + x);
+	};
+	BOOST_REQUIRE_CLOSE(rule.integrate(f),GaussLineRule<4>::integrate(f),
+			1.0e-12);
+
+	return;
+}
+
+/**
+ * This operation checks the triangle rules and the rules selected by degree.
+ */
+BOOST_AUTO_TEST_CASE(checkTriangleRules) {
+
+	checkTriangleRule<GaussTriangleRule<1>>();
+	checkTriangleRule<GaussTriangleRule<3>>();
+	checkTriangleRule<GaussTriangleRule<5,4>>();
+	checkTriangleRule<TriangleRuleForDegree<0>::type>();
+	checkTriangleRule<TriangleRuleForDegree<1>::type>();
+	checkTriangleRule<TriangleRuleForDegree<2>::type>();
+	checkTriangleRule<TriangleRuleForDegree<5>::type>();
+	checkTriangleRule<TriangleRuleForDegree<8>::type>();
+
+	// The cheapest rules are selected
+	BOOST_REQUIRE_EQUAL(1,(int) TriangleRuleForDegree<0>::type::numPoints);
+	BOOST_REQUIRE_EQUAL(2,(int) TriangleRuleForDegree<1>::type::numPoints);
+	BOOST_REQUIRE_EQUAL(4,(int) TriangleRuleForDegree<2>::type::numPoints);
+	BOOST_REQUIRE_EQUAL(9,(int) TriangleRuleForDegree<4>::type::numPoints);
+	BOOST_REQUIRE_EQUAL(4,(int) TriangleRuleForDegree<4>::type::degree);
+	BOOST_REQUIRE_EQUAL(2,(int) LineRuleForDegree<3>::type::numPoints);
+
+	return;
+}
+
+/**
+ * This operation checks the tetrahedron rules and the rules selected by
+ * degree.
+ */
+BOOST_AUTO_TEST_CASE(checkTetrahedronRules) {
+
+	checkTetrahedronRule<GaussTetrahedronRule<2>>();
+	checkTetrahedronRule<GaussTetrahedronRule<4,3,3>>();
+	checkTetrahedronRule<TetrahedronRuleForDegree<0>::type>();
+	checkTetrahedronRule<TetrahedronRuleForDegree<1>::type>();
+	checkTetrahedronRule<TetrahedronRuleForDegree<2>::type>();
+	checkTetrahedronRule<TetrahedronRuleForDegree<5>::type>();
+
+	BOOST_REQUIRE_EQUAL(4,(int) TetrahedronRuleForDegree<1>::type::numPoints);
+	BOOST_REQUIRE_EQUAL(1,(int) GaussTetrahedronRule<2>::degree);
+
+	return;
+}
@@ -165,5 +165,45 @@ BOOST_AUTO_TEST_CASE(checkTwoIndexQuadrature) {
 	BOOST_TEST_MESSAGE("Result = " << result << ", relErr = " << relErr);
 	BOOST_REQUIRE(relErr < epsilon);
 
+	// Odd polynomials are only integrated correctly if every point is used
+	// exactly once. Area = 4.
+	std::function<double(const double &,
+				const int &, const int &)> cubic = [](const double & point,
+			const int &, const int &) {
+		return (point + 1.0)*(point + 1.0)*(point + 1.0);
+	};
+	result = rule.integrate(cubic, 0, 0);
+	BOOST_REQUIRE_CLOSE(4.0,result,1.0e-10);
+
+	return;
+}
+
+/**
+ * This operation checks the templated integration of kernels that are
+ * compile-time types against exact integrals of polynomials on [-1,1].
+ */
+BOOST_AUTO_TEST_CASE(checkKernelQuadrature) {
+
+	LineQuadratureRule rule;
+
+	double result = rule.integrate([](const double &) {
+		return 1.0;
+	});
+	BOOST_REQUIRE_CLOSE(2.0,result,1.0e-10);
+	result = rule.integrate([](const double & x) {
+		return x*x;
+	});
+	BOOST_REQUIRE_CLOSE(2.0/3.0,result,1.0e-10);
+	result = rule.integrate([](const double & x) {
+		return x*x*x*x*x*x + x*x*x*x*x;
+	});
+	BOOST_REQUIRE_CLOSE(2.0/7.0,result,1.0e-10);
+
+	// Lambdas that take indices still use the default indices
+	result = rule.integrate([](const double & x, const int & i) {
+		return x*x + i;
+	});
+	BOOST_REQUIRE_CLOSE(2.0/3.0,result,1.0e-10);
+
 	return;
 }
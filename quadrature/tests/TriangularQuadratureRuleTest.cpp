@@ -139,3 +139,60 @@ BOOST_AUTO_TEST_CASE(checkTwoIndexQuadrature) {
 
 	return;
 }
+
+/**
+ * This operation checks the templated integration of kernels that are
+ * compile-time types against the exact integrals of polynomials in area
+ * coordinates over the unit triangle,
+ * \f[
+ * \iint L_{1}^{a}L_{2}^{b}L_{3}^{c} dA = \frac{a!b!c!}{(a+b+c+2)!}2A
+ * \f]
+ */
+BOOST_AUTO_TEST_CASE(checkKernelQuadrature) {
+
+	TriangularQuadratureRule rule;
+
+	// Constant
+	double result = rule.integrate([](const std::array<double,3> &) {
+		return 1.0;
+	});
+	BOOST_REQUIRE_CLOSE(0.5,result,1.0e-12);
+	// L_1 = 1/6 and L_1 L_2 = 1/24
+	result = rule.integrate([](const std::array<double,3> & point) {
+		return point[0];
+	});
+	BOOST_REQUIRE_CLOSE(1.0/6.0,result,1.0e-12);
+	result = rule.integrate([](const std::array<double,3> & point) {
+		return point[0]*point[1];
+	});
+	BOOST_REQUIRE_CLOSE(1.0/24.0,result,1.0e-12);
+
+	// Captured indices give the same result as the std::function version
+	std::function<double(const std::array<double,3> &,
+			const int &, const int &)> indexed = [](const std::array<double,3> & point,
+			const int & i, const int & j) {
+		return point[i]*point[j];
+	};
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 3; j++) {
+			result = rule.integrate([&](const std::array<double,3> & point) {
+				return point[i]*point[j];
+			});
+			BOOST_REQUIRE_CLOSE(rule.integrate(indexed,i,j),result,1.0e-12);
+		}
+	}
+
+	// Lambdas that take indices still use the default indices
+	result = rule.integrate([](const std::array<double,3> & point,
+			const int & i) {
+		return point[i] + i;
+	});
+	BOOST_REQUIRE_CLOSE(1.0/6.0,result,1.0e-12);
+	result = rule.integrate([](const std::array<double,3> & point,
+			const int & i, const int & j) {
+		return point[i]*point[j] + i + j;
+	});
+	BOOST_REQUIRE_CLOSE(1.0/12.0,result,1.0e-12);
+
+	return;
+}
@@ -0,0 +1,212 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+
+// See the header file for API documentation
+
+#include <BandedSolver.h>
+#include <stdexcept>
+#include <algorithm>
+#include <string>
+#include <math.h>
+
+using namespace std;
+
+#ifdef FIRE_SOLVERS_HAVE_LAPACK
+// The LAPACK band routines
+extern "C" {
+void dpbtrf_(const char * uplo, const int * n, const int * kd, double * ab,
+		const int * ldab, int * info);
+void dpbtrs_(const char * uplo, const int * n, const int * kd,
+		const int * nrhs, const double * ab, const int * ldab, double * b,
+		const int * ldb, int * info);
+void dgbtrf_(const int * m, const int * n, const int * kl, const int * ku,
+		double * ab, const int * ldab, int * ipiv, int * info);
+void dgbtrs_(const char * trans, const int * n, const int * kl,
+		const int * ku, const int * nrhs, const double * ab, const int * ldab,
+		const int * ipiv, double * b, const int * ldb, int * info);
+}
+#endif
+
+namespace fire {
+
+bool BandedSolver::lapackAvailable() {
+#ifdef FIRE_SOLVERS_HAVE_LAPACK
+	return true;
+#else
+	return false;
+#endif
+}
+
+void BandedSolver::factor(const CSRMatrix<double> & matrix,
+		const BandedFactorization & type) {
+
+	if (type == BandedFactorization::LU && !lapackAvailable()) {
+		throw runtime_error("Banded LU factorization requires LAPACK.");
+	}
+	band.clear();
+	pivots.clear();
+	factorization = type;
+	numRows = matrix.size();
+
+	// Find the bandwidths
+	lowerBandwidth = 0;
+	upperBandwidth = 0;
+	for (int i = 0; i < numRows; i++) {
+		for (long k = matrix.rowOffsets[i]; k < matrix.rowOffsets[i+1]; k++) {
+			int j = matrix.columns[k];
+			lowerBandwidth = max(lowerBandwidth, i - j);
+			upperBandwidth = max(upperBandwidth, j - i);
+		}
+	}
+
+	// Copy the band. Entry (i,j) is at row (i - j) of column j for Cholesky
+	// and at row (kl + ku + i - j) for LU, which leaves kl rows for fill-in.
+	int offset = 0;
+	if (type == BandedFactorization::CHOLESKY) {
+		leadingDimension = lowerBandwidth + 1;
+	} else {
+		offset = lowerBandwidth + upperBandwidth;
+		leadingDimension = 2*lowerBandwidth + upperBandwidth + 1;
+	}
+	vector<double> entries((long) leadingDimension*numRows, 0.0);
+	for (int i = 0; i < numRows; i++) {
+		for (long k = matrix.rowOffsets[i]; k < matrix.rowOffsets[i+1]; k++) {
+			int j = matrix.columns[k];
+			if (type == BandedFactorization::LU || j <= i) {
+				entries[(long) j*leadingDimension + offset + i - j] =
+						matrix.values[k];
+			}
+		}
+	}
+	band.swap(entries);
+
+	// Factor
+	int info = 0;
+	if (type == BandedFactorization::CHOLESKY) {
+#ifdef FIRE_SOLVERS_HAVE_LAPACK
+		dpbtrf_("L", &numRows, &lowerBandwidth, band.data(),
+				&leadingDimension, &info);
+#else
+		factorCholesky();
+#endif
+		if (info > 0) {
+			band.clear();
+			throw runtime_error("Matrix is not positive definite at row "
+					+ to_string(info - 1) + ".");
+		}
+	} else {
+#ifdef FIRE_SOLVERS_HAVE_LAPACK
+		pivots.resize(numRows);
+		dgbtrf_(&numRows, &numRows, &lowerBandwidth, &upperBandwidth,
+				band.data(), &leadingDimension, pivots.data(), &info);
+#endif
+		if (info > 0) {
+			band.clear();
+			throw runtime_error("Matrix is singular at row "
+					+ to_string(info - 1) + ".");
+		}
+	}
+
+	return;
+}
+
+void BandedSolver::factorCholesky() {
+	int kd = lowerBandwidth, ld = leadingDimension;
+	for (int j = 0; j < numRows; j++) {
+		double * column = &band[(long) j*ld];
+		// Subtract the contributions of the previous columns
+		for (int k = max(0, j - kd); k < j; k++) {
+			const double * previous = &band[(long) k*ld];
+			double ljk = previous[j - k];
+			int last = min(numRows - 1, k + kd);
+			for (int i = j; i <= last; i++) {
+				column[i - j] -= previous[i - k]*ljk;
+			}
+		}
+		if (column[0] <= 0.0) {
+			band.clear();
+			throw runtime_error("Matrix is not positive definite at row "
+					+ to_string(j) + ".");
+		}
+		column[0] = sqrt(column[0]);
+		int last = min(numRows - 1, j + kd);
+		for (int i = j + 1; i <= last; i++) column[i - j] /= column[0];
+	}
+}
+
+void BandedSolver::solve(const vector<double> & b, vector<double> & x) const {
+
+	if (!factored()) {
+		throw runtime_error("Matrix must be factored before solving.");
+	}
+	if ((int) b.size() != numRows) {
+		throw runtime_error("Right hand side has the wrong size.");
+	}
+	if (&x != &b) x = b;
+
+	int numRHS = 1, info = 0;
+	if (factorization == BandedFactorization::CHOLESKY) {
+#ifdef FIRE_SOLVERS_HAVE_LAPACK
+		dpbtrs_("L", &numRows, &lowerBandwidth, &numRHS, band.data(),
+				&leadingDimension, x.data(), &numRows, &info);
+#else
+		int kd = lowerBandwidth, ld = leadingDimension;
+		// Forward substitution with L
+		for (int j = 0; j < numRows; j++) {
+			const double * column = &band[(long) j*ld];
+			x[j] /= column[0];
+			int last = min(numRows - 1, j + kd);
+			for (int i = j + 1; i <= last; i++) x[i] -= column[i - j]*x[j];
+		}
+		// Backward substitution with L^T
+		for (int j = numRows - 1; j >= 0; j--) {
+			const double * column = &band[(long) j*ld];
+			int last = min(numRows - 1, j + kd);
+			for (int i = j + 1; i <= last; i++) x[j] -= column[i - j]*x[i];
+			x[j] /= column[0];
+		}
+#endif
+	} else {
+#ifdef FIRE_SOLVERS_HAVE_LAPACK
+		dgbtrs_("N", &numRows, &lowerBandwidth, &upperBandwidth, &numRHS,
+				band.data(), &leadingDimension, pivots.data(), x.data(),
+				&numRows, &info);
+#endif
+	}
+	if (info != 0) {
+		throw runtime_error("Banded solve failed.");
+	}
+
+	return;
+}
+
+} /* namespace fire */
@@ -0,0 +1,186 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#ifndef SOLVERS_BANDEDSOLVER_H_
+#define SOLVERS_BANDEDSOLVER_H_
+
+#include <vector>
+#include <CSRMatrix.h>
+
+namespace fire {
+
+/**
+ * The factorizations that BandedSolver can use.
+ */
+enum class BandedFactorization {
+	/**
+	 * Cholesky factorization for symmetric positive definite matrices
+	 * (LAPACK dpbtrf/dpbtrs). Only the lower band is stored.
+	 */
+	CHOLESKY,
+	/**
+	 * LU factorization with partial pivoting for general banded matrices
+	 * (LAPACK dgbtrf/dgbtrs).
+	 */
+	LU
+};
+
+/**
+ * This class is a direct solver for banded matrices. The band of a
+ * CSRMatrix is copied into LAPACK band storage and factored once, after
+ * which any number of right hand sides can be solved. The storage is
+ * proportional to the number of rows times the bandwidth and the work of the
+ * factorization to the number of rows times the square of the bandwidth, so
+ * the rows should be numbered to make the bandwidth small, for example with
+ * reverseCuthillMcKee() in GraphOrdering.h:
+ * @code
+ * std::vector<int> order = reverseCuthillMcKee(matrix);
+ * CSRMatrix<double> banded = permute(matrix, order);
+ * BandedSolver solver;
+ * solver.factor(banded);
+ * std::vector<double> x;
+ * solver.solve(permute(b, order), x);
+ * x = unpermute(x, order);
+ * @endcode
+ * For the matrices of 2D meshes with up to a few hundred thousand nodes this
+ * is faster than dense LU and unpreconditioned iterative solvers.
+ *
+ * The factor and solve steps are the ones that LAPACK's dpbsv and dgbsv
+ * drivers call, kept separate so that the factors can be reused. When Fire
+ * is built without LAPACK, Cholesky factorizations use a built-in band
+ * algorithm and LU factorizations are not available.
+ */
+class BandedSolver {
+
+protected:
+
+	/**
+	 * The factorization in use.
+	 */
+	BandedFactorization factorization = BandedFactorization::CHOLESKY;
+
+	/**
+	 * The number of rows in the matrix.
+	 */
+	int numRows = 0;
+
+	/**
+	 * The number of diagonals below the main diagonal.
+	 */
+	int lowerBandwidth = 0;
+
+	/**
+	 * The number of diagonals above the main diagonal.
+	 */
+	int upperBandwidth = 0;
+
+	/**
+	 * The leading dimension of the band storage.
+	 */
+	int leadingDimension = 0;
+
+	/**
+	 * The factors in LAPACK band storage, column by column.
+	 */
+	std::vector<double> band;
+
+	/**
+	 * The pivots of the LU factorization.
+	 */
+	std::vector<int> pivots;
+
+	/**
+	 * This operation factors the band with the built-in Cholesky
+	 * algorithm.
+	 */
+	void factorCholesky();
+
+public:
+
+	/**
+	 * This operation factors a matrix, replacing any previous factors.
+	 * @param matrix the matrix, which must be symmetric positive definite
+	 * for Cholesky factorizations. Only its lower triangle is read in that
+	 * case.
+	 * @param type the factorization to use
+	 * @throw std::runtime_error if the matrix is singular or, for Cholesky,
+	 * not positive definite, or if LU is requested without LAPACK
+	 */
+	void factor(const CSRMatrix<double> & matrix,
+			const BandedFactorization & type = BandedFactorization::CHOLESKY);
+
+	/**
+	 * This operation solves Ax = b with the factors.
+	 * @param b the right hand side
+	 * @param x the solution, which is resized if required. It may be the same
+	 * vector as b.
+	 * @throw std::runtime_error if the matrix has not been factored or b has
+	 * the wrong size
+	 */
+	void solve(const std::vector<double> & b, std::vector<double> & x) const;
+
+	/**
+	 * This operation returns true if a matrix has been factored.
+	 * @return true if factored, false otherwise
+	 */
+	bool factored() const { return !band.empty();};
+
+	/**
+	 * This operation returns the size of the factored matrix.
+	 * @return the number of rows
+	 */
+	int size() const { return numRows;};
+
+	/**
+	 * This operation returns the number of diagonals below the main diagonal
+	 * of the factored matrix.
+	 * @return the lower bandwidth
+	 */
+	int bandwidth() const { return lowerBandwidth;};
+
+	/**
+	 * This operation returns the number of entries in the band storage.
+	 * @return the number of entries
+	 */
+	long storage() const { return band.size();};
+
+	/**
+	 * This operation returns true if Fire was built with LAPACK, in which
+	 * case both factorizations are available.
+	 * @return true if LAPACK is used
+	 */
+	static bool lapackAvailable();
+
+};
+
+} /* namespace fire */
+
+#endif /* SOLVERS_BANDEDSOLVER_H_ */
@@ -0,0 +1,208 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#ifndef SOLVERS_CSRMATRIX_H_
+#define SOLVERS_CSRMATRIX_H_
+
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <ThreadPool.h>
+
+namespace fire {
+
+/**
+ * This class is a sparse matrix stored in the Compressed Sparse Row (CSR)
+ * format. The nonzero values of row i are stored in
+ * values[rowOffsets[i]..rowOffsets[i+1]) and their column indices, which are
+ * sorted, in the same range of columns. Each position in the values array is
+ * called a slot.
+ *
+ * The sparsity pattern is fixed when the matrix is constructed from a list of
+ * (row,column) pairs. Only the values change afterwards, which is the normal
+ * situation in finite element codes where the pattern follows from the mesh
+ * connectivity and the values are reassembled many times:
+ * @code
+ * std::vector<std::pair<int,int>> entries = {{0,0},{0,1},{1,0},{1,1}};
+ * CSRMatrix<double> matrix(2,entries);
+ * matrix.values[matrix.slot(0,1)] += 2.0;
+ * matrix.multiply(x,y);
+ * @endcode
+ *
+ * The arrays are public so that assemblers and solvers can work on them
+ * directly.
+ */
+template<typename T>
+class CSRMatrix {
+
+public:
+
+	/**
+	 * The number of rows, which is also the number of columns.
+	 */
+	int numRows = 0;
+
+	/**
+	 * The offsets of the first slot in each row, with one extra entry at the
+	 * end that holds the number of nonzeros.
+	 */
+	std::vector<long> rowOffsets;
+
+	/**
+	 * The column index of each slot, sorted within each row.
+	 */
+	std::vector<int> columns;
+
+	/**
+	 * The value of each slot.
+	 */
+	std::vector<T> values;
+
+	/**
+	 * Constructor for an empty matrix
+	 */
+	CSRMatrix() : rowOffsets(1,0) {};
+
+	/**
+	 * This constructor creates the sparsity pattern from a list of
+	 * (row,column) pairs, which may contain duplicates and be in any order.
+	 * All values are zero.
+	 * @param size the number of rows and columns
+	 * @param entries the positions of the nonzeros
+	 */
+	CSRMatrix(const int & size,
+			const std::vector<std::pair<int,int>> & entries) : numRows(size),
+			rowOffsets(size + 1,0) {
+		// Sort the entries by row and then column and remove duplicates
+		std::vector<std::pair<int,int>> sorted(entries);
+		std::sort(sorted.begin(), sorted.end());
+		sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+		// Count the nonzeros in each row and compute the offsets
+		columns.resize(sorted.size());
+		for (long k = 0; k < (long) sorted.size(); k++) {
+			if (sorted[k].first < 0 || sorted[k].first >= size
+					|| sorted[k].second < 0 || sorted[k].second >= size) {
+				throw std::out_of_range("CSRMatrix entry is out of range.");
+			}
+			rowOffsets[sorted[k].first + 1]++;
+			columns[k] = sorted[k].second;
+		}
+		for (int i = 0; i < size; i++) rowOffsets[i+1] += rowOffsets[i];
+		values.assign(sorted.size(), T());
+	};
+
+	/**
+	 * This operation returns the number of rows in the matrix.
+	 * @return the number of rows
+	 */
+	int size() const { return numRows;};
+
+	/**
+	 * This operation returns the number of nonzeros in the matrix.
+	 * @return the number of stored values
+	 */
+	long nonZeros() const { return values.size();};
+
+	/**
+	 * This operation finds the slot of the value at (row,column) with a
+	 * binary search of the row.
+	 * @param row the row
+	 * @param column the column
+	 * @return the index of the value in the values array or -1 if the entry
+	 * is not in the sparsity pattern.
+	 */
+	long slot(const int & row, const int & column) const {
+		auto begin = columns.begin() + rowOffsets[row],
+				end = columns.begin() + rowOffsets[row+1];
+		auto it = std::lower_bound(begin, end, column);
+		return (it != end && *it == column) ? it - columns.begin() : -1;
+	}
+
+	/**
+	 * This operation returns the value at (row,column), which is zero if the
+	 * entry is not in the sparsity pattern.
+	 * @param row the row
+	 * @param column the column
+	 * @return the value
+	 */
+	T operator () (const int & row, const int & column) const {
+		long index = slot(row,column);
+		return (index < 0) ? T() : values[index];
+	}
+
+	/**
+	 * This operation sets all of the values to zero without changing the
+	 * sparsity pattern.
+	 */
+	void zero() { std::fill(values.begin(), values.end(), T());};
+
+	/**
+	 * This operation computes the product y = Ax.
+	 * @param x the vector to multiply, which must have size() elements
+	 * @param y the product, which is resized if required
+	 */
+	void multiply(const std::vector<T> & x, std::vector<T> & y) const {
+		y.resize(numRows);
+		for (int i = 0; i < numRows; i++) {
+			T sum = T();
+			for (long k = rowOffsets[i]; k < rowOffsets[i+1]; k++) {
+				sum += values[k]*x[columns[k]];
+			}
+			y[i] = sum;
+		}
+	}
+
+	/**
+	 * This operation computes the product y = Ax in parallel, with each
+	 * thread computing a contiguous block of rows.
+	 * @param x the vector to multiply, which must have size() elements
+	 * @param y the product, which is resized if required
+	 * @param pool the threads to use
+	 */
+	void multiply(const std::vector<T> & x, std::vector<T> & y,
+			ThreadPool & pool) const {
+		y.resize(numRows);
+		pool.parallelFor(0, numRows, [&](const long & begin, const long & end) {
+			for (long i = begin; i < end; i++) {
+				T sum = T();
+				for (long k = rowOffsets[i]; k < rowOffsets[i+1]; k++) {
+					sum += values[k]*x[columns[k]];
+				}
+				y[i] = sum;
+			}
+		});
+	}
+
+};
+
+} /* namespace fire */
+
+#endif /* SOLVERS_CSRMATRIX_H_ */
@@ -0,0 +1,200 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#include <Checkpoint.h>
+#include <fstream>
+#include <stdexcept>
+#include <cstdio>
+#include <cstdint>
+#include <algorithm>
+
+namespace fire {
+
+/**
+ * The identifier at the start of every checkpoint file.
+ */
+static const char magic[8] = {'F','I','R','E','C','K','P','T'};
+
+/**
+ * The version of the checkpoint file format.
+ */
+static const std::uint32_t version = 1;
+
+/**
+ * These are utility functions for reading and writing the fields.
+ */
+template<typename V>
+static void put(std::ofstream & out, const V & value) {
+	out.write(reinterpret_cast<const char *>(&value), sizeof(V));
+}
+
+template<typename V>
+static void put(std::ofstream & out, const std::vector<V> & values) {
+	put<std::uint64_t>(out, values.size());
+	out.write(reinterpret_cast<const char *>(values.data()),
+			values.size()*sizeof(V));
+}
+
+template<typename V>
+static void get(std::ifstream & in, V & value) {
+	in.read(reinterpret_cast<char *>(&value), sizeof(V));
+}
+
+template<typename V>
+static void get(std::ifstream & in, std::vector<V> & values) {
+	std::uint64_t size = 0;
+	get(in, size);
+	if (!in) return;
+	values.resize(size);
+	in.read(reinterpret_cast<char *>(values.data()), size*sizeof(V));
+}
+
+void Checkpoint::write(const std::string & fileName) const {
+	std::string tmpName = fileName + ".tmp";
+	{
+		std::ofstream out(tmpName, std::ios::binary | std::ios::trunc);
+		if (!out) {
+			throw std::runtime_error("Unable to open checkpoint file " + tmpName);
+		}
+		out.write(magic, sizeof(magic));
+		put(out, version);
+		std::vector<char> name(solver.begin(), solver.end());
+		put(out, name);
+		put(out, t);
+		put(out, u);
+		put(out, parameters);
+		put(out, stepSize);
+		put<std::int32_t>(out, order);
+		put<std::uint64_t>(out, history.size());
+		for (auto & column : history) put(out, column);
+		put(out, counters);
+		put(out, values);
+		if (!out) {
+			throw std::runtime_error("Unable to write checkpoint file " + tmpName);
+		}
+	}
+	if (std::rename(tmpName.c_str(), fileName.c_str()) != 0) {
+		throw std::runtime_error("Unable to rename checkpoint file " + tmpName);
+	}
+}
+
+void Checkpoint::read(const std::string & fileName) {
+	std::ifstream in(fileName, std::ios::binary);
+	if (!in) {
+		throw std::runtime_error("Unable to open checkpoint file " + fileName);
+	}
+	char fileMagic[sizeof(magic)];
+	std::uint32_t fileVersion = 0;
+	in.read(fileMagic, sizeof(magic));
+	get(in, fileVersion);
+	if (!in || !std::equal(magic, magic + sizeof(magic), fileMagic)
+			|| fileVersion != version) {
+		throw std::runtime_error(fileName + " is not a valid checkpoint file.");
+	}
+	std::vector<char> name;
+	get(in, name);
+	solver.assign(name.begin(), name.end());
+	get(in, t);
+	get(in, u);
+	get(in, parameters);
+	get(in, stepSize);
+	std::int32_t fileOrder = 0;
+	get(in, fileOrder);
+	order = fileOrder;
+	std::uint64_t numColumns = 0;
+	get(in, numColumns);
+	history.resize(in ? numColumns : 0);
+	for (auto & column : history) get(in, column);
+	get(in, counters);
+	get(in, values);
+	if (!in) {
+		throw std::runtime_error("Checkpoint file " + fileName + " is truncated.");
+	}
+}
+
+CheckpointWriter::CheckpointWriter() : worker(&CheckpointWriter::work, this) {}
+
+CheckpointWriter::~CheckpointWriter() {
+	{
+		std::unique_lock<std::mutex> lock(queueMutex);
+		stopping = true;
+	}
+	queueChanged.notify_all();
+	worker.join();
+}
+
+void CheckpointWriter::work() {
+	std::unique_lock<std::mutex> lock(queueMutex);
+	while (true) {
+		queueChanged.wait(lock, [&] {return stopping || !queue.empty();});
+		// Finish the queue before stopping.
+		if (queue.empty()) return;
+		auto item = std::move(queue.front());
+		queue.pop_front();
+		writing = true;
+		lock.unlock();
+		try {
+			item.first.write(item.second);
+		} catch (...) {
+			lock.lock();
+			if (!error) error = std::current_exception();
+			lock.unlock();
+		}
+		lock.lock();
+		writing = false;
+		queueChanged.notify_all();
+	}
+}
+
+void CheckpointWriter::rethrow() {
+	if (error) {
+		auto current = error;
+		error = nullptr;
+		std::rethrow_exception(current);
+	}
+}
+
+void CheckpointWriter::write(Checkpoint checkpoint, const std::string & fileName) {
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		rethrow();
+		queue.emplace_back(std::move(checkpoint), fileName);
+	}
+	queueChanged.notify_all();
+}
+
+void CheckpointWriter::wait() {
+	std::unique_lock<std::mutex> lock(queueMutex);
+	queueChanged.wait(lock, [&] {return queue.empty() && !writing;});
+	rethrow();
+}
+
+} /* namespace fire */
@@ -0,0 +1,212 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#ifndef SOLVERS_CHECKPOINT_H_
+#define SOLVERS_CHECKPOINT_H_
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+namespace fire {
+
+/**
+ * This structure holds everything that is needed to restart an integration
+ * from the middle: the State's t, unknowns and parameters, and the history of
+ * the integrator that wrote it. The history is stored generically so that
+ * every solver can decide what it needs to continue with identical behavior.
+ * For example, RKSolver stores the derivative at t and its step size
+ * controller state, while IVPSolver stores the Nordsieck array of CVODE.
+ *
+ * Checkpoints are stored in a simple, native-endian binary format. The files
+ * are written to a temporary file first and then renamed, so a checkpoint
+ * file is never left partially written if the process is killed. Errors are
+ * reported by throwing std::runtime_error.
+ */
+struct Checkpoint {
+
+	/**
+	 * The name of the solver that wrote the checkpoint. Solvers use it to
+	 * make sure that they do not restart from another solver's history.
+	 */
+	std::string solver;
+
+	/**
+	 * The value of t at the checkpoint.
+	 */
+	double t = 0.0;
+
+	/**
+	 * The values of the unknowns, as returned by State.u(), at t.
+	 */
+	std::vector<double> u;
+
+	/**
+	 * The parameters of the State, as returned by State.parameters(), such as
+	 * the temperature and density of a reaction network.
+	 */
+	std::vector<double> parameters;
+
+	/**
+	 * The step size that the integrator would have taken next.
+	 */
+	double stepSize = 0.0;
+
+	/**
+	 * The order of the integrator at t, if it varies.
+	 */
+	int order = 0;
+
+	/**
+	 * The solution history of the integrator, such as the columns of a
+	 * Nordsieck array or stored stage derivatives. Each entry has the same
+	 * size as u.
+	 */
+	std::vector<std::vector<double>> history;
+
+	/**
+	 * Integer state of the integrator, such as counters and flags.
+	 */
+	std::vector<long> counters;
+
+	/**
+	 * Real state of the integrator, such as controller state and statistics.
+	 */
+	std::vector<double> values;
+
+	/**
+	 * This operation writes the checkpoint to a file, replacing it if it
+	 * exists.
+	 * @param fileName the name of the file
+	 */
+	void write(const std::string & fileName) const;
+
+	/**
+	 * This operation reads the checkpoint from a file.
+	 * @param fileName the name of the file
+	 */
+	void read(const std::string & fileName);
+};
+
+/**
+ * This class writes checkpoints on a background thread so that solvers do not
+ * wait on the file system. The solver only pays for the copy of the
+ * checkpoint that it hands to write(). Checkpoints are written in the order
+ * they are submitted.
+ *
+ * Errors on the background thread are stored and rethrown by the next call to
+ * write() or wait(). The destructor waits for all of the pending writes.
+ */
+class CheckpointWriter {
+
+protected:
+
+	/**
+	 * The checkpoints waiting to be written with their file names.
+	 */
+	std::deque<std::pair<Checkpoint,std::string>> queue;
+
+	/**
+	 * The lock that guards the queue and the flags.
+	 */
+	std::mutex queueMutex;
+
+	/**
+	 * The condition used to signal that the queue changed.
+	 */
+	std::condition_variable queueChanged;
+
+	/**
+	 * True if a checkpoint is being written.
+	 */
+	bool writing = false;
+
+	/**
+	 * True if the writer is being destroyed.
+	 */
+	bool stopping = false;
+
+	/**
+	 * The first error thrown on the background thread.
+	 */
+	std::exception_ptr error;
+
+	/**
+	 * The background thread.
+	 */
+	std::thread worker;
+
+	/**
+	 * This is the main loop of the background thread.
+	 */
+	void work();
+
+	/**
+	 * This operation rethrows any stored error. The caller must hold the lock.
+	 */
+	void rethrow();
+
+public:
+
+	/**
+	 * Constructor. It starts the background thread.
+	 */
+	CheckpointWriter();
+
+	/**
+	 * Destructor. It waits for the pending writes and stops the thread.
+	 */
+	~CheckpointWriter();
+
+	CheckpointWriter(const CheckpointWriter &) = delete;
+	CheckpointWriter & operator=(const CheckpointWriter &) = delete;
+
+	/**
+	 * This operation queues a checkpoint to be written to a file and returns
+	 * immediately.
+	 * @param checkpoint the checkpoint, which is moved into the queue
+	 * @param fileName the name of the file
+	 */
+	void write(Checkpoint checkpoint, const std::string & fileName);
+
+	/**
+	 * This operation waits until all of the queued checkpoints are written.
+	 */
+	void wait();
+};
+
+} /* namespace fire */
+
+#endif /* SOLVERS_CHECKPOINT_H_ */
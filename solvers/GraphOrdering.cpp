@@ -0,0 +1,245 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+
+// See the header file for API documentation
+
+#include <GraphOrdering.h>
+#include <algorithm>
+
+using namespace std;
+
+namespace fire {
+
+/**
+ * This class holds a graph and the work arrays for the breadth first
+ * searches used by the orderings and partitions. The searches can be
+ * restricted to the vertices with a given label.
+ */
+class GraphSearch {
+
+public:
+
+	/**
+	 * The graph, stored like the pattern of a CSRMatrix.
+	 */
+	const vector<long> & offsets;
+	const vector<int> & neighbors;
+
+	/**
+	 * The number of neighbors of each vertex, not counting itself.
+	 */
+	vector<int> degrees;
+
+	/**
+	 * The stamp of the last search that reached each vertex.
+	 */
+	vector<int> marks;
+
+	/**
+	 * The stamp of the current search.
+	 */
+	int stamp = 0;
+
+	/**
+	 * The labels of the vertices, or null if the searches are not
+	 * restricted, and the label of the vertices they may visit.
+	 */
+	const vector<int> * labels = nullptr;
+	int label = 0;
+
+	/**
+	 * The constructor
+	 */
+	GraphSearch(const vector<long> & graphOffsets,
+			const vector<int> & graphNeighbors) : offsets(graphOffsets),
+			neighbors(graphNeighbors), degrees(graphOffsets.size() - 1, 0),
+			marks(graphOffsets.size() - 1, 0) {
+		for (int i = 0; i < (int) degrees.size(); i++) {
+			for (long n = offsets[i]; n < offsets[i+1]; n++) {
+				if (neighbors[n] != i) degrees[i]++;
+			}
+		}
+	}
+
+	/**
+	 * This operation numbers the component of a vertex breadth first,
+	 * visiting the unmarked neighbors of each vertex in order of increasing
+	 * degree. It appends the vertices to the order and returns the number of
+	 * levels and the position of the first vertex of the last level.
+	 */
+	int breadthFirst(const int & start, vector<int> & order,
+			long & lastLevelStart) {
+		stamp++;
+		order.push_back(start);
+		marks[start] = stamp;
+		int levels = 0;
+		long levelBegin = order.size() - 1, levelEnd = order.size();
+		while (levelBegin < levelEnd) {
+			levels++;
+			lastLevelStart = levelBegin;
+			for (long k = levelBegin; k < levelEnd; k++) {
+				int vertex = order[k];
+				long begin = order.size();
+				for (long n = offsets[vertex]; n < offsets[vertex+1]; n++) {
+					int neighbor = neighbors[n];
+					if (marks[neighbor] != stamp
+							&& (!labels || (*labels)[neighbor] == label)) {
+						marks[neighbor] = stamp;
+						order.push_back(neighbor);
+					}
+				}
+				stable_sort(order.begin() + begin, order.end(),
+						[&](const int & a, const int & b) {
+					return degrees[a] < degrees[b];
+				});
+			}
+			levelBegin = levelEnd;
+			levelEnd = order.size();
+		}
+		return levels;
+	}
+
+	/**
+	 * This operation appends the component of a vertex to the order, breadth
+	 * first from a pseudo-peripheral vertex. The George-Liu search restarts
+	 * from the lowest degree vertex of the last level as long as the number
+	 * of levels grows.
+	 */
+	void numberComponent(const int & seed, vector<int> & order) {
+		vector<int> trial;
+		int start = seed, levels = 0;
+		long lastLevel = 0;
+		while (true) {
+			trial.clear();
+			int newLevels = breadthFirst(start, trial, lastLevel);
+			if (newLevels <= levels) break;
+			levels = newLevels;
+			int next = trial[lastLevel];
+			for (long k = lastLevel; k < (long) trial.size(); k++) {
+				if (degrees[trial[k]] < degrees[next]) next = trial[k];
+			}
+			if (next == start) break;
+			start = next;
+		}
+		breadthFirst(start, order, lastLevel);
+	}
+
+};
+
+vector<int> reverseCuthillMcKee(const vector<long> & offsets,
+		const vector<int> & neighbors) {
+	int size = offsets.size() - 1;
+	GraphSearch search(offsets, neighbors);
+	vector<int> order;
+	order.reserve(size);
+	vector<bool> numbered(size, false);
+	for (int seed = 0; seed < size; seed++) {
+		if (numbered[seed]) continue;
+		long first = order.size();
+		search.numberComponent(seed, order);
+		for (long k = first; k < (long) order.size(); k++) {
+			numbered[order[k]] = true;
+		}
+	}
+	reverse(order.begin(), order.end());
+	return order;
+}
+
+/**
+ * This operation splits the vertices of one part in two along the breadth
+ * first order of the part and recurses.
+ */
+static void bisect(GraphSearch & search, vector<int> & parts,
+		const vector<int> & vertices, const int & firstPart,
+		const int & numParts) {
+	if (numParts < 2 || vertices.empty()) return;
+	// Number each connected piece of the part in breadth first order
+	vector<int> order;
+	order.reserve(vertices.size());
+	search.labels = &parts;
+	search.label = firstPart;
+	// Every search in this call only visits the piece of its seed, so a
+	// vertex that any of them marked has been numbered.
+	int firstStamp = search.stamp + 1;
+	for (int seed : vertices) {
+		if (search.marks[seed] >= firstStamp) continue;
+		search.numberComponent(seed, order);
+	}
+	// Split the order in proportion to the number of parts on each side
+	int leftParts = numParts/2;
+	long cut = (long) vertices.size()*leftParts/numParts;
+	vector<int> left(order.begin(), order.begin() + cut),
+			right(order.begin() + cut, order.end());
+	for (int vertex : right) parts[vertex] = firstPart + leftParts;
+	bisect(search, parts, left, firstPart, leftParts);
+	bisect(search, parts, right, firstPart + leftParts, numParts - leftParts);
+}
+
+vector<int> recursiveBisection(const vector<long> & offsets,
+		const vector<int> & neighbors, const int & numParts) {
+	int size = offsets.size() - 1;
+	if (numParts < 1) {
+		throw runtime_error("Graphs must be split into at least one part.");
+	}
+	GraphSearch search(offsets, neighbors);
+	vector<int> parts(size, 0), vertices(size);
+	for (int i = 0; i < size; i++) vertices[i] = i;
+	bisect(search, parts, vertices, 0, numParts);
+	return parts;
+}
+
+vector<int> inversePermutation(const vector<int> & order) {
+	vector<int> inverse(order.size(), -1);
+	for (int k = 0; k < (int) order.size(); k++) {
+		if (order[k] < 0 || order[k] >= (int) order.size()
+				|| inverse[order[k]] >= 0) {
+			throw runtime_error("Order is not a permutation.");
+		}
+		inverse[order[k]] = k;
+	}
+	return inverse;
+}
+
+void checkOrder(const vector<long> & order, const long & size) {
+	vector<bool> found(size, false);
+	if ((long) order.size() != size) {
+		throw runtime_error("Order is not a permutation.");
+	}
+	for (long index : order) {
+		if (index < 0 || index >= size || found[index]) {
+			throw runtime_error("Order is not a permutation.");
+		}
+		found[index] = true;
+	}
+}
+
+} /* namespace fire */
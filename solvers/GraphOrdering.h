@@ -0,0 +1,219 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#ifndef SOLVERS_GRAPHORDERING_H_
+#define SOLVERS_GRAPHORDERING_H_
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+#include <CSRMatrix.h>
+
+namespace fire {
+
+/**
+ * This operation computes the Reverse Cuthill-McKee ordering of an
+ * undirected graph, which numbers the vertices such that neighbors have
+ * nearby numbers. Applied to the rows and columns of a sparse matrix, it
+ * reduces the bandwidth and the profile, so banded and skyline
+ * factorizations need less storage and work and the entries of x that a
+ * row of y = Ax reads are close together in memory.
+ *
+ * Each connected component is numbered by a breadth first search from a
+ * pseudo-peripheral vertex, found with the George-Liu algorithm, that
+ * visits the neighbors of each vertex in order of increasing degree. The
+ * order is then reversed.
+ *
+ * The graph is stored like the pattern of a CSRMatrix: the neighbors of
+ * vertex i are neighbors[offsets[i]..offsets[i+1]). Self loops are ignored
+ * and the graph must be symmetric.
+ * @param offsets the offsets of the neighbors of each vertex, with one extra
+ * entry at the end
+ * @param neighbors the neighbors of all vertices
+ * @return the order, where order[k] is the original index of the vertex that
+ * is numbered k
+ */
+std::vector<int> reverseCuthillMcKee(const std::vector<long> & offsets,
+		const std::vector<int> & neighbors);
+
+/**
+ * This operation computes the Reverse Cuthill-McKee ordering of the rows of
+ * a matrix with a symmetric sparsity pattern.
+ * @param matrix the matrix
+ * @return the order, where order[k] is the original row that becomes row k
+ */
+template<typename T>
+std::vector<int> reverseCuthillMcKee(const CSRMatrix<T> & matrix) {
+	return reverseCuthillMcKee(matrix.rowOffsets, matrix.columns);
+}
+
+/**
+ * This operation partitions a graph into parts of nearly equal size by
+ * recursive graph bisection. The vertices of a part are ordered breadth
+ * first from a pseudo-peripheral vertex, as in reverseCuthillMcKee(), and
+ * split at the point that leaves each side a number of vertices in
+ * proportion to the number of parts that it will be split into. Since the
+ * breadth first order sweeps across the graph level by level, the two
+ * halves are connected pieces separated by a short cut. This is cheaper
+ * than multilevel partitioners and gives compact subdomains on meshes.
+ * @param offsets the offsets of the neighbors of each vertex, with one extra
+ * entry at the end
+ * @param neighbors the neighbors of all vertices
+ * @param numParts the number of parts, which need not be a power of two
+ * @return the part of each vertex, from 0 to numParts - 1
+ */
+std::vector<int> recursiveBisection(const std::vector<long> & offsets,
+		const std::vector<int> & neighbors, const int & numParts);
+
+/**
+ * This operation inverts a permutation.
+ * @param order the permutation, where order[k] is the original index of
+ * item k. An exception is thrown if it is not a permutation.
+ * @return the new index of each original item
+ */
+std::vector<int> inversePermutation(const std::vector<int> & order);
+
+/**
+ * This operation throws an exception if an order is not a permutation of
+ * the given number of items.
+ * @param order the order, where order[k] is the original index of item k
+ * @param size the number of items
+ */
+void checkOrder(const std::vector<long> & order, const long & size);
+
+/**
+ * This operation moves the blocks of width values of an array that belong
+ * to each item into a new order, so that block k of the result is block
+ * order[k] of the original. The order must be a permutation.
+ * @param values the array, which is overwritten
+ * @param order the order, where order[k] is the original index of item k
+ * @param width the number of values of each item
+ */
+template<typename T, typename I>
+void reorder(std::vector<T> & values, const std::vector<I> & order,
+		const int & width) {
+	std::vector<T> reordered(values.size());
+	for (long k = 0; k < (long) order.size(); k++) {
+		std::copy(values.begin() + order[k]*width,
+				values.begin() + (order[k] + 1)*width,
+				reordered.begin() + k*width);
+	}
+	values.swap(reordered);
+}
+
+/**
+ * This operation returns the bandwidth of a matrix, the largest distance of
+ * a nonzero from the diagonal, |i - j|.
+ * @param matrix the matrix
+ * @return the bandwidth
+ */
+template<typename T>
+int bandwidth(const CSRMatrix<T> & matrix) {
+	int width = 0;
+	for (int i = 0; i < matrix.numRows; i++) {
+		for (long k = matrix.rowOffsets[i]; k < matrix.rowOffsets[i+1]; k++) {
+			width = std::max(width, std::abs(i - matrix.columns[k]));
+		}
+	}
+	return width;
+}
+
+/**
+ * This operation symmetrically permutes the rows and columns of a matrix,
+ * B = PAP^T, so that row k of B is row order[k] of A.
+ * @param matrix the matrix A
+ * @param order the permutation, for example from reverseCuthillMcKee()
+ * @return the permuted matrix B
+ */
+template<typename T>
+CSRMatrix<T> permute(const CSRMatrix<T> & matrix,
+		const std::vector<int> & order) {
+	if ((int) order.size() != matrix.numRows) {
+		throw std::runtime_error("Permutation does not match the matrix.");
+	}
+	std::vector<int> newIndex = inversePermutation(order);
+	std::vector<std::pair<int,int>> entries;
+	entries.reserve(matrix.nonZeros());
+	for (int i = 0; i < matrix.numRows; i++) {
+		for (long k = matrix.rowOffsets[i]; k < matrix.rowOffsets[i+1]; k++) {
+			entries.emplace_back(newIndex[i],newIndex[matrix.columns[k]]);
+		}
+	}
+	CSRMatrix<T> permuted(matrix.numRows, entries);
+	for (int i = 0; i < matrix.numRows; i++) {
+		for (long k = matrix.rowOffsets[i]; k < matrix.rowOffsets[i+1]; k++) {
+			permuted.values[permuted.slot(newIndex[i],
+					newIndex[matrix.columns[k]])] = matrix.values[k];
+		}
+	}
+	return permuted;
+}
+
+/**
+ * This operation permutes a vector so that entry k of the result is entry
+ * order[k] of the original, which maps a right hand side into the
+ * numbering of a permuted matrix.
+ * @param vector the vector in the original numbering
+ * @param order the permutation
+ * @return the vector in the new numbering
+ */
+template<typename T>
+std::vector<T> permute(const std::vector<T> & vector,
+		const std::vector<int> & order) {
+	std::vector<T> permuted(order.size());
+	for (long k = 0; k < (long) order.size(); k++) {
+		permuted[k] = vector[order[k]];
+	}
+	return permuted;
+}
+
+/**
+ * This operation undoes permute() on a vector, which maps a solution back
+ * to the original numbering.
+ * @param vector the vector in the new numbering
+ * @param order the permutation
+ * @return the vector in the original numbering
+ */
+template<typename T>
+std::vector<T> unpermute(const std::vector<T> & vector,
+		const std::vector<int> & order) {
+	std::vector<T> original(order.size());
+	for (long k = 0; k < (long) order.size(); k++) {
+		original[order[k]] = vector[k];
+	}
+	return original;
+}
+
+} /* namespace fire */
+
+#endif /* SOLVERS_GRAPHORDERING_H_ */
@@ -34,9 +34,32 @@
 
 #include <State.h>
 #include <fire_cvode_functions.h>
+#include <fire_nvector.h>
+#include <Checkpoint.h>
+#include <SolverEvent.h>
+#include <vector>
+#include <memory>
+#include <string>
+#include <stdexcept>
+#include <math.h>
 
 namespace fire {
 
+/**
+ * The linear solvers that the IVPSolver can use to solve the linear systems
+ * in each Newton iteration.
+ *
+ * DENSE forms and factors the full Jacobian by finite differences, which is
+ * the best choice for small systems.
+ *
+ * GMRES uses CVODE's scaled, preconditioned GMRES solver, which only requires
+ * Jacobian-vector products from State.jv() and a Jacobi preconditioner built
+ * from State.jacobianDiagonal(). No matrix is ever formed, so this is the
+ * best choice for large systems where factoring the Jacobian is too
+ * expensive.
+ */
+enum class LinearSolverType {DENSE, GMRES};
+
 /**
  * This class numerically integrates a set of Ordinary Differential Equations
  * \f[
@@ -65,6 +88,37 @@ namespace fire {
  * solve can be configured by calling maxOutputSteps() with the desired number
  * of steps.
  *
+ * By default, the linear systems in each Newton iteration are solved with a
+ * dense direct solver. Large systems should use the matrix-free GMRES solver
+ * instead by calling
+ * @code
+ * solver.linearSolver(LinearSolverType::GMRES);
+ * @endcode
+ * which uses State.jv() and State.jacobianDiagonal(). The default
+ * implementations of those operations work for any state, but types with a
+ * known Jacobian structure should specialize them.
+ *
+ * Systems with at least threadedVectorSize() unknowns are integrated with
+ * Fire's threaded N_Vector (see fire_nvector.h), which executes the vector
+ * operations in CVODE on all of the threads of the shared ThreadPool. The
+ * solution vector aliases the array returned by State.u(), so no copies of
+ * the state are made. Smaller systems use CVODE's serial vectors, which are
+ * faster when there is too little work to share between threads.
+ *
+ * Long integrations can be checkpointed by calling checkpoints() with a file
+ * name. A Checkpoint is written in the background after every output step.
+ * It holds the State's t, unknowns and parameters together with CVODE's last
+ * step size, order and Nordsieck array. The integration is continued by
+ * calling restart() with the file name before solve(). CVODE cannot be loaded
+ * with an existing Nordsieck array, so it restarts at first order, but the
+ * saved array is used to pick a first step that satisfies the error test
+ * instead of starting over from a tiny step.
+ *
+ * Events, such as reaching a steady state, are added with addEvent() and
+ * located with CVODE's root finder. solve() returns a SolveResult that
+ * records the events and why the integration ended. Events do not count as
+ * output steps.
+ *
  * The original and present implementation is based on CVODE's example_v2.c
  * with user-defined Jacobians disabled and other adaptations for fitness.
  *
@@ -93,13 +147,116 @@ protected:
 	 * The maximum number of "output" steps the solver should take. An
 	 * output step is a step where output is produced by the solver at
 	 * a regular user-specified interval. The solver may take more
-	 * computational steps than output steps but will always report
-	 * for a number of output steps required to meet the final time or
-	 * the maximum number of output steps, whichever is less. The default
-	 * value is 10.
+	 * computational steps than output steps. The output steps are spaced
+	 * evenly between the initial and final times. The default value is 10.
 	 */
 	int maxNumOutputSteps = 10;
 
+	/**
+	 * The linear solver used in the Newton iteration. The default is DENSE.
+	 */
+	LinearSolverType linearSolverType = LinearSolverType::DENSE;
+
+	/**
+	 * The maximum dimension of the Krylov subspace for GMRES. If zero, the
+	 * CVODE default of 5 is used.
+	 */
+	int maxKrylovDimension = 0;
+
+	/**
+	 * The minimum system size for which the threaded vectors are used.
+	 */
+	long minThreadedSize = 100000;
+
+	/**
+	 * The name of the checkpoint file, which is empty if checkpoints are
+	 * disabled.
+	 */
+	std::string checkpointFile;
+
+	/**
+	 * The writer for the checkpoints. It is only created if checkpoints are
+	 * enabled.
+	 */
+	std::unique_ptr<CheckpointWriter> writer;
+
+	/**
+	 * The checkpoint from which the next solve should restart, if any.
+	 */
+	std::unique_ptr<Checkpoint> restartPoint;
+
+	/**
+	 * The events that are located during the solve.
+	 */
+	std::vector<SolverEvent> events;
+
+	/**
+	 * This operation creates a checkpoint from CVODE's current state. The
+	 * columns of the Nordsieck array are h^j/j! times the j-th derivative of
+	 * the solution at t, where h is the last step size, for j = 0..q.
+	 */
+	Checkpoint checkpoint(State<T> & state, void * cvode_mem, N_Vector u) {
+		Checkpoint cp;
+		int size = state.size(), order = 0;
+		realtype hLast = 0.0;
+		cp.solver = "IVPSolver";
+		cp.t = currentT;
+		realtype * udata = N_VGetArrayPointer(u);
+		cp.u.assign(udata, udata + size);
+		cp.parameters = state.parameters();
+		CVodeGetLastStep(cvode_mem, &hLast);
+		CVodeGetLastOrder(cvode_mem, &order);
+		cp.stepSize = hLast;
+		cp.order = order;
+		N_Vector dky = N_VClone(u);
+		double factor = 1.0;
+		for (int j = 0; j <= order; j++) {
+			if (CVodeGetDky(cvode_mem, currentT, j, dky) < 0) break;
+			factor *= (j > 0) ? hLast/j : 1.0;
+			realtype * dkyData = N_VGetArrayPointer(dky);
+			cp.history.emplace_back(size);
+			for (int i = 0; i < size; i++) {
+				cp.history[j][i] = factor*dkyData[i];
+			}
+		}
+		N_VDestroy(dky);
+		return cp;
+	}
+
+	/**
+	 * This operation computes the first step after a restart. CVODE restarts
+	 * at first order, where the local error is approximately the second
+	 * column of the Nordsieck array scaled by (h0/h)^2, so the step is chosen
+	 * such that this error is half of the tolerance.
+	 */
+	double restartStepSize(const Checkpoint & cp, const double & reltol,
+			const double & abstol) const {
+		double h = cp.stepSize;
+		if (cp.history.size() < 3 || h == 0.0) return h;
+		double sum = 0.0;
+		int size = cp.u.size();
+		for (int i = 0; i < size; i++) {
+			double err = cp.history[2][i]/(reltol*fabs(cp.u[i]) + abstol);
+			sum += err*err;
+		}
+		double norm = sqrt(sum/size);
+		return (norm > 0.5) ? h*sqrt(0.5/norm) : h;
+	}
+
+	/**
+	 * This operation completes the result of a solve. Frozen states jump to
+	 * the final time without changing their unknowns.
+	 */
+	SolveResult finish(State<T> & state, SolveResult & result) {
+		if (result.terminatedEarly
+				&& result.events.back().action == EventAction::FREEZE) {
+			currentT = finalT;
+			state.t(currentT);
+		}
+		result.t = currentT;
+		return result;
+	}
+
 public:
 
 	/**
@@ -126,6 +283,68 @@ public:
 	 */
 	void maxOutputSteps(const int & steps) { maxNumOutputSteps = steps;};
 
+	/**
+	 * This operation sets the linear solver used in the Newton iteration.
+	 * @param the type of the linear solver
+	 */
+	void linearSolver(const LinearSolverType & type) { linearSolverType = type;};
+
+	/**
+	 * This operation sets the maximum dimension of the Krylov subspace used by
+	 * the GMRES linear solver. It is ignored by the dense linear solver.
+	 * @param the maximum dimension, or zero for the CVODE default
+	 */
+	void krylovDimension(const int & dim) { maxKrylovDimension = dim;};
+
+	/**
+	 * This operation sets the minimum system size for which Fire's threaded
+	 * N_Vector is used instead of CVODE's serial vector.
+	 * @param the minimum number of unknowns. The default is 100000.
+	 */
+	void threadedVectorSize(const long & size) { minThreadedSize = size;};
+
+	/**
+	 * This operation enables checkpoints, which are written asynchronously to
+	 * a file after every output step. Each checkpoint replaces the previous
+	 * one.
+	 * @param the name of the checkpoint file. Checkpoints are disabled if it
+	 * is empty.
+	 */
+	void checkpoints(const std::string & fileName) {
+		checkpointFile = fileName;
+		if (!fileName.empty() && !writer) writer.reset(new CheckpointWriter());
+	}
+
+	/**
+	 * This operation waits until all of the checkpoints have been written to
+	 * disk. It rethrows any errors from writing them.
+	 */
+	void waitForCheckpoints() {
+		if (writer) writer->wait();
+	}
+
+	/**
+	 * This operation directs the next call to solve() to continue from a
+	 * checkpoint instead of starting from the initial conditions in the State.
+	 * The State's unknowns, t and parameters and the solver's initial and
+	 * current t are overwritten from the checkpoint when solve() is called.
+	 * @param the checkpoint
+	 */
+	void restart(const Checkpoint & checkpoint) {
+		restartPoint.reset(new Checkpoint(checkpoint));
+	}
+
+	/**
+	 * This operation directs the next call to solve() to continue from a
+	 * checkpoint file.
+	 * @param the name of the checkpoint file
+	 */
+	void restart(const std::string & fileName) {
+		Checkpoint checkpoint;
+		checkpoint.read(fileName);
+		restart(checkpoint);
+	}
+
 	/**
 	 * This operation returns the current value of t in the system.
 	 * @param the current value of t in the solver
@@ -151,11 +370,42 @@ public:
 	 */
 	int maxOutputSteps() { return maxNumOutputSteps;};
 
+	/**
+	 * This operation returns the linear solver used in the Newton iteration.
+	 * @return the type of the linear solver
+	 */
+	LinearSolverType linearSolver() const { return linearSolverType;};
+
+	/**
+	 * This operation returns the maximum dimension of the Krylov subspace.
+	 * @return the maximum dimension, or zero for the CVODE default
+	 */
+	int krylovDimension() const { return maxKrylovDimension;};
+
+	/**
+	 * This operation returns the minimum system size for which Fire's
+	 * threaded N_Vector is used.
+	 * @return the minimum number of unknowns
+	 */
+	long threadedVectorSize() const { return minThreadedSize;};
+
+	/**
+	 * This operation adds an event that will be located during the solve.
+	 * @param event the event
+	 */
+	void addEvent(const SolverEvent & event) { events.push_back(event);};
+
+	/**
+	 * This operation removes all of the events.
+	 */
+	void clearEvents() { events.clear();};
+
 	/**
 	 * This operation solves the system of equations specified in the State
 	 * @param the State describing the system to be solved.
+	 * @return the result of the solve, including any events that triggered
 	 */
-	void solve(State<T> & state) {
+	SolveResult solve(State<T> & state) {
 
 		// Begin CVODE code. Adapted from their examples.
 		realtype dx, dy, reltol, abstol, tout, umax;
@@ -168,11 +418,46 @@ public:
 		cvode_mem = NULL;
 		int size = state.size();
 
-		/* Create a serial vector */
-		u = N_VNew_Serial(size);
+		// Restore the state from the checkpoint if restarting
+		std::unique_ptr<Checkpoint> cp = std::move(restartPoint);
+		if (cp) {
+			if (cp->solver != "IVPSolver" || (int) cp->u.size() != size) {
+				throw std::runtime_error("Invalid checkpoint for IVPSolver.");
+			}
+			state.parameters(cp->parameters);
+			state.t(cp->t);
+			state.u(cp->u.data());
+			initialT = cp->t;
+			currentT = cp->t;
+		}
+
+		// Check the events at the initial solution. CVODE only reports
+		// crossings, so events that are already satisfied are handled here.
+		SolveResult result;
+		bool terminated = false;
+		for (auto & event : events) {
+			double g = event.function(initialT, state.u(),
+					state.dudt(initialT), size);
+			if (event.satisfiedAtStart(g)
+					&& (terminated = result.record(event, initialT))) break;
+		}
+		if (terminated) {
+			currentT = initialT;
+			state.t(currentT);
+			return finish(state, result);
+		}
+
+		/* Create a threaded vector that aliases the state for large systems
+		 * and a serial vector otherwise. */
+		bool threaded = (size >= minThreadedSize);
+		if (threaded) {
+			u = fire::nvector::makeVector(size, state.u());
+		} else {
+			u = N_VNew_Serial(size);
+		}
 		/* Allocate the U vector */
-		if (fire::cvode::check_flag((void*) u, "N_VNew_Serial", 0))
-			return;
+		if (fire::cvode::check_flag((void*) u, "N_VNew", 0))
+			return result;
 
 		reltol = ZERO; /* Set the tolerances */
 		abstol = ATOL;
@@ -184,30 +469,69 @@ public:
 		 * Backward Differentiation Formula and the use of a Newton iteration */
 		cvode_mem = CVodeCreate(CV_BDF, CV_NEWTON);
 		if (fire::cvode::check_flag((void *) cvode_mem, "CVodeCreate", 0))
-			return;
+			return result;
 
 		/* Call CVodeInit to initialize the integrator memory and specify the
 		 * user's right hand side function in u'=f(t,u), the inital time T0, and
 		 * the initial dependent variable vector u. */
 		flag = CVodeInit(cvode_mem, fire::cvode::f<T>, initialT, u);
 		if (fire::cvode::check_flag(&flag, "CVodeInit", 1))
-			return;
+			return result;
 
 		/* Call CVodeSStolerances to specify the scalar relative tolerance
 		 * and scalar absolute tolerance */
 		flag = CVodeSStolerances(cvode_mem, reltol, abstol);
 		if (fire::cvode::check_flag(&flag, "CVodeSStolerances", 1))
-			return;
+			return result;
+
+		/* Start from the step size in the checkpoint if restarting */
+		if (cp) {
+			flag = CVodeSetInitStep(cvode_mem,
+					restartStepSize(*cp, reltol, abstol));
+			if (fire::cvode::check_flag(&flag, "CVodeSetInitStep", 1))
+				return result;
+		}
 
 		/* Set the pointer to user-defined data */
-		flag = CVodeSetUserData(cvode_mem, &state);
+		fire::cvode::SolverData<T> data(state);
+		flag = CVodeSetUserData(cvode_mem, &data);
 		if (fire::cvode::check_flag(&flag, "CVodeSetUserData", 1))
-			return;
+			return result;
+
+		/* Locate the events with CVODE's root finder */
+		std::vector<int> rootDirections, rootsFound(events.size());
+		if (!events.empty()) {
+			data.events = &events;
+			flag = CVodeRootInit(cvode_mem, events.size(), fire::cvode::g<T>);
+			if (fire::cvode::check_flag(&flag, "CVodeRootInit", 1))
+				return result;
+			for (auto & event : events) rootDirections.push_back(event.direction);
+			flag = CVodeSetRootDirection(cvode_mem, rootDirections.data());
+			if (fire::cvode::check_flag(&flag, "CVodeSetRootDirection", 1))
+				return result;
+		}
 
-		/* Call CVBand to specify the CVBAND band linear solver */
-		flag = CVDense(cvode_mem, size);
-		if (fire::cvode::check_flag(&flag, "CVDense", 1))
-			return;
+		bool iterative = (linearSolverType == LinearSolverType::GMRES);
+		if (iterative) {
+			/* Call CVSpgmr to specify the left-preconditioned GMRES solver */
+			flag = CVSpgmr(cvode_mem, PREC_LEFT, maxKrylovDimension);
+			if (fire::cvode::check_flag(&flag, "CVSpgmr", 1))
+				return result;
+			/* Set the Jacobian-vector product so no matrix is formed */
+			flag = CVSpilsSetJacTimesVecFn(cvode_mem, fire::cvode::jtv<T>);
+			if (fire::cvode::check_flag(&flag, "CVSpilsSetJacTimesVecFn", 1))
+				return result;
+			/* Set the Jacobi preconditioner */
+			flag = CVSpilsSetPreconditioner(cvode_mem, fire::cvode::precSetup<T>,
+					fire::cvode::precSolve<T>);
+			if (fire::cvode::check_flag(&flag, "CVSpilsSetPreconditioner", 1))
+				return result;
+		} else {
+			/* Call CVDense to specify the CVDENSE dense linear solver */
+			flag = CVDense(cvode_mem, size);
+			if (fire::cvode::check_flag(&flag, "CVDense", 1))
+				return result;
+		}
 
 		/* Set the user-supplied Jacobian routine Jac */
 //        flag = CVDlsSetBandJacFn(cvode_mem, Jac);
@@ -216,27 +540,53 @@ public:
 		/* In loop over output points: call CVode, print results, test for errors */
 		umax = N_VMaxNorm(u);
 		fire::cvode::PrintHeader(reltol, abstol, umax, initialT);
-		for (iout = 1, tout = DTOUT; iout <= maxNumOutputSteps && currentT < finalT; iout++, tout += DTOUT) {
-			flag = CVode(cvode_mem, tout, u, &currentT, CV_NORMAL);
+		// Output steps are spaced evenly between the initial and final times
+		// so that the solve always ends at the final time, even when it is
+		// used to integrate over a short interval in the middle of a larger
+		// problem.
+		realtype dtOut = (finalT - initialT)/maxNumOutputSteps;
+		iout = 1;
+		tout = initialT + dtOut;
+		while (iout <= maxNumOutputSteps && currentT < finalT) {
+			flag = CVode(cvode_mem, (iout == maxNumOutputSteps) ? finalT : tout,
+					u, &currentT, CV_NORMAL);
 			if (fire::cvode::check_flag(&flag, "CVode", 1))
 				break;
 			umax = N_VMaxNorm(u);
 			flag = CVodeGetNumSteps(cvode_mem, &nst);
 			fire::cvode::check_flag(&flag, "CVodeGetNumSteps", 1);
 			// Update the state
-			realtype * udata = NV_DATA_S(u);
+			realtype * udata = N_VGetArrayPointer(u);
 			state.t(currentT);
 			state.u(udata);
 			// Replace! - Notify observers that the state has changed
 			fire::cvode::PrintOutput(currentT, umax, nst);
+			// Record the events that triggered. The output step is repeated.
+			if (flag == CV_ROOT_RETURN) {
+				flag = CVodeGetRootInfo(cvode_mem, rootsFound.data());
+				fire::cvode::check_flag(&flag, "CVodeGetRootInfo", 1);
+				for (int i = 0; i < (int) events.size() && !terminated; i++) {
+					if (rootsFound[i] != 0) {
+						terminated = result.record(events[i], currentT);
+					}
+				}
+				if (terminated) break;
+				continue;
+			}
+			// Write the checkpoint in the background
+			if (!checkpointFile.empty() && currentT < finalT) {
+				writer->write(checkpoint(state, cvode_mem, u), checkpointFile);
+			}
+			iout++;
+			tout += dtOut;
 		}
 
-		fire::cvode::PrintFinalStats(cvode_mem); /* Print some final statistics   */
+		fire::cvode::PrintFinalStats(cvode_mem, iterative); /* Print some final statistics   */
 
-		N_VDestroy_Serial(u); /* Free the u vector */
+		N_VDestroy(u); /* Free the u vector */
 		CVodeFree(&cvode_mem); /* Free the integrator memory */
 
-		return;
+		return finish(state, result);
 	}
 
 };
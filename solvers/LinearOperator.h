@@ -0,0 +1,118 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#ifndef SOLVERS_LINEAROPERATOR_H_
+#define SOLVERS_LINEAROPERATOR_H_
+
+#include <vector>
+#include <CSRMatrix.h>
+#include <ThreadPool.h>
+
+namespace fire {
+
+/**
+ * This is the interface for linear operators that can be applied to vectors
+ * without being stored as a matrix, such as the matrix-free stiffness
+ * operators of finite element meshes. The PCGSolver only needs the product
+ * of the system matrix and a vector, so it accepts any ILinearOperator in
+ * place of a CSRMatrix.
+ */
+class ILinearOperator {
+
+public:
+
+	/**
+	 * Destructor
+	 */
+	virtual ~ILinearOperator() {};
+
+	/**
+	 * This operation returns the number of rows (and columns) of the
+	 * operator.
+	 * @return the size
+	 */
+	virtual int size() const = 0;
+
+	/**
+	 * This operation applies the operator, y = Ax.
+	 * @param x the vector, which must have size() elements
+	 * @param y the product, which is resized if required
+	 */
+	virtual void multiply(const std::vector<double> & x,
+			std::vector<double> & y) const = 0;
+};
+
+/**
+ * This is an ILinearOperator for an assembled CSRMatrix, which is
+ * multiplied in parallel.
+ */
+class CSRMatrixOperator : public ILinearOperator {
+
+protected:
+
+	/**
+	 * The matrix.
+	 */
+	const CSRMatrix<double> & matrix;
+
+	/**
+	 * The threads used for the product.
+	 */
+	ThreadPool & pool;
+
+public:
+
+	/**
+	 * Constructor
+	 * @param csrMatrix the matrix, which must outlive this object
+	 * @param threadPool the threads used for the product
+	 */
+	CSRMatrixOperator(const CSRMatrix<double> & csrMatrix,
+			ThreadPool & threadPool = ThreadPool::shared()) :
+			matrix(csrMatrix), pool(threadPool) {};
+
+	/**
+	 * See ILinearOperator::size().
+	 */
+	virtual int size() const { return matrix.size();};
+
+	/**
+	 * See ILinearOperator::multiply().
+	 */
+	virtual void multiply(const std::vector<double> & x,
+			std::vector<double> & y) const {
+		matrix.multiply(x, y, pool);
+	};
+};
+
+} /* namespace fire */
+
+#endif /* SOLVERS_LINEAROPERATOR_H_ */
@@ -0,0 +1,128 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+
+// See the header file for API documentation
+
+#include <PCGSolver.h>
+#include <stdexcept>
+#include <functional>
+#include <math.h>
+
+using namespace std;
+
+namespace fire {
+
+double PCGSolver::dot(const vector<double> & a, const vector<double> & b) {
+	return pool.parallelReduce<double>(0, a.size(), 0.0,
+			[&](const long & begin, const long & end) {
+		double sum = 0.0;
+		for (long i = begin; i < end; i++) sum += a[i]*b[i];
+		return sum;
+	}, std::plus<double>());
+}
+
+PCGResult PCGSolver::solve(const ILinearOperator & matrix,
+		const vector<double> & b, vector<double> & x,
+		const IPreconditioner * preconditioner) {
+
+	int n = matrix.size();
+	if ((int) b.size() != n) {
+		throw runtime_error("PCGSolver right hand side has the wrong size.");
+	}
+	x.resize(n, 0.0);
+	r.resize(n);
+	z.resize(n);
+	p.resize(n);
+	q.resize(n);
+
+	// r = b - Ax
+	PCGResult result;
+	matrix.multiply(x, q);
+	pool.parallelFor(0, n, [&](const long & begin, const long & end) {
+		for (long i = begin; i < end; i++) r[i] = b[i] - q[i];
+	});
+	double bNorm = sqrt(dot(b, b)), rNorm = sqrt(dot(r, r));
+	double target = relativeTolerance*bNorm;
+	result.history.push_back(rNorm);
+	result.residualNorm = rNorm;
+	if (rNorm <= target || bNorm == 0.0) {
+		// b = 0 has the solution x = 0
+		if (bNorm == 0.0) std::fill(x.begin(), x.end(), 0.0);
+		result.residualNorm = (bNorm == 0.0) ? 0.0 : rNorm;
+		result.converged = true;
+		return result;
+	}
+
+	// z = M^{-1}r, p = z
+	if (preconditioner) preconditioner->apply(r, z);
+	else z = r;
+	p = z;
+	double rz = dot(r, z);
+
+	while (result.iterations < maxNumIterations) {
+		// q = Ap, alpha = (r,z)/(p,Ap)
+		matrix.multiply(p, q);
+		double pq = dot(p, q);
+		if (pq <= 0.0) {
+			throw runtime_error("PCGSolver matrix is not positive definite.");
+		}
+		double alpha = rz/pq;
+		// x += alpha p, r -= alpha q
+		pool.parallelFor(0, n, [&](const long & begin, const long & end) {
+			for (long i = begin; i < end; i++) {
+				x[i] += alpha*p[i];
+				r[i] -= alpha*q[i];
+			}
+		});
+		result.iterations++;
+		rNorm = sqrt(dot(r, r));
+		result.history.push_back(rNorm);
+		result.residualNorm = rNorm;
+		if (rNorm <= target) {
+			result.converged = true;
+			break;
+		}
+		// z = M^{-1}r, beta = (r,z)_new/(r,z)_old, p = z + beta p
+		if (preconditioner) preconditioner->apply(r, z);
+		else z = r;
+		double rzNew = dot(r, z);
+		double beta = rzNew/rz;
+		rz = rzNew;
+		pool.parallelFor(0, n, [&](const long & begin, const long & end) {
+			for (long i = begin; i < end; i++) p[i] = z[i] + beta*p[i];
+		});
+	}
+
+	return result;
+}
+
+} /* namespace fire */
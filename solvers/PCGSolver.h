@@ -0,0 +1,229 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#ifndef SOLVERS_PCGSOLVER_H_
+#define SOLVERS_PCGSOLVER_H_
+
+#include <vector>
+#include <CSRMatrix.h>
+#include <Preconditioner.h>
+#include <LinearOperator.h>
+#include <ThreadPool.h>
+
+namespace fire {
+
+/**
+ * This structure describes the outcome of a PCGSolver solve.
+ */
+struct PCGResult {
+
+	/**
+	 * True if the residual met the tolerance.
+	 */
+	bool converged = false;
+
+	/**
+	 * The number of iterations that were taken.
+	 */
+	int iterations = 0;
+
+	/**
+	 * The 2-norm of the final residual, b - Ax.
+	 */
+	double residualNorm = 0.0;
+
+	/**
+	 * The 2-norm of the residual before the first iteration and after each
+	 * iteration, so it has iterations + 1 entries.
+	 */
+	std::vector<double> history;
+};
+
+/**
+ * This class solves sparse, symmetric positive definite linear systems
+ * \f[
+ * A\vec{x} = \vec{b}
+ * \f]
+ * with the Preconditioned Conjugate Gradient (PCG) method. It is intended for
+ * the assembled stiffness matrices of heat conduction and similar problems
+ * (see FEMAssembler), which are far too large for dense solvers.
+ *
+ * The matrix-vector products, dot products and vector updates are executed on
+ * a ThreadPool, so each iteration streams through the matrix and vectors on
+ * all threads. Any IPreconditioner can be used:
+ * @code
+ * PCGSolver solver;
+ * solver.tolerance(1.0e-10);
+ * IncompleteCholeskyPreconditioner preconditioner(matrix);
+ * PCGResult result = solver.solve(matrix, b, x, preconditioner);
+ * @endcode
+ * The matrix can also be any ILinearOperator, such as a matrix-free finite
+ * element operator, since only its products with vectors are needed.
+ *
+ * The value of x on entry is used as the initial guess. The iteration stops
+ * when the 2-norm of the residual is less than the tolerance times the 2-norm
+ * of b.
+ */
+class PCGSolver {
+
+protected:
+
+	/**
+	 * The relative tolerance on the residual.
+	 */
+	double relativeTolerance = 1.0e-8;
+
+	/**
+	 * The maximum number of iterations.
+	 */
+	int maxNumIterations = 10000;
+
+	/**
+	 * The threads used for the vector operations.
+	 */
+	ThreadPool & pool;
+
+	/**
+	 * The residual, preconditioned residual, search direction and product of
+	 * the matrix and the search direction, which are kept between solves.
+	 */
+	std::vector<double> r, z, p, q;
+
+	/**
+	 * This operation computes the dot product of two vectors in parallel.
+	 */
+	double dot(const std::vector<double> & a, const std::vector<double> & b);
+
+	/**
+	 * This is the implementation of solve(). The preconditioner is not used
+	 * if it is null.
+	 */
+	PCGResult solve(const ILinearOperator & matrix,
+			const std::vector<double> & b, std::vector<double> & x,
+			const IPreconditioner * preconditioner);
+
+public:
+
+	/**
+	 * Constructor
+	 * @param threadPool the threads used by the solver, which is the shared
+	 * pool by default.
+	 */
+	PCGSolver(ThreadPool & threadPool = ThreadPool::shared()) :
+		pool(threadPool) {};
+
+	/**
+	 * This operation sets the relative tolerance on the residual.
+	 * @param tol the tolerance
+	 */
+	void tolerance(const double & tol) { relativeTolerance = tol;};
+
+	/**
+	 * This operation returns the relative tolerance on the residual.
+	 * @return the tolerance
+	 */
+	double tolerance() const { return relativeTolerance;};
+
+	/**
+	 * This operation sets the maximum number of iterations.
+	 * @param maxIterations the maximum number of iterations
+	 */
+	void maxIterations(const int & maxIterations) {
+		maxNumIterations = maxIterations;
+	};
+
+	/**
+	 * This operation returns the maximum number of iterations.
+	 * @return the maximum number of iterations
+	 */
+	int maxIterations() const { return maxNumIterations;};
+
+	/**
+	 * This operation solves the system with a preconditioner.
+	 * @param matrix the symmetric positive definite matrix A
+	 * @param b the right hand side
+	 * @param x the initial guess on entry and the solution on exit. It is
+	 * resized to the size of the matrix, with zeros, if required.
+	 * @param preconditioner the preconditioner, which must have been built
+	 * from the matrix
+	 * @return the result of the solve
+	 */
+	PCGResult solve(const CSRMatrix<double> & matrix,
+			const std::vector<double> & b, std::vector<double> & x,
+			const IPreconditioner & preconditioner) {
+		return solve(CSRMatrixOperator(matrix, pool), b, x, &preconditioner);
+	};
+
+	/**
+	 * This operation solves the system without a preconditioner.
+	 * @param matrix the symmetric positive definite matrix A
+	 * @param b the right hand side
+	 * @param x the initial guess on entry and the solution on exit
+	 * @return the result of the solve
+	 */
+	PCGResult solve(const CSRMatrix<double> & matrix,
+			const std::vector<double> & b, std::vector<double> & x) {
+		return solve(CSRMatrixOperator(matrix, pool), b, x, nullptr);
+	};
+
+	/**
+	 * This operation solves a system with a linear operator and a
+	 * preconditioner.
+	 * @param matrix the symmetric positive definite operator A
+	 * @param b the right hand side
+	 * @param x the initial guess on entry and the solution on exit
+	 * @param preconditioner the preconditioner
+	 * @return the result of the solve
+	 */
+	PCGResult solve(const ILinearOperator & matrix,
+			const std::vector<double> & b, std::vector<double> & x,
+			const IPreconditioner & preconditioner) {
+		return solve(matrix, b, x, &preconditioner);
+	};
+
+	/**
+	 * This operation solves a system with a linear operator and no
+	 * preconditioner.
+	 * @param matrix the symmetric positive definite operator A
+	 * @param b the right hand side
+	 * @param x the initial guess on entry and the solution on exit
+	 * @return the result of the solve
+	 */
+	PCGResult solve(const ILinearOperator & matrix,
+			const std::vector<double> & b, std::vector<double> & x) {
+		return solve(matrix, b, x, nullptr);
+	};
+
+};
+
+} /* namespace fire */
+
+#endif /* SOLVERS_PCGSOLVER_H_ */
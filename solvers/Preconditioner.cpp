@@ -0,0 +1,350 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+
+// See the header file for API documentation
+
+#include <Preconditioner.h>
+#include <GraphOrdering.h>
+#include <algorithm>
+#include <stdexcept>
+#include <math.h>
+
+using namespace std;
+
+namespace fire {
+
+const long AdditiveSchwarzPreconditioner::subdomainGrain;
+
+/**
+ * This operation finds the slot of the diagonal element in each row and
+ * checks that it is nonzero.
+ */
+static void findDiagonal(const CSRMatrix<double> & matrix,
+		vector<long> & slots) {
+	slots.resize(matrix.size());
+	for (int i = 0; i < matrix.size(); i++) {
+		slots[i] = matrix.slot(i,i);
+		if (slots[i] < 0 || matrix.values[slots[i]] == 0.0) {
+			throw runtime_error("Preconditioner requires a nonzero diagonal.");
+		}
+	}
+}
+
+JacobiPreconditioner::JacobiPreconditioner(const CSRMatrix<double> & matrix,
+		ThreadPool & threadPool) : pool(threadPool) {
+	update(matrix);
+}
+
+JacobiPreconditioner::JacobiPreconditioner(const vector<double> & diagonal,
+		ThreadPool & threadPool) : inverseDiagonal(diagonal.size()),
+		pool(threadPool) {
+	for (long i = 0; i < (long) diagonal.size(); i++) {
+		if (diagonal[i] == 0.0) {
+			throw runtime_error("Preconditioner requires a nonzero diagonal.");
+		}
+		inverseDiagonal[i] = 1.0/diagonal[i];
+	}
+}
+
+void JacobiPreconditioner::update(const CSRMatrix<double> & matrix) {
+	vector<long> slots;
+	findDiagonal(matrix, slots);
+	inverseDiagonal.resize(matrix.size());
+	for (int i = 0; i < matrix.size(); i++) {
+		inverseDiagonal[i] = 1.0/matrix.values[slots[i]];
+	}
+}
+
+void JacobiPreconditioner::apply(const vector<double> & r,
+		vector<double> & z) const {
+	pool.parallelFor(0, r.size(), [&](const long & begin, const long & end) {
+		for (long i = begin; i < end; i++) z[i] = inverseDiagonal[i]*r[i];
+	});
+}
+
+SSORPreconditioner::SSORPreconditioner(const CSRMatrix<double> & matrix,
+		const double & relaxation) : omega(relaxation) {
+	if (omega <= 0.0 || omega >= 2.0) {
+		throw runtime_error("SSOR relaxation factor must be in (0,2).");
+	}
+	update(matrix);
+}
+
+void SSORPreconditioner::update(const CSRMatrix<double> & newMatrix) {
+	matrix = &newMatrix;
+	findDiagonal(newMatrix, diagonalSlots);
+}
+
+void SSORPreconditioner::apply(const vector<double> & r,
+		vector<double> & z) const {
+	auto & offsets = matrix->rowOffsets;
+	auto & columns = matrix->columns;
+	auto & values = matrix->values;
+	int n = matrix->size();
+	// Forward sweep, (D/w + L)y = r(2-w)/w
+	double scale = (2.0 - omega)/omega;
+	for (int i = 0; i < n; i++) {
+		double sum = scale*r[i];
+		for (long k = offsets[i]; k < diagonalSlots[i]; k++) {
+			sum -= values[k]*z[columns[k]];
+		}
+		z[i] = sum*omega/values[diagonalSlots[i]];
+	}
+	// Scale by D/w and sweep backwards, (D/w + U)z = (D/w)y
+	for (int i = n - 1; i >= 0; i--) {
+		double diagonal = values[diagonalSlots[i]]/omega;
+		double sum = diagonal*z[i];
+		for (long k = diagonalSlots[i] + 1; k < offsets[i+1]; k++) {
+			sum -= values[k]*z[columns[k]];
+		}
+		z[i] = sum/diagonal;
+	}
+}
+
+IncompleteCholeskyPreconditioner::IncompleteCholeskyPreconditioner(
+		const CSRMatrix<double> & matrix) {
+	// The factor has the pattern of the lower triangle of the matrix
+	vector<pair<int,int>> entries;
+	for (int i = 0; i < matrix.size(); i++) {
+		for (long k = matrix.rowOffsets[i]; k < matrix.rowOffsets[i+1]; k++) {
+			if (matrix.columns[k] <= i) {
+				entries.emplace_back(i,matrix.columns[k]);
+				sourceSlots.push_back(k);
+			}
+		}
+	}
+	factor = CSRMatrix<double>(matrix.size(), entries);
+	update(matrix);
+}
+
+void IncompleteCholeskyPreconditioner::update(const CSRMatrix<double> & matrix) {
+	auto & offsets = factor.rowOffsets;
+	auto & columns = factor.columns;
+	auto & values = factor.values;
+	for (long k = 0; k < factor.nonZeros(); k++) {
+		values[k] = matrix.values[sourceSlots[k]];
+	}
+	// Row-oriented factorization. Row i of L is computed from the rows of
+	// the earlier columns in its pattern, using sparse dot products of the
+	// sorted rows restricted to columns less than j.
+	for (int i = 0; i < factor.size(); i++) {
+		long last = offsets[i+1] - 1;
+		if (last < offsets[i] || columns[last] != i) {
+			throw runtime_error("Incomplete Cholesky requires a diagonal.");
+		}
+		for (long k = offsets[i]; k <= last; k++) {
+			int j = columns[k];
+			double sum = values[k];
+			long a = offsets[i], b = offsets[j];
+			while (a < k && columns[b] < j) {
+				if (columns[a] == columns[b]) {
+					sum -= values[a++]*values[b++];
+				} else if (columns[a] < columns[b]) {
+					a++;
+				} else {
+					b++;
+				}
+			}
+			if (j < i) {
+				values[k] = sum/values[offsets[j+1] - 1];
+			} else if (sum > 0.0) {
+				values[k] = sqrt(sum);
+			} else {
+				throw runtime_error("Incomplete Cholesky factorization broke down.");
+			}
+		}
+	}
+}
+
+void IncompleteCholeskyPreconditioner::apply(const vector<double> & r,
+		vector<double> & z) const {
+	auto & offsets = factor.rowOffsets;
+	auto & columns = factor.columns;
+	auto & values = factor.values;
+	int n = factor.size();
+	// Solve Ly = r
+	for (int i = 0; i < n; i++) {
+		double sum = r[i];
+		long last = offsets[i+1] - 1;
+		for (long k = offsets[i]; k < last; k++) sum -= values[k]*z[columns[k]];
+		z[i] = sum/values[last];
+	}
+	// Solve L^{T}z = y by columns
+	for (int i = n - 1; i >= 0; i--) {
+		long last = offsets[i+1] - 1;
+		z[i] /= values[last];
+		for (long k = offsets[i]; k < last; k++) z[columns[k]] -= values[k]*z[i];
+	}
+}
+
+AdditiveSchwarzPreconditioner::AdditiveSchwarzPreconditioner(
+		const CSRMatrix<double> & matrix, const vector<int> & parts,
+		const int & overlap, ThreadPool & threadPool) : pool(threadPool) {
+
+	int n = matrix.size();
+	if ((int) parts.size() != n) {
+		throw runtime_error("Partition does not match the matrix.");
+	}
+	int numParts = 0;
+	for (int part : parts) {
+		if (part < 0) throw runtime_error("Subdomains must not be negative.");
+		numParts = max(numParts, part + 1);
+	}
+
+	// Gather the rows of each part and add the layers of neighbors
+	subdomainRows.assign(numParts, vector<int>());
+	for (int i = 0; i < n; i++) subdomainRows[parts[i]].push_back(i);
+	vector<int> marks(n, -1);
+	for (int s = 0; s < numParts; s++) {
+		auto & rows = subdomainRows[s];
+		for (int row : rows) marks[row] = s;
+		long layerBegin = 0;
+		for (int layer = 0; layer < overlap; layer++) {
+			long layerEnd = rows.size();
+			for (long k = layerBegin; k < layerEnd; k++) {
+				int row = rows[k];
+				for (long m = matrix.rowOffsets[row];
+						m < matrix.rowOffsets[row+1]; m++) {
+					int column = matrix.columns[m];
+					if (marks[column] != s) {
+						marks[column] = s;
+						rows.push_back(column);
+					}
+				}
+			}
+			layerBegin = layerEnd;
+		}
+		sort(rows.begin(), rows.end());
+	}
+
+	// Build the local matrices in Reverse Cuthill-McKee order so that their
+	// skyline factors are small
+	localMatrices.resize(numParts);
+	sourceSlots.resize(numParts);
+	vector<int> localIds(n, -1);
+	for (int s = 0; s < numParts; s++) {
+		auto & rows = subdomainRows[s];
+		int size = rows.size();
+		for (int k = 0; k < size; k++) localIds[rows[k]] = k;
+		vector<pair<int,int>> entries;
+		for (int k = 0; k < size; k++) {
+			int row = rows[k];
+			for (long m = matrix.rowOffsets[row]; m < matrix.rowOffsets[row+1];
+					m++) {
+				int local = localIds[matrix.columns[m]];
+				if (local >= 0) entries.emplace_back(k, local);
+			}
+		}
+		vector<int> order = reverseCuthillMcKee(CSRMatrix<double>(size,
+				entries));
+		vector<int> newIds = inversePermutation(order);
+		for (auto & entry : entries) {
+			entry.first = newIds[entry.first];
+			entry.second = newIds[entry.second];
+		}
+		CSRMatrix<double> local(size, entries);
+		auto & slots = sourceSlots[s];
+		slots.resize(local.nonZeros());
+		for (int k = 0; k < size; k++) {
+			int row = rows[order[k]];
+			for (long m = local.rowOffsets[k]; m < local.rowOffsets[k+1]; m++) {
+				slots[m] = matrix.slot(row, rows[order[local.columns[m]]]);
+			}
+		}
+		for (int k = 0; k < size; k++) localIds[rows[k]] = -1;
+		vector<int> orderedRows(size);
+		for (int k = 0; k < size; k++) orderedRows[k] = rows[order[k]];
+		rows.swap(orderedRows);
+		localMatrices[s] = std::move(local);
+	}
+
+	// Find the copies of each row
+	copyOffsets.assign(n + 1, 0);
+	for (auto & rows : subdomainRows) {
+		for (int row : rows) copyOffsets[row + 1]++;
+	}
+	for (int i = 0; i < n; i++) copyOffsets[i+1] += copyOffsets[i];
+	copies.resize(copyOffsets[n]);
+	vector<long> next(copyOffsets.begin(), copyOffsets.end() - 1);
+	for (int s = 0; s < numParts; s++) {
+		for (int k = 0; k < (int) subdomainRows[s].size(); k++) {
+			copies[next[subdomainRows[s][k]]++] = make_pair(s, k);
+		}
+	}
+
+	factors.resize(numParts);
+	localVectors.resize(numParts);
+	update(matrix);
+}
+
+void AdditiveSchwarzPreconditioner::update(const CSRMatrix<double> & matrix) {
+	// A subdomain that is not positive definite throws from its thread and
+	// the pool rethrows it here
+	pool.parallelFor(0, numSubdomains(),
+			[&](const long & begin, const long & end) {
+		for (long s = begin; s < end; s++) {
+			auto & local = localMatrices[s];
+			auto & slots = sourceSlots[s];
+			for (long m = 0; m < local.nonZeros(); m++) {
+				local.values[m] = matrix.values[slots[m]];
+			}
+			factors[s].factor(local);
+		}
+	}, subdomainGrain);
+}
+
+void AdditiveSchwarzPreconditioner::apply(const vector<double> & r,
+		vector<double> & z) const {
+	// Solve the subdomains independently
+	pool.parallelFor(0, numSubdomains(),
+			[&](const long & begin, const long & end) {
+		for (long s = begin; s < end; s++) {
+			auto & rows = subdomainRows[s];
+			auto & local = localVectors[s];
+			local.resize(rows.size());
+			for (long k = 0; k < (long) rows.size(); k++) local[k] = r[rows[k]];
+			factors[s].solve(local, local);
+		}
+	}, subdomainGrain);
+	// Add the solutions on the overlap, one global row per iteration
+	pool.parallelFor(0, r.size(), [&](const long & begin, const long & end) {
+		for (long i = begin; i < end; i++) {
+			double sum = 0.0;
+			for (long c = copyOffsets[i]; c < copyOffsets[i+1]; c++) {
+				sum += localVectors[copies[c].first][copies[c].second];
+			}
+			z[i] = sum;
+		}
+	});
+}
+
+} /* namespace fire */
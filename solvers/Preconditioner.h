@@ -0,0 +1,341 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#ifndef SOLVERS_PRECONDITIONER_H_
+#define SOLVERS_PRECONDITIONER_H_
+
+#include <vector>
+#include <CSRMatrix.h>
+#include <ThreadPool.h>
+#include <SkylineCholesky.h>
+
+namespace fire {
+
+/**
+ * This is the interface for preconditioners of sparse, symmetric positive
+ * definite systems, such as those solved by the PCGSolver. A preconditioner
+ * approximates the inverse of a matrix A and is applied to residual vectors
+ * as z = M^{-1}r.
+ *
+ * Preconditioners are built from the matrix on construction. If the values in
+ * the matrix change, but not its sparsity pattern, they can be rebuilt by
+ * calling update(), which reuses their storage.
+ */
+class IPreconditioner {
+
+public:
+
+	/**
+	 * Destructor
+	 */
+	virtual ~IPreconditioner() {};
+
+	/**
+	 * This operation rebuilds the preconditioner from the values of the
+	 * matrix, which must have the same sparsity pattern as the original.
+	 * @param matrix the matrix
+	 */
+	virtual void update(const CSRMatrix<double> & matrix) = 0;
+
+	/**
+	 * This operation applies the preconditioner, z = M^{-1}r.
+	 * @param r the residual
+	 * @param z the preconditioned residual, which must have the same size as r
+	 */
+	virtual void apply(const std::vector<double> & r,
+			std::vector<double> & z) const = 0;
+};
+
+/**
+ * This is the Jacobi or diagonal preconditioner, M = diag(A). It is cheap to
+ * build, applied in parallel and a good choice for diagonally dominant
+ * systems.
+ */
+class JacobiPreconditioner : public IPreconditioner {
+
+protected:
+
+	/**
+	 * The inverse of the diagonal of the matrix.
+	 */
+	std::vector<double> inverseDiagonal;
+
+	/**
+	 * The threads used to apply the preconditioner.
+	 */
+	ThreadPool & pool;
+
+public:
+
+	/**
+	 * Constructor. An exception is thrown if the matrix has a zero or
+	 * missing diagonal element.
+	 * @param matrix the matrix
+	 * @param threadPool the threads used to apply the preconditioner
+	 */
+	JacobiPreconditioner(const CSRMatrix<double> & matrix,
+			ThreadPool & threadPool = ThreadPool::shared());
+
+	/**
+	 * Constructor for operators that are not stored as matrices. An
+	 * exception is thrown if an element of the diagonal is zero.
+	 * @param diagonal the diagonal of the operator
+	 * @param threadPool the threads used to apply the preconditioner
+	 */
+	JacobiPreconditioner(const std::vector<double> & diagonal,
+			ThreadPool & threadPool = ThreadPool::shared());
+
+	/**
+	 * See IPreconditioner::update().
+	 */
+	virtual void update(const CSRMatrix<double> & matrix);
+
+	/**
+	 * See IPreconditioner::apply().
+	 */
+	virtual void apply(const std::vector<double> & r,
+			std::vector<double> & z) const;
+};
+
+/**
+ * This is the Symmetric Successive Over-Relaxation (SSOR) preconditioner,
+ * \f[
+ * M = \frac{\omega}{2-\omega}\left(\frac{D}{\omega} + L\right)
+ * \left(\frac{D}{\omega}\right)^{-1}\left(\frac{D}{\omega} + U\right)
+ * \f]
+ * where D, L and U are the diagonal, strictly lower and strictly upper
+ * triangular parts of A. It requires no extra storage beyond the diagonal,
+ * but each application is a forward and a backward sweep through the matrix,
+ * which is sequential.
+ */
+class SSORPreconditioner : public IPreconditioner {
+
+protected:
+
+	/**
+	 * The matrix, which is used directly in the sweeps.
+	 */
+	const CSRMatrix<double> * matrix;
+
+	/**
+	 * The relaxation factor, 0 < omega < 2.
+	 */
+	double omega;
+
+	/**
+	 * The slot of the diagonal element in each row.
+	 */
+	std::vector<long> diagonalSlots;
+
+public:
+
+	/**
+	 * Constructor. The preconditioner keeps a pointer to the matrix, which
+	 * must outlive it. An exception is thrown if omega is not in (0,2) or if
+	 * the matrix has a zero or missing diagonal element.
+	 * @param matrix the matrix
+	 * @param relaxation the relaxation factor omega, which is one (symmetric
+	 * Gauss-Seidel) by default.
+	 */
+	SSORPreconditioner(const CSRMatrix<double> & matrix,
+			const double & relaxation = 1.0);
+
+	/**
+	 * See IPreconditioner::update().
+	 */
+	virtual void update(const CSRMatrix<double> & matrix);
+
+	/**
+	 * See IPreconditioner::apply().
+	 */
+	virtual void apply(const std::vector<double> & r,
+			std::vector<double> & z) const;
+};
+
+/**
+ * This is the zero fill-in Incomplete Cholesky preconditioner, IC(0), which
+ * computes a lower triangular factor L with the same sparsity pattern as the
+ * lower triangle of A such that LL^{T} matches A on that pattern. It is the
+ * most effective of the preconditioners for FEM matrices, but it costs a
+ * factorization and each application is a pair of sequential triangular
+ * solves. The factorization can break down for matrices that are not
+ * M-matrices, in which case an exception is thrown.
+ */
+class IncompleteCholeskyPreconditioner : public IPreconditioner {
+
+protected:
+
+	/**
+	 * The incomplete factor, stored by rows with the diagonal last in each
+	 * row.
+	 */
+	CSRMatrix<double> factor;
+
+	/**
+	 * The slots in the original matrix of each entry of the factor.
+	 */
+	std::vector<long> sourceSlots;
+
+public:
+
+	/**
+	 * Constructor
+	 * @param matrix the matrix
+	 */
+	IncompleteCholeskyPreconditioner(const CSRMatrix<double> & matrix);
+
+	/**
+	 * See IPreconditioner::update().
+	 */
+	virtual void update(const CSRMatrix<double> & matrix);
+
+	/**
+	 * See IPreconditioner::apply().
+	 */
+	virtual void apply(const std::vector<double> & r,
+			std::vector<double> & z) const;
+};
+
+/**
+ * This is the one-level additive Schwarz preconditioner,
+ * \f[
+ * M^{-1} = \sum_{s} R_{s}^{T} A_{s}^{-1} R_{s}
+ * \f]
+ * where R_s restricts a vector to the rows of subdomain s and
+ * A_s = R_s A R_s^T is the block of the matrix for those rows. The
+ * subdomains are given as a partition of the rows, for example from
+ * recursiveBisection() in GraphOrdering.h or the node owners of a
+ * DomainDecomposition, and are grown by a number of layers of neighboring
+ * rows so that they overlap. The blocks are numbered with Reverse
+ * Cuthill-McKee, factored with SkylineCholesky and solved independently,
+ * one subdomain per thread, so the preconditioner scales with the number of
+ * cores where SSOR and incomplete Cholesky are sequential. The solutions
+ * are added together on the overlap, which keeps the preconditioner
+ * symmetric for PCG.
+ *
+ * The number of iterations grows with the number of subdomains because
+ * there is no coarse space, so a few large subdomains, one per core, work
+ * best.
+ */
+class AdditiveSchwarzPreconditioner : public IPreconditioner {
+
+protected:
+
+	/**
+	 * The global rows of each subdomain in the order of its local matrix.
+	 */
+	std::vector<std::vector<int>> subdomainRows;
+
+	/**
+	 * The local matrix of each subdomain.
+	 */
+	std::vector<CSRMatrix<double>> localMatrices;
+
+	/**
+	 * The slot in the global matrix of each value of each local matrix.
+	 */
+	std::vector<std::vector<long>> sourceSlots;
+
+	/**
+	 * The factors of the local matrices.
+	 */
+	std::vector<SkylineCholesky> factors;
+
+	/**
+	 * The copies of each global row in the subdomains, as (subdomain, local
+	 * row) pairs stored from copyOffsets[i] to copyOffsets[i+1].
+	 */
+	std::vector<long> copyOffsets;
+	std::vector<std::pair<int,int>> copies;
+
+	/**
+	 * The local residuals and solutions, which are kept between
+	 * applications.
+	 */
+	mutable std::vector<std::vector<double>> localVectors;
+
+	/**
+	 * The threads used to factor and solve the subdomains.
+	 */
+	ThreadPool & pool;
+
+	/**
+	 * The minimum number of subdomains per thread, which gives each subdomain
+	 * its own task.
+	 */
+	static const long subdomainGrain = 1;
+
+public:
+
+	/**
+	 * Constructor. An exception is thrown if a part is negative or the size
+	 * of the partition does not match the matrix.
+	 * @param matrix the matrix
+	 * @param parts the subdomain of each row
+	 * @param overlap the number of layers of neighboring rows added to each
+	 * subdomain
+	 * @param threadPool the threads used to factor and solve the subdomains
+	 */
+	AdditiveSchwarzPreconditioner(const CSRMatrix<double> & matrix,
+			const std::vector<int> & parts, const int & overlap = 1,
+			ThreadPool & threadPool = ThreadPool::shared());
+
+	/**
+	 * See IPreconditioner::update(). The subdomains are refactored in
+	 * parallel.
+	 */
+	virtual void update(const CSRMatrix<double> & matrix);
+
+	/**
+	 * See IPreconditioner::apply().
+	 */
+	virtual void apply(const std::vector<double> & r,
+			std::vector<double> & z) const;
+
+	/**
+	 * This operation returns the number of subdomains.
+	 */
+	int numSubdomains() const { return subdomainRows.size();};
+
+	/**
+	 * This operation returns the global rows of a subdomain, including its
+	 * overlap.
+	 * @param s the subdomain
+	 * @return the rows
+	 */
+	const std::vector<int> & rows(const int & s) const {
+		return subdomainRows[s];
+	};
+};
+
+} /* namespace fire */
+
+#endif /* SOLVERS_PRECONDITIONER_H_ */
@@ -0,0 +1,1026 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#ifndef SOLVERS_RKSOLVER_H_
+#define SOLVERS_RKSOLVER_H_
+
+#include <State.h>
+#include <Checkpoint.h>
+#include <SolverEvent.h>
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <math.h>
+
+namespace fire {
+
+/**
+ * This structure holds the coefficients of the Dormand-Prince 5(4) embedded
+ * Runge-Kutta pair. The coefficients are stored statically because they are
+ * used unmodified by all instances of RKSolver. The tableau is
+ * \f[
+ * k_{i} = f(t + c_{i}h, u + h\sum_{j<i} a_{ij}k_{j}), \quad
+ * u_{n+1} = u_{n} + h\sum_{i} b_{i}k_{i}
+ * \f]
+ * where the seventh stage is evaluated at the new solution ("First Same As
+ * Last") and is reused as the first stage of the next step. The error
+ * estimate is \f$h\sum_{i} e_{i}k_{i}\f$, the difference between the fifth
+ * and fourth order solutions.
+ */
+struct DormandPrinceCoefficients {
+
+	/**
+	 * The number of stages in the method.
+	 */
+	constexpr static int numStages = 7;
+
+	/**
+	 * The stage times c_i.
+	 */
+	static constexpr std::array<double,7> const c = {0.0, 1.0/5.0, 3.0/10.0,
+			4.0/5.0, 8.0/9.0, 1.0, 1.0};
+
+	/**
+	 * The lower triangle of the Runge-Kutta matrix a_ij, stored row by row
+	 * such that a_ij is at index i*(i-1)/2 + j for i = 1..6 and j < i.
+	 */
+	static constexpr std::array<double,21> const a = {
+			1.0/5.0,
+			3.0/40.0, 9.0/40.0,
+			44.0/45.0, -56.0/15.0, 32.0/9.0,
+			19372.0/6561.0, -25360.0/2187.0, 64448.0/6561.0, -212.0/729.0,
+			9017.0/3168.0, -355.0/33.0, 46732.0/5247.0, 49.0/176.0,
+			-5103.0/18656.0,
+			35.0/384.0, 0.0, 500.0/1113.0, 125.0/192.0, -2187.0/6784.0,
+			11.0/84.0};
+
+	/**
+	 * The weights e_i of the embedded error estimate (b_i - b*_i).
+	 */
+	static constexpr std::array<double,7> const e = {71.0/57600.0, 0.0,
+			-71.0/16695.0, 71.0/1920.0, -17253.0/339200.0, 22.0/525.0,
+			-1.0/40.0};
+
+	/**
+	 * The approximate distance from the origin to the boundary of the
+	 * stability region of the method along the negative real axis.
+	 */
+	static constexpr double stabilityBoundary = 3.3;
+};
+
+/**
+ * This structure collects statistics from an RKSolver integration, including
+ * how the integration was split between the explicit and stiff regimes.
+ */
+struct RKSolverStatistics {
+
+	/**
+	 * The number of accepted explicit steps.
+	 */
+	long numSteps = 0;
+
+	/**
+	 * The number of rejected explicit steps.
+	 */
+	long numRejectedSteps = 0;
+
+	/**
+	 * The number of evaluations of the right hand side, dudt(), made by the
+	 * explicit solver and the stiffness detector. Evaluations made by the
+	 * stiff solver are not counted.
+	 */
+	long numRHSEvals = 0;
+
+	/**
+	 * The number of times that stiffness was detected during explicit
+	 * integration.
+	 */
+	long numStiffnessDetections = 0;
+
+	/**
+	 * The number of times the problem was handed to the stiff solver.
+	 */
+	long numSwitchesToStiff = 0;
+
+	/**
+	 * The number of times the problem was taken back from the stiff solver.
+	 */
+	long numSwitchesToExplicit = 0;
+
+	/**
+	 * The number of intervals integrated by the stiff solver.
+	 */
+	long numStiffIntervals = 0;
+
+	/**
+	 * The length of the interval in t covered by the explicit solver.
+	 */
+	double explicitT = 0.0;
+
+	/**
+	 * The length of the interval in t covered by the stiff solver.
+	 */
+	double stiffT = 0.0;
+
+	/**
+	 * The wall clock time, in seconds, spent in the explicit solver.
+	 */
+	double explicitWallTime = 0.0;
+
+	/**
+	 * The wall clock time, in seconds, spent in the stiff solver.
+	 */
+	double stiffWallTime = 0.0;
+};
+
+/**
+ * This class numerically integrates a set of Ordinary Differential Equations
+ * \f[
+ * \frac{d\vec{u}}{dt} = \vec{f}(t,\vec{u})
+ * \f]
+ * with the explicit, adaptive Dormand-Prince 5(4) Runge-Kutta method. It works
+ * with any State<T> that implements u() and dudt(), just like IVPSolver, and
+ * it is meant for non-stiff and mildly stiff problems where the Newton
+ * iterations of an implicit solver are not needed.
+ *
+ * Stiffness is detected at no extra cost from the last two stages of each
+ * step following Hairer and Wanner, "Solving Ordinary Differential Equations
+ * II," Section IV.2. Both stages are evaluated at t+h, so
+ * \f[
+ * h\rho \approx h\frac{\|k_{7} - k_{6}\|}{\|u_{n+1} - U_{6}\|}
+ * \f]
+ * estimates h times the dominant eigenvalue of the Jacobian. When this value
+ * sits on the boundary of the stability region for stiffnessPatience()
+ * consecutive checks, the problem is stiff. If a stiff solver has been
+ * provided by stiffSolver(), the problem is handed to it for an interval of t.
+ * At the end of each stiff interval, the spectral radius of the Jacobian is
+ * estimated by a few power iterations with finite difference Jacobian-vector
+ * products and compared to the step that the explicit method could take for
+ * accuracy alone. If the explicit method is stable at that step, the problem
+ * is taken back. Otherwise the next stiff interval is twice as long. If no
+ * stiff solver is provided, stiffness is only recorded in the statistics and
+ * the explicit integration continues.
+ *
+ * The stiff solver is any function that advances the State from t0 to t1 in
+ * place. IVPSolver can be used as follows:
+ * @code
+ * RKSolver<T> solver;
+ * solver.tInit(tInit);
+ * solver.tFinal(tFinal);
+ * solver.stiffSolver([](State<T> & state, const double & t0,
+ *		const double & t1) {
+ *	IVPSolver<T> implicitSolver;
+ *	implicitSolver.t(t0);
+ *	implicitSolver.tInit(t0);
+ *	implicitSolver.tFinal(t1);
+ *	implicitSolver.solve(state);
+ * });
+ * solver.solve(state);
+ * // Check how the work was split between the two regimes
+ * auto & stats = solver.statistics();
+ * @endcode
+ *
+ * The State is updated and its monitors notified after every accepted step.
+ * Note that, as with IVPSolver, the State's u(double *) is also called for
+ * each evaluation of the right hand side.
+ *
+ * Long integrations can be checkpointed by calling checkpoints() with a file
+ * name and an interval of t. A Checkpoint is written in the background each
+ * time the integration passes a multiple of the interval. It holds the State's
+ * t, unknowns and parameters together with the derivative at t, the next step
+ * size and the state of the step size and stiffness controllers. The
+ * integration can then be continued with
+ * @code
+ * RKSolver<T> solver;
+ * solver.tFinal(tFinal);
+ * solver.restart("checkpoint.bin");
+ * solver.solve(state);
+ * @endcode
+ * and it will take exactly the same steps that the original integration would
+ * have taken.
+ *
+ * Events, such as reaching a steady state, are added with addEvent(). They are
+ * checked after every accepted step and located within the step by the
+ * Illinois method on the cubic Hermite interpolant of the solution. Events
+ * that occur while the stiff solver has the problem are checked at the end
+ * of each stiff interval and reported at that time. solve() returns a
+ * SolveResult that records the events and why the integration ended.
+ */
+template<typename T>
+class RKSolver {
+
+protected:
+
+	/**
+	 * The initial t value from which the solve should start.
+	 */
+	double initialT = 0.0;
+
+	/**
+	 * The final t value at which the solve should stop.
+	 */
+	double finalT = 0.0;
+
+	/**
+	 * The current value of t in the integration.
+	 */
+	double currentT = 0.0;
+
+	/**
+	 * The relative tolerance of the local error test.
+	 */
+	double relTol = 1.0e-6;
+
+	/**
+	 * The absolute tolerance of the local error test.
+	 */
+	double absTol = 1.0e-10;
+
+	/**
+	 * The initial step size. If it is zero or less, the initial step size is
+	 * estimated by the solver.
+	 */
+	double initialStepSize = 0.0;
+
+	/**
+	 * The maximum number of steps, accepted or rejected, that the solver
+	 * will take before it gives up.
+	 */
+	long maxNumSteps = 100000;
+
+	/**
+	 * The number of consecutive stiff steps after which the problem is
+	 * considered stiff.
+	 */
+	int numStiffSteps = 15;
+
+	/**
+	 * The initial length of a stiff interval as a multiple of the last
+	 * explicit step size.
+	 */
+	double stiffIntervalFactor = 100.0;
+
+	/**
+	 * The function that integrates the State over an interval when the
+	 * problem is stiff.
+	 */
+	std::function<void(State<T> &, const double &, const double &)> stiffFunction;
+
+	/**
+	 * The statistics from the last solve.
+	 */
+	RKSolverStatistics stats;
+
+	/**
+	 * The size of the system being solved.
+	 */
+	int n = 0;
+
+	/**
+	 * The stage derivatives k_1 through k_7.
+	 */
+	std::array<std::vector<double>,DormandPrinceCoefficients::numStages> k;
+
+	/**
+	 * Work arrays for the current solution, the new solution and the stage
+	 * solution.
+	 */
+	std::vector<double> y, yNew, yStage;
+
+	/**
+	 * The size of the next step.
+	 */
+	double h = 0.0;
+
+	/**
+	 * The length of the next stiff interval.
+	 */
+	double stiffInterval = 0.0;
+
+	/**
+	 * The number of consecutive steps that appeared stiff and non-stiff.
+	 */
+	int stiffCount = 0, nonStiffCount = 0;
+
+	/**
+	 * True if the problem is currently handed to the stiff solver.
+	 */
+	bool isStiff = false;
+
+	/**
+	 * True if the last step was rejected.
+	 */
+	bool lastRejected = false;
+
+	/**
+	 * The number of step attempts in the current solve.
+	 */
+	long numAttempts = 0;
+
+	/**
+	 * The name of the checkpoint file.
+	 */
+	std::string checkpointFile;
+
+	/**
+	 * The interval of t between checkpoints, or zero if checkpoints are
+	 * disabled.
+	 */
+	double checkpointInterval = 0.0;
+
+	/**
+	 * The value of t after which the next checkpoint is written.
+	 */
+	double nextCheckpointT = 0.0;
+
+	/**
+	 * The writer for the checkpoints. It is only created if checkpoints are
+	 * enabled.
+	 */
+	std::unique_ptr<CheckpointWriter> writer;
+
+	/**
+	 * The checkpoint from which the next solve should restart, if any.
+	 */
+	std::unique_ptr<Checkpoint> restartPoint;
+
+	/**
+	 * The events that are located during the solve.
+	 */
+	std::vector<SolverEvent> events;
+
+	/**
+	 * The values of the event functions at the current solution.
+	 */
+	std::vector<double> eventValues;
+
+	/**
+	 * The result of the current solve.
+	 */
+	SolveResult result;
+
+	/**
+	 * This operation computes the cubic Hermite interpolant of the solution
+	 * at t in the last step, [t0,t0+h], and stores it in uVals. The solution
+	 * and derivative at the start of the step must be in yNew and k[6] and
+	 * those at the end of the step in y and k[0].
+	 */
+	void interpolate(const double & t, const double & t0, const double & hStep,
+			std::vector<double> & uVals) const {
+		double theta = (t - t0)/hStep;
+		for (int i = 0; i < n; i++) {
+			double dy = y[i] - yNew[i];
+			uVals[i] = (1.0 - theta)*yNew[i] + theta*y[i]
+					+ theta*(theta - 1.0)*((1.0 - 2.0*theta)*dy
+					+ (theta - 1.0)*hStep*k[6][i] + theta*hStep*k[0][i]);
+		}
+	}
+
+	/**
+	 * This operation evaluates an event function for the solution uVals at t
+	 * with derivatives dudt.
+	 */
+	double eventValue(const SolverEvent & event, const double & t,
+			const std::vector<double> & uVals, const std::vector<double> & dudt) {
+		return event.function(t, uVals.data(), dudt.data(), n);
+	}
+
+	/**
+	 * This operation locates the zero of an event function in the last step
+	 * with the Illinois method. It returns the time just after the crossing
+	 * and leaves the interpolated solution at that time in yStage.
+	 */
+	double locateEvent(State<T> & state, const SolverEvent & event,
+			const double & t0, const double & hStep, double ga, double gb) {
+		double ta = t0, tb = t0 + hStep;
+		double tol = 1.0e-12*(fabs(t0) + hStep);
+		int side = 0;
+		for (int iter = 0; iter < 50 && tb - ta > tol; iter++) {
+			double tc = (ta*gb - tb*ga)/(gb - ga);
+			interpolate(tc, t0, hStep, yStage);
+			rhs(state, tc, yStage, k[1]);
+			double gc = eventValue(event, tc, yStage, k[1]);
+			if (gc == 0.0) {
+				tb = tc;
+				break;
+			}
+			if ((gc > 0.0) == (gb > 0.0)) {
+				tb = tc;
+				gb = gc;
+				if (side == -1) ga *= 0.5;
+				side = -1;
+			} else {
+				ta = tc;
+				ga = gc;
+				if (side == 1) gb *= 0.5;
+				side = 1;
+			}
+		}
+		interpolate(tb, t0, hStep, yStage);
+		return tb;
+	}
+
+	/**
+	 * This operation checks the events at the end of the last step or stiff
+	 * interval, which started at t0 and had length hStep. The derivative at
+	 * the current solution must be in k[0]. If interpolating, the events are
+	 * located within the step. Otherwise they are reported at the current
+	 * time. It returns true if an event ended the integration, in which case
+	 * the solution and the State are moved to the time of the event.
+	 */
+	bool processEvents(State<T> & state, const double & t0,
+			const double & hStep, const bool & interpolating) {
+		// Find the events that triggered and when
+		std::vector<double> newValues(events.size());
+		std::vector<std::pair<double,int>> triggered;
+		for (int i = 0; i < (int) events.size(); i++) {
+			newValues[i] = eventValue(events[i], currentT, y, k[0]);
+			if (events[i].crossed(eventValues[i], newValues[i])) {
+				double tEvent = (interpolating) ? locateEvent(state, events[i],
+						t0, hStep, eventValues[i], newValues[i]) : currentT;
+				triggered.emplace_back(tEvent, i);
+			}
+		}
+		eventValues = newValues;
+		if (triggered.empty()) return false;
+		// Record them in order until one ends the integration
+		std::sort(triggered.begin(), triggered.end());
+		for (auto & trigger : triggered) {
+			if (result.record(events[trigger.second], trigger.first)) {
+				if (interpolating) {
+					interpolate(trigger.first, t0, hStep, yStage);
+					y = yStage;
+					currentT = trigger.first;
+					state.t(currentT);
+					state.u(y.data());
+				}
+				return true;
+			}
+		}
+		// Put the State back at the end of the step after locating the events
+		if (interpolating) {
+			state.t(currentT);
+			state.u(y.data());
+		}
+		return false;
+	}
+
+	/**
+	 * This operation writes a checkpoint if the integration has passed the
+	 * next checkpoint time.
+	 */
+	void writeCheckpointIfNeeded(State<T> & state) {
+		if (checkpointInterval > 0.0 && currentT >= nextCheckpointT
+				&& currentT < finalT) {
+			writer->write(checkpoint(state), checkpointFile);
+			while (nextCheckpointT <= currentT) {
+				nextCheckpointT += checkpointInterval;
+			}
+		}
+	}
+
+	/**
+	 * This operation restores the solver and the State from the restart
+	 * checkpoint.
+	 */
+	void restore(State<T> & state) {
+		const Checkpoint & cp = *restartPoint;
+		if (cp.solver != "RKSolver" || (int) cp.u.size() != n
+				|| cp.history.size() != 1 || cp.counters.size() != 12
+				|| cp.values.size() != 6) {
+			throw std::runtime_error("Invalid checkpoint for RKSolver.");
+		}
+		currentT = cp.t;
+		y = cp.u;
+		k[0] = cp.history[0];
+		h = cp.stepSize;
+		numAttempts = cp.counters[0];
+		stiffCount = cp.counters[1];
+		nonStiffCount = cp.counters[2];
+		isStiff = cp.counters[3];
+		lastRejected = cp.counters[4];
+		stats.numSteps = cp.counters[5];
+		stats.numRejectedSteps = cp.counters[6];
+		stats.numRHSEvals = cp.counters[7];
+		stats.numStiffnessDetections = cp.counters[8];
+		stats.numSwitchesToStiff = cp.counters[9];
+		stats.numSwitchesToExplicit = cp.counters[10];
+		stats.numStiffIntervals = cp.counters[11];
+		stiffInterval = cp.values[0];
+		stats.explicitT = cp.values[1];
+		stats.stiffT = cp.values[2];
+		stats.explicitWallTime = cp.values[3];
+		stats.stiffWallTime = cp.values[4];
+		initialT = cp.values[5];
+		// Restore the state
+		state.parameters(cp.parameters);
+		state.t(currentT);
+		state.u(y.data());
+		restartPoint.reset();
+	}
+
+	/**
+	 * This operation evaluates the right hand side at (t,yVals) and stores it
+	 * in dydt.
+	 */
+	void rhs(State<T> & state, const double & t, std::vector<double> & yVals,
+			std::vector<double> & dydt) {
+		state.u(yVals.data());
+		auto * rhsVals = state.dudt(t);
+		std::copy(rhsVals, rhsVals + n, dydt.begin());
+		stats.numRHSEvals++;
+	}
+
+	/**
+	 * This operation computes the weighted root mean square norm of vec using
+	 * the solution values in a and b to scale each component.
+	 */
+	double norm(const std::vector<double> & vec, const std::vector<double> & a,
+			const std::vector<double> & b) const {
+		double sum = 0.0;
+		for (int i = 0; i < n; i++) {
+			double scale = absTol + relTol*std::max(fabs(a[i]),fabs(b[i]));
+			double val = vec[i]/scale;
+			sum += val*val;
+		}
+		return sqrt(sum/n);
+	}
+
+	/**
+	 * This operation estimates a step size that the explicit method could
+	 * take from accuracy considerations alone. It is the first guess from
+	 * Hairer, Norsett and Wanner, Section II.4, and only uses the solution
+	 * and its derivative, which is stored in k[0].
+	 */
+	double accuracyStepSize() const {
+		double d0 = norm(y,y,y), d1 = norm(k[0],y,y);
+		double hGuess = (d0 < 1.0e-5 || d1 < 1.0e-5) ? 1.0e-6 : 0.01*d0/d1;
+		return std::min(hGuess,finalT - currentT);
+	}
+
+	/**
+	 * This operation estimates the spectral radius of the Jacobian at the
+	 * current solution with power iterations. Jacobian-vector products are
+	 * computed by finite differences, so each iteration costs one evaluation
+	 * of the right hand side. The current derivative must be in k[0] and k[1]
+	 * and yStage are used as work space.
+	 */
+	double spectralRadius(State<T> & state) {
+		const int numIterations = 5;
+		double vNorm = 0.0, radius = 0.0, yNorm = 0.0;
+		// Start from the derivative since it is dominated by the fast modes,
+		// but fall back to a uniform vector if the derivative vanishes.
+		std::vector<double> v(k[0]);
+		for (int i = 0; i < n; i++) {
+			vNorm += v[i]*v[i];
+			yNorm += y[i]*y[i];
+		}
+		if (vNorm == 0.0) {
+			std::fill(v.begin(),v.end(),1.0);
+			vNorm = n;
+		}
+		vNorm = sqrt(vNorm);
+		yNorm = sqrt(yNorm);
+		double eps = sqrt(1.0e-16)*std::max(1.0,yNorm);
+		for (int iter = 0; iter < numIterations; iter++) {
+			// Perturb along the unit vector v
+			for (int i = 0; i < n; i++) {
+				v[i] /= vNorm;
+				yStage[i] = y[i] + eps*v[i];
+			}
+			rhs(state,currentT,yStage,k[1]);
+			// v <- J v
+			vNorm = 0.0;
+			for (int i = 0; i < n; i++) {
+				v[i] = (k[1][i] - k[0][i])/eps;
+				vNorm += v[i]*v[i];
+			}
+			vNorm = sqrt(vNorm);
+			radius = vNorm;
+			if (vNorm == 0.0) break;
+		}
+		return radius;
+	}
+
+	/**
+	 * This operation returns the number of seconds since start.
+	 */
+	double elapsed(const std::chrono::steady_clock::time_point & start) const {
+		std::chrono::duration<double> diff = std::chrono::steady_clock::now()
+				- start;
+		return diff.count();
+	}
+
+public:
+
+	/**
+	 * This operation sets the current value of t.
+	 * @param the current value of t in the solver
+	 */
+	void t(const double & tVal) { currentT = tVal;};
+
+	/**
+	 * This operation sets the initial value of t
+	 * @param the initial value of t in the solver
+	 */
+	void tInit(const double & tVal) { initialT = tVal;};
+
+	/**
+	 * This operation sets the final value of t
+	 * @param the final value of t in the solver
+	 */
+	void tFinal(const double & tVal) { finalT = tVal;};
+
+	/**
+	 * This operation returns the current value of t in the system.
+	 * @return the current value of t in the solver
+	 */
+	double t() const {return currentT;};
+
+	/**
+	 * This operation returns the initial value of t configured for the solver.
+	 * @return the initial value of t in the solver
+	 */
+	double tInit() const {return initialT;};
+
+	/**
+	 * This operation returns the final value of t configured for the solver.
+	 * @return the final value of t in the solver
+	 */
+	double tFinal() const {return finalT;};
+
+	/**
+	 * This operation sets the relative and absolute tolerances of the local
+	 * error test.
+	 * @param rtol the relative tolerance
+	 * @param atol the absolute tolerance
+	 */
+	void tolerances(const double & rtol, const double & atol) {
+		relTol = rtol;
+		absTol = atol;
+	}
+
+	/**
+	 * This operation sets the initial step size. Values less than or equal to
+	 * zero direct the solver to estimate it, which is the default.
+	 * @param h the initial step size
+	 */
+	void initialStep(const double & h) { initialStepSize = h;};
+
+	/**
+	 * This operation sets the maximum number of steps the solver may take.
+	 * @param steps the maximum number of accepted and rejected steps
+	 */
+	void maxSteps(const long & steps) { maxNumSteps = steps;};
+
+	/**
+	 * This operation sets the number of consecutive stiff steps after which
+	 * the problem is handed to the stiff solver. The default is 15.
+	 * @param steps the number of consecutive stiff steps
+	 */
+	void stiffnessPatience(const int & steps) { numStiffSteps = steps;};
+
+	/**
+	 * This operation sets the function that will integrate the State over an
+	 * interval of t when the problem is stiff. It will be called with the
+	 * State and the bounds of the interval and must leave the State at the
+	 * end of the interval.
+	 * @param solver the stiff solver
+	 */
+	void stiffSolver(const std::function<void(State<T> &, const double &,
+			const double &)> & solver) {
+		stiffFunction = solver;
+	}
+
+	/**
+	 * This operation returns the statistics from the last solve.
+	 * @return the statistics
+	 */
+	const RKSolverStatistics & statistics() const { return stats;};
+
+	/**
+	 * This operation adds an event that will be located during the solve.
+	 * @param event the event
+	 */
+	void addEvent(const SolverEvent & event) { events.push_back(event);};
+
+	/**
+	 * This operation removes all of the events.
+	 */
+	void clearEvents() { events.clear();};
+
+	/**
+	 * This operation enables checkpoints, which are written asynchronously to
+	 * a file every time the integration passes a multiple of the interval
+	 * after the initial t. Each checkpoint replaces the previous one.
+	 * @param fileName the name of the checkpoint file
+	 * @param interval the interval of t between checkpoints. Checkpoints are
+	 * disabled if it is zero or less.
+	 */
+	void checkpoints(const std::string & fileName, const double & interval) {
+		checkpointFile = fileName;
+		checkpointInterval = interval;
+		if (interval > 0.0 && !writer) writer.reset(new CheckpointWriter());
+	}
+
+	/**
+	 * This operation waits until all of the checkpoints have been written to
+	 * disk. It rethrows any errors from writing them.
+	 */
+	void waitForCheckpoints() {
+		if (writer) writer->wait();
+	}
+
+	/**
+	 * This operation creates a checkpoint of the solver and the State at the
+	 * current value of t. It is normally called by the solver, but may be
+	 * called after a solve to save the final solution.
+	 * @param state the State that is being solved
+	 * @return the checkpoint
+	 */
+	Checkpoint checkpoint(State<T> & state) {
+		Checkpoint cp;
+		cp.solver = "RKSolver";
+		cp.t = currentT;
+		cp.u = y;
+		cp.parameters = state.parameters();
+		cp.stepSize = h;
+		cp.order = 5;
+		cp.history.push_back(k[0]);
+		cp.counters = {numAttempts, stiffCount, nonStiffCount, isStiff,
+				lastRejected, stats.numSteps, stats.numRejectedSteps,
+				stats.numRHSEvals, stats.numStiffnessDetections,
+				stats.numSwitchesToStiff, stats.numSwitchesToExplicit,
+				stats.numStiffIntervals};
+		cp.values = {stiffInterval, stats.explicitT, stats.stiffT,
+				stats.explicitWallTime, stats.stiffWallTime, initialT};
+		return cp;
+	}
+
+	/**
+	 * This operation directs the next call to solve() to continue from a
+	 * checkpoint instead of starting from the initial conditions in the State.
+	 * The State's unknowns, t and parameters are overwritten from the
+	 * checkpoint when solve() is called.
+	 * @param checkpoint the checkpoint
+	 */
+	void restart(const Checkpoint & checkpoint) {
+		restartPoint.reset(new Checkpoint(checkpoint));
+	}
+
+	/**
+	 * This operation directs the next call to solve() to continue from a
+	 * checkpoint file.
+	 * @param fileName the name of the checkpoint file
+	 */
+	void restart(const std::string & fileName) {
+		Checkpoint checkpoint;
+		checkpoint.read(fileName);
+		restart(checkpoint);
+	}
+
+	/**
+	 * This operation solves the system of equations specified in the State.
+	 * It throws an exception if the maximum number of steps is exceeded, if
+	 * the step size underflows or if the restart checkpoint is invalid.
+	 * @param the State describing the system to be solved.
+	 * @return the result of the solve, including any events that triggered
+	 */
+	SolveResult solve(State<T> & state) {
+
+		typedef DormandPrinceCoefficients DP;
+		const double safety = 0.9, minFactor = 0.2, maxFactor = 10.0;
+
+		// Allocate storage
+		stats = RKSolverStatistics();
+		n = state.size();
+		for (auto & stage : k) stage.assign(n,0.0);
+		yNew.assign(n,0.0);
+		yStage.assign(n,0.0);
+		std::vector<double> error(n,0.0);
+
+		auto * stateU = state.u();
+		if (restartPoint) {
+			// Continue from the checkpoint
+			restore(state);
+		} else {
+			// Pull the initial conditions from the state
+			currentT = initialT;
+			y.assign(stateU,stateU + n);
+			rhs(state,currentT,y,k[0]);
+			h = (initialStepSize > 0.0) ? initialStepSize : accuracyStepSize();
+			stiffInterval = 0.0;
+			stiffCount = 0;
+			nonStiffCount = 0;
+			isStiff = false;
+			lastRejected = false;
+			numAttempts = 0;
+		}
+		nextCheckpointT = initialT + checkpointInterval;
+		while (checkpointInterval > 0.0 && nextCheckpointT <= currentT) {
+			nextCheckpointT += checkpointInterval;
+		}
+		auto start = std::chrono::steady_clock::now();
+
+		// Check the events at the initial solution
+		result = SolveResult();
+		bool terminated = false;
+		eventValues.resize(events.size());
+		for (int i = 0; i < (int) events.size() && !terminated; i++) {
+			eventValues[i] = eventValue(events[i], currentT, y, k[0]);
+			if (events[i].satisfiedAtStart(eventValues[i])) {
+				terminated = result.record(events[i], currentT);
+			}
+		}
+
+		while (currentT < finalT && !terminated) {
+
+			// Hand the problem to the stiff solver if required.
+			if (isStiff) {
+				double t0 = currentT, t1 = std::min(currentT + stiffInterval,
+						finalT);
+				state.t(t0);
+				state.u(y.data());
+				auto stiffStart = std::chrono::steady_clock::now();
+				stiffFunction(state,t0,t1);
+				stats.stiffWallTime += elapsed(stiffStart);
+				stats.stiffT += t1 - t0;
+				stats.numStiffIntervals++;
+				// Pull the solution back from the state
+				currentT = t1;
+				stateU = state.u();
+				std::copy(stateU,stateU + n,y.begin());
+				if (!events.empty()) {
+					rhs(state,currentT,y,k[0]);
+					terminated = processEvents(state,t0,t1 - t0,false);
+					if (terminated) break;
+				}
+				if (currentT >= finalT) break;
+				// Check if the explicit method can take the problem back
+				start = std::chrono::steady_clock::now();
+				rhs(state,currentT,y,k[0]);
+				h = accuracyStepSize();
+				if (h*spectralRadius(state) < DP::stabilityBoundary) {
+					isStiff = false;
+					stiffCount = 0;
+					nonStiffCount = 0;
+					stats.numSwitchesToExplicit++;
+				} else {
+					stiffInterval *= 2.0;
+					stats.explicitWallTime += elapsed(start);
+				}
+				writeCheckpointIfNeeded(state);
+				continue;
+			}
+
+			if (++numAttempts > maxNumSteps) {
+				throw std::runtime_error("RKSolver exceeded the maximum number of steps.");
+			}
+			if (currentT + h > finalT) h = finalT - currentT;
+			if (currentT + h == currentT) {
+				throw std::runtime_error("RKSolver step size underflow.");
+			}
+
+			// Compute stages 2-6
+			for (int s = 1; s < DP::numStages - 1; s++) {
+				int offset = s*(s-1)/2;
+				for (int i = 0; i < n; i++) {
+					double sum = 0.0;
+					for (int j = 0; j < s; j++) {
+						sum += DP::a[offset + j]*k[j][i];
+					}
+					yStage[i] = y[i] + h*sum;
+				}
+				rhs(state,currentT + DP::c[s]*h,yStage,k[s]);
+			}
+			// Compute the new solution from the last row of a and then the
+			// final stage, which is also the derivative at the new solution.
+			int offset = (DP::numStages-1)*(DP::numStages-2)/2;
+			for (int i = 0; i < n; i++) {
+				double sum = 0.0;
+				for (int j = 0; j < DP::numStages - 1; j++) {
+					sum += DP::a[offset + j]*k[j][i];
+				}
+				yNew[i] = y[i] + h*sum;
+			}
+			rhs(state,currentT + h,yNew,k[6]);
+
+			// Estimate the error
+			for (int i = 0; i < n; i++) {
+				double sum = 0.0;
+				for (int j = 0; j < DP::numStages; j++) {
+					sum += DP::e[j]*k[j][i];
+				}
+				error[i] = h*sum;
+			}
+			double err = norm(error,y,yNew);
+
+			if (err <= 1.0) {
+				// Accept the step. Check for stiffness using stages 6 and 7,
+				// both of which are evaluated at t+h. yStage holds U_6.
+				double num = 0.0, den = 0.0;
+				for (int i = 0; i < n; i++) {
+					num += (k[6][i] - k[5][i])*(k[6][i] - k[5][i]);
+					den += (yNew[i] - yStage[i])*(yNew[i] - yStage[i]);
+				}
+				double hRho = (den > 0.0) ? h*sqrt(num/den) : 0.0;
+				if (hRho > DP::stabilityBoundary) {
+					nonStiffCount = 0;
+					if (++stiffCount == numStiffSteps) {
+						stats.numStiffnessDetections++;
+						stiffCount = 0;
+						if (stiffFunction) {
+							isStiff = true;
+							stiffInterval = stiffIntervalFactor*h;
+							stats.numSwitchesToStiff++;
+						}
+					}
+				} else if (++nonStiffCount == 6) {
+					stiffCount = 0;
+				}
+
+				stats.explicitT += h;
+				currentT += h;
+				y.swap(yNew);
+				k[0].swap(k[6]);
+				stats.numSteps++;
+				// Update the state
+				state.t(currentT);
+				state.u(y.data());
+				if (!events.empty()) {
+					terminated = processEvents(state,currentT - h,h,true);
+					if (terminated) break;
+				}
+
+				// Pick the next step size. Do not grow right after a rejection.
+				double factor = (err == 0.0) ? maxFactor
+						: safety*pow(err,-0.2);
+				factor = std::min(lastRejected ? 1.0 : maxFactor,
+						std::max(minFactor,factor));
+				h *= factor;
+				lastRejected = false;
+				if (isStiff) stats.explicitWallTime += elapsed(start);
+				writeCheckpointIfNeeded(state);
+			} else {
+				// Reject the step and try again with a smaller one.
+				stats.numRejectedSteps++;
+				h *= std::max(minFactor,safety*pow(err,-0.2));
+				lastRejected = true;
+			}
+		}
+
+		if (!isStiff) stats.explicitWallTime += elapsed(start);
+
+		// Make sure the state is at the final solution
+		state.t(currentT);
+		state.u(y.data());
+
+		// Frozen states jump to the final time without changing. The
+		// monitors are not notified because the solution did not change.
+		if (terminated && result.events.back().action == EventAction::FREEZE) {
+			currentT = finalT;
+			state.t(currentT);
+		}
+		result.t = currentT;
+
+		return result;
+	}
+
+};
+
+} /* namespace fire */
+
+#endif /* SOLVERS_RKSOLVER_H_ */
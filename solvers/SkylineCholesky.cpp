@@ -0,0 +1,126 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+
+// See the header file for API documentation
+
+#include <SkylineCholesky.h>
+#include <stdexcept>
+#include <algorithm>
+#include <math.h>
+
+using namespace std;
+
+namespace fire {
+
+void SkylineCholesky::factor(const CSRMatrix<double> & matrix) {
+
+	numRows = matrix.size();
+	firstColumns.resize(numRows);
+	diagonals.resize(numRows);
+
+	// Find the envelope of the lower triangle
+	long offset = -1;
+	for (int i = 0; i < numRows; i++) {
+		int first = i;
+		for (long k = matrix.rowOffsets[i]; k < matrix.rowOffsets[i+1]; k++) {
+			first = min(first, matrix.columns[k]);
+		}
+		firstColumns[i] = first;
+		offset += i - first + 1;
+		diagonals[i] = offset;
+	}
+
+	// Load the lower triangle of the matrix into the envelope
+	factors.assign(offset + 1, 0.0);
+	for (int i = 0; i < numRows; i++) {
+		for (long k = matrix.rowOffsets[i]; k < matrix.rowOffsets[i+1]; k++) {
+			int j = matrix.columns[k];
+			if (j <= i) factors[diagonals[i] - (i - j)] = matrix.values[k];
+		}
+	}
+
+	// Factor row by row. Entry (i,j) only needs the entries of rows i and j
+	// that are inside both envelopes. Column k of row i is at rowI + k.
+	double * L = factors.data();
+	for (int i = 0; i < numRows; i++) {
+		long rowI = diagonals[i] - i;
+		for (int j = firstColumns[i]; j <= i; j++) {
+			long rowJ = diagonals[j] - j;
+			int first = max(firstColumns[i], firstColumns[j]);
+			double sum = L[rowI + j];
+			for (int k = first; k < j; k++) sum -= L[rowI + k]*L[rowJ + k];
+			if (j < i) {
+				L[rowI + j] = sum/L[rowJ + j];
+			} else if (sum > 0.0) {
+				L[rowI + i] = sqrt(sum);
+			} else {
+				diagonals.clear();
+				throw runtime_error("SkylineCholesky matrix is not positive "
+						"definite.");
+			}
+		}
+	}
+
+	return;
+}
+
+void SkylineCholesky::solve(const vector<double> & b, vector<double> & x) const {
+
+	if (!factored()) {
+		throw runtime_error("SkylineCholesky matrix has not been factored.");
+	} else if ((int) b.size() != numRows) {
+		throw runtime_error("SkylineCholesky right hand side has the wrong "
+				"size.");
+	}
+	if (&x != &b) x = b;
+
+	// Forward substitution, Ly = b
+	const double * L = factors.data();
+	for (int i = 0; i < numRows; i++) {
+		long row = diagonals[i] - i;
+		double sum = x[i];
+		for (int k = firstColumns[i]; k < i; k++) sum -= L[row + k]*x[k];
+		x[i] = sum/L[row + i];
+	}
+
+	// Back substitution, L^T x = y, by columns of L^T (rows of L)
+	for (int i = numRows - 1; i >= 0; i--) {
+		long row = diagonals[i] - i;
+		x[i] /= L[row + i];
+		double xi = x[i];
+		for (int k = firstColumns[i]; k < i; k++) x[k] -= L[row + k]*xi;
+	}
+
+	return;
+}
+
+} /* namespace fire */
@@ -0,0 +1,132 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#ifndef SOLVERS_SKYLINECHOLESKY_H_
+#define SOLVERS_SKYLINECHOLESKY_H_
+
+#include <vector>
+#include <CSRMatrix.h>
+
+namespace fire {
+
+/**
+ * This class factors sparse, symmetric positive definite matrices as
+ * \f[
+ * A = LL^{T}
+ * \f]
+ * and solves systems with the factors. L is stored in skyline (envelope)
+ * form: row i holds the entries from the first nonzero column of row i of A
+ * up to the diagonal. Fill-in only occurs inside this envelope, so the
+ * storage and work depend on the profile of the matrix, which is small for
+ * well-numbered meshes.
+ *
+ * The factorization is the expensive step and the solve is cheap, so the
+ * factors should be reused for as long as the matrix does not change, for
+ * example across the time steps of a linear transient problem:
+ * @code
+ * SkylineCholesky cholesky;
+ * cholesky.factor(matrix);
+ * for (int step = 0; step < numSteps; step++) {
+ *     ...
+ *     cholesky.solve(b, x);
+ * }
+ * @endcode
+ * Only the lower triangle of the matrix is read.
+ */
+class SkylineCholesky {
+
+protected:
+
+	/**
+	 * The number of rows in the matrix.
+	 */
+	int numRows = 0;
+
+	/**
+	 * The first column stored in each row.
+	 */
+	std::vector<int> firstColumns;
+
+	/**
+	 * The offset of the diagonal of each row in the factor. The entries of
+	 * row i are stored before its diagonal, so column j of row i is at
+	 * diagonals[i] - (i - j).
+	 */
+	std::vector<long> diagonals;
+
+	/**
+	 * The entries of L.
+	 */
+	std::vector<double> factors;
+
+public:
+
+	/**
+	 * This operation factors a matrix, replacing any previous factors.
+	 * @param matrix the symmetric positive definite matrix
+	 * @throw std::runtime_error if the matrix is not positive definite
+	 */
+	void factor(const CSRMatrix<double> & matrix);
+
+	/**
+	 * This operation solves Ax = b with the factors.
+	 * @param b the right hand side
+	 * @param x the solution, which is resized if required. It may be the same
+	 * vector as b.
+	 * @throw std::runtime_error if the matrix has not been factored or b has
+	 * the wrong size
+	 */
+	void solve(const std::vector<double> & b, std::vector<double> & x) const;
+
+	/**
+	 * This operation returns true if a matrix has been factored.
+	 * @return true if factored, false otherwise
+	 */
+	bool factored() const { return !diagonals.empty();};
+
+	/**
+	 * This operation returns the size of the factored matrix.
+	 * @return the number of rows
+	 */
+	int size() const { return numRows;};
+
+	/**
+	 * This operation returns the number of entries stored in the envelope of
+	 * the factors, which determines the cost of the factorization and solves.
+	 * @return the number of entries
+	 */
+	long profile() const { return factors.size();};
+
+};
+
+} /* namespace fire */
+
+#endif /* SOLVERS_SKYLINECHOLESKY_H_ */
@@ -0,0 +1,261 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#ifndef SOLVERS_SOLVEREVENT_H_
+#define SOLVERS_SOLVEREVENT_H_
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <math.h>
+
+namespace fire {
+
+/**
+ * The actions that a solver takes when an event triggers.
+ *
+ * STOP ends the integration at the time of the event, leaving the State at
+ * that time.
+ *
+ * FREEZE ends the integration at the time of the event but advances t to the
+ * final time with the unknowns held at their values at the event. This is the
+ * cheap mode for systems that have reached a steady state: nothing is
+ * integrated and monitors are not notified again.
+ *
+ * CONTINUE records the event and continues the integration.
+ */
+enum class EventAction {STOP, FREEZE, CONTINUE};
+
+/**
+ * This structure describes an event that solvers locate during an
+ * integration. The event function g(t,u,dudt) is evaluated along the
+ * solution and the event triggers when g crosses zero in the requested
+ * direction. Solvers also check the event at the initial time, where a
+ * directional event triggers immediately if g is already on the far side of
+ * zero, so that systems that start at a steady state are not integrated.
+ *
+ * The event functions are called with the size of the system and arrays of
+ * that size for the unknowns and their derivatives. They must not modify the
+ * arrays. The helper functions below create the common events, but any
+ * function can be used, for example:
+ * @code
+ * SolverEvent event;
+ * event.name = "hot";
+ * event.function = [](const double & t, const double * u,
+ *		const double * dudt, const int & size) {
+ *	return u[0] - 10.0;
+ * };
+ * event.direction = 1;
+ * event.action = EventAction::STOP;
+ * solver.addEvent(event);
+ * @endcode
+ */
+struct SolverEvent {
+
+	/**
+	 * The name of the event, which is recorded when it triggers.
+	 */
+	std::string name;
+
+	/**
+	 * The event function g(t,u,dudt).
+	 */
+	std::function<double(const double &, const double *, const double *,
+			const int &)> function;
+
+	/**
+	 * The direction of the zero crossings that trigger the event: -1 for
+	 * decreasing g, 1 for increasing g and 0 for both.
+	 */
+	int direction = 0;
+
+	/**
+	 * The action taken when the event triggers.
+	 */
+	EventAction action = EventAction::STOP;
+
+	/**
+	 * This operation returns true if the value of the event function at the
+	 * initial time is already on the far side of zero. This is only possible
+	 * for directional events.
+	 * @param g the value of the event function
+	 * @return true if the event is satisfied
+	 */
+	bool satisfiedAtStart(const double & g) const {
+		return (direction < 0 && g <= 0.0) || (direction > 0 && g >= 0.0);
+	}
+
+	/**
+	 * This operation returns true if the event function crossed zero in the
+	 * event's direction between two values.
+	 * @param gOld the value at the start of the interval
+	 * @param gNew the value at the end of the interval
+	 * @return true if the event triggered in the interval
+	 */
+	bool crossed(const double & gOld, const double & gNew) const {
+		bool down = gOld > 0.0 && gNew <= 0.0;
+		bool up = gOld < 0.0 && gNew >= 0.0;
+		return (direction <= 0 && down) || (direction >= 0 && up);
+	}
+};
+
+/**
+ * This structure records an event that triggered during a solve.
+ */
+struct EventRecord {
+
+	/**
+	 * The name of the event.
+	 */
+	std::string name;
+
+	/**
+	 * The value of t at which the event triggered.
+	 */
+	double t;
+
+	/**
+	 * The action that was taken.
+	 */
+	EventAction action;
+};
+
+/**
+ * This structure is returned by solvers to describe how a solve ended.
+ */
+struct SolveResult {
+
+	/**
+	 * The value of t at the end of the solve. This is the final time unless
+	 * an event stopped the integration.
+	 */
+	double t = 0.0;
+
+	/**
+	 * True if an event ended the integration before the final time, either
+	 * by stopping it or by freezing the State.
+	 */
+	bool terminatedEarly = false;
+
+	/**
+	 * The name of the event that ended the integration, or empty if it ran to
+	 * the final time.
+	 */
+	std::string reason;
+
+	/**
+	 * The value of t at which the integration ended, which is less than t if
+	 * the State was frozen.
+	 */
+	double terminationT = 0.0;
+
+	/**
+	 * All of the events that triggered, in order.
+	 */
+	std::vector<EventRecord> events;
+
+	/**
+	 * This operation records an event and, if its action ends the
+	 * integration, the reason.
+	 * @param event the event
+	 * @param t the value of t at which it triggered
+	 * @return true if the integration should end
+	 */
+	bool record(const SolverEvent & event, const double & t) {
+		events.push_back({event.name, t, event.action});
+		if (event.action == EventAction::CONTINUE) return false;
+		terminatedEarly = true;
+		reason = event.name;
+		terminationT = t;
+		return true;
+	}
+};
+
+/**
+ * This operation creates an event that detects a steady state, when the norm
+ * of the derivatives relative to the norm of the unknowns
+ * \f[
+ * \frac{\|du/dt\|_{2}}{\|u\|_{2}}
+ * \f]
+ * falls below a threshold, which has units of inverse t.
+ * @param threshold the threshold
+ * @param action the action, which is FREEZE by default
+ * @return the event
+ */
+inline SolverEvent steadyStateEvent(const double & threshold,
+		const EventAction & action = EventAction::FREEZE) {
+	SolverEvent event;
+	event.name = "steady state";
+	event.function = [threshold](const double &, const double * u,
+			const double * dudt, const int & size) {
+		double uNorm = 0.0, dudtNorm = 0.0;
+		for (int i = 0; i < size; i++) {
+			uNorm += u[i]*u[i];
+			dudtNorm += dudt[i]*dudt[i];
+		}
+		uNorm = sqrt(uNorm);
+		dudtNorm = sqrt(dudtNorm);
+		return (uNorm > 0.0) ? dudtNorm/uNorm - threshold : dudtNorm - threshold;
+	};
+	event.direction = -1;
+	event.action = action;
+	return event;
+}
+
+/**
+ * This operation creates an event that triggers when one of the unknowns
+ * crosses a threshold, such as a mass fraction or abundance falling below a
+ * given value.
+ * @param name the name of the event
+ * @param index the index of the unknown in the array returned by State.u()
+ * @param value the threshold
+ * @param direction -1 to trigger when the unknown falls below the threshold,
+ * 1 to trigger when it rises above it and 0 for both.
+ * @param action the action, which is STOP by default
+ * @return the event
+ */
+inline SolverEvent thresholdEvent(const std::string & name, const int & index,
+		const double & value, const int & direction,
+		const EventAction & action = EventAction::STOP) {
+	SolverEvent event;
+	event.name = name;
+	event.function = [index,value](const double &, const double * u,
+			const double *, const int &) {
+		return u[index] - value;
+	};
+	event.direction = direction;
+	event.action = action;
+	return event;
+}
+
+} /* namespace fire */
+
+#endif /* SOLVERS_SOLVEREVENT_H_ */
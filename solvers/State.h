@@ -37,6 +37,7 @@
 #include <utility>
 #include <functional>
 #include <vector>
+#include <cmath>
 #include <build.h>
 
 namespace fire {
@@ -358,6 +359,97 @@ public:
 		throw "Operation not implemented for this type.";
 	}
 
+	/**
+	 * This operation computes the product of the Jacobian of dudt(t) with
+	 * respect to u and the vector v without forming the Jacobian. It is used
+	 * by iterative (Krylov) solvers that only need the action of the
+	 * Jacobian.
+	 *
+	 * The default implementation uses a first order finite difference
+	 * \f[
+	 * Jv \approx \frac{f(t,u + \sigma v) - f(t,u)}{\sigma}
+	 * \f]
+	 * with the perturbation sigma scaled by the norms of u and v, so it works
+	 * for any type that implements u() and dudt(). Types that know the
+	 * structure of their Jacobian should override this operation with an
+	 * explicit specialization. Note that the default implementation calls
+	 * u(double *) twice, so monitors are notified.
+	 *
+	 * @param t the value of the free variable at which the product is computed
+	 * @param v the vector that should be multiplied, of size State.size()
+	 * @param jvData the product, of size State.size(), which is set on exit
+	 */
+	void jv(const double & t, const double * v, double * jvData) {
+		// Store the current state and derivatives
+		double * uLoc = u();
+		std::vector<double> uSaved(uLoc, uLoc + systemSize);
+		double * f = dudt(t);
+		std::vector<double> fSaved(f, f + systemSize);
+		// Compute the perturbation
+		double uNorm = 0.0, vNorm = 0.0;
+		for (int i = 0; i < systemSize; i++) {
+			uNorm += uSaved[i]*uSaved[i];
+			vNorm += v[i]*v[i];
+		}
+		if (vNorm == 0.0) {
+			for (int i = 0; i < systemSize; i++) jvData[i] = 0.0;
+			return;
+		}
+		double sigma = 1.0e-8*(1.0 + std::sqrt(uNorm))/std::sqrt(vNorm);
+		// Evaluate the perturbed derivatives
+		std::vector<double> uTrial(systemSize);
+		for (int i = 0; i < systemSize; i++) {
+			uTrial[i] = uSaved[i] + sigma*v[i];
+		}
+		u(uTrial.data());
+		f = dudt(t);
+		for (int i = 0; i < systemSize; i++) {
+			jvData[i] = (f[i] - fSaved[i])/sigma;
+		}
+		// Restore the original state
+		u(uSaved.data());
+		return;
+	}
+
+	/**
+	 * This operation computes an approximation of the diagonal of the
+	 * Jacobian of dudt(t) with respect to u at the current state. It is used
+	 * to build cheap (Jacobi) preconditioners for iterative solvers.
+	 *
+	 * The default implementation does not provide a diagonal and returns
+	 * false, in which case solvers should not precondition the system. Types
+	 * that can compute the diagonal cheaply should override this operation
+	 * with an explicit specialization and return true.
+	 *
+	 * @param t the value of the free variable at which the diagonal is computed
+	 * @param diag the diagonal, of size State.size(), which is set on exit if
+	 * this operation returns true
+	 * @return true if the diagonal was computed, false otherwise
+	 */
+	bool jacobianDiagonal(const double & t, double * diag) {
+		return false;
+	}
+
+	/**
+	 * This operation returns the parameters of the state: the values, other
+	 * than t and u, that are required to reproduce dudt(t). For example, the
+	 * temperature and density of a reaction network. It is used to write
+	 * checkpoints of the state. The default implementation has no parameters.
+	 * @return the parameters
+	 */
+	std::vector<double> parameters() {
+		return std::vector<double>();
+	}
+
+	/**
+	 * This operation sets the parameters of the state from the values
+	 * returned by parameters(). It is used to restart from checkpoints. The
+	 * default implementation ignores the parameters and does nothing.
+	 */
+	void parameters(const std::vector<double> &) {
+		return;
+	}
+
 	/**
 	 * This operation explicitly sets the number of unique data elements in the
 	 * state. At present this value is constant for all values of t.
@@ -0,0 +1,350 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#ifndef SOLVERS_THREADPOOL_H_
+#define SOLVERS_THREADPOOL_H_
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+#include <exception>
+
+namespace fire {
+
+/**
+ * This class is a small, persistent pool of worker threads for data-parallel
+ * loops over large arrays, such as the vector operations in the solvers. The
+ * threads are created once and sleep between loops, so the cost of each
+ * parallel loop is a wake up and a join instead of thread creation.
+ *
+ * Work is distributed as contiguous, equally sized ranges - one per thread -
+ * so that each thread streams through its own block of memory and the inner
+ * loops can be vectorized by the compiler. The calling thread always works on
+ * the first range. Loops that are too short to benefit from threading are
+ * executed serially on the calling thread.
+ *
+ * The pool is used as follows:
+ * @code
+ * ThreadPool pool(4);
+ * pool.parallelFor(0, n, [&](long begin, long end) {
+ *     for (long i = begin; i < end; i++) z[i] = a*x[i] + y[i];
+ * });
+ * double dot = pool.parallelReduce(0, n, 0.0, [&](long begin, long end) {
+ *     double sum = 0.0;
+ *     for (long i = begin; i < end; i++) sum += x[i]*y[i];
+ *     return sum;
+ * }, std::plus<double>());
+ * @endcode
+ *
+ * The minimum number of iterations per thread - the grain - can be given
+ * for each loop, so modules with very different amounts of work per
+ * iteration can all share one pool, such as shared(), instead of creating
+ * pools of their own. Loops from different threads are serialized. A loop
+ * that is started from the body of another loop on the same pool runs
+ * serially on the thread that started it.
+ *
+ * If the body throws on any thread, the loop still waits for every thread
+ * to finish its range and then rethrows the exception of the lowest
+ * numbered thread that failed on the calling thread. The pool remains
+ * usable afterwards.
+ */
+class ThreadPool {
+
+protected:
+
+	/**
+	 * The worker threads. The calling thread acts as thread zero, so there is
+	 * one fewer worker than the total number of threads.
+	 */
+	std::vector<std::thread> workers;
+
+	/**
+	 * The lock that guards the task and the counters.
+	 */
+	std::mutex taskMutex;
+
+	/**
+	 * The lock that serializes loops started from different threads.
+	 */
+	std::mutex loopMutex;
+
+	/**
+	 * The condition used to wake the workers when a new task is available.
+	 */
+	std::condition_variable taskReady;
+
+	/**
+	 * The condition used to notify the calling thread that the workers are
+	 * finished.
+	 */
+	std::condition_variable taskDone;
+
+	/**
+	 * The current task. It is called with the id of the thread.
+	 */
+	std::function<void(const int &)> task;
+
+	/**
+	 * The generation of the current task, used by the workers to detect that
+	 * a new task is available.
+	 */
+	long generation = 0;
+
+	/**
+	 * The number of workers that have not yet finished the current task.
+	 */
+	int remaining = 0;
+
+	/**
+	 * The exception thrown by each thread during the current task, if any.
+	 */
+	std::vector<std::exception_ptr> failures;
+
+	/**
+	 * True if the pool is being destroyed.
+	 */
+	bool stopping = false;
+
+	/**
+	 * The minimum number of iterations assigned to each thread by default.
+	 */
+	long grain;
+
+	/**
+	 * This operation returns the pool whose loop body the current thread is
+	 * executing, or null if it is not executing one.
+	 * @return the pool
+	 */
+	static const ThreadPool * & activePool() {
+		static thread_local const ThreadPool * pool = nullptr;
+		return pool;
+	}
+
+	/**
+	 * This is the main loop of each worker.
+	 * @param id the id of the worker's thread
+	 */
+	void work(const int id) {
+		long seen = 0;
+		std::unique_lock<std::mutex> lock(taskMutex);
+		while (true) {
+			taskReady.wait(lock,
+					[&] {return stopping || generation != seen;});
+			if (stopping) return;
+			seen = generation;
+			lock.unlock();
+			activePool() = this;
+			try {
+				task(id);
+			} catch (...) {
+				failures[id] = std::current_exception();
+			}
+			activePool() = nullptr;
+			lock.lock();
+			if (--remaining == 0) taskDone.notify_one();
+		}
+	}
+
+	/**
+	 * This operation executes the function on every thread and waits for
+	 * all of them to finish. The first exception thrown by any of them is
+	 * rethrown after they have all finished.
+	 * @param func the function, which is called with the id of each thread
+	 */
+	void run(const std::function<void(const int &)> & func) {
+		{
+			std::lock_guard<std::mutex> lock(taskMutex);
+			task = func;
+			remaining = workers.size();
+			generation++;
+		}
+		taskReady.notify_all();
+		activePool() = this;
+		try {
+			func(0);
+		} catch (...) {
+			failures[0] = std::current_exception();
+		}
+		activePool() = nullptr;
+		// The workers hold references to the caller's frame, so they must
+		// finish before anything is thrown
+		std::exception_ptr failure;
+		{
+			std::unique_lock<std::mutex> lock(taskMutex);
+			taskDone.wait(lock, [&] {return remaining == 0;});
+			for (auto & error : failures) {
+				if (error && !failure) failure = error;
+				error = nullptr;
+			}
+		}
+		if (failure) std::rethrow_exception(failure);
+	}
+
+	/**
+	 * This operation computes the number of ranges that a loop should be
+	 * split into.
+	 * @param length the number of iterations in the loop
+	 * @param minIterations the minimum number of iterations per thread, or
+	 * zero for the default of the pool
+	 * @return the number of ranges, which is one for serial execution
+	 */
+	int numRanges(const long & length, const long & minIterations) const {
+		if (activePool() == this) return 1;
+		long loopGrain = (minIterations > 0) ? minIterations : grain;
+		long ranges = std::min<long>(size(), length/loopGrain);
+		return std::max<long>(1, ranges);
+	}
+
+public:
+
+	/**
+	 * Constructor
+	 * @param numThreads the total number of threads, including the calling
+	 * thread. If zero, the hardware concurrency is used.
+	 * @param minIterations the default minimum number of iterations assigned
+	 * to each thread. Loops shorter than twice this are executed serially.
+	 */
+	ThreadPool(const int & numThreads = 0, const long & minIterations = 16384) :
+			grain(std::max<long>(1, minIterations)) {
+		int count = (numThreads > 0) ?
+				numThreads : std::max(1u, std::thread::hardware_concurrency());
+		failures.resize(count);
+		for (int i = 1; i < count; i++) {
+			workers.emplace_back(&ThreadPool::work, this, i);
+		}
+	}
+
+	/**
+	 * Destructor. It stops and joins all of the workers.
+	 */
+	~ThreadPool() {
+		{
+			std::lock_guard<std::mutex> lock(taskMutex);
+			stopping = true;
+		}
+		taskReady.notify_all();
+		for (auto & worker : workers) worker.join();
+	}
+
+	ThreadPool(const ThreadPool &) = delete;
+	ThreadPool & operator=(const ThreadPool &) = delete;
+
+	/**
+	 * This operation returns the total number of threads in the pool,
+	 * including the calling thread.
+	 * @return the number of threads
+	 */
+	int size() const { return workers.size() + 1;};
+
+	/**
+	 * This operation executes a loop over [begin,end) in parallel.
+	 * @param begin the first index
+	 * @param end one past the last index
+	 * @param body the body of the loop, which is called once per thread with
+	 * the subrange [begin,end) that the thread should process.
+	 * @param minIterations the minimum number of iterations assigned to each
+	 * thread, or zero for the default of the pool
+	 */
+	void parallelFor(const long & begin, const long & end,
+			const std::function<void(const long &, const long &)> & body,
+			const long & minIterations = 0) {
+		long length = end - begin;
+		int ranges = numRanges(length, minIterations);
+		if (ranges == 1) {
+			if (length > 0) body(begin, end);
+			return;
+		}
+		std::lock_guard<std::mutex> lock(loopMutex);
+		run([&](const int & id) {
+			if (id < ranges) {
+				body(begin + (length*id)/ranges, begin + (length*(id + 1))/ranges);
+			}
+		});
+	}
+
+	/**
+	 * This operation executes a reduction over [begin,end) in parallel. The
+	 * partial results from each thread are combined in thread order, so the
+	 * result is deterministic for a given number of threads.
+	 * @param begin the first index
+	 * @param end one past the last index
+	 * @param init the initial value of the result
+	 * @param body the body of the loop, which returns the partial result for
+	 * the subrange [begin,end)
+	 * @param combine the function that combines two partial results
+	 * @param minIterations the minimum number of iterations assigned to each
+	 * thread, or zero for the default of the pool
+	 * @return the combined result
+	 */
+	template<typename R>
+	R parallelReduce(const long & begin, const long & end, const R & init,
+			const std::function<R(const long &, const long &)> & body,
+			const std::function<R(const R &, const R &)> & combine,
+			const long & minIterations = 0) {
+		long length = end - begin;
+		int ranges = numRanges(length, minIterations);
+		if (ranges == 1) {
+			return (length > 0) ? combine(init, body(begin, end)) : init;
+		}
+		std::vector<R> partials(ranges, init);
+		{
+			std::lock_guard<std::mutex> lock(loopMutex);
+			run([&](const int & id) {
+				if (id < ranges) {
+					partials[id] = body(begin + (length*id)/ranges,
+							begin + (length*(id + 1))/ranges);
+				}
+			});
+		}
+		R result = init;
+		for (auto & partial : partials) result = combine(result, partial);
+		return result;
+	}
+
+	/**
+	 * This operation returns a pool that is shared by all of the solvers and
+	 * assemblers in the process. It is created on first use with one thread
+	 * per hardware thread.
+	 * @return the shared pool
+	 */
+	static ThreadPool & shared() {
+		static ThreadPool pool;
+		return pool;
+	}
+
+};
+
+} /* namespace fire */
+
+#endif /* SOLVERS_THREADPOOL_H_ */
@@ -79,7 +79,7 @@ void PrintOutput(const realtype & t, const realtype & umax, const long int & nst
 
 //----------- Replace with metrics tracking! ---------------///
 /* Get and print some final statistics */
-void PrintFinalStats(void *cvode_mem)
+void PrintFinalStats(void *cvode_mem, bool iterative)
 {
   int flag;
   long int nst, nfe, nsetups, netf, nni, ncfn, nje, nfeLS;
@@ -97,6 +97,29 @@ void PrintFinalStats(void *cvode_mem)
   flag = CVodeGetNumNonlinSolvConvFails(cvode_mem, &ncfn);
   check_flag(&flag, "CVodeGetNumNonlinSolvConvFails", 1);
 
+  if (iterative) {
+    long int nli, npe, nps, ncfl;
+    flag = CVSpilsGetNumJtimesEvals(cvode_mem, &nje);
+    check_flag(&flag, "CVSpilsGetNumJtimesEvals", 1);
+    flag = CVSpilsGetNumLinIters(cvode_mem, &nli);
+    check_flag(&flag, "CVSpilsGetNumLinIters", 1);
+    flag = CVSpilsGetNumPrecEvals(cvode_mem, &npe);
+    check_flag(&flag, "CVSpilsGetNumPrecEvals", 1);
+    flag = CVSpilsGetNumPrecSolves(cvode_mem, &nps);
+    check_flag(&flag, "CVSpilsGetNumPrecSolves", 1);
+    flag = CVSpilsGetNumConvFails(cvode_mem, &ncfl);
+    check_flag(&flag, "CVSpilsGetNumConvFails", 1);
+
+    printf("\nFinal Statistics:\n");
+    printf("nst = %-6ld nfe  = %-6ld nsetups = %-6ld njtv = %ld\n",
+	   nst, nfe, nsetups, nje);
+    printf("nli = %-6ld npe  = %-6ld nps = %-6ld ncfl = %ld\n",
+	   nli, npe, nps, ncfl);
+    printf("nni = %-6ld ncfn = %-6ld netf = %ld\n \n",
+	   nni, ncfn, netf);
+    return;
+  }
+
   flag = CVDlsGetNumJacEvals(cvode_mem, &nje);
   check_flag(&flag, "CVDlsGetNumJacEvals", 1);
   flag = CVDlsGetNumRhsEvals(cvode_mem, &nfeLS);
@@ -33,12 +33,15 @@
 #define SOLVERS_FIRE_CVODE_FUNCTIONS_H_
 
 #include <State.h>
+#include <SolverEvent.h>
 #include <cvode/cvode.h>             /* prototypes for CVODE fcts., consts. */
 #include <cvode/cvode_dense.h>        /* prototype for CVBand */
+#include <cvode/cvode_spgmr.h>       /* prototypes for CVSpgmr and CVSpils */
 #include <nvector/nvector_serial.h>  /* serial N_Vector types, fcts., macros */
 #include <sundials/sundials_band.h>  /* definitions of type DlsMat and macros */
 #include <sundials/sundials_types.h> /* definition of type realtype */
 #include <sundials/sundials_math.h>  /* definition of ABS and EXP */
+#include <vector>
 
 namespace fire {
 namespace cvode {
@@ -61,7 +64,7 @@ namespace cvode {
 /* Helper Functions */
 void PrintHeader(realtype reltol, realtype abstol, realtype umax, double t);
 void PrintOutput(const realtype & t, const realtype & umax, const long int & nst);
-void PrintFinalStats(void *cvode_mem);
+void PrintFinalStats(void *cvode_mem, bool iterative = false);
 /* Function to check function return values */
 int check_flag(void *flagvalue, char *funcname, int opt);
 
@@ -71,6 +74,50 @@ int check_flag(void *flagvalue, char *funcname, int opt);
  *-------------------------------
  */
 
+/**
+ * This is the user data that is passed through CVODE to the functions below.
+ * It holds the user's state, the events that CVODE's root finder locates and
+ * the storage for the preconditioner, which must persist between the
+ * preconditioner setup and solve calls.
+ */
+template<typename T>
+struct SolverData {
+
+	/**
+	 * The user's state.
+	 */
+	State<T> & state;
+
+	/**
+	 * The diagonal of the Jacobian at the last preconditioner setup.
+	 */
+	std::vector<double> jacobianDiagonal;
+
+	/**
+	 * The diagonal of the preconditioner, P = I - gamma*diag(J), at the last
+	 * preconditioner setup.
+	 */
+	std::vector<double> preconditioner;
+
+	/**
+	 * True if the state provides the diagonal of its Jacobian.
+	 */
+	bool hasDiagonal = true;
+
+	/**
+	 * The events that are located during the solve, if any.
+	 */
+	const std::vector<SolverEvent> * events = nullptr;
+
+	/**
+	 * Constructor
+	 * @param the state
+	 */
+	SolverData(State<T> & userState) : state(userState),
+			jacobianDiagonal(userState.size()),
+			preconditioner(userState.size()) {};
+};
+
 /**
  * This operation pulls the initial conditions from the state and provides them
  * to the solver.
@@ -83,7 +130,7 @@ void setICs(N_Vector u, State<T> & state) {
 	  realtype *udata;
 
 	  /* Set pointer to data array in vector u. */
-	  udata = NV_DATA_S(u);
+	  udata = N_VGetArrayPointer(u);
 
 	  // Get the user's state data.
 	  auto * stateU = state.u();
@@ -109,10 +156,10 @@ template<typename T>
 int f(realtype t, N_Vector u,N_Vector udot, void *user_data) {
   realtype *udata, *dudata;
   int i, j;
-  State<T> * state = reinterpret_cast<State<T> *>(user_data);
+  State<T> * state = &(reinterpret_cast<SolverData<T> *>(user_data)->state);
 
-  udata = NV_DATA_S(u);
-  dudata = NV_DATA_S(udot);
+  udata = N_VGetArrayPointer(u);
+  dudata = N_VGetArrayPointer(udot);
 
   // Update the state with the test values of u.
   state->u(udata);
@@ -127,6 +174,119 @@ int f(realtype t, N_Vector u,N_Vector udot, void *user_data) {
   return(0);
 }
 
+/**
+ * This function evaluates the event functions for CVODE's root finder.
+ * @param the time
+ * @param the vector u of current state values in the system
+ * @param the values of the event functions, updated in place
+ * @param the user data, which is reinterpreted as SolverData<T>.
+ */
+template<typename T>
+int g(realtype t, N_Vector u, realtype *gout, void *user_data) {
+  auto * data = reinterpret_cast<SolverData<T> *>(user_data);
+  realtype * udata = N_VGetArrayPointer(u);
+  int size = data->state.size();
+
+  // Update the state and compute the derivatives for the event functions
+  data->state.u(udata);
+  auto * rhs = data->state.dudt(t);
+  for (int i = 0; i < (int) data->events->size(); i++) {
+      gout[i] = (*data->events)[i].function(t, udata, rhs, size);
+  }
+
+  return(0);
+}
+
+/**
+ * This function computes the product of the Jacobian and the vector v for
+ * the Krylov solver by delegating to State.jv().
+ * @param the vector v
+ * @param the product Jv, updated in place
+ * @param the time
+ * @param the vector u of current state values in the system
+ * @param the values of f(t,u), unused
+ * @param the user data, which is reinterpreted as SolverData<T>.
+ * @param a temporary vector, unused
+ */
+template<typename T>
+int jtv(N_Vector v, N_Vector Jv, realtype t, N_Vector u, N_Vector fu,
+		void *user_data, N_Vector tmp) {
+	State<T> & state = reinterpret_cast<SolverData<T> *>(user_data)->state;
+
+	// Make sure the state is evaluated at u and compute the product
+	state.u(N_VGetArrayPointer(u));
+	state.jv(t, N_VGetArrayPointer(v), N_VGetArrayPointer(Jv));
+
+	return(0);
+}
+
+/**
+ * This function sets up the Jacobi preconditioner P = I - gamma*diag(J) for
+ * the Krylov solver. The diagonal of the Jacobian is only recomputed if CVODE
+ * indicates that the previous one is out of date. If the state does not
+ * provide the diagonal, P = I.
+ * @param the time
+ * @param the vector u of current state values in the system
+ * @param the values of f(t,u), unused
+ * @param true if the previous Jacobian data can be reused
+ * @param flag that is set to true if the Jacobian data was recomputed
+ * @param the scalar gamma in the Newton matrix I - gamma*J
+ * @param the user data, which is reinterpreted as SolverData<T>.
+ */
+template<typename T>
+int precSetup(realtype t, N_Vector u, N_Vector fu, booleantype jok,
+		booleantype *jcurPtr, realtype gamma, void *user_data,
+		N_Vector tmp1, N_Vector tmp2, N_Vector tmp3) {
+	SolverData<T> * data = reinterpret_cast<SolverData<T> *>(user_data);
+	int size = data->state.size();
+
+	// Recompute the diagonal if needed
+	if (jok) {
+		*jcurPtr = FALSE;
+	} else {
+		data->state.u(N_VGetArrayPointer(u));
+		data->hasDiagonal = data->state.jacobianDiagonal(t,
+				data->jacobianDiagonal.data());
+		*jcurPtr = TRUE;
+	}
+
+	// Compute the preconditioner for this value of gamma
+	for (int i = 0; i < size; i++) {
+		double p = (data->hasDiagonal) ?
+				1.0 - gamma*data->jacobianDiagonal[i] : 1.0;
+		data->preconditioner[i] = (p != 0.0) ? p : 1.0;
+	}
+
+	return(0);
+}
+
+/**
+ * This function solves Pz = r with the Jacobi preconditioner computed by
+ * precSetup().
+ * @param the time, unused
+ * @param the vector u of current state values in the system, unused
+ * @param the values of f(t,u), unused
+ * @param the right hand side r
+ * @param the solution z, updated in place
+ * @param the scalar gamma, unused
+ * @param the tolerance, unused
+ * @param the preconditioner side, unused
+ * @param the user data, which is reinterpreted as SolverData<T>.
+ */
+template<typename T>
+int precSolve(realtype t, N_Vector u, N_Vector fu, N_Vector r, N_Vector z,
+		realtype gamma, realtype delta, int lr, void *user_data, N_Vector tmp) {
+	SolverData<T> * data = reinterpret_cast<SolverData<T> *>(user_data);
+	realtype * rdata = N_VGetArrayPointer(r), * zdata = N_VGetArrayPointer(z);
+	int size = data->state.size();
+
+	for (int i = 0; i < size; i++) {
+		zdata[i] = rdata[i]/data->preconditioner[i];
+	}
+
+	return(0);
+}
+
 } /* end namespace cvode */
 } /* end namespace fire */
 
@@ -0,0 +1,388 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2015-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#include <fire_nvector.h>
+#include <stdlib.h>
+#include <math.h>
+#include <algorithm>
+#include <functional>
+
+namespace fire {
+namespace nvector {
+
+/*
+ *-------------------------------
+ * Private helper functions
+ *-------------------------------
+ */
+
+/**
+ * This operation returns the content of a vector.
+ */
+static inline Content * content(N_Vector v) {
+	return static_cast<Content *>(v->content);
+}
+
+/**
+ * This operation returns the length of a vector.
+ */
+static inline long length(N_Vector v) {
+	return content(v)->length;
+}
+
+/**
+ * This operation returns the pool of a vector.
+ */
+static inline ThreadPool & pool(N_Vector v) {
+	return *(content(v)->pool);
+}
+
+/**
+ * This operation computes the sum of f over the elements of a vector in
+ * parallel.
+ */
+static realtype sum(N_Vector v,
+		const std::function<realtype(const long &, const long &)> & f) {
+	return pool(v).parallelReduce<realtype>(0, length(v), 0.0, f,
+			std::plus<realtype>());
+}
+
+/**
+ * This operation computes the maximum of f over the elements of a vector in
+ * parallel.
+ */
+static realtype maximum(N_Vector v, const realtype & init,
+		const std::function<realtype(const long &, const long &)> & f) {
+	return pool(v).parallelReduce<realtype>(0, length(v), init, f,
+			[](const realtype & a, const realtype & b) {return std::max(a,b);});
+}
+
+/*
+ *-------------------------------
+ * Vector operations
+ *-------------------------------
+ */
+
+static N_Vector cloneEmpty(N_Vector w) {
+	if (w == NULL) return NULL;
+	N_Vector v = new _generic_N_Vector();
+	v->ops = new _generic_N_Vector_Ops(*(w->ops));
+	Content * c = new Content(*content(w));
+	c->ownData = false;
+	c->data = NULL;
+	v->content = c;
+	return v;
+}
+
+static N_Vector clone(N_Vector w) {
+	N_Vector v = cloneEmpty(w);
+	if (v == NULL) return NULL;
+	void * storage = NULL;
+	long size = std::max(1L, length(w))*sizeof(realtype);
+	if (posix_memalign(&storage, alignment, size) != 0) {
+		destroyVector(v);
+		return NULL;
+	}
+	content(v)->data = static_cast<realtype *>(storage);
+	content(v)->ownData = true;
+	return v;
+}
+
+static void space(N_Vector v, long int * lrw, long int * liw) {
+	*lrw = length(v);
+	*liw = 2;
+}
+
+static realtype * getArrayPointer(N_Vector v) {
+	return content(v)->data;
+}
+
+static void setArrayPointer(realtype * v_data, N_Vector v) {
+	content(v)->data = v_data;
+}
+
+static void linearSum(realtype a, N_Vector x, realtype b, N_Vector y,
+		N_Vector z) {
+	realtype * xd = data(x), * yd = data(y), * zd = data(z);
+	pool(z).parallelFor(0, length(z), [&](const long & begin, const long & end) {
+		for (long i = begin; i < end; i++) zd[i] = a*xd[i] + b*yd[i];
+	});
+}
+
+static void constant(realtype c, N_Vector z) {
+	realtype * zd = data(z);
+	pool(z).parallelFor(0, length(z), [&](const long & begin, const long & end) {
+		for (long i = begin; i < end; i++) zd[i] = c;
+	});
+}
+
+static void product(N_Vector x, N_Vector y, N_Vector z) {
+	realtype * xd = data(x), * yd = data(y), * zd = data(z);
+	pool(z).parallelFor(0, length(z), [&](const long & begin, const long & end) {
+		for (long i = begin; i < end; i++) zd[i] = xd[i]*yd[i];
+	});
+}
+
+static void divide(N_Vector x, N_Vector y, N_Vector z) {
+	realtype * xd = data(x), * yd = data(y), * zd = data(z);
+	pool(z).parallelFor(0, length(z), [&](const long & begin, const long & end) {
+		for (long i = begin; i < end; i++) zd[i] = xd[i]/yd[i];
+	});
+}
+
+static void scale(realtype c, N_Vector x, N_Vector z) {
+	realtype * xd = data(x), * zd = data(z);
+	pool(z).parallelFor(0, length(z), [&](const long & begin, const long & end) {
+		for (long i = begin; i < end; i++) zd[i] = c*xd[i];
+	});
+}
+
+static void absolute(N_Vector x, N_Vector z) {
+	realtype * xd = data(x), * zd = data(z);
+	pool(z).parallelFor(0, length(z), [&](const long & begin, const long & end) {
+		for (long i = begin; i < end; i++) zd[i] = fabs(xd[i]);
+	});
+}
+
+static void inverse(N_Vector x, N_Vector z) {
+	realtype * xd = data(x), * zd = data(z);
+	pool(z).parallelFor(0, length(z), [&](const long & begin, const long & end) {
+		for (long i = begin; i < end; i++) zd[i] = 1.0/xd[i];
+	});
+}
+
+static void addConstant(N_Vector x, realtype b, N_Vector z) {
+	realtype * xd = data(x), * zd = data(z);
+	pool(z).parallelFor(0, length(z), [&](const long & begin, const long & end) {
+		for (long i = begin; i < end; i++) zd[i] = xd[i] + b;
+	});
+}
+
+static realtype dotProduct(N_Vector x, N_Vector y) {
+	realtype * xd = data(x), * yd = data(y);
+	return sum(x, [&](const long & begin, const long & end) {
+		realtype s = 0.0;
+		for (long i = begin; i < end; i++) s += xd[i]*yd[i];
+		return s;
+	});
+}
+
+static realtype maxNorm(N_Vector x) {
+	realtype * xd = data(x);
+	return maximum(x, 0.0, [&](const long & begin, const long & end) {
+		realtype m = 0.0;
+		for (long i = begin; i < end; i++) m = std::max(m, (realtype) fabs(xd[i]));
+		return m;
+	});
+}
+
+static realtype wrmsNorm(N_Vector x, N_Vector w) {
+	realtype * xd = data(x), * wd = data(w);
+	realtype s = sum(x, [&](const long & begin, const long & end) {
+		realtype s = 0.0;
+		for (long i = begin; i < end; i++) {
+			realtype p = xd[i]*wd[i];
+			s += p*p;
+		}
+		return s;
+	});
+	return sqrt(s/length(x));
+}
+
+static realtype wrmsNormMask(N_Vector x, N_Vector w, N_Vector id) {
+	realtype * xd = data(x), * wd = data(w), * idd = data(id);
+	realtype s = sum(x, [&](const long & begin, const long & end) {
+		realtype s = 0.0;
+		for (long i = begin; i < end; i++) {
+			realtype p = (idd[i] > 0.0) ? xd[i]*wd[i] : 0.0;
+			s += p*p;
+		}
+		return s;
+	});
+	return sqrt(s/length(x));
+}
+
+static realtype minimum(N_Vector x) {
+	realtype * xd = data(x);
+	// The minimum is the negative of the maximum of the negatives.
+	return -maximum(x, -xd[0], [&](const long & begin, const long & end) {
+		realtype m = -xd[begin];
+		for (long i = begin; i < end; i++) m = std::max(m, -xd[i]);
+		return m;
+	});
+}
+
+static realtype wl2Norm(N_Vector x, N_Vector w) {
+	realtype * xd = data(x), * wd = data(w);
+	return sqrt(sum(x, [&](const long & begin, const long & end) {
+		realtype s = 0.0;
+		for (long i = begin; i < end; i++) {
+			realtype p = xd[i]*wd[i];
+			s += p*p;
+		}
+		return s;
+	}));
+}
+
+static realtype l1Norm(N_Vector x) {
+	realtype * xd = data(x);
+	return sum(x, [&](const long & begin, const long & end) {
+		realtype s = 0.0;
+		for (long i = begin; i < end; i++) s += fabs(xd[i]);
+		return s;
+	});
+}
+
+static void compare(realtype c, N_Vector x, N_Vector z) {
+	realtype * xd = data(x), * zd = data(z);
+	pool(z).parallelFor(0, length(z), [&](const long & begin, const long & end) {
+		for (long i = begin; i < end; i++) zd[i] = (fabs(xd[i]) >= c) ? 1.0 : 0.0;
+	});
+}
+
+static booleantype invTest(N_Vector x, N_Vector z) {
+	realtype * xd = data(x), * zd = data(z);
+	// Count the zeros while inverting
+	realtype zeros = sum(x, [&](const long & begin, const long & end) {
+		realtype count = 0.0;
+		for (long i = begin; i < end; i++) {
+			if (xd[i] == 0.0) {
+				count += 1.0;
+			} else {
+				zd[i] = 1.0/xd[i];
+			}
+		}
+		return count;
+	});
+	return (zeros == 0.0) ? TRUE : FALSE;
+}
+
+static booleantype constrMask(N_Vector c, N_Vector x, N_Vector m) {
+	realtype * cd = data(c), * xd = data(x), * md = data(m);
+	// Count the violated constraints while setting the mask
+	realtype violations = sum(x, [&](const long & begin, const long & end) {
+		realtype count = 0.0;
+		for (long i = begin; i < end; i++) {
+			md[i] = 0.0;
+			if (cd[i] == 0.0) continue;
+			bool strict = fabs(cd[i]) > 1.5;
+			bool violated = (cd[i] > 0.0) ?
+					(strict ? xd[i] <= 0.0 : xd[i] < 0.0) :
+					(strict ? xd[i] >= 0.0 : xd[i] > 0.0);
+			if (violated) {
+				md[i] = 1.0;
+				count += 1.0;
+			}
+		}
+		return count;
+	});
+	return (violations == 0.0) ? TRUE : FALSE;
+}
+
+static realtype minQuotient(N_Vector num, N_Vector denom) {
+	realtype * nd = data(num), * dd = data(denom);
+	// BIG_REAL is returned if all of the denominators are zero.
+	realtype m = maximum(num, -BIG_REAL, [&](const long & begin, const long & end) {
+		realtype m = -BIG_REAL;
+		for (long i = begin; i < end; i++) {
+			if (dd[i] != 0.0) m = std::max(m, -nd[i]/dd[i]);
+		}
+		return m;
+	});
+	return -m;
+}
+
+/*
+ *-------------------------------
+ * Public functions
+ *-------------------------------
+ */
+
+N_Vector makeVector(const long & length, realtype * data, ThreadPool & pool) {
+	N_Vector v = new _generic_N_Vector();
+	// Unused operations are left NULL by value initialization.
+	N_Vector_Ops ops = new _generic_N_Vector_Ops();
+	ops->nvclone = clone;
+	ops->nvcloneempty = cloneEmpty;
+	ops->nvdestroy = destroyVector;
+	ops->nvspace = space;
+	ops->nvgetarraypointer = getArrayPointer;
+	ops->nvsetarraypointer = setArrayPointer;
+	ops->nvlinearsum = linearSum;
+	ops->nvconst = constant;
+	ops->nvprod = product;
+	ops->nvdiv = divide;
+	ops->nvscale = scale;
+	ops->nvabs = absolute;
+	ops->nvinv = inverse;
+	ops->nvaddconst = addConstant;
+	ops->nvdotprod = dotProduct;
+	ops->nvmaxnorm = maxNorm;
+	ops->nvwrmsnorm = wrmsNorm;
+	ops->nvwrmsnormmask = wrmsNormMask;
+	ops->nvmin = minimum;
+	ops->nvwl2norm = wl2Norm;
+	ops->nvl1norm = l1Norm;
+	ops->nvcompare = compare;
+	ops->nvinvtest = invTest;
+	ops->nvconstrmask = constrMask;
+	ops->nvminquotient = minQuotient;
+	v->ops = ops;
+	Content * c = new Content();
+	c->length = length;
+	c->ownData = false;
+	c->data = data;
+	c->pool = &pool;
+	v->content = c;
+	return v;
+}
+
+N_Vector newVector(const long & length, ThreadPool & pool) {
+	// Build an empty template and clone it to get aligned storage
+	N_Vector empty = makeVector(length, NULL, pool);
+	N_Vector v = clone(empty);
+	destroyVector(empty);
+	return v;
+}
+
+void destroyVector(N_Vector v) {
+	if (v == NULL) return;
+	Content * c = content(v);
+	if (c != NULL) {
+		if (c->ownData) free(c->data);
+		delete c;
+	}
+	delete v->ops;
+	delete v;
+}
+
+} /* namespace nvector */
+} /* namespace fire */
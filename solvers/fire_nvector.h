@@ -0,0 +1,118 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#ifndef SOLVERS_FIRE_NVECTOR_H_
+#define SOLVERS_FIRE_NVECTOR_H_
+
+#include <ThreadPool.h>
+#include <sundials/sundials_nvector.h> /* generic N_Vector types and ops */
+#include <sundials/sundials_types.h>   /* definition of type realtype */
+
+namespace fire {
+namespace nvector {
+
+/**
+ * This is the content of Fire's N_Vector implementation. The data is stored
+ * contiguously on cache line aligned storage and every operation is executed
+ * in parallel by the thread pool, with simple unit stride loops that the
+ * compiler can vectorize on each thread.
+ *
+ * The data may either be owned by the vector or aliased from an existing
+ * buffer, such as the array returned by State.u(), in which case it is not
+ * copied or freed.
+ */
+struct Content {
+
+	/**
+	 * The number of elements in the vector.
+	 */
+	long length;
+
+	/**
+	 * True if the vector owns and should free its data.
+	 */
+	bool ownData;
+
+	/**
+	 * The data of the vector.
+	 */
+	realtype * data;
+
+	/**
+	 * The thread pool used to execute the vector operations.
+	 */
+	ThreadPool * pool;
+};
+
+/**
+ * The alignment of the storage allocated by the vectors, in bytes.
+ */
+constexpr int alignment = 64;
+
+/**
+ * This operation creates a new vector with its own aligned storage.
+ * @param length the number of elements in the vector
+ * @param pool the thread pool that executes the vector operations
+ * @return the new vector or NULL if the allocation failed
+ */
+N_Vector newVector(const long & length, ThreadPool & pool = ThreadPool::shared());
+
+/**
+ * This operation creates a new vector that aliases existing storage. The
+ * storage is not copied or freed by the vector and must outlive it. This is
+ * used to integrate directly into the buffers of a State without copies.
+ * @param length the number of elements in the vector
+ * @param data the existing storage
+ * @param pool the thread pool that executes the vector operations
+ * @return the new vector or NULL if the allocation failed
+ */
+N_Vector makeVector(const long & length, realtype * data,
+		ThreadPool & pool = ThreadPool::shared());
+
+/**
+ * This operation destroys a vector created by newVector() or makeVector().
+ * @param v the vector
+ */
+void destroyVector(N_Vector v);
+
+/**
+ * This operation returns the data array of a vector.
+ * @param v the vector
+ * @return the data
+ */
+inline realtype * data(N_Vector v) {
+	return static_cast<Content *>(v->content)->data;
+}
+
+} /* namespace nvector */
+} /* namespace fire */
+
+#endif /* SOLVERS_FIRE_NVECTOR_H_ */
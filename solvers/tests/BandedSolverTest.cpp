@@ -0,0 +1,159 @@
+
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE BandedSolver
+
+#include <boost/test/included/unit_test.hpp>
+#include <BandedSolver.h>
+#include <SkylineCholesky.h>
+#include <GraphOrdering.h>
+#include <CSRMatrix.h>
+#include <vector>
+#include <cmath>
+
+using namespace std;
+using namespace fire;
+
+/**
+ * This operation creates the matrix of an n by n grid with a five point
+ * stencil, numbered row by row, with the given coefficients for the center
+ * and the west, east, south and north neighbors.
+ */
+static CSRMatrix<double> gridMatrix(const int & n, const double & center,
+		const double & west, const double & east, const double & south,
+		const double & north) {
+	vector<pair<int,int>> entries;
+	for (int j = 0; j < n; j++) {
+		for (int i = 0; i < n; i++) {
+			int id = j*n + i;
+			entries.emplace_back(id,id);
+			if (i > 0) entries.emplace_back(id,id-1);
+			if (i < n-1) entries.emplace_back(id,id+1);
+			if (j > 0) entries.emplace_back(id,id-n);
+			if (j < n-1) entries.emplace_back(id,id+n);
+		}
+	}
+	CSRMatrix<double> matrix(n*n,entries);
+	for (int i = 0; i < n*n; i++) {
+		for (long k = matrix.rowOffsets[i]; k < matrix.rowOffsets[i+1]; k++) {
+			int j = matrix.columns[k];
+			matrix.values[k] = (j == i) ? center : (j == i-1) ? west :
+					(j == i+1) ? east : (j == i-n) ? south : north;
+		}
+	}
+	return matrix;
+}
+
+/**
+ * This operation checks the banded Cholesky factorization against the
+ * skyline factorization.
+ */
+BOOST_AUTO_TEST_CASE(checkCholesky) {
+
+	int n = 25;
+	CSRMatrix<double> matrix = gridMatrix(n,4.0,-1.0,-1.0,-1.0,-1.0);
+	vector<double> x(n*n), b;
+	for (int i = 0; i < n*n; i++) x[i] = cos(0.05*i) + 2.0;
+	matrix.multiply(x,b);
+
+	BandedSolver solver;
+	BOOST_REQUIRE(!solver.factored());
+	BOOST_REQUIRE_THROW(solver.solve(b,x),std::runtime_error);
+	solver.factor(matrix);
+	BOOST_REQUIRE(solver.factored());
+	BOOST_REQUIRE_EQUAL(n*n,solver.size());
+	BOOST_REQUIRE_EQUAL(n,solver.bandwidth());
+	BOOST_REQUIRE_EQUAL((n + 1)*n*n,solver.storage());
+
+	vector<double> result;
+	solver.solve(b,result);
+	for (int i = 0; i < n*n; i++) BOOST_REQUIRE_CLOSE(x[i],result[i],1.0e-10);
+
+	// The same as the skyline factors
+	SkylineCholesky cholesky;
+	cholesky.factor(matrix);
+	vector<double> skylineResult;
+	cholesky.solve(b,skylineResult);
+	for (int i = 0; i < n*n; i++) {
+		BOOST_REQUIRE_CLOSE(skylineResult[i],result[i],1.0e-10);
+	}
+
+	// In place
+	result = b;
+	solver.solve(result,result);
+	for (int i = 0; i < n*n; i++) BOOST_REQUIRE_CLOSE(x[i],result[i],1.0e-10);
+	BOOST_REQUIRE_THROW(solver.solve(vector<double>(3),result),
+			std::runtime_error);
+
+	// Indefinite matrices are rejected
+	CSRMatrix<double> indefinite = gridMatrix(4,1.0,-1.0,-1.0,-1.0,-1.0);
+	BOOST_REQUIRE_THROW(solver.factor(indefinite),std::runtime_error);
+	BOOST_REQUIRE(!solver.factored());
+
+	return;
+}
+
+/**
+ * This operation checks the banded LU factorization on a nonsymmetric
+ * convection-diffusion matrix, after Reverse Cuthill-McKee ordering.
+ */
+BOOST_AUTO_TEST_CASE(checkLU) {
+
+	int n = 20;
+	CSRMatrix<double> matrix = gridMatrix(n,4.0,-1.6,-0.4,-1.3,-0.7);
+	vector<int> order = reverseCuthillMcKee(matrix);
+	CSRMatrix<double> reordered = permute(matrix,order);
+	vector<double> x(n*n), b;
+	for (int i = 0; i < n*n; i++) x[i] = sin(0.3*i) + 2.0;
+	matrix.multiply(x,b);
+
+	BandedSolver solver;
+	if (!BandedSolver::lapackAvailable()) {
+		BOOST_REQUIRE_THROW(solver.factor(reordered,BandedFactorization::LU),
+				std::runtime_error);
+		return;
+	}
+	solver.factor(reordered,BandedFactorization::LU);
+	BOOST_REQUIRE(solver.bandwidth() <= n + 1);
+	vector<double> result;
+	solver.solve(permute(b,order),result);
+	result = unpermute(result,order);
+	for (int i = 0; i < n*n; i++) BOOST_REQUIRE_CLOSE(x[i],result[i],1.0e-10);
+
+	// Singular matrices are rejected
+	CSRMatrix<double> singular = gridMatrix(3,0.0,0.0,0.0,0.0,0.0);
+	BOOST_REQUIRE_THROW(solver.factor(singular,BandedFactorization::LU),
+			std::runtime_error);
+
+	return;
+}
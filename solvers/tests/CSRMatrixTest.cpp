@@ -0,0 +1,92 @@
+
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE CSRMatrix
+
+#include <boost/test/included/unit_test.hpp>
+#include <CSRMatrix.h>
+#include <vector>
+#include <utility>
+
+using namespace std;
+using namespace fire;
+
+/**
+ * This operation checks that the sparsity pattern is built correctly from
+ * unsorted entries with duplicates and that values can be found, set and
+ * multiplied.
+ */
+BOOST_AUTO_TEST_CASE(checkCSRMatrix) {
+
+	// Tridiagonal 4x4 matrix with the entries out of order and duplicated
+	vector<pair<int,int>> entries = {{3,3},{0,1},{0,0},{1,0},{1,1},{1,2},
+			{2,1},{2,2},{2,3},{3,2},{1,1},{0,0}};
+	CSRMatrix<double> matrix(4,entries);
+	BOOST_REQUIRE_EQUAL(4,matrix.size());
+	BOOST_REQUIRE_EQUAL(10,matrix.nonZeros());
+	vector<long> offsets = {0,2,5,8,10};
+	vector<int> columns = {0,1,0,1,2,1,2,3,2,3};
+	BOOST_REQUIRE(offsets == matrix.rowOffsets);
+	BOOST_REQUIRE(columns == matrix.columns);
+
+	// Slots
+	BOOST_REQUIRE_EQUAL(0,matrix.slot(0,0));
+	BOOST_REQUIRE_EQUAL(4,matrix.slot(1,2));
+	BOOST_REQUIRE_EQUAL(9,matrix.slot(3,3));
+	BOOST_REQUIRE_EQUAL(-1,matrix.slot(0,3));
+	BOOST_REQUIRE_EQUAL(-1,matrix.slot(3,0));
+
+	// Fill in the 1D Laplacian and multiply
+	for (int i = 0; i < 4; i++) {
+		matrix.values[matrix.slot(i,i)] = 2.0;
+		if (i > 0) matrix.values[matrix.slot(i,i-1)] = -1.0;
+		if (i < 3) matrix.values[matrix.slot(i,i+1)] = -1.0;
+	}
+	BOOST_REQUIRE_EQUAL(-1.0,matrix(2,3));
+	BOOST_REQUIRE_EQUAL(0.0,matrix(0,3));
+	vector<double> x = {1.0,2.0,3.0,4.0}, y;
+	matrix.multiply(x,y);
+	vector<double> yRef = {0.0,0.0,0.0,5.0};
+	BOOST_REQUIRE(yRef == y);
+
+	// Zeroing keeps the pattern
+	matrix.zero();
+	BOOST_REQUIRE_EQUAL(10,matrix.nonZeros());
+	BOOST_REQUIRE_EQUAL(0.0,matrix(1,1));
+
+	// Out of range entries are rejected
+	entries.push_back({4,0});
+	BOOST_REQUIRE_THROW(CSRMatrix<double>(4,entries),out_of_range);
+
+	return;
+}
@@ -0,0 +1,118 @@
+
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Checkpoint
+
+#include <boost/test/included/unit_test.hpp>
+#include <Checkpoint.h>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+using namespace std;
+using namespace fire;
+
+/**
+ * This operation creates a checkpoint with recognizable values.
+ */
+static Checkpoint testCheckpoint(const double & t) {
+	Checkpoint cp;
+	cp.solver = "TestSolver";
+	cp.t = t;
+	cp.u = {1.0, 2.0, 3.0};
+	cp.parameters = {7.0, 1.0e8};
+	cp.stepSize = 1.0e-3;
+	cp.order = 4;
+	cp.history = {{4.0, 5.0, 6.0}, {7.0, 8.0, 9.0}};
+	cp.counters = {1, 2, 3};
+	cp.values = {0.5, 0.25};
+	return cp;
+}
+
+/**
+ * This operation checks that checkpoints are written and read back exactly.
+ */
+BOOST_AUTO_TEST_CASE(checkReadWrite) {
+
+	string fileName = "checkpoint_test.bin";
+	Checkpoint written = testCheckpoint(0.125), read;
+	written.write(fileName);
+	read.read(fileName);
+
+	BOOST_REQUIRE_EQUAL(written.solver,read.solver);
+	BOOST_REQUIRE_EQUAL(written.t,read.t);
+	BOOST_REQUIRE(written.u == read.u);
+	BOOST_REQUIRE(written.parameters == read.parameters);
+	BOOST_REQUIRE_EQUAL(written.stepSize,read.stepSize);
+	BOOST_REQUIRE_EQUAL(written.order,read.order);
+	BOOST_REQUIRE(written.history == read.history);
+	BOOST_REQUIRE(written.counters == read.counters);
+	BOOST_REQUIRE(written.values == read.values);
+
+	// Missing and invalid files should throw
+	BOOST_REQUIRE_THROW(read.read("no_such_checkpoint.bin"),runtime_error);
+	{
+		ofstream out("bad_checkpoint.bin");
+		out << "This is not a checkpoint.";
+	}
+	BOOST_REQUIRE_THROW(read.read("bad_checkpoint.bin"),runtime_error);
+
+	return;
+}
+
+/**
+ * This operation checks that the asynchronous writer writes the checkpoints
+ * in order and reports errors.
+ */
+BOOST_AUTO_TEST_CASE(checkWriter) {
+
+	string fileName = "checkpoint_writer_test.bin";
+	CheckpointWriter writer;
+	for (int i = 0; i < 10; i++) {
+		writer.write(testCheckpoint(i),fileName);
+	}
+	writer.wait();
+	// The last checkpoint wins
+	Checkpoint read;
+	read.read(fileName);
+	BOOST_REQUIRE_EQUAL(9.0,read.t);
+
+	// Errors are reported on the next wait
+	writer.write(testCheckpoint(0.0),"no_such_directory/checkpoint.bin");
+	BOOST_REQUIRE_THROW(writer.wait(),runtime_error);
+	// and then cleared.
+	writer.wait();
+
+	return;
+}
@@ -0,0 +1,219 @@
+
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE GraphOrdering
+
+#include <boost/test/included/unit_test.hpp>
+#include <GraphOrdering.h>
+#include <SkylineCholesky.h>
+#include <CSRMatrix.h>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+using namespace fire;
+
+/**
+ * This operation creates the five point Laplacian of an n by n grid, plus a
+ * shift that makes it positive definite, with the grid points numbered in a
+ * random order.
+ */
+static CSRMatrix<double> shuffledLaplacian(const int & n) {
+	vector<int> ids(n*n);
+	for (int k = 0; k < n*n; k++) ids[k] = k;
+	shuffle(ids.begin(), ids.end(), mt19937(42));
+	auto id = [&](int i, int j) { return ids[j*n + i];};
+	vector<pair<int,int>> entries;
+	for (int j = 0; j < n; j++) {
+		for (int i = 0; i < n; i++) {
+			entries.emplace_back(id(i,j),id(i,j));
+			if (i > 0) entries.emplace_back(id(i,j),id(i-1,j));
+			if (i < n-1) entries.emplace_back(id(i,j),id(i+1,j));
+			if (j > 0) entries.emplace_back(id(i,j),id(i,j-1));
+			if (j < n-1) entries.emplace_back(id(i,j),id(i,j+1));
+		}
+	}
+	CSRMatrix<double> matrix(n*n,entries);
+	for (int i = 0; i < n*n; i++) {
+		for (long k = matrix.rowOffsets[i]; k < matrix.rowOffsets[i+1]; k++) {
+			matrix.values[k] = (matrix.columns[k] == i) ? 4.1 : -1.0;
+		}
+	}
+	return matrix;
+}
+
+/**
+ * This operation checks that Reverse Cuthill-McKee reduces the bandwidth of
+ * a randomly numbered grid to about the width of the grid.
+ */
+BOOST_AUTO_TEST_CASE(checkReverseCuthillMcKee) {
+
+	int n = 30;
+	CSRMatrix<double> matrix = shuffledLaplacian(n);
+	BOOST_REQUIRE(bandwidth(matrix) > 10*n);
+
+	vector<int> order = reverseCuthillMcKee(matrix);
+	BOOST_REQUIRE_EQUAL(n*n,order.size());
+	vector<int> newIndex = inversePermutation(order);
+	CSRMatrix<double> permuted = permute(matrix,order);
+	BOOST_REQUIRE_EQUAL(matrix.nonZeros(),permuted.nonZeros());
+	BOOST_REQUIRE(bandwidth(permuted) <= n + 1);
+	for (int i = 0; i < n*n; i++) {
+		for (long k = matrix.rowOffsets[i]; k < matrix.rowOffsets[i+1]; k++) {
+			BOOST_REQUIRE_EQUAL(matrix.values[k],
+					permuted(newIndex[i],newIndex[matrix.columns[k]]));
+		}
+	}
+
+	// The same product in both numberings
+	vector<double> x(n*n), y, permutedY;
+	for (int i = 0; i < n*n; i++) x[i] = sin(0.1*i);
+	matrix.multiply(x,y);
+	permuted.multiply(permute(x,order),permutedY);
+	vector<double> result = unpermute(permutedY,order);
+	for (int i = 0; i < n*n; i++) BOOST_REQUIRE_CLOSE(y[i],result[i],1.0e-12);
+
+	// The skyline factors are much smaller and give the same solution
+	SkylineCholesky original, reordered;
+	original.factor(matrix);
+	reordered.factor(permuted);
+	BOOST_REQUIRE(reordered.profile() < original.profile()/5);
+	vector<double> solution, permutedSolution;
+	original.solve(y,solution);
+	reordered.solve(permute(y,order),permutedSolution);
+	result = unpermute(permutedSolution,order);
+	for (int i = 0; i < n*n; i++) {
+		BOOST_REQUIRE_CLOSE(solution[i] + 2.0,result[i] + 2.0,1.0e-10);
+		BOOST_REQUIRE_CLOSE(x[i] + 2.0,result[i] + 2.0,1.0e-10);
+	}
+
+	return;
+}
+
+/**
+ * This operation checks graphs with several components and isolated
+ * vertices, and the checks and moves of permutations.
+ */
+BOOST_AUTO_TEST_CASE(checkComponents) {
+
+	// A path 0-2-4, an isolated vertex 1 and an edge 3-5
+	vector<long> offsets = {0, 1, 1, 3, 4, 5, 6};
+	vector<int> neighbors = {2, 0, 4, 5, 2, 3};
+	vector<int> order = reverseCuthillMcKee(offsets,neighbors);
+	BOOST_REQUIRE_EQUAL(6,order.size());
+	vector<int> sorted(order);
+	sort(sorted.begin(),sorted.end());
+	for (int k = 0; k < 6; k++) BOOST_REQUIRE_EQUAL(k,sorted[k]);
+	// The path is numbered contiguously and in order
+	vector<int> newIndex = inversePermutation(order);
+	BOOST_REQUIRE_EQUAL(1,abs(newIndex[0] - newIndex[2]));
+	BOOST_REQUIRE_EQUAL(1,abs(newIndex[4] - newIndex[2]));
+	BOOST_REQUIRE_EQUAL(1,abs(newIndex[3] - newIndex[5]));
+
+	BOOST_REQUIRE_THROW(inversePermutation({0,0,1}),std::runtime_error);
+	BOOST_REQUIRE_THROW(inversePermutation({0,3,1}),std::runtime_error);
+	checkOrder({2,0,1},3);
+	BOOST_REQUIRE_THROW(checkOrder({0,0,1},3),std::runtime_error);
+	BOOST_REQUIRE_THROW(checkOrder({0,1},3),std::runtime_error);
+	vector<double> blocks = {0.0, 0.5, 1.0, 1.5, 2.0, 2.5};
+	reorder(blocks,vector<long>({2,0,1}),2);
+	vector<double> expected = {2.0, 2.5, 0.0, 0.5, 1.0, 1.5};
+	for (int k = 0; k < 6; k++) BOOST_REQUIRE_EQUAL(expected[k],blocks[k]);
+	BOOST_REQUIRE_THROW(permute(shuffledLaplacian(2),{0,1}),
+			std::runtime_error);
+	BOOST_REQUIRE(reverseCuthillMcKee(vector<long>(1,0),vector<int>()).empty());
+
+	return;
+}
+
+/**
+ * This operation checks that recursive bisection splits a grid into
+ * connected parts of equal size with short cuts.
+ */
+BOOST_AUTO_TEST_CASE(checkRecursiveBisection) {
+
+	int n = 30, numParts = 5;
+	CSRMatrix<double> matrix = shuffledLaplacian(n);
+	vector<int> parts = recursiveBisection(matrix.rowOffsets,matrix.columns,
+			numParts);
+	BOOST_REQUIRE_EQUAL(n*n,parts.size());
+
+	vector<int> sizes(numParts,0);
+	for (int part : parts) {
+		BOOST_REQUIRE(part >= 0 && part < numParts);
+		sizes[part]++;
+	}
+	for (int size : sizes) BOOST_REQUIRE(abs(size - n*n/numParts) <= 1);
+
+	// Count the edges between parts, which a random split would cut about
+	// 80% of
+	int cut = 0;
+	for (int i = 0; i < n*n; i++) {
+		for (long k = matrix.rowOffsets[i]; k < matrix.rowOffsets[i+1]; k++) {
+			if (parts[matrix.columns[k]] != parts[i]) cut++;
+		}
+	}
+	BOOST_REQUIRE(cut/2 < 6*n);
+
+	// Each part is connected
+	for (int part = 0; part < numParts; part++) {
+		vector<bool> reached(n*n,false);
+		vector<int> queue;
+		for (int i = 0; i < n*n && queue.empty(); i++) {
+			if (parts[i] == part) queue.push_back(i);
+		}
+		reached[queue[0]] = true;
+		for (long q = 0; q < (long) queue.size(); q++) {
+			int i = queue[q];
+			for (long k = matrix.rowOffsets[i]; k < matrix.rowOffsets[i+1];
+					k++) {
+				int j = matrix.columns[k];
+				if (parts[j] == part && !reached[j]) {
+					reached[j] = true;
+					queue.push_back(j);
+				}
+			}
+		}
+		BOOST_REQUIRE_EQUAL(sizes[part],queue.size());
+	}
+
+	// One part and errors
+	parts = recursiveBisection(matrix.rowOffsets,matrix.columns,1);
+	for (int part : parts) BOOST_REQUIRE_EQUAL(0,part);
+	BOOST_REQUIRE_THROW(recursiveBisection(matrix.rowOffsets,matrix.columns,0),
+			std::runtime_error);
+
+	return;
+}
@@ -0,0 +1,207 @@
+
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE PCGSolver
+
+#include <boost/test/included/unit_test.hpp>
+#include <PCGSolver.h>
+#include <Preconditioner.h>
+#include <CSRMatrix.h>
+#include <vector>
+#include <memory>
+#include <math.h>
+
+using namespace std;
+using namespace fire;
+
+/**
+ * This operation creates the five point Laplacian with Dirichlet boundaries
+ * on an m x m grid, which is symmetric positive definite.
+ */
+static CSRMatrix<double> laplacian(const int & m) {
+	int n = m*m;
+	vector<pair<int,int>> entries;
+	auto neighbors = [&](int i, int j, const function<void(int,double)> & add) {
+		int k = i + m*j;
+		add(k,4.0);
+		if (i > 0) add(k-1,-1.0);
+		if (i < m-1) add(k+1,-1.0);
+		if (j > 0) add(k-m,-1.0);
+		if (j < m-1) add(k+m,-1.0);
+	};
+	for (int j = 0; j < m; j++) {
+		for (int i = 0; i < m; i++) {
+			neighbors(i,j,[&](int col, double) {
+				entries.emplace_back(i + m*j,col);
+			});
+		}
+	}
+	CSRMatrix<double> matrix(n,entries);
+	for (int j = 0; j < m; j++) {
+		for (int i = 0; i < m; i++) {
+			neighbors(i,j,[&](int col, double value) {
+				matrix.values[matrix.slot(i + m*j,col)] = value;
+			});
+		}
+	}
+	return matrix;
+}
+
+/**
+ * This operation checks that PCG solves the Laplacian with each
+ * preconditioner, that the history is consistent and that the better
+ * preconditioners take fewer iterations.
+ */
+BOOST_AUTO_TEST_CASE(checkSolve) {
+	int m = 40, n = m*m;
+	auto matrix = laplacian(m);
+	vector<double> exact(n), b;
+	for (int k = 0; k < n; k++) exact[k] = sin(0.01*k) + 2.0;
+	matrix.multiply(exact,b);
+
+	// Use a pool that splits short loops to exercise the threading
+	ThreadPool pool(4,64);
+	PCGSolver solver(pool);
+	BOOST_REQUIRE_CLOSE(1.0e-8,solver.tolerance(),1.0e-12);
+	BOOST_REQUIRE_EQUAL(10000,solver.maxIterations());
+	solver.tolerance(1.0e-10);
+
+	vector<unique_ptr<IPreconditioner>> preconditioners;
+	preconditioners.emplace_back(new JacobiPreconditioner(matrix,pool));
+	preconditioners.emplace_back(new SSORPreconditioner(matrix,1.5));
+	preconditioners.emplace_back(new IncompleteCholeskyPreconditioner(matrix));
+
+	// Unpreconditioned first
+	vector<double> x;
+	auto plain = solver.solve(matrix,b,x);
+	BOOST_REQUIRE(plain.converged);
+	vector<int> iterations = {plain.iterations};
+	for (auto & preconditioner : preconditioners) {
+		x.assign(n,0.0);
+		auto result = solver.solve(matrix,b,x,*preconditioner);
+		BOOST_REQUIRE(result.converged);
+		BOOST_REQUIRE_EQUAL(result.iterations + 1,result.history.size());
+		BOOST_REQUIRE_EQUAL(result.residualNorm,result.history.back());
+		for (int k = 0; k < n; k++) BOOST_REQUIRE_CLOSE(exact[k],x[k],1.0e-6);
+		// Check the true residual
+		vector<double> ax;
+		matrix.multiply(x,ax);
+		double rNorm = 0.0, bNorm = 0.0;
+		for (int k = 0; k < n; k++) {
+			rNorm += (b[k] - ax[k])*(b[k] - ax[k]);
+			bNorm += b[k]*b[k];
+		}
+		BOOST_REQUIRE(sqrt(rNorm) < 1.0e-9*sqrt(bNorm));
+		iterations.push_back(result.iterations);
+	}
+	// Jacobi is the same as nothing for a constant diagonal
+	BOOST_REQUIRE(abs(iterations[1] - iterations[0]) <= 1);
+	BOOST_REQUIRE(iterations[2] < iterations[1]);
+	BOOST_REQUIRE(iterations[3] < iterations[1]);
+
+	// Starting from the solution takes no iterations
+	auto again = solver.solve(matrix,b,x,*preconditioners[2]);
+	BOOST_REQUIRE(again.converged);
+	BOOST_REQUIRE_EQUAL(0,again.iterations);
+
+	// Running out of iterations is reported
+	solver.maxIterations(3);
+	x.assign(n,0.0);
+	auto limited = solver.solve(matrix,b,x);
+	BOOST_REQUIRE(!limited.converged);
+	BOOST_REQUIRE_EQUAL(3,limited.iterations);
+
+	// b = 0 gives x = 0
+	vector<double> zero(n,0.0);
+	auto trivial = solver.solve(matrix,zero,x);
+	BOOST_REQUIRE(trivial.converged);
+	for (auto & value : x) BOOST_REQUIRE_EQUAL(0.0,value);
+
+	return;
+}
+
+/**
+ * This is the five point Laplacian of an m x m grid, applied without a
+ * matrix.
+ */
+class LaplacianOperator : public ILinearOperator {
+public:
+	int m;
+	LaplacianOperator(const int & gridSize) : m(gridSize) {};
+	virtual int size() const { return m*m;};
+	virtual void multiply(const vector<double> & x, vector<double> & y) const {
+		y.resize(m*m);
+		for (int j = 0; j < m; j++) {
+			for (int i = 0; i < m; i++) {
+				int k = i + m*j;
+				y[k] = 4.0*x[k] - ((i > 0) ? x[k-1] : 0.0)
+						- ((i < m-1) ? x[k+1] : 0.0) - ((j > 0) ? x[k-m] : 0.0)
+						- ((j < m-1) ? x[k+m] : 0.0);
+			}
+		}
+	};
+};
+
+/**
+ * This operation checks that solving with a linear operator gives the same
+ * iterations as solving with the assembled matrix.
+ */
+BOOST_AUTO_TEST_CASE(checkOperator) {
+	int m = 30, n = m*m;
+	auto matrix = laplacian(m);
+	LaplacianOperator laplacianOperator(m);
+	vector<double> b(n), x, y;
+	for (int k = 0; k < n; k++) b[k] = cos(0.05*k);
+
+	PCGSolver solver;
+	solver.tolerance(1.0e-10);
+	JacobiPreconditioner jacobi(vector<double>(n,4.0));
+	auto assembled = solver.solve(matrix,b,x,jacobi);
+	auto free = solver.solve(laplacianOperator,b,y,jacobi);
+	BOOST_REQUIRE(free.converged);
+	BOOST_REQUIRE_EQUAL(assembled.iterations,free.iterations);
+	for (int k = 0; k < n; k++) BOOST_REQUIRE_CLOSE(x[k],y[k],1.0e-8);
+
+	// The adapter for assembled matrices
+	CSRMatrixOperator csrOperator(matrix);
+	BOOST_REQUIRE_EQUAL(n,csrOperator.size());
+	y.assign(n,0.0);
+	auto adapted = solver.solve(csrOperator,b,y);
+	BOOST_REQUIRE(adapted.converged);
+	for (int k = 0; k < n; k++) BOOST_REQUIRE_CLOSE(x[k],y[k],1.0e-7);
+
+	BOOST_REQUIRE_THROW(JacobiPreconditioner(vector<double>(3,0.0)),
+			runtime_error);
+
+	return;
+}
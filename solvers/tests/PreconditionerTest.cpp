@@ -0,0 +1,200 @@
+
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Preconditioner
+
+#include <boost/test/included/unit_test.hpp>
+#include <Preconditioner.h>
+#include <CSRMatrix.h>
+#include <vector>
+#include <stdexcept>
+#include <math.h>
+
+using namespace std;
+using namespace fire;
+
+/**
+ * This operation creates the n x n tridiagonal matrix tridiag(-1,d,-1).
+ */
+static CSRMatrix<double> tridiagonal(const int & n, const double & d) {
+	vector<pair<int,int>> entries;
+	for (int i = 0; i < n; i++) {
+		for (int j = max(0,i-1); j <= min(n-1,i+1); j++) entries.emplace_back(i,j);
+	}
+	CSRMatrix<double> matrix(n,entries);
+	for (int i = 0; i < n; i++) {
+		for (int j = max(0,i-1); j <= min(n-1,i+1); j++) {
+			matrix.values[matrix.slot(i,j)] = (i == j) ? d : -1.0;
+		}
+	}
+	return matrix;
+}
+
+/**
+ * This operation checks the Jacobi preconditioner.
+ */
+BOOST_AUTO_TEST_CASE(checkJacobi) {
+	auto matrix = tridiagonal(10,4.0);
+	ThreadPool pool(2,1);
+	JacobiPreconditioner preconditioner(matrix,pool);
+	vector<double> r(10,2.0), z(10);
+	preconditioner.apply(r,z);
+	for (auto & value : z) BOOST_REQUIRE_CLOSE(0.5,value,1.0e-12);
+
+	// Rebuild after the values change
+	for (int i = 0; i < 10; i++) matrix.values[matrix.slot(i,i)] = 8.0;
+	preconditioner.update(matrix);
+	preconditioner.apply(r,z);
+	for (auto & value : z) BOOST_REQUIRE_CLOSE(0.25,value,1.0e-12);
+
+	// Zero diagonals are rejected
+	matrix.values[matrix.slot(3,3)] = 0.0;
+	BOOST_REQUIRE_THROW(JacobiPreconditioner bad(matrix),runtime_error);
+
+	return;
+}
+
+/**
+ * This operation checks that the incomplete Cholesky factorization of a
+ * tridiagonal matrix is exact, since it has no fill-in, so applying it
+ * inverts the matrix.
+ */
+BOOST_AUTO_TEST_CASE(checkIncompleteCholesky) {
+	int n = 20;
+	auto matrix = tridiagonal(n,2.5);
+	IncompleteCholeskyPreconditioner preconditioner(matrix);
+	vector<double> x(n), b, z(n);
+	for (int i = 0; i < n; i++) x[i] = sin(0.3*i) + 1.0;
+	matrix.multiply(x,b);
+	preconditioner.apply(b,z);
+	for (int i = 0; i < n; i++) BOOST_REQUIRE_CLOSE(x[i],z[i],1.0e-10);
+
+	// Indefinite matrices break down
+	auto indefinite = tridiagonal(n,0.5);
+	BOOST_REQUIRE_THROW(IncompleteCholeskyPreconditioner bad(indefinite),
+			runtime_error);
+
+	return;
+}
+
+/**
+ * This operation checks that the SSOR preconditioner is symmetric, which is
+ * required for CG, by comparing (u,M^{-1}v) and (M^{-1}u,v), and that it
+ * matches the definition of M for a small matrix.
+ */
+BOOST_AUTO_TEST_CASE(checkSSOR) {
+	int n = 15;
+	auto matrix = tridiagonal(n,3.0);
+	SSORPreconditioner preconditioner(matrix,1.3);
+	vector<double> u(n), v(n), mu(n), mv(n);
+	for (int i = 0; i < n; i++) {
+		u[i] = cos(0.7*i);
+		v[i] = 1.0 + 0.1*i*i;
+	}
+	preconditioner.apply(u,mu);
+	preconditioner.apply(v,mv);
+	double umv = 0.0, muv = 0.0;
+	for (int i = 0; i < n; i++) {
+		umv += u[i]*mv[i];
+		muv += mu[i]*v[i];
+	}
+	BOOST_REQUIRE_CLOSE(umv,muv,1.0e-10);
+
+	// M = w/(2-w) (D/w + L)(D/w)^{-1}(D/w + U) applied to M^{-1}u is u
+	double w = 1.3, d = 3.0/w;
+	vector<double> y(n), result(n);
+	for (int i = 0; i < n; i++) y[i] = d*mu[i] - ((i < n-1) ? mu[i+1] : 0.0);
+	for (int i = 0; i < n; i++) {
+		result[i] = (w/(2.0 - w))*(d*y[i] - ((i > 0) ? y[i-1] : 0.0))/d;
+		BOOST_REQUIRE_CLOSE(u[i] + 2.0,result[i] + 2.0,1.0e-10);
+	}
+
+	BOOST_REQUIRE_THROW(SSORPreconditioner bad(matrix,2.0),runtime_error);
+
+	return;
+}
+
+/**
+ * This operation checks the additive Schwarz preconditioner. A single
+ * subdomain inverts the matrix, and with several overlapping subdomains the
+ * preconditioner is symmetric.
+ */
+BOOST_AUTO_TEST_CASE(checkAdditiveSchwarz) {
+	int n = 40;
+	auto matrix = tridiagonal(n,4.0);
+	vector<double> r(n), z(n), Az;
+	for (int i = 0; i < n; i++) r[i] = sin(0.3*i) + 1.0;
+
+	AdditiveSchwarzPreconditioner exact(matrix,vector<int>(n,0));
+	BOOST_REQUIRE_EQUAL(1,exact.numSubdomains());
+	exact.apply(r,z);
+	matrix.multiply(z,Az);
+	for (int i = 0; i < n; i++) BOOST_REQUIRE_CLOSE(r[i],Az[i],1.0e-10);
+
+	// Four blocks of ten rows, grown by two rows on each side
+	vector<int> parts(n);
+	for (int i = 0; i < n; i++) parts[i] = i/10;
+	ThreadPool pool(4,1);
+	AdditiveSchwarzPreconditioner schwarz(matrix,parts,2,pool);
+	BOOST_REQUIRE_EQUAL(4,schwarz.numSubdomains());
+	BOOST_REQUIRE_EQUAL(14,schwarz.rows(1).size());
+	BOOST_REQUIRE_EQUAL(12,schwarz.rows(3).size());
+	vector<double> s(n), zs(n);
+	for (int i = 0; i < n; i++) s[i] = cos(0.7*i);
+	schwarz.apply(r,z);
+	schwarz.apply(s,zs);
+	double sz = 0.0, rzs = 0.0;
+	for (int i = 0; i < n; i++) {
+		sz += s[i]*z[i];
+		rzs += r[i]*zs[i];
+	}
+	BOOST_REQUIRE_CLOSE(sz,rzs,1.0e-10);
+	// Interior rows of a block are close to the exact solution because the
+	// inverse decays away from the diagonal
+	exact.apply(r,Az);
+	BOOST_REQUIRE_SMALL(Az[15] - z[15],1.0e-3);
+
+	// Rebuild after the values change
+	for (auto & value : matrix.values) value *= 2.0;
+	schwarz.update(matrix);
+	schwarz.apply(r,zs);
+	for (int i = 0; i < n; i++) BOOST_REQUIRE_CLOSE(0.5*z[i],zs[i],1.0e-10);
+
+	// Indefinite blocks and bad partitions are rejected
+	for (auto & value : matrix.values) value = -value;
+	BOOST_REQUIRE_THROW(schwarz.update(matrix),runtime_error);
+	BOOST_REQUIRE_THROW(AdditiveSchwarzPreconditioner bad(matrix,
+			vector<int>(3,0)),runtime_error);
+
+	return;
+}
@@ -0,0 +1,350 @@
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Solvers
+
+#include <boost/test/included/unit_test.hpp>
+#include <State.h>
+#include <RKSolver.h>
+#include <vector>
+#include <string>
+#include <math.h>
+
+using namespace std;
+using namespace fire;
+
+/**
+ * A simple, non-stiff test struct: y' = 0.85y.
+ */
+struct GrowthStruct {
+	vector<double> y;
+	vector<double> dydt;
+	GrowthStruct(const int & size) : y(size), dydt(size) {};
+};
+
+/**
+ * A scalar test struct with a stiffness that switches off at t = 1:
+ * y' = -lambda(t)(y - cos(t)) - sin(t), which has the solution y = cos(t) for
+ * y(0) = 1 and is stiff when lambda is large.
+ */
+struct SwitchingStruct {
+	vector<double> y;
+	vector<double> dydt;
+	SwitchingStruct(const int & size) : y(size), dydt(size) {};
+	double lambda(const double & t) const {
+		return (t < 1.0) ? 1.0e4 : 1.0;
+	}
+};
+
+/**
+ * A scalar test struct that relaxes to a steady state: y' = 1 - y, which has
+ * the solution y = 1 + exp(-t) for y(0) = 2.
+ */
+struct RelaxationStruct {
+	vector<double> y;
+	vector<double> dydt;
+	RelaxationStruct(const int & size) : y(size), dydt(size) {};
+};
+
+/**
+ * Explicit member function instantiations for the test structures.
+ */
+namespace fire {
+
+template<>
+double * State<GrowthStruct>::u() {
+	return state.y.data();
+};
+
+template<>
+double * State<GrowthStruct>::dudt(const double &) {
+	state.dydt[0] = 0.85*state.y[0];
+	return state.dydt.data();
+};
+
+template<>
+double * State<SwitchingStruct>::u() {
+	return state.y.data();
+};
+
+template<>
+double * State<SwitchingStruct>::dudt(const double & t) {
+	state.dydt[0] = -state.lambda(t)*(state.y[0] - cos(t)) - sin(t);
+	return state.dydt.data();
+};
+
+template<>
+double * State<RelaxationStruct>::u() {
+	return state.y.data();
+};
+
+template<>
+double * State<RelaxationStruct>::dudt(const double &) {
+	state.dydt[0] = 1.0 - state.y[0];
+	return state.dydt.data();
+};
+
+} // end namespace fire
+
+/**
+ * This operation checks that the solver integrates y' = 0.85y, y(0) = 1,
+ * accurately and without any stiff intervals.
+ */
+BOOST_AUTO_TEST_CASE(checkNonStiffSolve) {
+	State<GrowthStruct> state = buildState<GrowthStruct,const int &>(1, 1);
+	state.get().y[0] = 1.0;
+	state.t(0.0);
+
+	RKSolver<GrowthStruct> solver;
+	solver.tInit(0.0);
+	solver.tFinal(1.0);
+	solver.tolerances(1.0e-8,1.0e-12);
+	solver.solve(state);
+
+	BOOST_REQUIRE_CLOSE(1.0,state.t(),1.0e-10);
+	BOOST_REQUIRE_CLOSE(exp(0.85),state.get().y[0],1.0e-5);
+	auto & stats = solver.statistics();
+	BOOST_REQUIRE(stats.numSteps > 0);
+	// FSAL - six new evaluations per step plus the initial one
+	BOOST_REQUIRE_EQUAL(1 + 6*(stats.numSteps + stats.numRejectedSteps),
+			stats.numRHSEvals);
+	BOOST_REQUIRE_EQUAL(0,stats.numStiffnessDetections);
+	BOOST_REQUIRE_EQUAL(0,stats.numSwitchesToStiff);
+	BOOST_REQUIRE_CLOSE(1.0,stats.explicitT,1.0e-10);
+	BOOST_REQUIRE_EQUAL(0.0,stats.stiffT);
+
+	return;
+}
+
+/**
+ * This operation checks that stiffness is detected, that the problem is
+ * handed to the stiff solver and that it is taken back once the stiffness
+ * goes away.
+ */
+BOOST_AUTO_TEST_CASE(checkStiffnessSwitching) {
+	State<SwitchingStruct> state = buildState<SwitchingStruct,const int &>(1, 1);
+	state.get().y[0] = 1.0;
+	state.t(0.0);
+
+	// The stiff solver is a simple backward Euler integrator with a
+	// finite-difference Newton iteration.
+	int numStiffCalls = 0;
+	auto backwardEuler = [&](State<SwitchingStruct> & s, const double & t0,
+			const double & t1) {
+		numStiffCalls++;
+		int numSteps = 1000;
+		double h = (t1 - t0)/numSteps, t = t0;
+		double y = s.u()[0];
+		for (int i = 0; i < numSteps; i++) {
+			t += h;
+			double yNext = y;
+			for (int iter = 0; iter < 4; iter++) {
+				double val = yNext, pert = yNext + 1.0e-7;
+				s.u(&val);
+				double f = s.dudt(t)[0];
+				s.u(&pert);
+				double dfdy = (s.dudt(t)[0] - f)/1.0e-7;
+				yNext -= (yNext - y - h*f)/(1.0 - h*dfdy);
+			}
+			y = yNext;
+		}
+		s.u(&y);
+		s.t(t1);
+	};
+
+	RKSolver<SwitchingStruct> solver;
+	solver.tInit(0.0);
+	solver.tFinal(3.0);
+	solver.tolerances(1.0e-6,1.0e-9);
+	solver.stiffSolver(backwardEuler);
+	solver.solve(state);
+
+	auto & stats = solver.statistics();
+	BOOST_REQUIRE_CLOSE(3.0,state.t(),1.0e-10);
+	BOOST_REQUIRE(fabs(state.get().y[0] - cos(3.0)) < 1.0e-3);
+	BOOST_REQUIRE(stats.numStiffnessDetections >= 1);
+	BOOST_REQUIRE(stats.numSwitchesToStiff >= 1);
+	BOOST_REQUIRE(stats.numSwitchesToExplicit >= 1);
+	BOOST_REQUIRE_EQUAL(numStiffCalls,stats.numStiffIntervals);
+	BOOST_REQUIRE(stats.stiffT > 0.0);
+	BOOST_REQUIRE(stats.explicitT > 0.0);
+	BOOST_REQUIRE_CLOSE(3.0,stats.stiffT + stats.explicitT,1.0e-8);
+	BOOST_REQUIRE(stats.stiffWallTime > 0.0);
+	BOOST_REQUIRE(stats.explicitWallTime > 0.0);
+	BOOST_TEST_MESSAGE("Explicit steps = " << stats.numSteps
+			<< ", stiff intervals = " << stats.numStiffIntervals
+			<< ", explicit t = " << stats.explicitT
+			<< ", stiff t = " << stats.stiffT);
+
+	// Without a stiff solver the stiffness is only recorded.
+	state.get().y[0] = 1.0;
+	RKSolver<SwitchingStruct> explicitSolver;
+	explicitSolver.tInit(0.0);
+	explicitSolver.tFinal(0.5);
+	explicitSolver.solve(state);
+	BOOST_REQUIRE(explicitSolver.statistics().numStiffnessDetections >= 1);
+	BOOST_REQUIRE_EQUAL(0,explicitSolver.statistics().numSwitchesToStiff);
+	BOOST_REQUIRE(fabs(state.get().y[0] - cos(0.5)) < 1.0e-4);
+
+	return;
+}
+
+/**
+ * This operation checks that an integration restarted from a checkpoint takes
+ * exactly the same steps as the original integration.
+ */
+BOOST_AUTO_TEST_CASE(checkRestart) {
+	State<GrowthStruct> state = buildState<GrowthStruct,const int &>(1, 1);
+	state.get().y[0] = 1.0;
+	state.t(0.0);
+
+	// Run the full integration, writing checkpoints along the way.
+	string fileName = "rk_checkpoint.bin";
+	RKSolver<GrowthStruct> solver;
+	solver.tInit(0.0);
+	solver.tFinal(2.0);
+	solver.tolerances(1.0e-8,1.0e-12);
+	solver.checkpoints(fileName,0.5);
+	solver.solve(state);
+	solver.waitForCheckpoints();
+
+	// The last checkpoint is written after t = 1.5.
+	Checkpoint checkpoint;
+	checkpoint.read(fileName);
+	BOOST_REQUIRE_EQUAL("RKSolver",checkpoint.solver);
+	BOOST_REQUIRE(checkpoint.t >= 1.5 && checkpoint.t < 2.0);
+	BOOST_REQUIRE_EQUAL(1,checkpoint.u.size());
+	BOOST_REQUIRE_CLOSE(exp(0.85*checkpoint.t),checkpoint.u[0],1.0e-5);
+
+	// Restart into a fresh state and solver and continue to the end.
+	State<GrowthStruct> restartState = buildState<GrowthStruct,const int &>(1, 1);
+	restartState.get().y[0] = 0.0;
+	RKSolver<GrowthStruct> restartSolver;
+	restartSolver.tFinal(2.0);
+	restartSolver.tolerances(1.0e-8,1.0e-12);
+	restartSolver.restart(fileName);
+	restartSolver.solve(restartState);
+
+	// The steps, and thus the answer, must be identical.
+	BOOST_REQUIRE_EQUAL(state.t(),restartState.t());
+	BOOST_REQUIRE_EQUAL(state.get().y[0],restartState.get().y[0]);
+	auto & stats = solver.statistics(), & restartStats = restartSolver.statistics();
+	BOOST_REQUIRE_EQUAL(stats.numSteps,restartStats.numSteps);
+	BOOST_REQUIRE_EQUAL(stats.numRejectedSteps,restartStats.numRejectedSteps);
+	BOOST_REQUIRE_EQUAL(stats.numRHSEvals,restartStats.numRHSEvals);
+
+	// Checkpoints from other solvers must be rejected.
+	checkpoint.solver = "IVPSolver";
+	restartSolver.restart(checkpoint);
+	BOOST_REQUIRE_THROW(restartSolver.solve(restartState),std::runtime_error);
+
+	return;
+}
+
+/**
+ * This operation checks that threshold events are located accurately and
+ * that they stop or continue the integration as requested.
+ */
+BOOST_AUTO_TEST_CASE(checkThresholdEvents) {
+	State<GrowthStruct> state = buildState<GrowthStruct,const int &>(1, 1);
+	state.get().y[0] = 1.0;
+	state.t(0.0);
+
+	// y = 2 is passed on the way to y = 4, which stops the solve.
+	RKSolver<GrowthStruct> solver;
+	solver.tInit(0.0);
+	solver.tFinal(10.0);
+	solver.tolerances(1.0e-8,1.0e-12);
+	solver.addEvent(thresholdEvent("doubled",0,2.0,1,EventAction::CONTINUE));
+	solver.addEvent(thresholdEvent("quadrupled",0,4.0,1));
+	auto result = solver.solve(state);
+
+	double tQuad = log(4.0)/0.85;
+	BOOST_REQUIRE(result.terminatedEarly);
+	BOOST_REQUIRE_EQUAL("quadrupled",result.reason);
+	BOOST_REQUIRE_EQUAL(2,result.events.size());
+	BOOST_REQUIRE_EQUAL("doubled",result.events[0].name);
+	BOOST_REQUIRE(EventAction::CONTINUE == result.events[0].action);
+	BOOST_REQUIRE_CLOSE(log(2.0)/0.85,result.events[0].t,1.0e-4);
+	BOOST_REQUIRE_CLOSE(tQuad,result.terminationT,1.0e-4);
+	BOOST_REQUIRE_CLOSE(tQuad,result.t,1.0e-4);
+	BOOST_REQUIRE_CLOSE(tQuad,state.t(),1.0e-4);
+	BOOST_REQUIRE_CLOSE(4.0,state.get().y[0],1.0e-5);
+
+	// Solving again from y = 4 stops immediately because the event is already
+	// satisfied.
+	solver.tInit(state.t());
+	result = solver.solve(state);
+	BOOST_REQUIRE(result.terminatedEarly);
+	BOOST_REQUIRE_EQUAL(0,solver.statistics().numSteps);
+	BOOST_REQUIRE_CLOSE(tQuad,result.t,1.0e-4);
+
+	// Without events the solve runs to the end.
+	solver.clearEvents();
+	solver.tInit(0.0);
+	state.get().y[0] = 1.0;
+	result = solver.solve(state);
+	BOOST_REQUIRE(!result.terminatedEarly);
+	BOOST_REQUIRE(result.events.empty());
+	BOOST_REQUIRE_CLOSE(10.0,result.t,1.0e-10);
+
+	return;
+}
+
+/**
+ * This operation checks that a system that reaches a steady state is frozen
+ * rather than integrated to the final time.
+ */
+BOOST_AUTO_TEST_CASE(checkSteadyStateEvent) {
+	State<RelaxationStruct> state = buildState<RelaxationStruct,const int &>(1, 1);
+	state.get().y[0] = 2.0;
+	state.t(0.0);
+
+	// |y'|/|y| = exp(-t)/(1 + exp(-t)) falls below 1e-4 at t = ln(9999).
+	RKSolver<RelaxationStruct> solver;
+	solver.tInit(0.0);
+	solver.tFinal(1.0e6);
+	solver.tolerances(1.0e-8,1.0e-12);
+	solver.addEvent(steadyStateEvent(1.0e-4));
+	auto result = solver.solve(state);
+
+	BOOST_REQUIRE(result.terminatedEarly);
+	BOOST_REQUIRE_EQUAL("steady state",result.reason);
+	BOOST_REQUIRE_CLOSE(log(9999.0),result.terminationT,1.0e-2);
+	BOOST_REQUIRE_CLOSE(1.0e6,result.t,1.0e-10);
+	BOOST_REQUIRE_CLOSE(1.0e6,state.t(),1.0e-10);
+	BOOST_REQUIRE_CLOSE(1.0 + 1.0/9999.0,state.get().y[0],1.0e-6);
+	// Only a handful of steps are needed to reach the steady state.
+	BOOST_REQUIRE(solver.statistics().numSteps < 100);
+
+	return;
+}
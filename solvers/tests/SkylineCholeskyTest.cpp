@@ -0,0 +1,123 @@
+
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE SkylineCholesky
+
+#include <boost/test/included/unit_test.hpp>
+#include <SkylineCholesky.h>
+#include <CSRMatrix.h>
+#include <vector>
+#include <utility>
+#include <cmath>
+
+using namespace std;
+using namespace fire;
+
+/**
+ * This operation creates the 5-point Laplacian on an n by n grid plus a
+ * shift on the diagonal.
+ */
+static CSRMatrix<double> laplacian(const int & n, const double & shift) {
+	vector<pair<int,int>> entries;
+	for (int j = 0; j < n; j++) {
+		for (int i = 0; i < n; i++) {
+			int row = j*n + i;
+			entries.push_back(make_pair(row,row));
+			if (i > 0) entries.push_back(make_pair(row,row-1));
+			if (i < n-1) entries.push_back(make_pair(row,row+1));
+			if (j > 0) entries.push_back(make_pair(row,row-n));
+			if (j < n-1) entries.push_back(make_pair(row,row+n));
+		}
+	}
+	CSRMatrix<double> matrix(n*n, entries);
+	for (int row = 0; row < n*n; row++) {
+		for (long k = matrix.rowOffsets[row]; k < matrix.rowOffsets[row+1];
+				k++) {
+			matrix.values[k] = (matrix.columns[k] == row) ? 4.0 + shift : -1.0;
+		}
+	}
+	return matrix;
+}
+
+/**
+ * This operation checks the factorization and repeated solves against the
+ * residual of the system.
+ */
+BOOST_AUTO_TEST_CASE(checkSolve) {
+
+	int n = 12;
+	auto matrix = laplacian(n, 0.1);
+	SkylineCholesky cholesky;
+	BOOST_REQUIRE(!cholesky.factored());
+	cholesky.factor(matrix);
+	BOOST_REQUIRE(cholesky.factored());
+	BOOST_REQUIRE_EQUAL(n*n,cholesky.size());
+	// Row i holds the columns i-n to i, except in the first n rows, which
+	// only reach back to i-1
+	BOOST_REQUIRE_EQUAL(1 + 2*(n - 1) + (n*n - n)*(n + 1),cholesky.profile());
+
+	// The factors are reused for several right hand sides
+	vector<double> b(n*n), x, ax;
+	for (int rhs = 0; rhs < 3; rhs++) {
+		for (int i = 0; i < n*n; i++) b[i] = sin(0.1*i*(rhs + 1)) + 2.0;
+		cholesky.solve(b, x);
+		matrix.multiply(x, ax);
+		for (int i = 0; i < n*n; i++) BOOST_REQUIRE_CLOSE(b[i],ax[i],1.0e-10);
+	}
+
+	// The solution can overwrite the right hand side
+	vector<double> inPlace(b);
+	cholesky.solve(inPlace, inPlace);
+	for (int i = 0; i < n*n; i++) BOOST_REQUIRE_CLOSE(x[i],inPlace[i],1.0e-12);
+
+	BOOST_REQUIRE_THROW(cholesky.solve(vector<double>(3), x),
+			std::runtime_error);
+
+	return;
+}
+
+/**
+ * This operation checks that matrices that are not positive definite are
+ * rejected and that unfactored solves fail.
+ */
+BOOST_AUTO_TEST_CASE(checkErrors) {
+
+	SkylineCholesky cholesky;
+	vector<double> b(16, 1.0), x;
+	BOOST_REQUIRE_THROW(cholesky.solve(b, x), std::runtime_error);
+	auto indefinite = laplacian(4, -6.0);
+	BOOST_REQUIRE_THROW(cholesky.factor(indefinite), std::runtime_error);
+	BOOST_REQUIRE(!cholesky.factored());
+
+	return;
+}
@@ -0,0 +1,189 @@
+
+/**----------------------------------------------------------------------------
+ Copyright (c) 2017-, UT-Battelle, LLC
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ * Neither the name of fern nor the names of its
+ contributors may be used to endorse or promote products derived from
+ this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ Author(s): Jay Jay Billings (jayjaybillings <at> gmail <dot> com)
+ -----------------------------------------------------------------------------*/
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE ThreadPool
+
+#include <boost/test/included/unit_test.hpp>
+#include <ThreadPool.h>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <stdexcept>
+
+using namespace std;
+using namespace fire;
+
+/**
+ * This operation checks that parallel loops visit every index exactly once,
+ * both when they are long enough to be split and when they are executed
+ * serially.
+ */
+BOOST_AUTO_TEST_CASE(checkParallelFor) {
+
+	ThreadPool pool(4, 100);
+	BOOST_REQUIRE_EQUAL(4, pool.size());
+
+	// Long loop, split across all of the threads
+	vector<int> counts(10007, 0);
+	atomic<int> numRanges(0);
+	pool.parallelFor(0, counts.size(), [&](const long & begin, const long & end) {
+		numRanges++;
+		for (long i = begin; i < end; i++) counts[i]++;
+	});
+	BOOST_REQUIRE_EQUAL(4, numRanges.load());
+	for (auto & count : counts) BOOST_REQUIRE_EQUAL(1, count);
+
+	// Short loop with an offset, executed serially
+	numRanges = 0;
+	pool.parallelFor(5, 105, [&](const long & begin, const long & end) {
+		numRanges++;
+		for (long i = begin; i < end; i++) counts[i]++;
+	});
+	BOOST_REQUIRE_EQUAL(1, numRanges.load());
+	for (long i = 0; i < (long) counts.size(); i++) {
+		BOOST_REQUIRE_EQUAL((i >= 5 && i < 105) ? 2 : 1, counts[i]);
+	}
+
+	// Empty loops should not call the body
+	pool.parallelFor(10, 10, [&](const long &, const long &) {
+		BOOST_FAIL("Empty loop executed.");
+	});
+
+	return;
+}
+
+/**
+ * This operation checks parallel reductions and that the pool can be reused
+ * for many loops.
+ */
+BOOST_AUTO_TEST_CASE(checkParallelReduce) {
+
+	ThreadPool pool(3, 10);
+	long n = 100000;
+	for (int k = 0; k < 100; k++) {
+		double sum = pool.parallelReduce<double>(0, n, 1.0,
+				[&](const long & begin, const long & end) {
+					double partial = 0.0;
+					for (long i = begin; i < end; i++) partial += i;
+					return partial;
+				}, plus<double>());
+		BOOST_REQUIRE_CLOSE(1.0 + 0.5*n*(n - 1), sum, 1.0e-12);
+	}
+
+	// A pool with a single thread should work serially.
+	ThreadPool serialPool(1);
+	BOOST_REQUIRE_EQUAL(1, serialPool.size());
+	double maximum = serialPool.parallelReduce<double>(0, n, 0.0,
+			[&](const long &, const long & end) {
+				return (double) (end - 1);
+			}, [](const double & a, const double & b) {return max(a,b);});
+	BOOST_REQUIRE_CLOSE((double) (n - 1), maximum, 1.0e-12);
+
+	return;
+}
+
+/**
+ * This operation checks that exceptions thrown by the body on the calling
+ * thread or on a worker reach the caller after every range has finished and
+ * that the pool can be used afterwards.
+ */
+BOOST_AUTO_TEST_CASE(checkExceptions) {
+
+	ThreadPool pool(4, 10);
+	long n = 1000;
+	for (long failing : {0L, 500L, 999L}) {
+		atomic<long> visited(0);
+		BOOST_REQUIRE_THROW(pool.parallelFor(0, n,
+				[&](const long & begin, const long & end) {
+			// Make the other ranges slower than the failing one
+			this_thread::sleep_for(chrono::milliseconds(
+					(failing >= begin && failing < end) ? 0 : 20));
+			visited += end - begin;
+			if (failing >= begin && failing < end) {
+				throw runtime_error("Failed");
+			}
+		}), runtime_error);
+		BOOST_REQUIRE_EQUAL(n, visited.load());
+	}
+	BOOST_REQUIRE_THROW(pool.parallelReduce<double>(0, n, 0.0,
+			[&](const long & begin, const long &) -> double {
+				if (begin > 0) throw logic_error("Failed");
+				return 1.0;
+			}, plus<double>()), logic_error);
+
+	// The pool still works
+	vector<int> counts(n, 0);
+	pool.parallelFor(0, n, [&](const long & begin, const long & end) {
+		for (long i = begin; i < end; i++) counts[i]++;
+	});
+	for (auto & count : counts) BOOST_REQUIRE_EQUAL(1, count);
+
+	return;
+}
+
+/**
+ * This operation checks the grain of individual loops and that loops
+ * started from the body of another loop run serially.
+ */
+BOOST_AUTO_TEST_CASE(checkGrain) {
+
+	ThreadPool pool(4, 1000);
+	atomic<int> numRanges(0);
+	auto count = [&](const long &, const long &) { numRanges++;};
+	pool.parallelFor(0, 100, count);
+	BOOST_REQUIRE_EQUAL(1, numRanges.load());
+	numRanges = 0;
+	pool.parallelFor(0, 100, count, 10);
+	BOOST_REQUIRE_EQUAL(4, numRanges.load());
+	numRanges = 0;
+	pool.parallelFor(0, 30, count, 10);
+	BOOST_REQUIRE_EQUAL(3, numRanges.load());
+
+	// Nested loops
+	vector<int> counts(400, 0);
+	atomic<int> numInner(0);
+	pool.parallelFor(0, 4, [&](const long & begin, const long & end) {
+		for (long i = begin; i < end; i++) {
+			pool.parallelFor(100*i, 100*(i + 1),
+					[&](const long & first, const long & last) {
+				numInner++;
+				for (long k = first; k < last; k++) counts[k]++;
+			}, 1);
+		}
+	}, 1);
+	BOOST_REQUIRE_EQUAL(4, numInner.load());
+	for (auto & value : counts) BOOST_REQUIRE_EQUAL(1, value);
+
+	return;
+}
@@ -37,6 +37,7 @@
 #include <memory>
 #include <algorithm>
 #include <IVPSolver.h>
+#include <string>
 #include <iostream>
 #include <math.h>
 
@@ -103,6 +104,15 @@ BOOST_AUTO_TEST_CASE(checkAccessors) {
 	BOOST_REQUIRE_CLOSE(testTime,solver.tFinal(),1.0e-8);
 	solver.maxOutputSteps(15);
 	BOOST_REQUIRE_EQUAL(15,solver.maxOutputSteps());
+	BOOST_REQUIRE(LinearSolverType::DENSE == solver.linearSolver());
+	solver.linearSolver(LinearSolverType::GMRES);
+	BOOST_REQUIRE(LinearSolverType::GMRES == solver.linearSolver());
+	BOOST_REQUIRE_EQUAL(0,solver.krylovDimension());
+	solver.krylovDimension(10);
+	BOOST_REQUIRE_EQUAL(10,solver.krylovDimension());
+	BOOST_REQUIRE_EQUAL(100000,solver.threadedVectorSize());
+	solver.threadedVectorSize(10);
+	BOOST_REQUIRE_EQUAL(10,solver.threadedVectorSize());
 
 	return;
 }
@@ -144,3 +154,155 @@ BOOST_AUTO_TEST_CASE(checkSingleVariableSolve) {
 
 	return;
 }
+
+/**
+ * This operation checks that the IVPSolver can solve the same problem as
+ * checkSingleVariableSolve() with the matrix-free GMRES solver, which uses the
+ * default finite difference Jacobian-vector product on State.
+ */
+BOOST_AUTO_TEST_CASE(checkGMRESSolve) {
+	int size = 1;
+	State<TestStruct> state = buildState<TestStruct,const int &>(size, size);
+
+	// Set the initial t value on the state
+	double tInit = 0.0, t = 0.0, tFinal = 1.0, tol = 1.0e-3;
+	state.t(t);
+	// Set the initial conditions
+	TestStruct & myStruct = state.get();
+	myStruct.y[0] = 1.0;
+	// Configure the solver to use GMRES
+	IVPSolver<TestStruct> solver;
+	solver.t(t);
+	solver.tInit(tInit);
+	solver.tFinal(tFinal);
+	solver.linearSolver(LinearSolverType::GMRES);
+
+	// Execute the solver and check the result against y = e^(0.85).
+	solver.solve(state);
+	BOOST_REQUIRE_CLOSE(tFinal,state.t(),1.0e-8);
+	double expected = exp(0.85);
+	bool closeEnough = ((expected - state.get().y[0])/expected) < tol;
+	BOOST_REQUIRE(closeEnough);
+
+	return;
+}
+
+/**
+ * This operation checks that the IVPSolver gives the same answer with Fire's
+ * threaded N_Vector as it does with the serial vector by forcing it to use the
+ * threaded vector for a small system of independent equations y' = 0.85y.
+ */
+BOOST_AUTO_TEST_CASE(checkThreadedVectorSolve) {
+	int size = 1000;
+	State<TestStruct> state = buildState<TestStruct,const int &>(size, size);
+
+	double tInit = 0.0, t = 0.0, tFinal = 1.0, tol = 1.0e-3;
+	state.t(t);
+	TestStruct & myStruct = state.get();
+	for (int i = 0; i < size; i++) myStruct.y[i] = 1.0;
+	// Configure the solver to use the threaded vectors
+	IVPSolver<TestStruct> solver;
+	solver.t(t);
+	solver.tInit(tInit);
+	solver.tFinal(tFinal);
+	solver.threadedVectorSize(1);
+
+	// Execute the solver. The solution aliases the state's storage.
+	solver.solve(state);
+	BOOST_REQUIRE_CLOSE(tFinal,state.t(),1.0e-8);
+	double expected = exp(0.85);
+	for (int i = 0; i < size; i++) {
+		bool closeEnough = fabs((expected - state.get().y[i])/expected) < tol;
+		BOOST_REQUIRE(closeEnough);
+	}
+
+	return;
+}
+
+/**
+ * This operation checks that the IVPSolver writes checkpoints with the
+ * Nordsieck array and that it can restart from them.
+ */
+BOOST_AUTO_TEST_CASE(checkRestart) {
+	int size = 1;
+	State<TestStruct> state = buildState<TestStruct,const int &>(size, size);
+	state.t(0.0);
+	state.get().y[0] = 1.0;
+
+	// Solve to the end, writing checkpoints after every output step
+	string fileName = "ivp_checkpoint.bin";
+	IVPSolver<TestStruct> solver;
+	solver.tInit(0.0);
+	solver.tFinal(1.0);
+	solver.checkpoints(fileName);
+	solver.solve(state);
+	solver.waitForCheckpoints();
+
+	// The last checkpoint is from the second to last output step at t = 0.9.
+	Checkpoint checkpoint;
+	checkpoint.read(fileName);
+	BOOST_REQUIRE_EQUAL("IVPSolver",checkpoint.solver);
+	BOOST_REQUIRE_CLOSE(0.9,checkpoint.t,1.0e-8);
+	BOOST_REQUIRE(checkpoint.order >= 1);
+	BOOST_REQUIRE_EQUAL(checkpoint.order + 1,checkpoint.history.size());
+	BOOST_REQUIRE_CLOSE(checkpoint.u[0],checkpoint.history[0][0],1.0e-8);
+	// The second column is h*y' = 0.85*h*y.
+	BOOST_REQUIRE_CLOSE(0.85*checkpoint.stepSize*checkpoint.u[0],
+			checkpoint.history[1][0],1.0);
+
+	// Restart from the checkpoint in a fresh state
+	State<TestStruct> restartState = buildState<TestStruct,const int &>(size, size);
+	restartState.get().y[0] = 0.0;
+	IVPSolver<TestStruct> restartSolver;
+	restartSolver.tFinal(1.0);
+	restartSolver.restart(fileName);
+	restartSolver.solve(restartState);
+	BOOST_REQUIRE_CLOSE(1.0,restartState.t(),1.0e-8);
+	BOOST_REQUIRE_CLOSE(state.get().y[0],restartState.get().y[0],1.0e-1);
+
+	return;
+}
+
+/**
+ * This operation checks that events are located by CVODE's root finder and
+ * that they stop, freeze or continue the integration as requested.
+ */
+BOOST_AUTO_TEST_CASE(checkEvents) {
+	State<TestStruct> state = buildState<TestStruct,const int &>(1, 1);
+	state.t(0.0);
+	state.get().y[0] = 1.0;
+
+	// y = 1.5 is passed on the way to y = 2, which stops the solve.
+	IVPSolver<TestStruct> solver;
+	solver.t(0.0);
+	solver.tInit(0.0);
+	solver.tFinal(10.0);
+	solver.addEvent(thresholdEvent("half",0,1.5,1,EventAction::CONTINUE));
+	solver.addEvent(thresholdEvent("doubled",0,2.0,1));
+	auto result = solver.solve(state);
+
+	double tDouble = log(2.0)/0.85;
+	BOOST_REQUIRE(result.terminatedEarly);
+	BOOST_REQUIRE_EQUAL("doubled",result.reason);
+	BOOST_REQUIRE_EQUAL(2,result.events.size());
+	BOOST_REQUIRE_CLOSE(log(1.5)/0.85,result.events[0].t,1.0e-2);
+	BOOST_REQUIRE_CLOSE(tDouble,result.terminationT,1.0e-2);
+	BOOST_REQUIRE_CLOSE(tDouble,result.t,1.0e-2);
+	BOOST_REQUIRE_CLOSE(tDouble,state.t(),1.0e-2);
+	BOOST_REQUIRE_CLOSE(2.0,state.get().y[0],1.0e-2);
+
+	// Freezing the state at y = 2 moves it to the final time.
+	solver.clearEvents();
+	solver.addEvent(thresholdEvent("doubled",0,2.0,1,EventAction::FREEZE));
+	solver.t(0.0);
+	state.t(0.0);
+	state.get().y[0] = 1.0;
+	result = solver.solve(state);
+	BOOST_REQUIRE(result.terminatedEarly);
+	BOOST_REQUIRE_CLOSE(tDouble,result.terminationT,1.0e-2);
+	BOOST_REQUIRE_CLOSE(10.0,result.t,1.0e-8);
+	BOOST_REQUIRE_CLOSE(10.0,state.t(),1.0e-8);
+	BOOST_REQUIRE_CLOSE(2.0,state.get().y[0],1.0e-2);
+
+	return;
+}